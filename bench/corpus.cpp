@@ -0,0 +1,275 @@
+//
+// Created by Zack Shrout on 3/31/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "corpus.h"
+
+#include <cpng/encoder.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace cpng::bench {
+    namespace {
+        enum class content_t : uint8_t
+        {
+            photo,  // smooth gradients with grain: long literal runs, short matches
+            ui,     // flat panels and text-like dots: long matches
+            noise,  // incompressible
+        };
+
+        enum class blocks_t : uint8_t
+        {
+            stored,
+            fixed,
+            dynamic,
+            automatic,  // whatever the encoder picks
+        };
+
+        /// @brief xorshift32, so the corpus is the same on every machine.
+        struct rng_t
+        {
+            uint32_t state{ };
+
+            [[nodiscard]] uint32_t next() noexcept
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state;
+            }
+        };
+
+        [[nodiscard]] std::string_view content_name(const content_t content) noexcept
+        {
+            switch (content)
+            {
+                case content_t::photo: return "photo";
+                case content_t::ui:    return "ui";
+                case content_t::noise: return "noise";
+            }
+
+            return "?";
+        }
+
+        [[nodiscard]] std::string_view filter_name(const encode_filter filter) noexcept
+        {
+            switch (filter)
+            {
+                case encode_filter::none:     return "none";
+                case encode_filter::sub:      return "sub";
+                case encode_filter::up:       return "up";
+                case encode_filter::average:  return "average";
+                case encode_filter::paeth:    return "paeth";
+                case encode_filter::adaptive: return "adaptive";
+            }
+
+            return "?";
+        }
+
+        [[nodiscard]] std::string_view blocks_name(const blocks_t blocks) noexcept
+        {
+            switch (blocks)
+            {
+                case blocks_t::stored:    return "stored";
+                case blocks_t::fixed:     return "fixed";
+                case blocks_t::dynamic:   return "dynamic";
+                case blocks_t::automatic: return "auto";
+            }
+
+            return "?";
+        }
+
+        /// @brief RGBA8 pixels of the given content.
+        [[nodiscard]] std::vector<uint8_t> make_pixels(const content_t content, const uint32_t width,
+                                                       const uint32_t height)
+        {
+            std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+            rng_t rng{ 0x9E3779B9u ^ (width * 31u + height) };
+
+            for (uint32_t y{ 0 }; y < height; ++y)
+            {
+                uint8_t* p{ pixels.data() + static_cast<size_t>(y) * width * 4 };
+
+                for (uint32_t x{ 0 }; x < width; ++x, p += 4)
+                {
+                    switch (content)
+                    {
+                        case content_t::photo:
+                        {
+                            const uint32_t grain{ rng.next() & 7u };
+                            p[0] = static_cast<uint8_t>(20 + x * 200 / width + grain);
+                            p[1] = static_cast<uint8_t>(40 + y * 180 / height + grain);
+                            const uint32_t tint{ (x + y) * 127 / (width + height) };
+                            p[2] = static_cast<uint8_t>(64 + tint + ((x / 17 + y / 23) & 15u));
+                            p[3] = static_cast<uint8_t>(255 - y * 96 / height);
+                            break;
+                        }
+                        case content_t::ui:
+                        {
+                            const uint32_t cx{ x % 160 };
+                            const uint32_t cy{ y % 120 };
+                            const bool dark_panel{ ((x / 160 + y / 120) & 1u) != 0 };
+
+                            std::array<uint8_t, 3> rgb{ dark_panel ? std::array<uint8_t, 3>{ 40, 44, 52 }
+                                                                   : std::array<uint8_t, 3>{ 224, 228, 236 } };
+
+                            if (cx < 2 || cy < 2)
+                                rgb = { 90, 120, 200 };
+                            else if (cy >= 20 && cy < 100 && cy % 12 < 7 && cx >= 8 && cx < 152 &&
+                                     ((x * 2654435761u ^ (y / 2) * 40503u) >> 28) < 6)
+                                rgb = dark_panel ? std::array<uint8_t, 3>{ 230, 230, 230 }
+                                                 : std::array<uint8_t, 3>{ 20, 20, 20 };
+
+                            p[0] = rgb[0];
+                            p[1] = rgb[1];
+                            p[2] = rgb[2];
+                            p[3] = static_cast<uint8_t>(cy >= 110 ? 128 + (119 - cy) * 12 : 255);
+                            break;
+                        }
+                        case content_t::noise:
+                        {
+                            const uint32_t bits{ rng.next() };
+                            std::memcpy(p, &bits, 4);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            return pixels;
+        }
+
+        void add_image(std::vector<corpus_image_t>& corpus, const std::string_view group, const content_t content,
+                       const std::vector<uint8_t>& pixels, const uint32_t width, const uint32_t height,
+                       const bool alpha, const encode_filter filter, const blocks_t blocks)
+        {
+            encode_options_t options{ };
+            options.mode = blocks == blocks_t::stored ? compression_mode::stored : compression_mode::fast;
+            options.filter = filter;
+            options.drop_alpha = !alpha;
+
+            // A handful of tokens per block: the dynamic header would cost more than fixed codes lose
+            if (blocks == blocks_t::fixed) options.block_tokens = 8;
+
+            corpus_image_t image{ .name = { }, .png = { }, .width = width, .height = height };
+            image.name.append(group).append("/").append(content_name(content));
+            image.name.append(alpha ? "_rgba_" : "_rgb_").append(filter_name(filter));
+            image.name.append("_").append(blocks_name(blocks));
+            image.name.append("_").append(std::to_string(width)).append("x").append(std::to_string(height));
+
+            const image_view_t view{ .width = width, .height = height, .pixels = pixels };
+            if (encode(view, image.png, options) == decode_error::ok) corpus.push_back(std::move(image));
+        }
+
+        /// @brief A PNG color type and bit depth, as the encoder input that produces it.
+        struct layout_t
+        {
+            std::string_view    name;
+            pixel_format        format;
+            bool                drop_alpha;
+        };
+
+        /// @brief RGBA8 pixels rewritten as `format`: gray takes the red channel, 16-bit samples repeat the byte.
+        [[nodiscard]] std::vector<uint8_t> convert_pixels(const std::vector<uint8_t>& rgba, const pixel_format format)
+        {
+            const bool wide{ format == pixel_format::r16 || format == pixel_format::rg16 ||
+                             format == pixel_format::rgba16 };
+            const bool gray{ format == pixel_format::r8 || format == pixel_format::r16 };
+            const bool gray_alpha{ format == pixel_format::rg8 || format == pixel_format::rg16 };
+
+            // Source channel of each output channel
+            constexpr std::array<uint32_t, 4> gray_alpha_channels{ 0, 3 };
+            constexpr std::array<uint32_t, 4> color_channels{ 0, 1, 2, 3 };
+
+            const std::span<const uint32_t> channels{
+                std::span{ gray || gray_alpha ? gray_alpha_channels : color_channels }
+                    .first(gray ? 1 : gray_alpha ? 2 : 4)
+            };
+
+            std::vector<uint8_t> out;
+            out.reserve(rgba.size() / 4 * channels.size() * (wide ? 2 : 1));
+
+            for (size_t p{ 0 }; p < rgba.size(); p += 4)
+            {
+                for (const uint32_t c: channels)
+                {
+                    out.push_back(rgba[p + c]);
+                    if (wide) out.push_back(rgba[p + c]);
+                }
+            }
+
+            return out;
+        }
+
+        void add_layout_image(std::vector<corpus_image_t>& corpus, const std::vector<uint8_t>& rgba,
+                              const uint32_t width, const uint32_t height, const layout_t& layout)
+        {
+            encode_options_t options{ };
+            options.filter = encode_filter::adaptive;
+            options.drop_alpha = layout.drop_alpha;
+
+            corpus_image_t image{ .name = { }, .png = { }, .width = width, .height = height };
+            image.name.append("formats/photo_").append(layout.name).append("_adaptive_dynamic_");
+            image.name.append(std::to_string(width)).append("x").append(std::to_string(height));
+
+            const std::vector<uint8_t> pixels{ convert_pixels(rgba, layout.format) };
+            const image_view_t view{ .width = width, .height = height, .pixels = pixels, .format = layout.format };
+            if (encode(view, image.png, options) == decode_error::ok) corpus.push_back(std::move(image));
+        }
+    } // anonymous namespace
+
+    std::vector<corpus_image_t> generate_corpus(const corpus_options_t& options)
+    {
+        std::vector<corpus_image_t> corpus;
+
+        constexpr encode_filter filters[]{
+            encode_filter::none, encode_filter::sub, encode_filter::up, encode_filter::average, encode_filter::paeth,
+            encode_filter::adaptive,
+        };
+
+        for (const content_t content: { content_t::photo, content_t::ui })
+        {
+            const std::vector<uint8_t> pixels{ make_pixels(content, 256, 256) };
+
+            for (const bool alpha: { false, true })
+                for (const encode_filter filter: filters)
+                    for (const blocks_t blocks: { blocks_t::stored, blocks_t::fixed, blocks_t::dynamic })
+                        add_image(corpus, "matrix", content, pixels, 256, 256, alpha, filter, blocks);
+        }
+
+        constexpr layout_t layouts[]{
+            { "gray8", pixel_format::r8, false },       { "gray_alpha8", pixel_format::rg8, false },
+            { "rgb8", pixel_format::rgba8, true },      { "rgba8", pixel_format::rgba8, false },
+            { "gray16", pixel_format::r16, false },     { "gray_alpha16", pixel_format::rg16, false },
+            { "rgb16", pixel_format::rgba16, true },    { "rgba16", pixel_format::rgba16, false },
+        };
+
+        const std::vector<uint8_t> format_pixels{ make_pixels(content_t::photo, 512, 512) };
+        for (const layout_t& layout: layouts)
+            add_layout_image(corpus, format_pixels, 512, 512, layout);
+
+        constexpr std::array<std::array<uint32_t, 2>, 7> sizes{ {
+            { 1, 1 }, { 7, 3 }, { 64, 64 }, { 256, 256 }, { 1024, 1024 }, { 4096, 4096 }, { 16384, 16384 },
+        } };
+
+        for (const auto [width, height]: sizes)
+        {
+            if (std::max(width, height) > options.max_dimension) break;
+
+            for (const content_t content: { content_t::photo, content_t::ui })
+                add_image(corpus, "ladder", content, make_pixels(content, width, height), width, height, true,
+                          encode_filter::adaptive, blocks_t::dynamic);
+        }
+
+        if (options.max_dimension >= 1024)
+            add_image(corpus, "ladder", content_t::noise, make_pixels(content_t::noise, 1024, 1024), 1024, 1024, true,
+                      encode_filter::up, blocks_t::automatic);
+
+        return corpus;
+    }
+} // namespace cpng::bench
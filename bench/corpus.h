@@ -0,0 +1,45 @@
+//
+// Created by Zack Shrout on 3/31/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <cpng/CarrotPNG.h>
+
+#include <string>
+#include <vector>
+
+namespace cpng::bench {
+    struct corpus_image_t
+    {
+        std::string             name;       // group/content_layout_filter_blocks_WxH
+        std::vector<uint8_t>    png;
+        uint32_t                width{ };
+        uint32_t                height{ };
+    };
+
+    struct corpus_options_t
+    {
+        // Largest edge in the size ladder. 16384 adds the 16k x 16k images, which need several
+        // GiB of memory to generate and decode.
+        uint32_t    max_dimension{ 4096 };
+    };
+
+    /**
+     * @brief Generates the synthetic corpus in memory, deterministically.
+     *
+     * Three groups, all encoded with @ref encode:
+     *
+     *  - matrix: 256 x 256 "photo" (smooth gradients plus grain) and "ui" (flat panels, borders,
+     *    text-like dots) images, as RGB and RGBA, with every filter type plus adaptive, each in
+     *    stored, fixed Huffman and dynamic Huffman blocks. Tiny blocks make the encoder choose
+     *    fixed codes.
+     *  - formats: one 512 x 512 photo per color type and bit depth the encoder writes (gray,
+     *    gray + alpha, RGB and RGBA at 8 and 16 bits), adaptive filters, dynamic blocks.
+     *  - ladder: photo and ui RGBA images with adaptive filters at 1 x 1, 7 x 3, 64, 256, 1024,
+     *    4096 and 16384 pixels square, up to `max_dimension`, plus 1024 x 1024 incompressible
+     *    noise, for which the encoder falls back to stored blocks ("auto").
+     */
+    [[nodiscard]] std::vector<corpus_image_t> generate_corpus(const corpus_options_t& options = { });
+} // namespace cpng::bench
@@ -0,0 +1,449 @@
+//
+// Created by Zack Shrout on 3/31/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// CarrotPNG_bench: decode throughput, latency, memory and allocations.
+//
+//   CarrotPNG_bench [--min-time MS] [--max-dim N] [--match TEXT] [--dir DIR] [--write-corpus DIR] [--no-libpng]
+//                   [--stages]
+//
+// Decodes every image of the synthetic corpus (see corpus.h), plus every *.png under --dir, to
+// RGBA8 until --min-time (default 200 ms) has passed and at least 3 decodes ran. Reports the
+// p50 / p90 / p99 latency, MB/s of RGBA8 output at p50, and the heap allocations of each stage
+// of the public API. When built against a system libpng, the same images are decoded with its
+// simplified API for comparison. One more decode per image fills a decode_stats_t: the run
+// ends with the time split across decode stages, and --stages prints it for every image.
+// --max-dim 16384 adds the 16k x 16k images. --write-corpus writes the corpus as PNG files
+// and exits, to feed other decoders.
+
+#include "corpus.h"
+
+#include <cpng/decode_cost.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(CPNG_BENCH_HAVE_LIBPNG)
+#include <png.h>
+#endif
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// ──────────────────────────────────────────────────────────────────────────────
+// Allocation counting
+// ──────────────────────────────────────────────────────────────────────────────
+
+namespace {
+    std::atomic<uint64_t> g_allocations{ 0 };
+    std::atomic<uint64_t> g_allocated_bytes{ 0 };
+} // anonymous namespace
+
+void* operator new(const std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* p{ std::malloc(size == 0 ? 1 : size) }) return p;
+    throw std::bad_alloc{ };
+}
+
+void* operator new[](const std::size_t size) { return operator new(size); }
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    struct alloc_count_t
+    {
+        uint64_t    count{ };
+        uint64_t    bytes{ };
+    };
+
+    /// @brief Heap allocations made by one call of `fn`.
+    template <typename Fn>
+    alloc_count_t count_allocations(Fn&& fn)
+    {
+        const uint64_t count{ g_allocations.load(std::memory_order_relaxed) };
+        const uint64_t bytes{ g_allocated_bytes.load(std::memory_order_relaxed) };
+        fn();
+        return { .count = g_allocations.load(std::memory_order_relaxed) - count,
+                 .bytes = g_allocated_bytes.load(std::memory_order_relaxed) - bytes };
+    }
+
+    struct latency_t
+    {
+        double  p50_ms{ };
+        double  p90_ms{ };
+        double  p99_ms{ };
+        bool    ok{ false };
+    };
+
+    /// @brief Runs `fn` until `min_time` has passed and at least 3 samples exist; `fn` returns false on failure.
+    template <typename Fn>
+    latency_t measure(const std::chrono::milliseconds min_time, Fn&& fn)
+    {
+        std::vector<double> samples;
+        const clock_type::time_point start{ clock_type::now() };
+
+        while (samples.size() < 3 || clock_type::now() - start < min_time)
+        {
+            const clock_type::time_point begin{ clock_type::now() };
+            if (!fn()) return { };
+            samples.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - begin).count());
+        }
+
+        std::ranges::sort(samples);
+        const auto percentile = [&](const size_t p) { return samples[(samples.size() - 1) * p / 100]; };
+        return { .p50_ms = percentile(50), .p90_ms = percentile(90), .p99_ms = percentile(99), .ok = true };
+    }
+
+    /// @brief Peak resident set size of the process, in bytes.
+    uint64_t peak_rss_bytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{ };
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage{ };
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+#if defined(CPNG_BENCH_HAVE_LIBPNG)
+    bool libpng_decode(const std::vector<uint8_t>& png, std::vector<uint8_t>& pixels)
+    {
+        png_image image{ };
+        image.version = PNG_IMAGE_VERSION;
+        if (png_image_begin_read_from_memory(&image, png.data(), png.size()) == 0) return false;
+
+        image.format = PNG_FORMAT_RGBA;
+        pixels.resize(PNG_IMAGE_SIZE(image));
+
+        const bool ok{ png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr) != 0 };
+        png_image_free(&image);
+        return ok;
+    }
+#endif
+
+    bool read_file(const fs::path& path, std::vector<uint8_t>& out)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        out.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size()));
+
+        return file.good();
+    }
+
+    bool write_file(const fs::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return file.good();
+    }
+
+    void add_directory(const fs::path& dir, std::vector<cpng::bench::corpus_image_t>& corpus)
+    {
+        std::vector<fs::path> found;
+        std::error_code ec;
+        for (const fs::directory_entry& entry: fs::recursive_directory_iterator(dir, ec))
+            if (entry.is_regular_file() && entry.path().extension() == ".png")
+                found.push_back(entry.path());
+
+        std::ranges::sort(found);
+
+        for (const fs::path& path: found)
+        {
+            cpng::bench::corpus_image_t image{ .name = "real/" + fs::relative(path, dir).generic_string(), .png = { },
+                                               .width = 0, .height = 0 };
+            cpng::ihdr_info_t ihdr{ };
+
+            if (!read_file(path, image.png) || cpng::read_ihdr_from_memory(image.png, ihdr) != cpng::decode_error::ok)
+            {
+                std::println(stderr, "{}: cannot read", path.generic_string());
+                continue;
+            }
+
+            image.width = ihdr.width;
+            image.height = ihdr.height;
+            corpus.push_back(std::move(image));
+        }
+    }
+
+    bool parse_u32(const std::string_view text, uint32_t& out)
+    {
+        return std::from_chars(text.data(), text.data() + text.size(), out).ec == std::errc{ };
+    }
+
+    void usage()
+    {
+        std::println(stderr, "usage: CarrotPNG_bench [--min-time MS] [--max-dim N] [--match TEXT] [--dir DIR] "
+                             "[--write-corpus DIR] [--no-libpng] [--stages]");
+    }
+
+    double to_mib(const uint64_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    double to_ms(const uint64_t ns)
+    {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    void accumulate(cpng::decode_stats_t& total, const cpng::decode_stats_t& stats)
+    {
+        total.parse_ns += stats.parse_ns;
+        total.crc_ns += stats.crc_ns;
+        total.concat_ns += stats.concat_ns;
+        total.inflate_ns += stats.inflate_ns;
+        total.adler_ns += stats.adler_ns;
+        total.defilter_ns += stats.defilter_ns;
+        total.convert_ns += stats.convert_ns;
+    }
+
+    void print_stage_times(const std::string_view prefix, const cpng::decode_stats_t& stats)
+    {
+        std::println("{}parse {:.3f} / crc {:.3f} / concat {:.3f} / inflate {:.3f} / adler {:.3f} / defilter {:.3f} / "
+                     "convert {:.3f} ms", prefix, to_ms(stats.parse_ns), to_ms(stats.crc_ns), to_ms(stats.concat_ns),
+                     to_ms(stats.inflate_ns), to_ms(stats.adler_ns), to_ms(stats.defilter_ns),
+                     to_ms(stats.convert_ns));
+    }
+
+    void print_stage_counts(const cpng::decode_stats_t& stats)
+    {
+        std::println("    {} IDAT, blocks {} stored / {} fixed / {} dynamic, {} table builds, {} literals, "
+                     "{} matches ({} bytes)", stats.idat_chunks, stats.stored_blocks, stats.fixed_blocks,
+                     stats.dynamic_blocks, stats.huffman_table_builds, stats.literals, stats.matches,
+                     stats.match_bytes);
+        std::println("    filter rows {} / {} / {} / {} / {}, {:.1f} KiB allocated, {:.1f} KiB peak scratch",
+                     stats.filter_rows[0], stats.filter_rows[1], stats.filter_rows[2], stats.filter_rows[3],
+                     stats.filter_rows[4], static_cast<double>(stats.bytes_allocated) / 1024.0,
+                     static_cast<double>(stats.peak_scratch_bytes) / 1024.0);
+    }
+} // anonymous namespace
+
+int main(const int argc, char** argv)
+{
+    uint32_t min_time_ms{ 200 };
+    cpng::bench::corpus_options_t corpus_options{ };
+    std::string_view match{ };
+    std::vector<fs::path> dirs;
+    const char* write_dir{ nullptr };
+    bool use_libpng{ true };
+    bool show_stages{ false };
+
+    for (int arg{ 1 }; arg < argc; ++arg)
+    {
+        const std::string_view flag{ argv[arg] };
+        const bool has_value{ arg + 1 < argc };
+
+        if (flag == "--min-time" && has_value && parse_u32(argv[arg + 1], min_time_ms))
+            ++arg;
+        else if (flag == "--max-dim" && has_value && parse_u32(argv[arg + 1], corpus_options.max_dimension))
+            ++arg;
+        else if (flag == "--match" && has_value)
+            match = argv[++arg];
+        else if (flag == "--dir" && has_value)
+            dirs.emplace_back(argv[++arg]);
+        else if (flag == "--write-corpus" && has_value)
+            write_dir = argv[++arg];
+        else if (flag == "--no-libpng")
+            use_libpng = false;
+        else if (flag == "--stages")
+            show_stages = true;
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+#if !defined(CPNG_BENCH_HAVE_LIBPNG)
+    use_libpng = false;
+#endif
+
+    std::vector<cpng::bench::corpus_image_t> corpus{ cpng::bench::generate_corpus(corpus_options) };
+    for (const fs::path& dir: dirs)
+        add_directory(dir, corpus);
+
+    std::erase_if(corpus, [&](const cpng::bench::corpus_image_t& image) {
+        return image.name.find(match) == std::string::npos;
+    });
+
+    if (write_dir != nullptr)
+    {
+        for (const cpng::bench::corpus_image_t& image: corpus)
+        {
+            if (!write_file(fs::path{ write_dir } / (image.name + ".png"), image.png))
+            {
+                std::println(stderr, "{}: cannot write", image.name);
+                return 1;
+            }
+        }
+
+        std::println("Wrote {} images to {}", corpus.size(), write_dir);
+        return 0;
+    }
+
+    // What the corpus exercises, counted by the same walk as cpng_reencode
+    cpng::decode_cost_t composition{ };
+    for (const cpng::bench::corpus_image_t& image: corpus)
+    {
+        cpng::decode_cost_t cost{ };
+        if (cpng::estimate_decode_cost(image.png, cost) != cpng::decode_error::ok) continue;
+
+        composition.idat_chunks += cost.idat_chunks;
+        composition.stored_blocks += cost.stored_blocks;
+        composition.fixed_blocks += cost.fixed_blocks;
+        composition.dynamic_blocks += cost.dynamic_blocks;
+        for (size_t f{ 0 }; f < composition.filter_bytes.size(); ++f)
+            composition.filter_bytes[f] += cost.filter_bytes[f];
+    }
+
+    std::println("{} | {} images, {} IDAT chunks, blocks: {} stored / {} fixed / {} dynamic", cpng::version_string(),
+                 corpus.size(), composition.idat_chunks, composition.stored_blocks, composition.fixed_blocks,
+                 composition.dynamic_blocks);
+    std::println("Filtered bytes: none {:.1f} / sub {:.1f} / up {:.1f} / average {:.1f} / paeth {:.1f} MiB",
+                 to_mib(composition.filter_bytes[0]), to_mib(composition.filter_bytes[1]),
+                 to_mib(composition.filter_bytes[2]), to_mib(composition.filter_bytes[3]),
+                 to_mib(composition.filter_bytes[4]));
+    std::println("Allocations per decode: probe = read_ihdr_from_memory, into = decode into a caller buffer, "
+                 "alloc = decode into a new vector");
+    std::println("{:<48} {:>10} {:>9} {:>9} {:>9} {:>9} {:>12} {:>14} {:>14}{}", "image", "png bytes", "p50 ms",
+                 "p90 ms", "p99 ms", "MB/s", "probe", "into", "alloc",
+                 use_libpng ? "  libpng p50 ms (CarrotPNG speedup)" : "");
+
+    const std::chrono::milliseconds min_time{ min_time_ms };
+    uint64_t total_output_bytes{ 0 };
+    double total_p50_ms{ 0.0 };
+    double total_libpng_ms{ 0.0 };
+    uint32_t failed{ 0 };
+    cpng::decode_stats_t total_stages{ };
+    std::vector<uint8_t> pixels;
+
+    for (const cpng::bench::corpus_image_t& image: corpus)
+    {
+        const size_t output_bytes{ static_cast<size_t>(image.width) * image.height * 4 };
+        pixels.resize(output_bytes);
+
+        cpng::image_view_t view{ };
+        cpng::decode_error err{ cpng::decode_error::ok };
+
+        const alloc_count_t probe_allocs{ count_allocations([&] {
+            cpng::ihdr_info_t ihdr{ };
+            err = cpng::read_ihdr_from_memory(image.png, ihdr);
+        }) };
+        const alloc_count_t into_allocs{ count_allocations([&] {
+            if (err == cpng::decode_error::ok) err = cpng::load_from_memory(image.png, view, std::span{ pixels });
+        }) };
+        const alloc_count_t alloc_allocs{ count_allocations([&] {
+            std::vector<uint8_t> storage;
+            if (err == cpng::decode_error::ok) err = cpng::load_from_memory(image.png, view, storage);
+        }) };
+
+        if (err != cpng::decode_error::ok)
+        {
+            std::println(stderr, "{}: {}", image.name, cpng::to_string(err));
+            ++failed;
+            continue;
+        }
+
+        const latency_t latency{ measure(min_time, [&] {
+            return cpng::load_from_memory(image.png, view, std::span{ pixels }) == cpng::decode_error::ok;
+        }) };
+
+        cpng::decode_stats_t stats{ };
+        if (cpng::load_from_memory(image.png, view, std::span{ pixels }, 0, { }, stats) == cpng::decode_error::ok)
+            accumulate(total_stages, stats);
+
+        total_output_bytes += output_bytes;
+        total_p50_ms += latency.p50_ms;
+
+        std::print("{:<48} {:>10} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.1f} {:>5} {:>6.1f}K {:>5} {:>7.1f}K {:>5} {:>7.1f}K",
+                   image.name, image.png.size(), latency.p50_ms, latency.p90_ms, latency.p99_ms,
+                   static_cast<double>(output_bytes) / (latency.p50_ms * 1000.0), probe_allocs.count,
+                   static_cast<double>(probe_allocs.bytes) / 1024.0, into_allocs.count,
+                   static_cast<double>(into_allocs.bytes) / 1024.0, alloc_allocs.count,
+                   static_cast<double>(alloc_allocs.bytes) / 1024.0);
+
+#if defined(CPNG_BENCH_HAVE_LIBPNG)
+        if (use_libpng)
+        {
+            std::vector<uint8_t> libpng_pixels;
+            const latency_t libpng{ measure(min_time, [&] { return libpng_decode(image.png, libpng_pixels); }) };
+
+            if (libpng.ok)
+            {
+                total_libpng_ms += libpng.p50_ms;
+                std::print("  {:>9.3f} ({:.2f}x)", libpng.p50_ms, libpng.p50_ms / latency.p50_ms);
+            }
+            else
+            {
+                std::print("  {:>9}", "failed");
+            }
+        }
+#endif
+
+        std::println("");
+
+        if (show_stages)
+        {
+            print_stage_times("    ", stats);
+            print_stage_counts(stats);
+        }
+    }
+
+    std::println("Total: {:.1f} MiB RGBA8 in {:.2f} ms at p50, {:.1f} MB/s", to_mib(total_output_bytes), total_p50_ms,
+                 total_p50_ms > 0.0 ? static_cast<double>(total_output_bytes) / (total_p50_ms * 1000.0) : 0.0);
+    print_stage_times("Stages: ", total_stages);
+    if (use_libpng && total_libpng_ms > 0.0)
+        std::println("libpng: {:.2f} ms at p50, CarrotPNG speedup {:.2f}x", total_libpng_ms,
+                     total_libpng_ms / total_p50_ms);
+    std::println("Peak RSS: {:.1f} MiB{}", to_mib(peak_rss_bytes()), failed == 0 ? "" : ", some images failed");
+
+    return failed == 0 ? 0 : 1;
+}
@@ -18,12 +18,20 @@
  *  - PNG scanline filter reconstruction
  *  - Conversion to RGBA8 pixel format
  *
- * Current supported PNG features (MVP):
- *  - Bit depth: 8
+ * Current supported PNG features:
+ *  - Bit depths: 1, 2, 4 (grayscale), 8 and 16
  *  - Color types:
+ *      - Grayscale (0)
  *      - RGB (2)
+ *      - Grayscale + alpha (4)
  *      - RGBA (6)
- *  - Non-interlaced images only
+ *  - Non-interlaced and Adam7 interlaced images
+ *
+ * Output is RGBA8 by default; RGBA16 is available for high precision
+ * content, RGBA32F / RGBA16F for linear lighting data, and grayscale images
+ * can also be emitted as R8 / RG8 / R16 / RG16 through @ref decode_options_t.
+ * Mip chains and BC1 / BC3 / BC4 / BC5 block compressed textures can be
+ * produced in the same pass as the decode.
  *
  * Unsupported features will return an appropriate @ref decode_error.
  *
@@ -61,9 +69,9 @@
  *  - Clear error reporting
  *
  * @note
- * This library does not perform color management or gamma correction.
- * PNG color information (gAMA, sRGB, etc.) may be supported in future
- * versions.
+ * No color management is performed by default. sRGB-to-linear and
+ * gAMA-based correction can be requested per decode through
+ * @ref decode_options_t::transform; ICC profiles are not interpreted.
  *
  * @author Zack Shrout
  * @copyright BunnySoft
@@ -80,13 +88,194 @@
 #include <cstddef>
 
 namespace cpng {
+    /**
+     * @brief Layout of decoded output pixels.
+     *
+     * Grayscale sources (color types 0 and 4) can be emitted in their native
+     * channel count; every source can be expanded to RGBA.
+     *
+     * Sample width is converted as needed: 16-bit sources are rounded to
+     * 8 bits for the 8-bit formats, and 8-bit (or sub-byte) sources are
+     * widened exactly (v * 257) for the 16-bit formats.
+     */
+    enum class pixel_format : uint8_t
+    {
+        rgba8,  // 4 × 8-bit; gray is replicated to RGB, missing alpha is 255
+        r8,     // 1 × 8-bit gray (grayscale sources only, alpha dropped)
+        rg8,    // 2 × 8-bit gray + alpha (grayscale sources only, alpha 255 if absent)
+        rgba16, // 4 × 16-bit, native endian; missing alpha is 65535
+        r16,    // 1 × 16-bit gray, native endian (grayscale sources only)
+        rg16,   // 2 × 16-bit gray + alpha, native endian (grayscale sources only)
+        rgba32f,// 4 × 32-bit float, normalized 0..1
+        rgba16f,// 4 × 16-bit half float, normalized 0..1
+    };
+
+    /**
+     * @brief Optional transfer function applied to color channels while rows are emitted.
+     *
+     * Alpha is always passed through linearly. Transforms are table driven: a LUT with one
+     * entry per input code (256 for 8-bit sources, 65536 for 16-bit) is built per decode.
+     */
+    enum class color_transform : uint8_t
+    {
+        none,           // samples are stored as encoded in the file
+        srgb_to_linear, // decode the sRGB curve; pair with a float format to keep precision
+        gamma,          // gAMA correction: out = in^(1 / (file_gamma * display_gamma)); sRGB files use 1/2.2
+    };
+
+    /**
+     * @brief Content statistics gathered while rows are written (@ref decode_options_t::compute_stats).
+     *
+     * Computed on the output samples, i.e. after transforms and premultiplication. Gray
+     * layouts report their gray channel as R, G and B; formats without alpha report 1.
+     */
+    struct image_stats_t
+    {
+        bool                    valid{ false };         // false when statistics were not requested
+        bool                    alpha_opaque{ false };  // every alpha sample is 1.0 (255 for RGBA8)
+        bool                    alpha_binary{ false };  // every alpha sample is 0 or 1.0
+        bool                    grayscale{ false };     // R == G == B for every pixel
+        bool                    solid{ false };         // every pixel is identical
+        std::array<float, 4>    channel_min{ };         // normalized 0..1, RGBA order
+        std::array<float, 4>    channel_max{ };
+    };
+
+    /**
+     * @brief Where one decode spent its time and memory (the @ref load_from_memory overloads taking one).
+     *
+     * Stage times are wall clock nanoseconds and do not overlap. `parse_ns` is the chunk walk
+     * and output stage setup without the CRC checks, and `inflate_ns` excludes the Adler-32
+     * check. `convert_ns` covers writing output rows (unpacking, transforms, premultiplication,
+     * statistics and hashing). Memory counts the decoder's own heap buffers; Huffman tables
+     * live on the stack and are not included.
+     */
+    struct decode_stats_t
+    {
+        uint64_t                    parse_ns{ };
+        uint64_t                    crc_ns{ };
+        uint64_t                    concat_ns{ };
+        uint64_t                    inflate_ns{ };
+        uint64_t                    adler_ns{ };
+        uint64_t                    defilter_ns{ };
+        uint64_t                    convert_ns{ };
+
+        uint32_t                    idat_chunks{ };
+        uint32_t                    stored_blocks{ };
+        uint32_t                    fixed_blocks{ };
+        uint32_t                    dynamic_blocks{ };
+        uint32_t                    huffman_table_builds{ };    // three per dynamic block; fixed tables are prebuilt
+        uint64_t                    literals{ };
+        uint64_t                    matches{ };
+        uint64_t                    match_bytes{ };             // bytes produced by matches
+        std::array<uint64_t, 5>     filter_rows{ };             // scanlines per filter type, Adam7 passes included
+
+        uint64_t                    bytes_allocated{ };         // output storage included
+        uint64_t                    peak_scratch_bytes{ };      // most intermediate bytes alive at once
+    };
+
+    /**
+     * @brief GPU block compressed formats produced by @ref load_compressed_from_memory.
+     *
+     * Each 4×4 pixel block is encoded independently; blocks past the right or bottom edge
+     * repeat the last column / row of the image.
+     */
+    enum class block_format : uint8_t
+    {
+        bc1,    // 8 bytes per block, RGB (alpha is dropped)
+        bc3,    // 16 bytes per block, RGBA: BC4 style alpha + BC1 color
+        bc4,    // 8 bytes per block, one channel (grayscale sources only)
+        bc5,    // 16 bytes per block, two channels: gray + alpha (grayscale sources only)
+    };
+
+    struct compressed_image_t
+    {
+        uint32_t                    width{ };       // in pixels
+        uint32_t                    height{ };
+        uint32_t                    blocks_x{ };
+        uint32_t                    blocks_y{ };
+        std::span<const uint8_t>    blocks{ };      // row-major blocks, `row_pitch_bytes` per block row
+        uint32_t                    row_pitch_bytes{ };
+        block_format                format{ block_format::bc1 };
+        bool                        is_srgb{ true };
+        image_stats_t               stats{ };       // of the rows fed to the encoder
+    };
+
     struct image_view_t
     {
         uint32_t                    width{ };
         uint32_t                    height{ };
-        std::span<const uint8_t>    pixels{ }; // contiguous RGBA8, row-major
+        std::span<const uint8_t>    pixels{ }; // contiguous, row-major, laid out as `format`
         uint32_t                    stride_bytes{ };
+        pixel_format                format{ pixel_format::rgba8 };
         bool                        is_srgb{ true };
+        image_stats_t               stats{ };
+        uint64_t                    pixel_hash{ };  // XXH64 of `pixels` (@ref decode_options_t::compute_hashes)
+        uint64_t                    source_hash{ }; // same value as @ref compressed_hash_from_memory
+    };
+
+    /// @brief A decoded image together with its pixel storage; `view` references `storage`.
+    struct decoded_image_t
+    {
+        image_view_t            view{ };
+        std::vector<uint8_t>    storage{ };
+
+        decoded_image_t() = default;
+        decoded_image_t(const decoded_image_t&) = delete;            // the view would dangle
+        decoded_image_t& operator=(const decoded_image_t&) = delete;
+    };
+
+    struct decode_diagnostics_t;
+
+    struct decode_options_t
+    {
+        pixel_format    format{ pixel_format::rgba8 };
+
+        // Adam7 progressive preview: decode only the first N passes (1..7) and replicate each
+        // pixel over the block it stands for. Only the needed prefix of the zlib stream is
+        // inflated, so a 1-pass preview costs roughly 1/64 of a full decode. Values outside
+        // 1..6 decode everything; ignored for non-interlaced images.
+        uint8_t         adam7_passes{ 7 };
+
+        // Transfer function applied during row emission (no extra pass over the image).
+        color_transform transform{ color_transform::none };
+
+        // Target exponent for color_transform::gamma: 2.2 for a typical display, 1.0 for linear output.
+        // Images without gAMA or sRGB information are left untouched by that transform.
+        float           display_gamma{ 2.2f };
+
+        // Multiply color by alpha while rows are written (exact rounding). For float formats the
+        // multiply happens after the transfer function, i.e. in linear space when linearizing.
+        // No-op for images without an alpha channel and for single channel formats.
+        bool            premultiply_alpha{ false };
+
+        // Mip chain generation (@ref load_mip_chain_from_memory only): number of levels including
+        // the base, 0 for a full chain down to 1×1. Levels use a 2×2 box filter with floor sizing.
+        uint32_t        mip_levels{ 0 };
+
+        // Average 8-bit color channels in linear light (sRGB decode, average, re-encode through LUTs)
+        // instead of averaging the encoded values. Alpha is always averaged linearly. Samples that
+        // color_transform::srgb_to_linear already linearized cannot be averaged this way.
+        bool            mip_srgb_average{ false };
+
+        // Gather @ref image_stats_t (alpha usage, grayscale, solid color, channel ranges) while rows
+        // are written, instead of a separate read pass over the decoded image. Flags the color type
+        // already answers (no alpha channel, grayscale source) are set without scanning.
+        bool            compute_stats{ false };
+
+        // Fill image_view_t::pixel_hash (XXH64 of the output pixels, hashed row by row as they are
+        // finalized) and image_view_t::source_hash (see @ref compressed_hash_from_memory).
+        // Used by @ref load_from_memory / @ref load_from_file and for level 0 of
+        // @ref load_mip_chain_from_memory; block compressed output carries no hashes.
+        bool            compute_hashes{ false };
+
+        // Threads used by the parallel stages (currently block compression), the calling thread
+        // included. 0 uses one per hardware thread.
+        uint32_t        worker_threads{ 1 };
+
+        // Filled with where and why a decode failed (reset when it starts), without any I/O.
+        // Decodes running at the same time need a record each; build_atlas, image_cache_t and
+        // async_loader_t give each of their decodes one and copy a failed one here.
+        decode_diagnostics_t* diagnostics{ nullptr };
     };
 
     enum class decode_error : uint8_t
@@ -109,6 +298,46 @@ namespace cpng {
         unsupported_interlace,
         unsupported_filter,
         file_not_found,
+        unsupported_output_format,
+        invalid_archive,
+        atlas_overflow,
+        invalid_chunk_data,
+        invalid_image_view,
+        file_write_failed,
+    };
+
+    /// @brief Decode stage in which a @ref decode_diagnostics_t failure happened.
+    enum class decode_stage : uint8_t
+    {
+        none,       // the decode succeeded
+        read,       // reading the file (@ref load_from_file)
+        parse,      // chunk walk, CRC checks
+        validate,   // header checks and output stage setup
+        inflate,
+        adler32,
+        defilter,
+        output,     // caller buffer checks
+    };
+
+    /**
+     * @brief Context of a failed decode (@ref decode_options_t::diagnostics).
+     *
+     * The innermost failing check fills the record, so a corrupt deflate stream reports where
+     * in the stream it broke rather than only @ref decode_error::invalid_idat_stream. Fields
+     * a stage has no use for stay zero.
+     */
+    struct decode_diagnostics_t
+    {
+        decode_error    error{ decode_error::ok };
+        decode_stage    stage{ decode_stage::none };
+        const char*     reason{ "" };           // static string naming the failed check
+        uint64_t        byte_offset{ };         // read position in the zlib stream (inflate, adler32) or scanlines
+        uint8_t         bit_offset{ };          // bits of that byte already consumed (inflate)
+        uint32_t        block_index{ };         // deflate block, from 0
+        uint64_t        symbol_index{ };        // literal/length symbol within the block, from 0
+        uint32_t        row{ };                 // scanline, within its Adam7 pass for interlaced images
+        uint64_t        expected_size{ };       // bytes the stage needed
+        uint64_t        actual_size{ };         // bytes it had or produced
     };
 
     struct ihdr_info_t
@@ -161,18 +390,22 @@ namespace cpng {
     [[nodiscard]] decode_error read_ihdr_from_memory(std::span<const uint8_t> data, ihdr_info_t& out_ihdr) noexcept;
 
     /**
-     * @brief Fully decodes a PNG image from memory into RGBA8 pixel data.
+     * @brief Fully decodes a PNG image from memory into RGBA8 (or the requested) pixel data.
      *
      * This function parses the PNG structure, concatenates IDAT chunks,
      * inflates the DEFLATE stream, applies PNG scanline filters, and
-     * converts the result into a contiguous RGBA8 pixel buffer.
+     * converts each reconstructed row into the output format as soon as it
+     * has been de-filtered.
      *
-     * Supported features (current MVP implementation):
-     * - Non-interlaced images only
-     * - Bit depth: 8
-     * - Color types: RGB (2) and RGBA (6)
+     * Supported features:
+     * - Non-interlaced and Adam7 interlaced images (with optional pass-limited preview)
+     * - Bit depths: 1, 2, 4 (grayscale), 8 and 16
+     * - Color types: grayscale (0), RGB (2), grayscale + alpha (4) and RGBA (6)
      *
-     * RGB images are automatically expanded to RGBA with alpha set to 255.
+     * With the default RGBA8 output, missing channels are expanded: gray is
+     * replicated into RGB and alpha is set to 255. Sub-byte samples are scaled
+     * to the full 0..255 range. 16-bit images can be emitted as native-endian
+     * RGBA16 (or R16 / RG16), or rounded to 8 bits for the 8-bit formats.
      *
      * @param data
      *     A contiguous memory buffer containing the PNG file contents.
@@ -182,14 +415,19 @@ namespace cpng {
      *     The pixel span references the storage in `out_pixel_storage`.
      *
      * @param out_pixel_storage
-     *     Storage buffer that will receive the decoded RGBA8 pixels.
+     *     Storage buffer that will receive the decoded pixels.
      *     The buffer will be resized as necessary.
      *
+     * @param options
+     *     Output format and Adam7 preview selection. Defaults to a full RGBA8 decode.
+     *
      * @return
      *     - decode_error::ok on success.
      *     - decode_error::invalid_signature if the PNG header is invalid.
      *     - decode_error::unsupported_color_type if the image format is unsupported.
      *     - decode_error::unsupported_bit_depth if the bit depth is unsupported.
+     *     - decode_error::unsupported_output_format if the image cannot be emitted as `options.format`.
+     *     - decode_error::unsupported_interlace if the interlace method is neither none nor Adam7.
      *     - decode_error::invalid_idat_stream if decompression fails.
      *     - decode_error::unsupported_filter if an unsupported PNG filter is encountered.
      *
@@ -202,7 +440,8 @@ namespace cpng {
      *     final pixel storage.
      */
     [[nodiscard]] decode_error load_from_memory(std::span<const uint8_t> data, image_view_t& out_view,
-                                                std::vector<uint8_t>& out_pixel_storage) noexcept;
+                                                std::vector<uint8_t>& out_pixel_storage,
+                                                const decode_options_t& options = { }) noexcept;
 
     /**
      * @brief Loads and decodes a PNG image directly from a file on disk.
@@ -218,9 +457,12 @@ namespace cpng {
      *     The pixel span references the storage in `out_pixel_storage`.
      *
      * @param out_pixel_storage
-     *     Storage buffer that will receive the decoded RGBA8 pixels.
+     *     Storage buffer that will receive the decoded pixels.
      *     The buffer will be resized as necessary.
      *
+     * @param options
+     *     Decode options, forwarded to @ref load_from_memory.
+     *
      * @return
      *     - decode_error::ok on success.
      *     - decode_error::file_not_found if the file cannot be opened.
@@ -228,7 +470,73 @@ namespace cpng {
      *     - Any error returned by @ref load_from_memory during decoding.
      */
     [[nodiscard]] decode_error load_from_file(const char* path, image_view_t& out_view,
-                                              std::vector<uint8_t>& out_pixel_storage) noexcept;
+                                              std::vector<uint8_t>& out_pixel_storage,
+                                              const decode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Decodes a PNG image and generates its mip chain in the same streaming pass.
+     *
+     * As level 0 rows are emitted, every pair of consecutive rows is box filtered into the
+     * next level, cascading down the chain, so the base image is never re-read from memory.
+     * Interlaced images build the chain once the final pass has been written.
+     *
+     * All levels live in one contiguous allocation in `out_pixel_storage`, level 0 first,
+     * each tightly packed. `out_levels[i]` views level i.
+     *
+     * @param options
+     *     Output format, transforms and premultiplication as for @ref load_from_memory, plus
+     *     @ref decode_options_t::mip_levels and @ref decode_options_t::mip_srgb_average.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::unsupported_output_format for RGBA16F output, or sRGB averaging with a
+     *       format other than R8 / RG8 / RGBA8 or with color_transform::srgb_to_linear.
+     *     - Any error returned by @ref load_from_memory.
+     */
+    [[nodiscard]] decode_error load_mip_chain_from_memory(std::span<const uint8_t> data,
+                                                          std::vector<image_view_t>& out_levels,
+                                                          std::vector<uint8_t>& out_pixel_storage,
+                                                          const decode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Decodes a PNG image straight into GPU block compressed data.
+     *
+     * Rows are emitted into a small band buffer and compressed 4 rows at a time, so the
+     * full uncompressed image is never held in memory (interlaced images are the exception:
+     * they are decoded whole, then compressed). With @ref decode_options_t::worker_threads
+     * above 1, several block rows are buffered and compressed in parallel by workers started
+     * once per call. Blocks are encoded independently, so the output does not depend on the
+     * thread count.
+     *
+     * @param format
+     *     Target block format. BC1/BC3 compress RGBA8 rows, BC4/BC5 compress R8/RG8 rows, so
+     *     `options.format` is ignored; transforms and premultiplication still apply.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::unsupported_output_format for BC4/BC5 with a color source.
+     *     - Any error returned by @ref load_from_memory.
+     */
+    [[nodiscard]] decode_error load_compressed_from_memory(std::span<const uint8_t> data,
+                                                           compressed_image_t& out_image,
+                                                           std::vector<uint8_t>& out_block_storage,
+                                                           block_format format,
+                                                           const decode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Hashes the encoded image without decoding it, for cache keys and dedupe.
+     *
+     * The hash is XXH64 over the IHDR payload followed by every IDAT payload, computed while
+     * the chunks are validated; nothing is inflated. Identical keys mean identical pixel
+     * data, so a cache hit can skip the decode entirely. Ancillary chunks (gAMA, sRGB, text)
+     * are not part of the key: include the decode options in the cache key if they matter.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - Any chunk-level error returned by @ref load_from_memory.
+     */
+    [[nodiscard]] decode_error compressed_hash_from_memory(std::span<const uint8_t> data,
+                                                           uint64_t& out_hash) noexcept;
 
     // ──────────────────────────────────────────────────────────────────────────────
     // Convenience / engine ergonomics helpers
@@ -253,13 +561,88 @@ namespace cpng {
     }
 
     /**
-     * @brief Fully decodes a PNG image from memory into a caller-provided RGBA8 buffer.
+     * @brief Returns the number of bytes per pixel of an output format.
+     */
+    [[nodiscard]] constexpr uint32_t bytes_per_pixel(const pixel_format format) noexcept
+    {
+        switch (format)
+        {
+            case pixel_format::r8:      return 1;
+            case pixel_format::rg8:     return 2;
+            case pixel_format::rgba8:   return 4;
+            case pixel_format::r16:     return 2;
+            case pixel_format::rg16:    return 4;
+            case pixel_format::rgba16:  return 8;
+            case pixel_format::rgba32f: return 16;
+            case pixel_format::rgba16f: return 8;
+            default:                    return 0;
+        }
+    }
+
+    /**
+     * @brief Returns the size in bytes required for an output buffer of the given format.
+     */
+    [[nodiscard]] constexpr size_t output_size_bytes(const ihdr_info_t& ihdr, const pixel_format format) noexcept
+    {
+        return static_cast<size_t>(ihdr.width) * static_cast<size_t>(ihdr.height) * bytes_per_pixel(format);
+    }
+
+    /**
+     * @brief Returns the size in bytes of one 4×4 block.
+     */
+    [[nodiscard]] constexpr uint32_t block_bytes(const block_format format) noexcept
+    {
+        return format == block_format::bc1 || format == block_format::bc4 ? 8u : 16u;
+    }
+
+    /**
+     * @brief Returns the size in bytes of a block compressed image of the given format.
+     */
+    [[nodiscard]] constexpr size_t compressed_size_bytes(const ihdr_info_t& ihdr, const block_format format) noexcept
+    {
+        return static_cast<size_t>((ihdr.width + 3) / 4) * ((ihdr.height + 3) / 4) * block_bytes(format);
+    }
+
+    /**
+     * @brief Fully decodes a PNG image from memory into a caller-provided buffer.
      *
-     * The caller must provide `out_rgba8` with at least `width*height*4` bytes.
+     * The caller must provide `out_rgba8` with at least
+     * @ref output_size_bytes(ihdr, options.format) bytes (`width*height*4` for the default RGBA8).
      * On success, @ref image_view_t::pixels will reference `out_rgba8`.
      */
     [[nodiscard]] decode_error load_from_memory(std::span<const uint8_t> data, image_view_t& out_view,
-                                                std::span<uint8_t> out_rgba8) noexcept;
+                                                std::span<uint8_t> out_rgba8,
+                                                const decode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Same, writing rows `stride_bytes` apart, e.g. into a sub-rectangle of a larger image.
+     *
+     * Only the `width * bytes_per_pixel(options.format)` bytes of each row are written, so
+     * bytes between rows are left untouched and several images can be decoded into disjoint
+     * rectangles of one buffer concurrently. `out_pixels` must hold
+     * `(height - 1) * stride_bytes + width * bytes_per_pixel(options.format)` bytes; a stride
+     * of 0 means tightly packed rows. @ref image_view_t::pixels spans from the first pixel
+     * to the end of the last row, and @ref image_view_t::pixel_hash covers only image bytes.
+     */
+    [[nodiscard]] decode_error load_from_memory(std::span<const uint8_t> data, image_view_t& out_view,
+                                                std::span<uint8_t> out_pixels, uint32_t stride_bytes,
+                                                const decode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief @ref load_from_memory, also reporting per-stage timings and counters in `out_stats`.
+     *
+     * The decode stages are instantiated a second time with recording hooks, so the plain
+     * overloads pay nothing for this. Recording reads the clock a few times per row and bumps
+     * a counter per deflate symbol. `out_stats` is reset first and filled as far as the decode got.
+     */
+    [[nodiscard]] decode_error load_from_memory(std::span<const uint8_t> data, image_view_t& out_view,
+                                                std::vector<uint8_t>& out_pixel_storage,
+                                                const decode_options_t& options, decode_stats_t& out_stats) noexcept;
+
+    /// @brief Same, into a caller-provided buffer with rows `stride_bytes` apart (0 for tightly packed).
+    [[nodiscard]] decode_error load_from_memory(std::span<const uint8_t> data, image_view_t& out_view,
+                                                std::span<uint8_t> out_pixels, uint32_t stride_bytes,
+                                                const decode_options_t& options, decode_stats_t& out_stats) noexcept;
 
     /**
      * @brief Returns the CarrotPNG version string.
@@ -287,4 +670,7 @@ namespace cpng {
      *     The returned string is a static string literal and does not allocate.
      */
     [[nodiscard]] std::string_view to_string(decode_error err) noexcept;
+
+    /// @brief Name of a @ref decode_stage, as a static string.
+    [[nodiscard]] std::string_view to_string(decode_stage stage) noexcept;
 } // namespace cpng
@@ -0,0 +1,119 @@
+//
+// Created by Zack Shrout on 3/23/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file archive.h
+ * @brief Packed PNG archives: one memory-mapped file instead of thousands of small ones.
+ *
+ * An archive stores PNG files back to back, followed by an index sorted by the XXH64
+ * hash of each name. Every index record carries the entry's offset and size plus its
+ * pre-parsed header, so header queries never touch the PNG bytes and lookups are a
+ * binary search over the mapped index. Entry data is handed out as spans into the
+ * mapping and can be passed straight to @ref load_from_memory.
+ *
+ * On-disk layout (all integers little endian):
+ *
+ * @code
+ * header   "CPAK" | version u32 | entry count u32 | reserved u32 | index offset u64 | names offset u64
+ * data     PNG files, each starting on an 8 byte boundary
+ * index    entry count × 48 byte records, sorted by name hash:
+ *          name hash u64 | offset u64 | size u64 | width u32 | height u32 |
+ *          bit depth u8 | color type u8 | interlace u8 | flags u8 | gAMA × 100000 u32 |
+ *          name offset u32 | name length u32
+ * names    UTF-8 names, not terminated, addressed from the names offset
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <string_view>
+
+namespace cpng {
+    struct archive_entry_t
+    {
+        std::string_view    name{ };        // points into the mapping
+        uint64_t            name_hash{ };
+        uint64_t            offset{ };      // of the PNG bytes from the start of the archive
+        uint64_t            size{ };
+        ihdr_info_t         ihdr{ };        // from the index; the PNG itself is not read
+    };
+
+    /// @brief One PNG to pack: its name in the archive and its encoded bytes.
+    struct archive_source_t
+    {
+        std::string_view            name{ };
+        std::span<const uint8_t>    png{ };
+    };
+
+    /**
+     * @brief Writes an archive containing `sources`.
+     *
+     * Every PNG is fully validated (chunk structure and CRCs) and its header recorded in the
+     * index.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::invalid_archive for duplicate names.
+     *     - decode_error::file_write_failed if the file cannot be opened or written.
+     *     - Any chunk-level error of an input PNG.
+     */
+    [[nodiscard]] decode_error write_archive(const char* path, std::span<const archive_source_t> sources) noexcept;
+
+    /**
+     * @brief Read-only view of an archive, memory mapped for the lifetime of the object.
+     *
+     * All lookups are const and lock free, so one archive can serve any number of threads.
+     */
+    class archive_t
+    {
+    public:
+        archive_t() = default;
+        ~archive_t();
+
+        archive_t(archive_t&& other) noexcept;
+        archive_t& operator=(archive_t&& other) noexcept;
+
+        archive_t(const archive_t&) = delete;
+        archive_t& operator=(const archive_t&) = delete;
+
+        /**
+         * @brief Maps an archive and validates its header and index bounds.
+         *
+         * @return
+         *     - decode_error::ok on success.
+         *     - decode_error::file_not_found if the file cannot be opened or mapped.
+         *     - decode_error::invalid_archive if the file is not a well-formed archive.
+         */
+        [[nodiscard]] decode_error open(const char* path) noexcept;
+        void close() noexcept;
+
+        [[nodiscard]] bool is_open() const noexcept { return _base != nullptr; }
+        [[nodiscard]] uint32_t size() const noexcept { return _count; }
+
+        /// @brief Entry `index` in index order (sorted by name hash).
+        [[nodiscard]] archive_entry_t entry(uint32_t index) const noexcept;
+
+        /// @brief Looks an entry up by name (binary search on the name hash).
+        [[nodiscard]] bool find(std::string_view name, archive_entry_t& out_entry) const noexcept;
+
+        /// @brief The entry's PNG bytes, straight from the mapping.
+        [[nodiscard]] std::span<const uint8_t> data(const archive_entry_t& entry) const noexcept;
+
+        /// @brief Finds and decodes an entry; decode_error::file_not_found if the name is absent.
+        [[nodiscard]] decode_error load(std::string_view name, image_view_t& out_view,
+                                        std::vector<uint8_t>& out_pixel_storage,
+                                        const decode_options_t& options = { }) const noexcept;
+
+    private:
+        const uint8_t*  _base{ nullptr };
+        size_t          _length{ 0 };
+        const uint8_t*  _index{ nullptr };
+        const uint8_t*  _names{ nullptr };
+        size_t          _names_length{ 0 };
+        uint32_t        _count{ 0 };
+    };
+} // namespace cpng
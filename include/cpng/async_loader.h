@@ -0,0 +1,116 @@
+//
+// Created by Zack Shrout on 3/26/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file async_loader.h
+ * @brief Asynchronous file loading: reads overlap with decoding instead of alternating.
+ *
+ * On Linux, reads are issued through io_uring: one I/O thread keeps up to
+ * @ref async_loader_options_t::queue_depth reads in flight and hands each file to
+ * the decode workers the moment its read completes. Elsewhere, or when io_uring is
+ * unavailable (old kernels, seccomp filtered containers), the decode workers read
+ * the files themselves with positional reads.
+ *
+ * Completion callbacks run on a decode worker thread, in completion order.
+ *
+ * @code
+ * cpng::async_loader_t loader{ };
+ *
+ * loader.load_batch(paths, [&](const size_t i, const cpng::decode_error err,
+ *                              std::shared_ptr<cpng::decoded_image_t> image) {
+ *     if (err == cpng::decode_error::ok) upload(i, image->view);
+ * });
+ *
+ * loader.wait();
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace cpng {
+    struct async_loader_options_t
+    {
+        uint32_t    decode_threads{ 0 };    // 0: one per hardware thread
+        uint32_t    queue_depth{ 64 };      // files read but not yet decoded, at most
+        bool        use_io_uring{ true };   // false forces the thread-pool backend
+    };
+
+    /// @brief Called once per file with the decode result; `image` is null on failure.
+    using load_callback_t = std::function<void(decode_error err, std::shared_ptr<decoded_image_t> image)>;
+
+    /// @brief Batch variant, also given the index of the path within the batch.
+    using batch_load_callback_t =
+        std::function<void(size_t index, decode_error err, std::shared_ptr<decoded_image_t> image)>;
+
+    class async_loader_t
+    {
+    public:
+        explicit async_loader_t(const async_loader_options_t& options = { }) noexcept;
+
+        /// @brief Finishes every queued load (callbacks included), then stops the threads.
+        ~async_loader_t();
+
+        async_loader_t(const async_loader_t&) = delete;
+        async_loader_t& operator=(const async_loader_t&) = delete;
+
+        /**
+         * @brief Queues a file. The callback receives decode_error::file_not_found or
+         * decode_error::file_too_short for I/O failures, otherwise the result of
+         * @ref load_from_memory.
+         *
+         * `options.diagnostics` is reset when the load is queued. The decode fills a record of
+         * its own, copied there under the loader's lock if the load fails, before its callback
+         * runs. Loads sharing a record overwrite each other: read it after @ref wait.
+         */
+        void load(const char* path, load_callback_t callback, const decode_options_t& options = { }) noexcept;
+
+        /**
+         * @brief Queues many files at once (one wake-up of the I/O thread for the whole batch).
+         * `options.diagnostics` is reset once and then holds the record of a failed file, as
+         * with @ref load.
+         */
+        void load_batch(std::span<const char* const> paths, const batch_load_callback_t& callback,
+                        const decode_options_t& options = { }) noexcept;
+
+        /// @brief Blocks until every queued load has completed and its callback has returned.
+        void wait() noexcept;
+
+        /// @brief True when reads go through io_uring, false on the thread-pool backend.
+        [[nodiscard]] bool uses_io_uring() const noexcept { return _ring != nullptr; }
+
+    private:
+        struct request_t;
+        struct ring_t;
+
+        void enqueue(std::unique_ptr<request_t> request) noexcept;
+        void io_loop() noexcept;
+        void decode_loop() noexcept;
+
+        async_loader_options_t                      _options;
+        std::unique_ptr<ring_t>                     _ring;
+
+        std::mutex                                  _mutex;
+        std::condition_variable                     _io_wake;       // new requests, or decode backlog drained
+        std::condition_variable                     _work_ready;    // decode queue not empty
+        std::condition_variable                     _idle;          // nothing outstanding
+        std::deque<std::unique_ptr<request_t>>      _pending;       // not yet read (io_uring backend)
+        std::deque<std::unique_ptr<request_t>>      _ready;         // to decode (and, without io_uring, read)
+        size_t                                      _buffered{ 0 }; // requests holding file bytes
+        size_t                                      _outstanding{ 0 };
+        bool                                        _stopping{ false };
+
+        std::vector<std::jthread>                   _workers;
+        std::jthread                                _io_thread;
+    };
+} // namespace cpng
@@ -0,0 +1,80 @@
+//
+// Created by Zack Shrout on 3/24/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file atlas.h
+ * @brief Decodes a batch of PNGs straight into one packed texture atlas.
+ *
+ * Only the headers are read up front; the rectangles are packed with a skyline
+ * bottom-left packer, then every image is decoded (in parallel when
+ * @ref decode_options_t::worker_threads allows) directly into its rectangle of
+ * the shared atlas buffer. No per-image buffers are allocated and nothing is
+ * blitted afterwards.
+ *
+ * @code
+ * std::vector<std::span<const uint8_t>> sprites{ ... };
+ *
+ * cpng::decode_options_t decode{ };
+ * decode.worker_threads = 0;
+ *
+ * cpng::atlas_t atlas{ };
+ * std::vector<uint8_t> pixels;
+ * if (cpng::build_atlas(sprites, atlas, pixels, { }, decode) == cpng::decode_error::ok)
+ *     upload(atlas.view);   // atlas.rects[i] holds the placement and UVs of sprites[i]
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+namespace cpng {
+    struct atlas_options_t
+    {
+        uint32_t    max_width{ 4096 };
+        uint32_t    max_height{ 4096 };
+        uint32_t    padding{ 1 };           // transparent (zero) pixels between neighboring images
+        bool        power_of_two{ false };  // round the atlas size up to powers of two, within the maximums
+    };
+
+    struct atlas_rect_t
+    {
+        uint32_t    x{ };                   // in pixels, top-left origin
+        uint32_t    y{ };
+        uint32_t    width{ };
+        uint32_t    height{ };
+        float       u0{ };                  // normalized texture coordinates of the rectangle edges
+        float       v0{ };
+        float       u1{ };
+        float       v1{ };
+    };
+
+    struct atlas_t
+    {
+        image_view_t                view{ };    // the whole atlas; is_srgb and stats are left at their defaults
+        std::vector<atlas_rect_t>   rects{ };   // one per input, in input order
+    };
+
+    /**
+     * @brief Packs and decodes `images` into a single atlas.
+     *
+     * All images are emitted as `options.format`, with the transforms of `options`
+     * applied; mip and hash options are ignored.
+     *
+     * Sprites decode concurrently, each into a diagnostics record of its own. When a decode
+     * fails, the record of the sprite whose error is returned is copied to `options.diagnostics`.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::atlas_overflow if the images do not fit in max_width × max_height
+     *       (with power_of_two, the largest powers of two within them).
+     *     - The first error returned by @ref read_ihdr_from_memory or @ref load_from_memory
+     *       for any input; `out_atlas` is then left empty.
+     */
+    [[nodiscard]] decode_error build_atlas(std::span<const std::span<const uint8_t>> images, atlas_t& out_atlas,
+                                           std::vector<uint8_t>& out_pixel_storage,
+                                           const atlas_options_t& atlas_options = { },
+                                           const decode_options_t& options = { }) noexcept;
+} // namespace cpng
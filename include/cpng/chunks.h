@@ -0,0 +1,181 @@
+//
+// Created by Zack Shrout on 3/27/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file chunks.h
+ * @brief Zero-copy access to every chunk of a PNG file, plus decoders for common metadata.
+ *
+ * @ref chunk_reader_t walks the chunk list of an in-memory file without allocating;
+ * each @ref png_chunk_t points into the caller's buffer. CRCs are only computed when
+ * asked for (@ref png_chunk_t::crc_ok), so skimming a file for one custom chunk
+ * costs a few bytes of reading per chunk.
+ *
+ * @code
+ * cpng::chunk_reader_t reader{ file_bytes };
+ * cpng::png_chunk_t chunk{ };
+ *
+ * while (reader.next(chunk))
+ * {
+ *     if (chunk.type == cpng::chunk_type("eNGn") && chunk.crc_ok())
+ *         parse_engine_data(chunk.data);
+ * }
+ *
+ * if (reader.error() != cpng::decode_error::ok) ...
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <string>
+#include <string_view>
+
+namespace cpng {
+    /// @brief Chunk type as a big-endian 32-bit value, e.g. chunk_type("IDAT") == 0x49444154.
+    [[nodiscard]] consteval uint32_t chunk_type(const char (&name)[5]) noexcept
+    {
+        return static_cast<uint32_t>(static_cast<uint8_t>(name[0])) << 24 |
+               static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 16 |
+               static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 8 |
+               static_cast<uint32_t>(static_cast<uint8_t>(name[3]));
+    }
+
+    struct png_chunk_t
+    {
+        uint32_t                    type{ };        // see @ref chunk_type
+        std::span<const uint8_t>    data{ };        // payload, inside the file buffer
+        uint32_t                    crc{ };         // as stored in the file
+        size_t                      offset{ };      // of the chunk's length field in the file
+
+        /// @brief The four type letters, e.g. "tEXt", built from `type` (so also for an empty or unset chunk).
+        [[nodiscard]] std::string name() const noexcept
+        {
+            return { static_cast<char>(type >> 24), static_cast<char>(type >> 16), static_cast<char>(type >> 8),
+                     static_cast<char>(type) };
+        }
+
+        /// @brief Critical chunks (IHDR, PLTE, IDAT, IEND) have an uppercase first letter.
+        [[nodiscard]] constexpr bool is_critical() const noexcept { return (type & 0x20000000u) == 0; }
+
+        /// @brief Computes the CRC over type and payload and compares it with the stored one.
+        [[nodiscard]] bool crc_ok() const noexcept;
+    };
+
+    /**
+     * @brief Iterates over the chunks of an in-memory PNG file, in file order, up to and including IEND.
+     *
+     * Only the chunk framing is checked (signature, lengths within the buffer); chunk order and
+     * contents are not validated.
+     */
+    class chunk_reader_t
+    {
+    public:
+        explicit chunk_reader_t(std::span<const uint8_t> file) noexcept;
+
+        /// @brief Moves to the next chunk; false at the end of the file or on an error.
+        [[nodiscard]] bool next(png_chunk_t& out_chunk) noexcept;
+
+        /**
+         * @brief Why iteration stopped:
+         *     - decode_error::ok after IEND.
+         *     - decode_error::invalid_signature if the buffer is not a PNG file.
+         *     - decode_error::no_iend if the data ends on a chunk boundary before IEND.
+         *     - decode_error::invalid_chunk_length / file_too_short for a truncated chunk.
+         */
+        [[nodiscard]] decode_error error() const noexcept { return _error; }
+
+    private:
+        std::span<const uint8_t>    _file{ };
+        size_t                      _pos{ 8 };
+        bool                        _done{ false };
+        decode_error                _error{ decode_error::ok };
+    };
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Metadata chunks
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Default cap on inflated metadata, guarding against compression bombs.
+    inline constexpr size_t k_default_metadata_limit{ 16u << 20 };
+
+    /**
+     * @brief Decodes an iCCP chunk: the profile name and the inflated ICC profile.
+     *
+     * `out_name` points into the chunk.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::invalid_chunk_data if the chunk is not iCCP, is malformed, uses an
+     *       unknown compression method, or inflates to `max_size` bytes or more.
+     */
+    [[nodiscard]] decode_error read_icc_profile(const png_chunk_t& chunk, std::string_view& out_name,
+                                                std::vector<uint8_t>& out_profile,
+                                                size_t max_size = k_default_metadata_limit) noexcept;
+
+    struct text_entry_t
+    {
+        std::string_view    keyword{ };             // Latin-1, points into the chunk
+        std::string_view    language{ };            // iTXt only
+        std::string_view    translated_keyword{ };  // iTXt only, UTF-8
+        std::string         text{ };                // Latin-1 for tEXt / zTXt, UTF-8 for iTXt; inflated if compressed
+        bool                compressed{ false };
+    };
+
+    /**
+     * @brief Decodes a tEXt, zTXt or iTXt chunk, inflating compressed text.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::invalid_chunk_data if the chunk is not a text chunk, is malformed, or
+     *       inflates to `max_size` bytes or more.
+     */
+    [[nodiscard]] decode_error read_text(const png_chunk_t& chunk, text_entry_t& out_text,
+                                         size_t max_size = k_default_metadata_limit) noexcept;
+
+    struct physical_size_t
+    {
+        uint32_t    pixels_per_unit_x{ };
+        uint32_t    pixels_per_unit_y{ };
+        bool        unit_is_meter{ false };     // false: the values only give the aspect ratio
+    };
+
+    /// @brief Decodes a pHYs chunk; decode_error::invalid_chunk_data if it is not a 9-byte pHYs.
+    [[nodiscard]] decode_error read_physical_size(const png_chunk_t& chunk, physical_size_t& out_size) noexcept;
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Stripe index
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /**
+     * Private chunk written by striped encodes (@ref encode_options_t::worker_threads): where each
+     * independently compressed row stripe starts in the zlib stream. Every stripe after the first
+     * begins on a byte boundary right after a sync flush and never references earlier data, so
+     * stripes can be inflated in parallel and their Adler-32s combined.
+     *
+     * The type is ancillary, private and unsafe to copy: an editor that rewrites IDAT without
+     * understanding it must drop it. Layout (big-endian): version (1), 3 reserved bytes, stripe
+     * count (u32), then per stripe first row (u32), zlib offset (u64) and Adler-32 (u32).
+     */
+    inline constexpr uint32_t k_stripe_index_chunk{ chunk_type("cpIX") };
+
+    struct stripe_index_entry_t
+    {
+        uint32_t    first_row{ };
+        uint64_t    zlib_offset{ };     // from the start of the zlib stream (IDAT payloads concatenated)
+        uint32_t    adler{ };           // Adler-32 of the stripe's filtered scanlines alone
+    };
+
+    /**
+     * @brief Decodes a stripe index chunk.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::invalid_chunk_data if the chunk is not a version 1 stripe index, its size
+     *       disagrees with its count, or rows / offsets are not increasing from row 0.
+     */
+    [[nodiscard]] decode_error read_stripe_index(const png_chunk_t& chunk,
+                                                 std::vector<stripe_index_entry_t>& out_stripes) noexcept;
+} // namespace cpng
@@ -0,0 +1,58 @@
+//
+// Created by Zack Shrout on 3/30/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file decode_cost.h
+ * @brief Predicts how long a PNG file takes CarrotPNG to decode, from the way it was encoded.
+ *
+ * Two files with the same pixels can decode at very different speeds. Every IDAT chunk is
+ * parsed and CRC checked. Every dynamic deflate block rebuilds three 32K-entry Huffman
+ * tables, so thousands of small blocks cost more than the data in them. Literals are dearer
+ * than bytes copied by a match. Paeth and Average rows reverse far slower than None, Sub
+ * or Up.
+ *
+ * @ref estimate_decode_cost walks the deflate stream and the filter bytes of a file and
+ * prices each of these. The constants were measured against this library's own inflate and
+ * SSE2 de-filter, so the prediction is meant for comparing encodings of one image; see
+ * @ref encode_profile::decode_speed and the `cpng_reencode` tool.
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <array>
+
+namespace cpng {
+    struct decode_cost_t
+    {
+        uint32_t                    idat_chunks{ };
+        uint32_t                    stored_blocks{ };
+        uint32_t                    fixed_blocks{ };
+        uint32_t                    dynamic_blocks{ };      // each one builds its Huffman tables
+        uint64_t                    stored_bytes{ };
+        uint64_t                    literals{ };
+        uint64_t                    matches{ };
+        uint64_t                    match_bytes{ };         // bytes produced by matches
+        std::array<uint64_t, 5>     filter_bytes{ };        // scanline bytes per filter type, filter byte excluded
+
+        // Sum of the priced parts, in nanoseconds on the machine the constants were measured
+        // on. Pixel conversion is left out: it does not depend on the encoding.
+        uint64_t                    predicted_ns{ };
+    };
+
+    /**
+     * @brief Counts what decoding `png` involves and predicts the time it takes.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - Any error of chunk parsing, and decode_error::invalid_idat_stream for a broken
+     *       zlib stream or a filter type above 4.
+     */
+    [[nodiscard]] decode_error estimate_decode_cost(std::span<const uint8_t> png, decode_cost_t& out_cost) noexcept;
+
+    /// @brief Prices the counts in `cost` (its `predicted_ns` is ignored) in nanoseconds.
+    [[nodiscard]] uint64_t predict_decode_ns(const decode_cost_t& cost) noexcept;
+} // namespace cpng
@@ -0,0 +1,152 @@
+//
+// Created by Zack Shrout on 3/28/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file encoder.h
+ * @brief Fast PNG encoding for runtime screenshots and cache baking.
+ *
+ * The encoder is built for throughput, not for the smallest file: rows are filtered
+ * with SSE2 kernels and deflated by a single pass greedy LZ77 (one hash probe plus a
+ * run candidate at the pixel distance, no match chains), with each block written as
+ * dynamic Huffman, fixed Huffman or stored, whichever is smallest. Expect hundreds of
+ * MB/s on typical screenshots.
+ *
+ * Every file it writes decodes with @ref load_from_memory to the same pixels.
+ *
+ * Large images can be encoded pigz style: rows are cut into stripes that are filtered
+ * and deflated on separate threads, each ending in a sync flush, then concatenated into
+ * one zlib stream whose Adler-32 is combined from the per-stripe sums. A stripe index
+ * chunk records where each stripe starts, so a segment-aware decoder can inflate them in
+ * parallel as well. Striping costs well under 1% of size at the default stripe height.
+ *
+ * The @ref encode_profile::decode_speed profile spends extra encode time to make files that
+ * decode faster (see decode_cost.h). @ref reencode applies it, or any other options, to an
+ * existing file without touching its pixels or its other chunks.
+ *
+ * @code
+ * cpng::image_view_t shot{ .width = w, .height = h, .pixels = framebuffer, .stride_bytes = pitch };
+ *
+ * cpng::encode_options_t options{ };
+ * options.drop_alpha = true;  // the swap chain alpha is meaningless
+ *
+ * std::vector<uint8_t> png;
+ * if (cpng::encode(shot, png, options) == cpng::decode_error::ok) write_file(png);
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+#include "chunks.h"
+
+namespace cpng {
+    /// @brief Scanline filter written for every row.
+    enum class encode_filter : uint8_t
+    {
+        none,
+        sub,
+        up,
+        average,
+        paeth,
+        adaptive,   // per row, the filter with the smallest sum of absolute differences (slower)
+    };
+
+    enum class compression_mode : uint8_t
+    {
+        stored,     // no compression: zlib framing around the raw scanlines
+        fast,       // greedy single probe LZ77 + per block Huffman / stored choice
+    };
+
+    enum class encode_profile : uint8_t
+    {
+        encode_speed,   // the options as given
+        decode_speed,   // several candidate encodings; the fastest to decode within size_budget wins
+    };
+
+    struct encode_options_t
+    {
+        compression_mode    mode{ compression_mode::fast };
+        encode_filter       filter{ encode_filter::up };
+
+        // With decode_speed, `filter`, `max_idat_bytes` and `block_tokens` are chosen per image:
+        // one IDAT, large deflate blocks, and None / Up / Sub rows where they cost little size.
+        encode_profile      profile{ encode_profile::encode_speed };
+
+        // decode_speed: how much larger than the smallest candidate the result may be (0.03 = 3%).
+        float               size_budget{ 0.03f };
+
+        // Tokens per deflate block. Each block gets Huffman codes fitted to its data, and costs the
+        // decoder one table build.
+        uint32_t            block_tokens{ 32768 };
+
+        // Write RGBA / gray + alpha input as RGB / gray, discarding alpha.
+        bool                drop_alpha{ false };
+
+        // Largest IDAT chunk in bytes; the zlib stream is split across as many as needed.
+        // 0 writes a single IDAT, split only past the PNG chunk limit of 2^31 - 1 bytes.
+        uint32_t            max_idat_bytes{ 0 };
+
+        // Threads used for striped encoding, the calling thread included; 0 uses one per hardware
+        // thread. Any value but 1 enables stripes (see stripe_rows).
+        uint32_t            worker_threads{ 1 };
+
+        // Rows per stripe. Stripes are filtered and deflated independently, joined by sync flushes
+        // and listed in a stripe index chunk (@ref k_stripe_index_chunk). 0 picks about 1 MiB of
+        // scanlines per stripe when striping is enabled; a non-zero value also stripes single
+        // threaded encodes. The output depends on the stripe layout only, not on the thread count.
+        uint32_t            stripe_rows{ 0 };
+    };
+
+    /**
+     * @brief Encodes an image as a PNG file in memory.
+     *
+     * The PNG keeps the layout of the input: R8 / RG8 / RGBA8 become 8-bit grayscale,
+     * grayscale + alpha and RGBA, the 16-bit formats (native endian) their 16-bit
+     * counterparts. `image.stride_bytes` may be 0 for tightly packed rows. An sRGB chunk
+     * is written when `image.is_srgb` is set.
+     *
+     * @param out_png
+     *     Receives the complete file; previous contents are replaced.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::invalid_image_view if the image is empty, too large, its pixel span is
+     *       shorter than its size and stride require, or its format is a float format.
+     */
+    [[nodiscard]] decode_error encode(const image_view_t& image, std::vector<uint8_t>& out_png,
+                                      const encode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Encodes an image and writes it to `path`.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - decode_error::file_write_failed if the file cannot be created or written.
+     *     - Any error returned by @ref encode.
+     */
+    [[nodiscard]] decode_error encode_to_file(const char* path, const image_view_t& image,
+                                              const encode_options_t& options = { }) noexcept;
+
+    /**
+     * @brief Re-encodes the image data of a PNG file.
+     *
+     * The scanlines are inflated and unfiltered, then filtered and deflated again with
+     * `options` (`drop_alpha` is ignored). Everything else stays byte for byte: the header,
+     * the pixel encoding, and every other chunk in its place. A stale stripe index is dropped.
+     * Any color type and bit depth the decoder reads is accepted.
+     *
+     * Adam7 files are de-interlaced and written progressive (Adam7 only costs size and decode
+     * time), so their IHDR interlace byte becomes 0, with its CRC; the rest of IHDR is kept.
+     *
+     * @param out_png
+     *     Receives the rewritten file; previous contents are replaced.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - Any error of chunk parsing or inflating `png`.
+     */
+    [[nodiscard]] decode_error reencode(std::span<const uint8_t> png, std::vector<uint8_t>& out_png,
+                                        const encode_options_t& options = { }) noexcept;
+} // namespace cpng
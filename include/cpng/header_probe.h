@@ -0,0 +1,54 @@
+//
+// Created by Zack Shrout on 3/25/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file header_probe.h
+ * @brief Reads the headers of many PNG files at once.
+ *
+ * Meant for boot-time scans over large asset trees (sizing GPU heaps, building
+ * asset indices), where per-file setup costs more than the bytes read. Each file
+ * is opened once and read with positional reads, no stream objects, and files
+ * are spread over worker threads so their I/O overlaps.
+ *
+ * With @ref probe_options_t::scan_chunks, the chunk list is walked as well. Only
+ * the 8-byte chunk headers (plus the 4-byte gAMA payload) are read; chunk data is
+ * skipped, so the cost does not grow with image size.
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+namespace cpng {
+    struct probe_options_t
+    {
+        bool        scan_chunks{ false };   // also fill the sRGB / gAMA / iCCP / PLTE / IDAT fields
+        uint32_t    worker_threads{ 0 };    // 0: one per hardware thread
+    };
+
+    struct header_probe_t
+    {
+        ihdr_info_t     ihdr{ };            // has_srgb / has_gamma / has_icc_profile need scan_chunks
+        decode_error    error{ decode_error::ok };
+        bool            has_palette{ false };
+        uint32_t        idat_chunks{ };
+        uint64_t        idat_bytes{ };      // total compressed image data
+        uint64_t        file_size{ };
+    };
+
+    /**
+     * @brief Probes the header of every file in `paths`, filling `out_probes[i]` for `paths[i]`.
+     *
+     * Failures are per file (@ref header_probe_t::error): file_not_found, or the errors of
+     * @ref read_ihdr_from_memory. Chunk scanning checks the chunk layout (lengths, IHDR first,
+     * IDAT present, IEND reached) but not the CRCs of chunks other than IHDR.
+     *
+     * @return
+     *     - decode_error::ok once every file has been probed.
+     *     - decode_error::output_buffer_too_small if `out_probes` is shorter than `paths`.
+     */
+    [[nodiscard]] decode_error probe_headers(std::span<const char* const> paths, std::span<header_probe_t> out_probes,
+                                             const probe_options_t& options = { }) noexcept;
+} // namespace cpng
@@ -0,0 +1,166 @@
+//
+// Created by Zack Shrout on 3/22/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file image_cache.h
+ * @brief Shared cache of decoded images with a memory budget.
+ *
+ * Images are opened as lazy handles: opening reads only the IHDR (and, for
+ * in-memory images, walks the chunk list to build the content key). Pixels
+ * are decoded the first time they are requested and shared by reference
+ * count between every user of the same key. Decoded images are kept in LRU
+ * order and evicted once the cache holds more than its byte budget; images
+ * still referenced by callers stay alive until the last reference drops.
+ *
+ * Concurrent requests for the same key are coalesced: one thread decodes,
+ * the others wait for its result. An entry lives while a handle refers to it
+ * or its pixels are resident; after that the key is forgotten, and opening it
+ * again reads the header anew.
+ *
+ * @code
+ * cpng::image_cache_t cache{ 64u << 20 }; // 64 MiB of decoded pixels
+ *
+ * cpng::image_handle_t icon{ };
+ * if (cache.open_file("ui/close.png", icon) == cpng::decode_error::ok)
+ * {
+ *     const uint32_t w{ icon.header().width }; // no decode yet
+ *
+ *     std::shared_ptr<const cpng::decoded_image_t> image;
+ *     if (icon.pixels(image) == cpng::decode_error::ok)
+ *         upload(image->view);
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cpng {
+    class image_cache_t;
+
+    struct image_cache_stats_t
+    {
+        uint64_t    hits{ };            // pixels requested and already resident
+        uint64_t    misses{ };          // pixels requested and decoded
+        uint64_t    coalesced{ };       // requests that waited on another thread's decode
+        uint64_t    evictions{ };
+        size_t      resident_bytes{ };  // decoded pixel bytes currently held by the cache
+        size_t      entries{ };         // held by a handle or resident
+    };
+
+    /**
+     * @brief Lazy reference to a cached image.
+     *
+     * Cheap to copy. The header is available immediately; pixels() decodes on first use.
+     * The cache must outlive its handles.
+     */
+    class image_handle_t
+    {
+    public:
+        image_handle_t() = default;
+
+        [[nodiscard]] bool valid() const noexcept { return _entry != nullptr; }
+        [[nodiscard]] uint64_t key() const noexcept;
+        [[nodiscard]] const ihdr_info_t& header() const noexcept;
+
+        /**
+         * @brief Returns the decoded image, decoding it (once, across all threads) if needed.
+         *
+         * @return
+         *     - decode_error::ok on success.
+         *     - decode_error::missing_ihdr for an empty handle.
+         *     - Any error returned by @ref load_from_memory / @ref load_from_file. Failures are
+         *       remembered: later requests for the same entry return the same error.
+         */
+        [[nodiscard]] decode_error pixels(std::shared_ptr<const decoded_image_t>& out_image) const noexcept;
+
+    private:
+        friend class image_cache_t;
+
+        struct entry_t;
+
+        image_handle_t(image_cache_t* cache, std::shared_ptr<entry_t> entry) noexcept
+            : _cache{ cache }, _entry{ std::move(entry) } { }
+
+        image_cache_t*              _cache{ nullptr };
+        std::shared_ptr<entry_t>    _entry{ };
+    };
+
+    class image_cache_t
+    {
+    public:
+        /**
+         * @param budget_bytes
+         *     Decoded pixel bytes the cache may keep resident. Least recently used images
+         *     are dropped first; an image larger than the whole budget is handed out but
+         *     not retained.
+         *
+         * @param options
+         *     Decode options applied to every image in this cache. Each decode fills a
+         *     diagnostics record of its own; a request that fails copies the record of its
+         *     image to `options.diagnostics` under the cache lock. With several threads using
+         *     the cache, read it only once they are done.
+         */
+        explicit image_cache_t(size_t budget_bytes, const decode_options_t& options = { }) noexcept;
+
+        image_cache_t(const image_cache_t&) = delete;
+        image_cache_t& operator=(const image_cache_t&) = delete;
+
+        /// @brief Opens a file, keyed by its path. Reads only the header until pixels are requested.
+        [[nodiscard]] decode_error open_file(const char* path, image_handle_t& out_handle) noexcept;
+
+        /**
+         * @brief Opens an in-memory PNG keyed by @ref compressed_hash_from_memory, so identical
+         * files share one decode whatever their origin. A new entry keeps a copy of `data`
+         * (evicted images are decoded again from it), so `data` may be released on return;
+         * opening a key that is already open returns that entry and copies nothing.
+         */
+        [[nodiscard]] decode_error open_memory(std::span<const uint8_t> data, image_handle_t& out_handle) noexcept;
+
+        /// @brief Same, with a caller-provided key (e.g. an asset id) instead of the content hash.
+        [[nodiscard]] decode_error open_memory(std::span<const uint8_t> data, uint64_t key,
+                                               image_handle_t& out_handle) noexcept;
+
+        void set_budget(size_t budget_bytes) noexcept;
+
+        /// @brief Drops every resident image (handles and outstanding references stay valid).
+        void clear() noexcept;
+
+        [[nodiscard]] image_cache_stats_t stats() const noexcept;
+
+    private:
+        friend class image_handle_t;
+
+        using entry_t = image_handle_t::entry_t;
+
+        [[nodiscard]] decode_error open(uint64_t key, const ihdr_info_t& ihdr, std::string path,
+                                        std::span<const uint8_t> data, image_handle_t& out_handle) noexcept;
+        [[nodiscard]] decode_error acquire(const std::shared_ptr<entry_t>& entry,
+                                           std::shared_ptr<const decoded_image_t>& out_image) noexcept;
+
+        /// @brief The live entry for `key`, if any. Caller holds `_mutex`.
+        [[nodiscard]] std::shared_ptr<entry_t> find(uint64_t key) const noexcept;
+
+        /// @brief Evicts from the LRU tail until the budget is met. Caller holds `_mutex`.
+        void trim() noexcept;
+
+        mutable std::mutex                                              _mutex;
+        std::condition_variable                                         _decoded;
+        std::unordered_map<uint64_t, std::weak_ptr<entry_t>>            _entries;   // owned by handles and `_lru`
+        std::list<std::shared_ptr<entry_t>>                             _lru;       // resident, most recent first
+        size_t                                                          _sweep_at{ 64 };   // next sweep of `_entries`
+        decode_options_t                                                _options;
+        size_t                                                          _budget;
+        image_cache_stats_t                                             _stats{ };
+    };
+} // namespace cpng
@@ -0,0 +1,110 @@
+//
+// Created by Zack Shrout on 3/29/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file optimizer.h
+ * @brief Offline, maximum-ratio recompression of shipped PNG assets.
+ *
+ * Where @ref encode is built for speed, @ref optimize_png spends seconds per megapixel
+ * to make files as small as it can while keeping every pixel exactly as it was:
+ *
+ *  - Lossless reduction. 16-bit samples that are all v * 257 become 8-bit. Gray images
+ *    drop their color channels and, without alpha, take the smallest exact bit depth.
+ *    Opaque images drop alpha. A tRNS color key moves to the new depth with them.
+ *  - Row filters. Each fixed filter, the per-row minimum sum of absolute differences,
+ *    and a brute force choice per row (every filter tried by compressing the row after
+ *    its predecessors) are compared by a fast trial compression.
+ *  - Compression. A zopfli-style deflate: block splitting, then per block a series of
+ *    shortest path LZ77 parses, each priced with the symbol statistics of the last.
+ *  - Chunks. Everything ancillary goes except the color space chunks (iCCP, sRGB,
+ *    gAMA, cHRM, cICP) and the types listed in @ref optimize_options_t::keep_chunks.
+ *
+ * The result is never interlaced and holds a single IDAT.
+ *
+ * @code
+ * std::vector<uint8_t> smaller;
+ * cpng::optimize_report_t report{ };
+ *
+ * if (cpng::optimize_png(file_bytes, smaller, report) == cpng::decode_error::ok &&
+ *     smaller.size() < file_bytes.size())
+ *     write_file(path, smaller);
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+namespace cpng {
+    /// @brief How the rows of an optimized file were filtered.
+    enum class filter_strategy : uint8_t
+    {
+        none,
+        sub,
+        up,
+        average,
+        paeth,
+        min_sum,        // per row, the smallest sum of absolute differences
+        brute_force,    // per row, the filter that compresses best after the rows before it
+    };
+
+    struct optimize_options_t
+    {
+        // Optimal parses per deflate block, each priced with the statistics of the one before.
+        // Stops early once a parse repeats; 1 is already far smaller than @ref encode.
+        uint32_t                    iterations{ 15 };
+
+        // Hash chain candidates visited per position while collecting matches.
+        uint32_t                    max_chain{ 4096 };
+
+        // Try smaller color types and bit depths. When false the file keeps its color type
+        // and bit depth.
+        bool                        reduce{ true };
+
+        // Keep iCCP, sRGB, gAMA, cHRM and cICP.
+        bool                        keep_color_chunks{ true };
+
+        // Further ancillary chunk types to copy (see @ref chunk_type). Types marked unsafe to copy
+        // (upper case fourth letter: tRNS, bKGD, sBIT, hIST, ...) are never copied: they describe
+        // the old pixel encoding.
+        std::span<const uint32_t>   keep_chunks{ };
+
+        // Threads for the filter trials and the deflate pieces; 0 uses one per hardware thread.
+        // The output does not depend on it.
+        uint32_t                    worker_threads{ 1 };
+    };
+
+    /// @brief What @ref optimize_png chose.
+    struct optimize_report_t
+    {
+        size_t              input_bytes{ };
+        size_t              output_bytes{ };
+        uint8_t             color_type{ };
+        uint8_t             bit_depth{ };
+        filter_strategy     filter{ };
+        uint32_t            chunks_removed{ };      // ancillary chunks not carried over
+    };
+
+    /**
+     * @brief Recompresses a PNG file as small as it can without changing its pixels.
+     *
+     * Decoding `out_png` gives exactly the pixels of `png`, in every output format `png` decodes
+     * to. The output may still be larger than the input for files that were already optimized
+     * harder; compare the sizes in `out_report` before replacing anything.
+     *
+     * @param out_png
+     *     Receives the optimized file; previous contents are replaced.
+     *
+     * @param out_report
+     *     Receives the sizes and the chosen layout.
+     *
+     * @return
+     *     - decode_error::ok on success.
+     *     - Any error returned by @ref load_from_memory for `png`.
+     */
+    [[nodiscard]] decode_error optimize_png(std::span<const uint8_t> png, std::vector<uint8_t>& out_png,
+                                            optimize_report_t& out_report,
+                                            const optimize_options_t& options = { }) noexcept;
+} // namespace cpng
@@ -0,0 +1,104 @@
+//
+// Created by Zack Shrout on 4/2/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file trace.h
+ * @brief Zone and counter hooks for profilers (Tracy, perf markers, Chrome tracing).
+ *
+ * A library built with `CARROTPNG_ENABLE_TRACE=ON` (macro `CPNG_ENABLE_TRACE`) reports:
+ *
+ *  - a zone around each walk of a file's chunks ("cpng parse chunks"),
+ *  - a zone per deflate block ("cpng inflate stored / fixed / dynamic block") and the
+ *    "cpng inflated bytes" counter after it,
+ *  - a zone per band of 32 de-filtered and converted rows ("cpng defilter rows") and the
+ *    "cpng rows" counter after it.
+ *
+ * Zone and counter names are string literals, so hooks may keep the pointers. Hooks run on
+ * the decoding thread and must be thread-safe when several threads decode. The default
+ * build compiles every trace point out: the hooks below can still be installed but are
+ * never called, and the decoder is the same code as without them.
+ *
+ * @code
+ * cpng::chrome_trace_writer_t trace;
+ * cpng::set_trace_hooks(trace.hooks());
+ * load_assets();
+ * cpng::set_trace_hooks({ });
+ * (void)trace.write("load.json"); // open in chrome://tracing or ui.perfetto.dev
+ * @endcode
+ */
+
+#pragma once
+
+#include "CarrotPNG.h"
+
+#include <mutex>
+
+namespace cpng {
+    struct trace_hooks_t
+    {
+        void    (*begin_zone)(void* user, const char* name) noexcept{ nullptr };
+        void    (*end_zone)(void* user, const char* name) noexcept{ nullptr };
+        void    (*counter)(void* user, const char* name, int64_t value) noexcept{ nullptr };
+        void*   user{ nullptr };
+    };
+
+    /// @brief Whether this build of the library has its trace points compiled in.
+    [[nodiscard]] bool trace_compiled_in() noexcept;
+
+    /**
+     * @brief Installs process-wide hooks; all three functions must be set, or none to uninstall.
+     *
+     * Install before decoding starts and uninstall after it ends: a decode in flight may
+     * still call the hooks it saw when its zone began.
+     */
+    void set_trace_hooks(const trace_hooks_t& hooks) noexcept;
+
+    /**
+     * @brief Records zones and counters in memory and writes them as Chrome trace event JSON.
+     *
+     * Every event is timestamped with the steady clock relative to the writer's creation
+     * and tagged with the calling thread, so decodes on several threads show as separate
+     * tracks.
+     */
+    class chrome_trace_writer_t
+    {
+    public:
+        chrome_trace_writer_t() noexcept;
+
+        chrome_trace_writer_t(const chrome_trace_writer_t&) = delete;
+        chrome_trace_writer_t& operator=(const chrome_trace_writer_t&) = delete;
+
+        /// @brief Hooks recording into this writer, which must outlive their installation.
+        [[nodiscard]] trace_hooks_t hooks() noexcept;
+
+        [[nodiscard]] size_t event_count() const noexcept;
+        void clear() noexcept;
+
+        /**
+         * @brief Writes the events recorded so far as a JSON trace file.
+         *
+         * @return
+         *     - decode_error::ok on success.
+         *     - decode_error::file_write_failed if the file cannot be written.
+         */
+        [[nodiscard]] decode_error write(const char* path) const noexcept;
+
+    private:
+        struct event_t
+        {
+            const char* name;
+            uint64_t    time_ns;
+            int64_t     value;      // counters only
+            uint32_t    thread;
+            char        phase;      // 'B', 'E' or 'C'
+        };
+
+        void record(const char* name, char phase, int64_t value) noexcept;
+
+        mutable std::mutex      _mutex;
+        std::vector<event_t>    _events;
+        uint64_t                _origin_ns;
+    };
+} // namespace cpng
@@ -6,15 +6,397 @@
 #include "cpng/CarrotPNG.h"
 
 #include "internal/crc32.h"
+#include "internal/decode_stats.h"
+#include "internal/diagnostics.h"
 #include "internal/bit_reader.h"
 #include "internal/chunk_parser.h"
 #include "internal/inflate.h"
 #include "internal/defilter.h"
+#include "internal/png_format.h"
+#include "internal/row_pipeline.h"
+#include "internal/adam7.h"
+#include "internal/mip_chain.h"
+#include "internal/block_compress.h"
+#include "internal/parallel.h"
+#include "internal/xxhash64.h"
 
 #include <fstream>
 #include <array>
+#include <cstring>
+#include <memory>
 
 namespace cpng {
+    namespace {
+        /// @brief Clears the caller's diagnostics record as a decode starts.
+        void begin_diagnostics(const decode_options_t& options) noexcept
+        {
+            if (options.diagnostics) *options.diagnostics = { };
+        }
+
+        /// @brief Passes `err` through, recording it against a stage that has no finer context to give.
+        [[nodiscard]] decode_error check_stage(const decode_options_t& options, const decode_stage stage,
+                                               const decode_error err) noexcept
+        {
+            if (err == decode_error::ok) return err;
+
+            // to_string() returns string literals, so the view is null-terminated
+            return report_failure(options.diagnostics,
+                                  { .error = err, .stage = stage, .reason = to_string(err).data() });
+        }
+
+        /// @brief Header checks shared by every decode entry point; also sets up the row emission stage.
+        [[nodiscard]] decode_error validate_for_decode(const ihdr_info_t& ihdr, const decode_options_t& options,
+                                                       row_pipeline_t& out_pipeline) noexcept
+        {
+            if (!ihdr.valid) return decode_error::missing_ihdr;
+
+            if (ihdr.compression_method != 0 || ihdr.filter_method != 0)
+                return decode_error::unsupported_compression_filter;
+
+            if (ihdr.interlace_method > 1)
+                return decode_error::unsupported_interlace;
+
+            if (ihdr.width == 0 || ihdr.height == 0)
+                return decode_error::invalid_chunk_length;
+
+            const decode_error err{ validate_png_format(ihdr.bit_depth, ihdr.color_type) };
+            if (err != decode_error::ok) return err;
+
+            return out_pipeline.init(ihdr, options);
+        }
+
+        /// @brief De-filters and emits the Adam7 sub-images, scattering pixels to their final positions.
+        template <typename Stats>
+        [[nodiscard]] decode_error decode_adam7(const ihdr_info_t& ihdr, std::span<uint8_t> raw,
+                                                const uint32_t pass_count, row_pipeline_t& pipeline,
+                                                const size_t pixel_bytes, uint8_t* out, const size_t out_stride,
+                                                decode_diagnostics_t* diagnostics, Stats& stats) noexcept
+        {
+            const uint32_t bpp{ filter_bpp(ihdr.bit_depth, ihdr.color_type) };
+            const bool preview{ pass_count < 7 };
+
+            const adam7_scatter_fn scatter{ select_adam7_scatter(pixel_bytes) };
+            const adam7_fill_fn fill{ select_adam7_fill(pixel_bytes) };
+            if (!scatter || !fill) return decode_error::unsupported_output_format;
+
+            // One emitted pass row, before it is spread out over the output row
+            std::vector<uint8_t> pass_row(static_cast<size_t>(ihdr.width) * pixel_bytes);
+            stats.scratch_alloc(pass_row.size());
+            const scratch_scope_t<Stats> pass_row_scope{ stats, pass_row.size() };
+
+            size_t offset{ 0 };
+
+            for (uint32_t p{ 0 }; p < pass_count; ++p)
+            {
+                const adam7_pass_t& pass{ k_adam7_passes[p] };
+                const uint32_t pw{ adam7_pass_width(pass, ihdr.width) };
+                const uint32_t ph{ adam7_pass_height(pass, ihdr.height) };
+
+                if (pw == 0 || ph == 0) continue;
+
+                const size_t row_bytes{ scanline_bytes(pw, ihdr.bit_depth, ihdr.color_type) };
+                const size_t pass_size{ static_cast<size_t>(ph) * (1 + row_bytes) };
+
+                const decode_error err{
+                    defilter_scanlines(raw.subspan(offset, pass_size), row_bytes, ph, bpp,
+                                       [&](const uint32_t y, const uint8_t* pixels) {
+                                           const uint32_t out_y{ pass.y0 + y * pass.dy };
+                                           uint8_t* dst_row{ out + out_y * out_stride };
+
+                                           if (!preview && pass.dx == 1)
+                                           {
+                                               // Pass 7 covers whole rows: emit in place
+                                               pipeline.write_row(pixels, dst_row, pw);
+                                               return;
+                                           }
+
+                                           pipeline.write_row(pixels, pass_row.data(), pw);
+
+                                           if (!preview)
+                                           {
+                                               scatter(pass_row.data(), dst_row, pass.x0, pass.dx, pw);
+                                               return;
+                                           }
+
+                                           fill(pass_row.data(), dst_row, pass, pw, ihdr.width);
+
+                                           // Rows covered by this block were uniform before this pass,
+                                           // so copying the whole row keeps earlier passes intact.
+                                           const uint32_t end_y{ std::min(out_y + pass.block_h, ihdr.height) };
+                                           for (uint32_t by{ out_y + 1 }; by < end_y; ++by)
+                                               std::memcpy(out + by * out_stride, dst_row, ihdr.width * pixel_bytes);
+                                       }, stats, diagnostics)
+                };
+
+                if (err != decode_error::ok)
+                {
+                    // Offsets count from the first pass, like the scanlines of a progressive image
+                    if (diagnostics) diagnostics->byte_offset += offset;
+                    return err;
+                }
+
+                offset += pass_size;
+            }
+
+            return decode_error::ok;
+        }
+
+        /// @brief Number of Adam7 passes to decode (7 for progressive images).
+        [[nodiscard]] uint32_t decode_pass_count(const ihdr_info_t& ihdr, const decode_options_t& options) noexcept
+        {
+            const bool interlaced{ ihdr.interlace_method == 1 };
+            return interlaced && options.adam7_passes >= 1 && options.adam7_passes < 7 ? options.adam7_passes : 7u;
+        }
+
+        /// @brief Inflates the IDAT stream into the filtered scanline bytes needed for `pass_count` passes.
+        template <typename Stats>
+        [[nodiscard]] decode_error inflate_scanlines(const ihdr_info_t& ihdr,
+                                                     const std::span<const std::span<const uint8_t>> idat_spans,
+                                                     const uint32_t pass_count,
+                                                     std::vector<uint8_t>& out_decompressed,
+                                                     decode_diagnostics_t* diagnostics, Stats& stats) noexcept
+        {
+            const uint64_t concat_start{ stats.now() };
+            std::vector<uint8_t> idat_concat;
+            decode_error err{ concat_idat(idat_spans, idat_concat) };
+            stats.add_time(&decode_stats_t::concat_ns, concat_start);
+
+            if (err != decode_error::ok) return err;
+
+            stats.scratch_alloc(idat_concat.capacity());
+
+            const bool interlaced{ ihdr.interlace_method == 1 };
+            const size_t row_bytes{ scanline_bytes(ihdr.width, ihdr.bit_depth, ihdr.color_type) };
+            const size_t expected_raw_size{
+                interlaced ? adam7_raw_size(ihdr, pass_count) : ihdr.height * (1 + row_bytes)
+            };
+
+            err = inflate_idat(idat_concat, out_decompressed, expected_raw_size,
+                               pass_count < 7 ? inflate_size::prefix : inflate_size::exact, stats, diagnostics);
+
+            // The scanlines outlive the compressed stream, so both count toward the peak
+            stats.scratch_alloc(out_decompressed.capacity());
+            stats.scratch_free(idat_concat.capacity());
+            return err;
+        }
+
+        /**
+         * Inflates the IDAT stream, then de-filters and emits each row into `out`.
+         * `on_row_done(y)` runs once output row y is final: right after it is written for
+         * progressive images, in row order after the last pass for interlaced ones.
+         */
+        template <typename RowDoneFn, typename Stats>
+        [[nodiscard]] decode_error decode_pixels(const ihdr_info_t& ihdr,
+                                                 const std::span<const std::span<const uint8_t>> idat_spans,
+                                                 const decode_options_t& options, row_pipeline_t& pipeline,
+                                                 uint8_t* out, const size_t out_stride,
+                                                 RowDoneFn&& on_row_done, Stats& stats) noexcept
+        {
+            const bool interlaced{ ihdr.interlace_method == 1 };
+            const uint32_t pass_count{ decode_pass_count(ihdr, options) };
+
+            std::vector<uint8_t> decompressed;
+            decode_error err{
+                inflate_scanlines(ihdr, idat_spans, pass_count, decompressed, options.diagnostics, stats)
+            };
+            const scratch_scope_t<Stats> decompressed_scope{ stats, decompressed.capacity() };
+
+            if (err != decode_error::ok) return err;
+
+            if (interlaced)
+            {
+                err = decode_adam7(ihdr, decompressed, pass_count, pipeline, bytes_per_pixel(options.format), out,
+                                   out_stride, options.diagnostics, stats);
+                if (err != decode_error::ok) return err;
+
+                const uint64_t hook_start{ stats.now() };
+                for (uint32_t y{ 0 }; y < ihdr.height; ++y)
+                    on_row_done(y);
+                stats.add_time(&decode_stats_t::convert_ns, hook_start);
+
+                return decode_error::ok;
+            }
+
+            const size_t row_bytes{ scanline_bytes(ihdr.width, ihdr.bit_depth, ihdr.color_type) };
+            const uint32_t bpp{ filter_bpp(ihdr.bit_depth, ihdr.color_type) };
+
+            return defilter_scanlines(decompressed, row_bytes, ihdr.height, bpp,
+                                      [&](const uint32_t y, const uint8_t* pixels) {
+                                          pipeline.write_row(pixels, out + y * out_stride, ihdr.width);
+                                          on_row_done(y);
+                                      }, stats, options.diagnostics);
+        }
+
+        constexpr auto k_no_row_hook{ [](uint32_t) noexcept { } };
+
+        /// @brief Heap buffers of the row emission stage.
+        [[nodiscard]] size_t pipeline_bytes(const row_pipeline_t& pipeline) noexcept
+        {
+            return pipeline.scratch.capacity() + pipeline.lut_storage.capacity() + pipeline.float_row.capacity();
+        }
+
+        /// @brief Parses the chunks and sets up the row pipeline, timing the parse apart from its CRC checks.
+        template <typename Stats>
+        [[nodiscard]] decode_error prepare_decode(const std::span<const uint8_t> data, const decode_options_t& options,
+                                                  ihdr_info_t& out_ihdr,
+                                                  std::vector<std::span<const uint8_t>>& out_idat_spans,
+                                                  xxh64_state_t& out_source_hash, row_pipeline_t& out_pipeline,
+                                                  Stats& stats) noexcept
+        {
+            begin_diagnostics(options);
+
+            const uint64_t parse_start{ stats.now() };
+            decode_error err{
+                parse_png_chunks(data, out_ihdr, out_idat_spans, options.compute_hashes ? &out_source_hash : nullptr,
+                                 stats)
+            };
+
+            if (err == decode_error::ok)
+                err = check_stage(options, decode_stage::validate, validate_for_decode(out_ihdr, options, out_pipeline));
+            else
+                err = check_stage(options, decode_stage::parse, err);
+
+            stats.record([&](decode_stats_t& out) noexcept {
+                out.parse_ns += Stats::now() - parse_start - out.crc_ns;
+            });
+            stats.scratch_alloc(out_idat_spans.capacity() * sizeof(std::span<const uint8_t>));
+            stats.scratch_alloc(pipeline_bytes(out_pipeline));
+            return err;
+        }
+
+        /// @brief Row hook hashing each final output row, in row order, when hashes were requested.
+        [[nodiscard]] auto row_hash_hook(const decode_options_t& options, xxh64_state_t& state, const uint8_t* out,
+                                         const size_t stride, const size_t row_bytes) noexcept
+        {
+            return [&state, out, stride, row_bytes, enabled = options.compute_hashes](const uint32_t y) noexcept {
+                if (enabled) state.update({ out + y * stride, row_bytes });
+            };
+        }
+
+        [[nodiscard]] bool is_srgb_hint(const ihdr_info_t& ihdr) noexcept
+        {
+            bool is_srgb{ true };
+
+            if (ihdr.has_srgb)
+            {
+                is_srgb = true;
+            }
+            else if (ihdr.has_gamma)
+            {
+                // PNG gamma chunk is "image gamma"; sRGB-ish gamma is ~0.45455.
+                // If gamma is ~1.0, the stored values are already linear.
+                if (ihdr.gamma > 0.95f && ihdr.gamma < 1.05f)
+                    is_srgb = false;
+                // else: leave as true for now (no color management)
+            }
+
+            return is_srgb;
+        }
+
+        /// @brief @ref load_from_memory into a vector, with a stats policy (decode_stats.h).
+        template <typename Stats>
+        [[nodiscard]] decode_error load_into_storage(const std::span<const uint8_t> data, image_view_t& out_view,
+                                                     std::vector<uint8_t>& out_pixel_storage,
+                                                     const decode_options_t& options, Stats& stats) noexcept
+        {
+            ihdr_info_t ihdr{ };
+            std::vector<std::span<const uint8_t>> idat_spans;
+            xxh64_state_t source_hash{ };
+            row_pipeline_t pipeline{ };
+
+            decode_error err{ prepare_decode(data, options, ihdr, idat_spans, source_hash, pipeline, stats) };
+            if (err != decode_error::ok) return err;
+
+            const uint32_t stride{ ihdr.width * bytes_per_pixel(options.format) };
+
+            const size_t capacity{ out_pixel_storage.capacity() };
+            out_pixel_storage.resize(output_size_bytes(ihdr, options.format));
+            stats.record([&](decode_stats_t& out) noexcept {
+                if (out_pixel_storage.capacity() != capacity) out.bytes_allocated += out_pixel_storage.capacity();
+            });
+
+            xxh64_state_t pixel_hash{ };
+            err = decode_pixels(ihdr, idat_spans, options, pipeline, out_pixel_storage.data(), stride,
+                                row_hash_hook(options, pixel_hash, out_pixel_storage.data(), stride, stride), stats);
+            if (err != decode_error::ok) return err;
+
+            out_view = {
+                .width = ihdr.width,
+                .height = ihdr.height,
+                .pixels = out_pixel_storage,
+                .stride_bytes = stride,
+                .format = options.format,
+                .is_srgb = !pipeline.output_linear && is_srgb_hint(ihdr),
+                .stats = pipeline.finish_stats(),
+                .pixel_hash = options.compute_hashes ? pixel_hash.digest() : 0,
+                .source_hash = options.compute_hashes ? source_hash.digest() : 0
+            };
+
+            return decode_error::ok;
+        }
+
+        /// @brief @ref load_from_memory into a caller buffer, with a stats policy (decode_stats.h).
+        template <typename Stats>
+        [[nodiscard]] decode_error load_into_buffer(const std::span<const uint8_t> data, image_view_t& out_view,
+                                                    const std::span<uint8_t> out_pixels, const uint32_t stride_bytes,
+                                                    const decode_options_t& options, Stats& stats) noexcept
+        {
+            // First parse IHDR + IDAT spans so we know the required size.
+            ihdr_info_t ihdr{ };
+            std::vector<std::span<const uint8_t>> idat_spans;
+            xxh64_state_t source_hash{ };
+            row_pipeline_t pipeline{ };
+
+            decode_error err{ prepare_decode(data, options, ihdr, idat_spans, source_hash, pipeline, stats) };
+            if (err != decode_error::ok) return err;
+
+            const size_t row_bytes{ static_cast<size_t>(ihdr.width) * bytes_per_pixel(options.format) };
+            const size_t stride{ stride_bytes != 0 ? stride_bytes : row_bytes };
+            if (stride < row_bytes)
+            {
+                return report_failure(options.diagnostics, {
+                    .error = decode_error::output_buffer_too_small,
+                    .stage = decode_stage::output,
+                    .reason = "stride shorter than a row",
+                    .expected_size = row_bytes,
+                    .actual_size = stride,
+                });
+            }
+
+            const size_t needed{ (ihdr.height - 1) * stride + row_bytes };
+            if (out_pixels.size() < needed)
+            {
+                return report_failure(options.diagnostics, {
+                    .error = decode_error::output_buffer_too_small,
+                    .stage = decode_stage::output,
+                    .reason = "output buffer too small",
+                    .expected_size = needed,
+                    .actual_size = out_pixels.size(),
+                });
+            }
+
+            // Rows are emitted straight into the caller's buffer; no intermediate image copy.
+            xxh64_state_t pixel_hash{ };
+            err = decode_pixels(ihdr, idat_spans, options, pipeline, out_pixels.data(), stride,
+                                row_hash_hook(options, pixel_hash, out_pixels.data(), stride, row_bytes), stats);
+            if (err != decode_error::ok) return err;
+
+            out_view = {
+                .width = ihdr.width,
+                .height = ihdr.height,
+                .pixels = std::span<const uint8_t>{ out_pixels.data(), needed },
+                .stride_bytes = static_cast<uint32_t>(stride),
+                .format = options.format,
+                .is_srgb = !pipeline.output_linear && is_srgb_hint(ihdr),
+                .stats = pipeline.finish_stats(),
+                .pixel_hash = options.compute_hashes ? pixel_hash.digest() : 0,
+                .source_hash = options.compute_hashes ? source_hash.digest() : 0
+            };
+
+            return decode_error::ok;
+        }
+    } // namespace
+
     [[nodiscard]] decode_error read_ihdr_from_memory(const std::span<const uint8_t> data,
                                                      ihdr_info_t& out_ihdr) noexcept
     {
@@ -99,113 +481,40 @@ namespace cpng {
     }
 
     [[nodiscard]] decode_error load_from_memory(const std::span<const uint8_t> data, image_view_t& out_view,
-                                                std::vector<uint8_t>& out_pixel_storage) noexcept
+                                                std::vector<uint8_t>& out_pixel_storage,
+                                                const decode_options_t& options) noexcept
     {
-        ihdr_info_t ihdr{ };
-        std::vector<std::span<const uint8_t>> idat_spans;
-
-        decode_error err{ parse_png_chunks(data, ihdr, idat_spans) };
-        if (err != decode_error::ok) return err;
-
-        if (!ihdr.valid) return decode_error::missing_ihdr;
-
-        if (ihdr.compression_method != 0 || ihdr.filter_method != 0)
-            return decode_error::unsupported_compression_filter;
-
-        if (ihdr.interlace_method != 0)
-            return decode_error::unsupported_interlace;
-
-        if (ihdr.width == 0 || ihdr.height == 0)
-            return decode_error::invalid_chunk_length;
-
-        // Quick MVP validation
-        if (ihdr.bit_depth != 8) return decode_error::unsupported_bit_depth;
-        if (ihdr.color_type != 2 && ihdr.color_type != 6) return decode_error::unsupported_color_type;
-
-        std::vector<uint8_t> idat_concat;
-        err = concat_idat(idat_spans, idat_concat);
-
-        if (err != decode_error::ok) return err;
-
-        const int bytes_per_pixel{ ihdr.color_type == 6 ? 4 : 3 }; // MVP: only 2 and 6
-        const size_t row_bytes{ 1 + ihdr.width * bytes_per_pixel };
-        const size_t expected_raw_size{ ihdr.height * row_bytes };
-
-        std::vector<uint8_t> decompressed;
-        err = inflate_idat(idat_concat, decompressed, expected_raw_size, ihdr.width, ihdr.height, ihdr.bit_depth,
-                           ihdr.color_type);
-
-        if (err != decode_error::ok) return err;
-
-        if (ihdr.color_type == 2)
-        {
-            std::vector<uint8_t> rgba;
-            rgba.resize(static_cast<size_t>(ihdr.width) * ihdr.height * 4);
-
-            const uint8_t* src{ decompressed.data() }; // RGB
-            uint8_t* dst{ rgba.data() };
-
-            const size_t px_count{ static_cast<size_t>(ihdr.width) * ihdr.height };
-            for (size_t i{ 0 }; i < px_count; ++i)
-            {
-                dst[0] = src[0];
-                dst[1] = src[1];
-                dst[2] = src[2];
-                dst[3] = 255;
-                src += 3;
-                dst += 4;
-            }
-
-            decompressed = std::move(rgba);
-        }
-
-        // After inflate + defilter, decompressed is now clean RGBA
-        const size_t stride_sz{ static_cast<size_t>(ihdr.width) * 4 };
-        const uint32_t stride{ static_cast<uint32_t>(stride_sz) };
-
-        out_pixel_storage = std::move(decompressed);
-
-        bool is_srgb{ true };
-
-        if (ihdr.has_srgb)
-        {
-            is_srgb = true;
-        }
-        else if (ihdr.has_gamma)
-        {
-            // PNG gamma chunk is "image gamma"; sRGB-ish gamma is ~0.45455.
-            // If gamma is ~1.0, the stored values are already linear.
-            if (ihdr.gamma > 0.95f && ihdr.gamma < 1.05f)
-                is_srgb = false;
-            // else: leave as true for now (no color management)
-        }
-
-        out_view = {
-            .width = ihdr.width,
-            .height = ihdr.height,
-            .pixels = out_pixel_storage,
-            .stride_bytes = stride,
-            .is_srgb = is_srgb
-        };
+        no_decode_stats_t stats{ };
+        return load_into_storage(data, out_view, out_pixel_storage, options, stats);
+    }
 
-        return decode_error::ok;
+    [[nodiscard]] decode_error load_from_memory(const std::span<const uint8_t> data, image_view_t& out_view,
+                                                std::vector<uint8_t>& out_pixel_storage,
+                                                const decode_options_t& options, decode_stats_t& out_stats) noexcept
+    {
+        out_stats = { };
+        decode_stats_recorder_t stats{ .stats = out_stats };
+        return load_into_storage(data, out_view, out_pixel_storage, options, stats);
     }
 
     [[nodiscard]] decode_error load_from_file(const char* path, image_view_t& out_view,
-                                              std::vector<uint8_t>& out_pixel_storage) noexcept
+                                              std::vector<uint8_t>& out_pixel_storage,
+                                              const decode_options_t& options) noexcept
     {
+        begin_diagnostics(options);
+
         std::ifstream file(path, std::ios::binary | std::ios::ate);
 
-        if (!file.is_open()) return decode_error::file_not_found;
+        if (!file.is_open()) return check_stage(options, decode_stage::read, decode_error::file_not_found);
 
         const std::streamsize size{ file.tellg() };
         file.seekg(0, std::ios::beg);
 
         std::vector<uint8_t> buffer(static_cast<size_t>(size));
         if (!file.read(reinterpret_cast<char *>(buffer.data()), size))
-            return decode_error::file_too_short;
+            return check_stage(options, decode_stage::read, decode_error::file_too_short);
 
-        return load_from_memory(buffer, out_view, out_pixel_storage);
+        return load_from_memory(buffer, out_view, out_pixel_storage, options);
     }
 
     [[nodiscard]] decode_error read_ihdr_from_file(const char* path, ihdr_info_t& out_ihdr) noexcept
@@ -227,59 +536,232 @@ namespace cpng {
     }
 
     [[nodiscard]] decode_error load_from_memory(const std::span<const uint8_t> data, image_view_t& out_view,
-                                                const std::span<uint8_t> out_rgba8) noexcept
+                                                const std::span<uint8_t> out_rgba8,
+                                                const decode_options_t& options) noexcept
+    {
+        return load_from_memory(data, out_view, out_rgba8, 0, options);
+    }
+
+    [[nodiscard]] decode_error load_from_memory(const std::span<const uint8_t> data, image_view_t& out_view,
+                                                const std::span<uint8_t> out_pixels, const uint32_t stride_bytes,
+                                                const decode_options_t& options) noexcept
+    {
+        no_decode_stats_t stats{ };
+        return load_into_buffer(data, out_view, out_pixels, stride_bytes, options, stats);
+    }
+
+    [[nodiscard]] decode_error load_from_memory(const std::span<const uint8_t> data, image_view_t& out_view,
+                                                const std::span<uint8_t> out_pixels, const uint32_t stride_bytes,
+                                                const decode_options_t& options, decode_stats_t& out_stats) noexcept
+    {
+        out_stats = { };
+        decode_stats_recorder_t stats{ .stats = out_stats };
+        return load_into_buffer(data, out_view, out_pixels, stride_bytes, options, stats);
+    }
+
+    [[nodiscard]] decode_error load_mip_chain_from_memory(const std::span<const uint8_t> data,
+                                                          std::vector<image_view_t>& out_levels,
+                                                          std::vector<uint8_t>& out_pixel_storage,
+                                                          const decode_options_t& options) noexcept
     {
-        // First parse IHDR + IDAT spans so we know the required size.
         ihdr_info_t ihdr{ };
         std::vector<std::span<const uint8_t>> idat_spans;
+        xxh64_state_t source_hash{ };
+        row_pipeline_t pipeline{ };
+        no_decode_stats_t stats{ };
+
+        decode_error err{ prepare_decode(data, options, ihdr, idat_spans, source_hash, pipeline, stats) };
+        if (err != decode_error::ok) return err;
+
+        // Linear light averaging decodes the sRGB curve itself; linearized samples would go through it twice
+        if (options.mip_srgb_average && options.transform == color_transform::srgb_to_linear)
+        {
+            return report_failure(options.diagnostics, {
+                .error = decode_error::unsupported_output_format,
+                .stage = decode_stage::validate,
+                .reason = "sRGB mip averaging of linearized samples",
+            });
+        }
+
+        const uint32_t full{ full_mip_count(ihdr.width, ihdr.height) };
+        const uint32_t count{ options.mip_levels == 0 ? full : std::min(options.mip_levels, full) };
 
-        decode_error err{ parse_png_chunks(data, ihdr, idat_spans) };
+        std::unique_ptr<srgb_mip_tables_t> srgb_tables;
+        if (options.mip_srgb_average)
+        {
+            srgb_tables = std::make_unique<srgb_mip_tables_t>();
+            srgb_tables->build();
+        }
 
+        mip_chain_builder_t chain{ };
+        err = check_stage(options, decode_stage::output,
+                          chain.init(ihdr.width, ihdr.height, count, options.format, srgb_tables.get()));
         if (err != decode_error::ok) return err;
 
-        if (!ihdr.valid) return decode_error::missing_ihdr;
+        out_pixel_storage.resize(chain.total_bytes);
+        chain.base = out_pixel_storage.data();
 
-        if (ihdr.compression_method != 0 || ihdr.filter_method != 0)
-            return decode_error::unsupported_compression_filter;
+        const size_t base_stride{ chain.levels[0].stride };
+        xxh64_state_t pixel_hash{ };
+        const auto hash_row{ row_hash_hook(options, pixel_hash, chain.base, base_stride, base_stride) };
 
-        if (ihdr.interlace_method != 0)
-            return decode_error::unsupported_interlace;
+        err = decode_pixels(ihdr, idat_spans, options, pipeline, chain.base, base_stride,
+                            [&](const uint32_t y) noexcept {
+                                hash_row(y);
+                                chain.on_row(0, y);
+                            }, stats);
+        if (err != decode_error::ok) return err;
 
-        if (ihdr.width == 0 || ihdr.height == 0)
-            return decode_error::invalid_chunk_length;
+        const bool is_srgb{ !pipeline.output_linear && is_srgb_hint(ihdr) };
 
-        // MVP validation
-        if (ihdr.bit_depth != 8) return decode_error::unsupported_bit_depth;
-        if (ihdr.color_type != 2 && ihdr.color_type != 6) return decode_error::unsupported_color_type;
+        out_levels.clear();
+        out_levels.reserve(count);
 
-        const size_t needed = rgba8_size_bytes(ihdr);
-        if (out_rgba8.size() < needed)
-            return decode_error::output_buffer_too_small;
+        for (const mip_chain_builder_t::level_t& level: chain.levels)
+        {
+            out_levels.push_back({
+                .width = level.width,
+                .height = level.height,
+                .pixels = std::span<const uint8_t>{ chain.base + level.offset, level.stride * level.height },
+                .stride_bytes = static_cast<uint32_t>(level.stride),
+                .format = options.format,
+                .is_srgb = is_srgb
+            });
+        }
+
+        // Statistics and hashes describe the decoded image, i.e. level 0
+        out_levels.front().stats = pipeline.finish_stats();
+        if (options.compute_hashes)
+        {
+            out_levels.front().pixel_hash = pixel_hash.digest();
+            out_levels.front().source_hash = source_hash.digest();
+        }
+
+        return decode_error::ok;
+    }
+
+    [[nodiscard]] decode_error load_compressed_from_memory(const std::span<const uint8_t> data,
+                                                           compressed_image_t& out_image,
+                                                           std::vector<uint8_t>& out_block_storage,
+                                                           const block_format format,
+                                                           const decode_options_t& options) noexcept
+    {
+        begin_diagnostics(options);
+
+        ihdr_info_t ihdr{ };
+        std::vector<std::span<const uint8_t>> idat_spans;
+
+        decode_error err{ check_stage(options, decode_stage::parse, parse_png_chunks(data, ihdr, idat_spans)) };
+        if (err != decode_error::ok) return err;
+
+        const block_row_fn compress_row{ select_block_row_compressor(format) };
+        if (!compress_row) return check_stage(options, decode_stage::validate, decode_error::unsupported_output_format);
+
+        decode_options_t row_options{ options };
+        row_options.format = block_source_format(format);
+
+        row_pipeline_t pipeline{ };
+        err = check_stage(options, decode_stage::validate, validate_for_decode(ihdr, row_options, pipeline));
+        if (err != decode_error::ok) return err;
+
+        const uint32_t blocks_x{ (ihdr.width + 3) / 4 };
+        const uint32_t blocks_y{ (ihdr.height + 3) / 4 };
+        const size_t pitch{ static_cast<size_t>(blocks_x) * block_bytes(format) };
+        const size_t stride{ static_cast<size_t>(ihdr.width) * bytes_per_pixel(row_options.format) };
+
+        out_block_storage.resize(pitch * blocks_y);
+
+        const uint32_t threads{ resolve_thread_count(options.worker_threads) };
+
+        // Started once: a band is only a few block rows, far too little work for a thread start each
+        worker_pool_t workers{ std::min(threads, blocks_y) };
+
+        // Compresses block rows [first, first + count) from `rows`, which holds pixel row first * 4 at index 0
+        const auto compress_band{
+            [&](const uint8_t* rows, const uint32_t first, const uint32_t count, const uint32_t rows_held) noexcept {
+                workers.run(count, [&](const uint32_t i) noexcept {
+                    const uint8_t* src[4];
+                    for (uint32_t r{ 0 }; r < 4; ++r)
+                        src[r] = rows + std::min(i * 4 + r, rows_held - 1) * stride;
 
-        // Decode using your existing vector-based path
-        std::vector<uint8_t> tmp_pixels;
-        image_view_t tmp_view{ };
+                    compress_row(src, ihdr.width, out_block_storage.data() + (first + i) * pitch);
+                });
+            }
+        };
+
+        const uint32_t pass_count{ decode_pass_count(ihdr, options) };
 
-        err = load_from_memory(data, tmp_view, tmp_pixels);
+        no_decode_stats_t stats{ };
+        std::vector<uint8_t> decompressed;
+        err = inflate_scanlines(ihdr, idat_spans, pass_count, decompressed, options.diagnostics, stats);
         if (err != decode_error::ok) return err;
 
-        // tmp_pixels should be RGBA8 with size == needed
-        if (tmp_pixels.size() < needed)
-            return decode_error::invalid_idat_stream;
+        if (ihdr.interlace_method == 1)
+        {
+            // Adam7 scatters pixels across the whole image, so decode it whole first
+            std::vector<uint8_t> pixels(stride * ihdr.height);
+
+            err = decode_adam7(ihdr, decompressed, pass_count, pipeline, bytes_per_pixel(row_options.format),
+                               pixels.data(), stride, options.diagnostics, stats);
+            if (err != decode_error::ok) return err;
 
-        std::copy_n(tmp_pixels.data(), needed, out_rgba8.data());
+            compress_band(pixels.data(), 0, blocks_y, ihdr.height);
+        }
+        else
+        {
+            // One block row per thread and a few more to keep them busy; a single thread holds just 4 rows
+            const uint32_t band_blocks{ threads == 1 ? 1u : std::min(threads * 4, blocks_y) };
+            const uint32_t band_rows{ band_blocks * 4 };
+
+            std::vector<uint8_t> band(stride * band_rows);
+            uint32_t band_first{ 0 };
+
+            const size_t row_bytes{ scanline_bytes(ihdr.width, ihdr.bit_depth, ihdr.color_type) };
+            const uint32_t bpp{ filter_bpp(ihdr.bit_depth, ihdr.color_type) };
+
+            err = defilter_scanlines(decompressed, row_bytes, ihdr.height, bpp,
+                                     [&](const uint32_t y, const uint8_t* pixels) {
+                                         const uint32_t local{ y - band_first * 4 };
+                                         pipeline.write_row(pixels, band.data() + local * stride, ihdr.width);
+
+                                         if (local + 1 == band_rows || y + 1 == ihdr.height)
+                                         {
+                                             compress_band(band.data(), band_first, (local + 4) / 4, local + 1);
+                                             band_first += band_blocks;
+                                         }
+                                     }, stats, options.diagnostics);
+            if (err != decode_error::ok) return err;
+        }
 
-        out_view = {
+        out_image = compressed_image_t{
             .width = ihdr.width,
             .height = ihdr.height,
-            .pixels = std::span<const uint8_t>{ out_rgba8.data(), needed },
-            .stride_bytes = ihdr.width * 4u,
-            .is_srgb = true // placeholder; later could use ihdr.has_srgb / gamma flags
+            .blocks_x = blocks_x,
+            .blocks_y = blocks_y,
+            .blocks = std::span<const uint8_t>{ out_block_storage.data(), out_block_storage.size() },
+            .row_pitch_bytes = static_cast<uint32_t>(pitch),
+            .format = format,
+            .is_srgb = !pipeline.output_linear && is_srgb_hint(ihdr),
+            .stats = pipeline.finish_stats()
         };
 
         return decode_error::ok;
     }
 
+    [[nodiscard]] decode_error compressed_hash_from_memory(const std::span<const uint8_t> data,
+                                                           uint64_t& out_hash) noexcept
+    {
+        ihdr_info_t ihdr{ };
+        std::vector<std::span<const uint8_t>> idat_spans;
+        xxh64_state_t hash{ };
+
+        const decode_error err{ parse_png_chunks(data, ihdr, idat_spans, &hash) };
+        if (err != decode_error::ok) return err;
+
+        out_hash = hash.digest();
+        return decode_error::ok;
+    }
+
     [[nodiscard]] std::string_view to_string(const decode_error err) noexcept
     {
         switch (err)
@@ -302,7 +784,30 @@ namespace cpng {
             case decode_error::unsupported_interlace:           return"unsupported interlace method";
             case decode_error::unsupported_filter:              return "unsupported filter";
             case decode_error::file_not_found:                  return "file not found";
+            case decode_error::unsupported_output_format:       return "unsupported output format";
+            case decode_error::invalid_archive:                 return "invalid or corrupt archive";
+            case decode_error::atlas_overflow:                  return "images do not fit in the atlas";
+            case decode_error::invalid_chunk_data:              return "invalid chunk data";
+            case decode_error::invalid_image_view:              return "image cannot be encoded";
+            case decode_error::file_write_failed:               return "file write failed";
             default:                                            return "unknown error";
         }
     }
+
+    [[nodiscard]] std::string_view to_string(const decode_stage stage) noexcept
+    {
+        switch (stage)
+        {
+            case decode_stage::none:        return "none";
+            case decode_stage::read:        return "read";
+            case decode_stage::parse:       return "parse";
+            case decode_stage::validate:    return "validate";
+            case decode_stage::inflate:     return "inflate";
+            case decode_stage::adler32:     return "adler32";
+            case decode_stage::defilter:    return "defilter";
+            case decode_stage::output:      return "output";
+        }
+
+        return "unknown stage";
+    }
 } // namespace cpng
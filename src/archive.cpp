@@ -0,0 +1,381 @@
+//
+// Created by Zack Shrout on 3/23/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/archive.h"
+
+#include "internal/chunk_parser.h"
+#include "internal/xxhash64.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace cpng {
+    namespace {
+        constexpr uint8_t   k_archive_magic[4]{ 'C', 'P', 'A', 'K' };
+        constexpr uint32_t  k_archive_version{ 1 };
+        constexpr size_t    k_header_bytes{ 32 };
+        constexpr size_t    k_record_bytes{ 48 };
+        constexpr size_t    k_data_alignment{ 8 };
+
+        constexpr uint8_t   k_flag_srgb{ 1u << 0 };
+        constexpr uint8_t   k_flag_gamma{ 1u << 1 };
+        constexpr uint8_t   k_flag_icc{ 1u << 2 };
+
+        [[nodiscard]] uint64_t name_hash(const std::string_view name) noexcept
+        {
+            return xxh64({ reinterpret_cast<const uint8_t*>(name.data()), name.size() });
+        }
+
+        constexpr void write_le32(uint8_t* p, const uint32_t v) noexcept
+        {
+            for (uint32_t i{ 0 }; i < 4; ++i)
+                p[i] = static_cast<uint8_t>(v >> (i * 8));
+        }
+
+        constexpr void write_le64(uint8_t* p, const uint64_t v) noexcept
+        {
+            for (uint32_t i{ 0 }; i < 8; ++i)
+                p[i] = static_cast<uint8_t>(v >> (i * 8));
+        }
+
+        struct pending_entry_t
+        {
+            uint64_t        hash{ };
+            uint64_t        offset{ };
+            uint32_t        source{ };      // index into the caller's sources
+            ihdr_info_t     ihdr{ };
+        };
+    } // anonymous namespace
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Writer
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    decode_error write_archive(const char* path, const std::span<const archive_source_t> sources) noexcept
+    {
+        if (sources.size() > UINT32_MAX) return decode_error::invalid_archive;
+
+        std::vector<pending_entry_t> entries(sources.size());
+        std::vector<std::span<const uint8_t>> idat_spans;
+
+        uint64_t offset{ k_header_bytes };
+        uint64_t names_bytes{ 0 };
+
+        for (uint32_t i{ 0 }; i < sources.size(); ++i)
+        {
+            const archive_source_t& source{ sources[i] };
+            pending_entry_t& entry{ entries[i] };
+
+            const decode_error err{ parse_png_chunks(source.png, entry.ihdr, idat_spans) };
+            if (err != decode_error::ok) return err;
+
+            entry.hash = name_hash(source.name);
+            entry.offset = offset;
+            entry.source = i;
+
+            offset = (offset + source.png.size() + k_data_alignment - 1) & ~uint64_t{ k_data_alignment - 1 };
+            names_bytes += source.name.size();
+        }
+
+        if (names_bytes > UINT32_MAX) return decode_error::invalid_archive;
+
+        const auto name_of{ [&](const pending_entry_t& e) noexcept { return sources[e.source].name; } };
+
+        std::ranges::sort(entries, [&](const pending_entry_t& a, const pending_entry_t& b) noexcept {
+            return a.hash != b.hash ? a.hash < b.hash : name_of(a) < name_of(b);
+        });
+
+        for (size_t i{ 1 }; i < entries.size(); ++i)
+            if (entries[i].hash == entries[i - 1].hash && name_of(entries[i]) == name_of(entries[i - 1]))
+                return decode_error::invalid_archive;
+
+        const uint64_t index_offset{ offset };
+        const uint64_t names_offset{ index_offset + entries.size() * k_record_bytes };
+
+        // Header + index + names are built in memory; the PNG bytes are streamed from the sources
+        uint8_t header[k_header_bytes]{ };
+        std::copy_n(k_archive_magic, 4, header);
+        write_le32(header + 4, k_archive_version);
+        write_le32(header + 8, static_cast<uint32_t>(entries.size()));
+        write_le64(header + 16, index_offset);
+        write_le64(header + 24, names_offset);
+
+        std::vector<uint8_t> index(entries.size() * k_record_bytes);
+        std::string names;
+        names.reserve(names_bytes);
+
+        for (size_t i{ 0 }; i < entries.size(); ++i)
+        {
+            const pending_entry_t& e{ entries[i] };
+            const std::string_view name{ name_of(e) };
+            uint8_t* r{ index.data() + i * k_record_bytes };
+
+            const uint8_t flags{
+                static_cast<uint8_t>((e.ihdr.has_srgb ? k_flag_srgb : 0) | (e.ihdr.has_gamma ? k_flag_gamma : 0) |
+                                     (e.ihdr.has_icc_profile ? k_flag_icc : 0))
+            };
+
+            write_le64(r + 0, e.hash);
+            write_le64(r + 8, e.offset);
+            write_le64(r + 16, sources[e.source].png.size());
+            write_le32(r + 24, e.ihdr.width);
+            write_le32(r + 28, e.ihdr.height);
+            r[32] = e.ihdr.bit_depth;
+            r[33] = e.ihdr.color_type;
+            r[34] = e.ihdr.interlace_method;
+            r[35] = flags;
+            write_le32(r + 36, static_cast<uint32_t>(std::lround(e.ihdr.gamma * 100000.0f)));
+            write_le32(r + 40, static_cast<uint32_t>(names.size()));
+            write_le32(r + 44, static_cast<uint32_t>(name.size()));
+
+            names.append(name);
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return decode_error::file_write_failed;
+
+        file.write(reinterpret_cast<const char*>(header), k_header_bytes);
+
+        constexpr char k_padding[k_data_alignment]{ };
+        for (const archive_source_t& source: sources)
+        {
+            file.write(reinterpret_cast<const char*>(source.png.data()), static_cast<std::streamsize>(source.png.size()));
+            file.write(k_padding, static_cast<std::streamsize>((k_data_alignment - source.png.size() % k_data_alignment) %
+                                                               k_data_alignment));
+        }
+
+        file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size()));
+        file.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+        return file.good() ? decode_error::ok : decode_error::file_write_failed;
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Reader
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    archive_t::~archive_t()
+    {
+        close();
+    }
+
+    archive_t::archive_t(archive_t&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    archive_t& archive_t::operator=(archive_t&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+
+            _base = std::exchange(other._base, nullptr);
+            _length = std::exchange(other._length, 0);
+            _index = std::exchange(other._index, nullptr);
+            _names = std::exchange(other._names, nullptr);
+            _names_length = std::exchange(other._names_length, 0);
+            _count = std::exchange(other._count, 0);
+        }
+
+        return *this;
+    }
+
+    decode_error archive_t::open(const char* path) noexcept
+    {
+        close();
+
+        const uint8_t* base{ nullptr };
+        size_t length{ 0 };
+
+#if defined(_WIN32)
+        const HANDLE file{ CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                       FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (file == INVALID_HANDLE_VALUE) return decode_error::file_not_found;
+
+        LARGE_INTEGER file_size{ };
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(k_header_bytes))
+        {
+            CloseHandle(file);
+            return decode_error::invalid_archive;
+        }
+
+        const HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        CloseHandle(file);
+        if (mapping == nullptr) return decode_error::file_not_found;
+
+        base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);   // the view keeps the mapping alive
+        if (base == nullptr) return decode_error::file_not_found;
+
+        length = static_cast<size_t>(file_size.QuadPart);
+#else
+        const int fd{ ::open(path, O_RDONLY | O_CLOEXEC) };
+        if (fd < 0) return decode_error::file_not_found;
+
+        struct stat st{ };
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(k_header_bytes))
+        {
+            ::close(fd);
+            return decode_error::invalid_archive;
+        }
+
+        length = static_cast<size_t>(st.st_size);
+
+        void* mapped{ mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) };
+        ::close(fd);            // the mapping keeps the file alive
+        if (mapped == MAP_FAILED) return decode_error::file_not_found;
+
+        base = static_cast<const uint8_t*>(mapped);
+#endif
+
+        _base = base;
+        _length = length;
+
+        // Everything below is read from the mapping, so a malformed file must not send us out of bounds
+        const auto reject{ [this]() noexcept { close(); return decode_error::invalid_archive; } };
+
+        if (!std::equal(k_archive_magic, k_archive_magic + 4, base) || read_le32(base + 4) != k_archive_version)
+            return reject();
+
+        const uint32_t count{ read_le32(base + 8) };
+        const uint64_t index_offset{ read_le64(base + 16) };
+        const uint64_t names_offset{ read_le64(base + 24) };
+
+        if (index_offset < k_header_bytes || index_offset > length ||
+            (length - index_offset) / k_record_bytes < count ||
+            names_offset != index_offset + uint64_t{ count } * k_record_bytes)
+            return reject();
+
+        _index = base + index_offset;
+        _names = base + names_offset;
+        _names_length = length - names_offset;
+        _count = count;
+
+        uint64_t previous_hash{ 0 };
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            const uint8_t* r{ _index + size_t{ i } * k_record_bytes };
+
+            const uint64_t hash{ read_le64(r) };
+            const uint64_t offset{ read_le64(r + 8) };
+            const uint64_t size{ read_le64(r + 16) };
+            const uint64_t name_offset{ read_le32(r + 40) };
+            const uint64_t name_length{ read_le32(r + 44) };
+
+            if (hash < previous_hash || offset < k_header_bytes || offset > index_offset ||
+                size > index_offset - offset || name_offset > _names_length ||
+                name_length > _names_length - name_offset)
+                return reject();
+
+            previous_hash = hash;
+        }
+
+        return decode_error::ok;
+    }
+
+    void archive_t::close() noexcept
+    {
+        if (_base == nullptr) return;
+
+#if defined(_WIN32)
+        UnmapViewOfFile(_base);
+#else
+        munmap(const_cast<uint8_t*>(_base), _length);
+#endif
+
+        _base = nullptr;
+        _length = 0;
+        _index = nullptr;
+        _names = nullptr;
+        _names_length = 0;
+        _count = 0;
+    }
+
+    archive_entry_t archive_t::entry(const uint32_t index) const noexcept
+    {
+        if (index >= _count) return { };
+
+        const uint8_t* r{ _index + size_t{ index } * k_record_bytes };
+        const uint8_t flags{ r[35] };
+
+        archive_entry_t out{ };
+        out.name = { reinterpret_cast<const char*>(_names) + read_le32(r + 40), read_le32(r + 44) };
+        out.name_hash = read_le64(r);
+        out.offset = read_le64(r + 8);
+        out.size = read_le64(r + 16);
+
+        ihdr_info_t& ihdr{ out.ihdr };
+        ihdr.width = read_le32(r + 24);
+        ihdr.height = read_le32(r + 28);
+        ihdr.bit_depth = r[32];
+        ihdr.color_type = r[33];
+        ihdr.interlace_method = r[34];
+        ihdr.valid = true;
+        ihdr.has_srgb = (flags & k_flag_srgb) != 0;
+        ihdr.has_gamma = (flags & k_flag_gamma) != 0;
+        ihdr.gamma = static_cast<float>(read_le32(r + 36)) / 100000.0f;
+        ihdr.has_icc_profile = (flags & k_flag_icc) != 0;
+
+        return out;
+    }
+
+    bool archive_t::find(const std::string_view name, archive_entry_t& out_entry) const noexcept
+    {
+        const uint64_t hash{ name_hash(name) };
+
+        // Lower bound on the hash, then compare names across the (almost always single) run of equal hashes
+        uint32_t lo{ 0 }, hi{ _count };
+        while (lo < hi)
+        {
+            const uint32_t mid{ lo + (hi - lo) / 2 };
+            if (read_le64(_index + size_t{ mid } * k_record_bytes) < hash)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        for (; lo < _count && read_le64(_index + size_t{ lo } * k_record_bytes) == hash; ++lo)
+        {
+            archive_entry_t candidate{ entry(lo) };
+            if (candidate.name == name)
+            {
+                out_entry = candidate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::span<const uint8_t> archive_t::data(const archive_entry_t& entry) const noexcept
+    {
+        if (_base == nullptr || entry.offset > _length || entry.size > _length - entry.offset) return { };
+
+        return { _base + entry.offset, static_cast<size_t>(entry.size) };
+    }
+
+    decode_error archive_t::load(const std::string_view name, image_view_t& out_view,
+                                 std::vector<uint8_t>& out_pixel_storage, const decode_options_t& options) const noexcept
+    {
+        archive_entry_t found{ };
+        if (!find(name, found)) return decode_error::file_not_found;
+
+        return load_from_memory(data(found), out_view, out_pixel_storage, options);
+    }
+} // namespace cpng
@@ -0,0 +1,345 @@
+//
+// Created by Zack Shrout on 3/26/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/async_loader.h"
+
+#include "internal/file_io.h"
+#include "internal/io_ring.h"
+#include "internal/parallel.h"
+
+#include <algorithm>
+#include <string>
+
+namespace cpng {
+    struct async_loader_t::request_t
+    {
+        std::string             path{ };
+        decode_options_t        options{ };
+        decode_diagnostics_t    diagnostics{ };                 // filled by this load's decode...
+        decode_diagnostics_t*   caller_diagnostics{ nullptr };  // ...and copied here if it fails
+        load_callback_t         callback{ };
+        std::vector<uint8_t>    bytes{ };       // whole file, once read
+        decode_error            error{ decode_error::ok };
+        bool                    read_done{ false };
+#if CPNG_HAS_IO_URING
+        int                     fd{ -1 };
+        size_t                  done{ 0 };      // bytes read so far
+        iovec                   iov{ };         // must outlive the submission
+#endif
+
+        /// Loads decode concurrently, so each one fills a record of its own.
+        void set_options(const decode_options_t& decode_options) noexcept
+        {
+            options = decode_options;
+            caller_diagnostics = decode_options.diagnostics;
+            if (caller_diagnostics) options.diagnostics = &diagnostics;
+        }
+    };
+
+#if CPNG_HAS_IO_URING
+    struct async_loader_t::ring_t
+    {
+        io_ring_t   ring{ };
+    };
+#else
+    struct async_loader_t::ring_t { };
+#endif
+
+    namespace {
+        /// @brief Blocking read of a whole file (thread-pool backend).
+        [[nodiscard]] decode_error read_whole_file(const char* path, std::vector<uint8_t>& out) noexcept
+        {
+            file_reader_t file{ };
+            if (!file.open(path)) return decode_error::file_not_found;
+
+            out.resize(static_cast<size_t>(file.size()));
+            return file.read_at(0, out) == out.size() ? decode_error::ok : decode_error::file_too_short;
+        }
+    } // anonymous namespace
+
+    async_loader_t::async_loader_t(const async_loader_options_t& options) noexcept
+        : _options{ options }
+    {
+        _options.queue_depth = std::max(_options.queue_depth, 1u);
+
+#if CPNG_HAS_IO_URING
+        if (_options.use_io_uring)
+        {
+            auto ring{ std::make_unique<ring_t>() };
+            if (ring->ring.init(std::min(_options.queue_depth, 4096u)))
+                _ring = std::move(ring);
+        }
+#endif
+
+        const uint32_t workers{ resolve_thread_count(_options.decode_threads) };
+        _workers.reserve(workers);
+        for (uint32_t i{ 0 }; i < workers; ++i)
+            _workers.emplace_back([this] { decode_loop(); });
+
+        if (_ring) _io_thread = std::jthread{ [this] { io_loop(); } };
+    }
+
+    async_loader_t::~async_loader_t()
+    {
+        wait();
+
+        {
+            std::lock_guard lock{ _mutex };
+            _stopping = true;
+        }
+
+        _io_wake.notify_all();
+        _work_ready.notify_all();
+
+        // jthreads join on destruction; the I/O thread must go before the ring it drives
+        if (_io_thread.joinable()) _io_thread.join();
+        _workers.clear();
+    }
+
+    void async_loader_t::load(const char* path, load_callback_t callback, const decode_options_t& options) noexcept
+    {
+        auto request{ std::make_unique<request_t>() };
+        request->path = path;
+        request->set_options(options);
+        request->callback = std::move(callback);
+
+        enqueue(std::move(request));
+    }
+
+    void async_loader_t::load_batch(const std::span<const char* const> paths, const batch_load_callback_t& callback,
+                                    const decode_options_t& options) noexcept
+    {
+        std::vector<std::unique_ptr<request_t>> requests(paths.size());
+        for (size_t i{ 0 }; i < paths.size(); ++i)
+        {
+            requests[i] = std::make_unique<request_t>();
+            requests[i]->path = paths[i];
+            requests[i]->set_options(options);
+            requests[i]->callback = [callback, i](const decode_error err, std::shared_ptr<decoded_image_t> image) {
+                callback(i, err, std::move(image));
+            };
+        }
+
+        {
+            std::lock_guard lock{ _mutex };
+            if (options.diagnostics) *options.diagnostics = { };
+            _outstanding += requests.size();
+
+            for (auto& request: requests)
+                (_ring ? _pending : _ready).push_back(std::move(request));
+        }
+
+        if (_ring)
+            _io_wake.notify_one();
+        else
+            _work_ready.notify_all();
+    }
+
+    void async_loader_t::enqueue(std::unique_ptr<request_t> request) noexcept
+    {
+        {
+            std::lock_guard lock{ _mutex };
+            if (request->caller_diagnostics) *request->caller_diagnostics = { };
+            ++_outstanding;
+            (_ring ? _pending : _ready).push_back(std::move(request));
+        }
+
+        if (_ring)
+            _io_wake.notify_one();
+        else
+            _work_ready.notify_one();
+    }
+
+    void async_loader_t::wait() noexcept
+    {
+        std::unique_lock lock{ _mutex };
+        _idle.wait(lock, [this] { return _outstanding == 0; });
+    }
+
+    void async_loader_t::decode_loop() noexcept
+    {
+        while (true)
+        {
+            std::unique_ptr<request_t> request;
+
+            {
+                std::unique_lock lock{ _mutex };
+                _work_ready.wait(lock, [this] { return _stopping || !_ready.empty(); });
+
+                if (_ready.empty()) return;
+
+                request = std::move(_ready.front());
+                _ready.pop_front();
+            }
+
+            if (!request->read_done)
+                request->error = read_whole_file(request->path.c_str(), request->bytes);
+
+            std::shared_ptr<decoded_image_t> image;
+            decode_error err{ request->error };
+
+            if (err == decode_error::ok)
+            {
+                image = std::make_shared<decoded_image_t>();
+                err = load_from_memory(request->bytes, image->view, image->storage, request->options);
+                if (err != decode_error::ok) image.reset();
+            }
+
+            // Free the file bytes (and let the I/O thread read further ahead) before the callback runs
+            const bool was_buffered{ request->read_done };
+            request->bytes = { };
+
+            if (was_buffered)
+            {
+                {
+                    std::lock_guard lock{ _mutex };
+                    --_buffered;
+                }
+                _io_wake.notify_one();
+            }
+
+            if (err != decode_error::ok && request->caller_diagnostics)
+            {
+                // A failed read never reached the decoder, which would have filled the record
+                if (request->diagnostics.error == decode_error::ok)
+                {
+                    request->diagnostics = { .error = err, .stage = decode_stage::read,
+                                             .reason = to_string(err).data() };
+                }
+
+                std::lock_guard lock{ _mutex };
+                *request->caller_diagnostics = request->diagnostics;
+            }
+
+            if (request->callback) request->callback(err, std::move(image));
+
+            {
+                std::lock_guard lock{ _mutex };
+                if (--_outstanding == 0) _idle.notify_all();
+            }
+        }
+    }
+
+#if CPNG_HAS_IO_URING
+    void async_loader_t::io_loop() noexcept
+    {
+        io_ring_t& ring{ _ring->ring };
+        uint32_t in_flight{ 0 };
+
+        // Hands a finished (or failed) read to the decode workers
+        const auto complete{
+            [&](std::unique_ptr<request_t> request) noexcept {
+                if (request->fd >= 0) ::close(request->fd);
+                request->fd = -1;
+                request->read_done = true;
+
+                {
+                    std::lock_guard lock{ _mutex };
+                    _ready.push_back(std::move(request));
+                }
+                _work_ready.notify_one();
+            }
+        };
+
+        const auto queue_read{
+            [&](request_t* request) noexcept {
+                request->iov = { request->bytes.data() + request->done, request->bytes.size() - request->done };
+                return ring.queue_readv(request->fd, &request->iov, request->done,
+                                        reinterpret_cast<uint64_t>(request));
+            }
+        };
+
+        while (true)
+        {
+            std::vector<std::unique_ptr<request_t>> starting;
+
+            {
+                std::unique_lock lock{ _mutex };
+
+                // Sleep only when nothing is in flight; otherwise the ring wait below wakes us
+                if (in_flight == 0)
+                {
+                    _io_wake.wait(lock, [&] {
+                        return _stopping || (!_pending.empty() && _buffered < _options.queue_depth);
+                    });
+
+                    if (_stopping && _pending.empty()) return;
+                }
+
+                while (!_pending.empty() && _buffered < _options.queue_depth && in_flight < ring.capacity())
+                {
+                    starting.push_back(std::move(_pending.front()));
+                    _pending.pop_front();
+                    ++_buffered;
+                    ++in_flight;
+                }
+            }
+
+            for (auto& request: starting)
+            {
+                request->fd = ::open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+
+                struct stat st{ };
+                if (request->fd < 0 || fstat(request->fd, &st) != 0)
+                {
+                    request->error = decode_error::file_not_found;
+                }
+                else
+                {
+                    request->bytes.resize(static_cast<size_t>(st.st_size));
+                    if (!request->bytes.empty() && queue_read(request.get()))
+                    {
+                        request.release();  // owned by the ring until its completion arrives
+                        continue;
+                    }
+                }
+
+                --in_flight;
+                complete(std::move(request));
+            }
+
+            if (in_flight == 0) continue;
+
+            // Reads already queued stay owned by the ring, so a failed submit (out of kernel memory)
+            // can only be retried, not abandoned
+            if (!ring.submit(true))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            io_ring_t::completion_t cqe{ };
+            while (ring.pop(cqe))
+            {
+                std::unique_ptr<request_t> request{ reinterpret_cast<request_t*>(cqe.user_data) };
+
+                if (cqe.result == -EINTR || cqe.result == -EAGAIN)
+                {
+                    if (queue_read(request.get())) { request.release(); continue; }
+                }
+                else if (cqe.result > 0)
+                {
+                    request->done += static_cast<size_t>(cqe.result);
+
+                    // Short read: ask for the rest
+                    if (request->done < request->bytes.size() && queue_read(request.get()))
+                    {
+                        request.release();
+                        continue;
+                    }
+                }
+
+                if (request->done < request->bytes.size())
+                    request->error = decode_error::file_too_short;
+
+                --in_flight;
+                complete(std::move(request));
+            }
+        }
+    }
+#else
+    void async_loader_t::io_loop() noexcept { }
+#endif
+} // namespace cpng
@@ -0,0 +1,201 @@
+//
+// Created by Zack Shrout on 3/24/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/atlas.h"
+
+#include "internal/diagnostics.h"
+#include "internal/parallel.h"
+#include "internal/skyline_packer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+namespace cpng {
+    namespace {
+        [[nodiscard]] uint32_t round_up_pow2(const uint32_t v) noexcept
+        {
+            return v <= 1 ? 1u : std::bit_ceil(v);
+        }
+
+        /**
+         * Packs the (padded) rectangles in `order` into the narrowest width that fits, starting
+         * from a square estimate and widening up to max_width. With power_of_two the limits are the
+         * largest powers of two within max_width and max_height, so rounding up stays inside them.
+         * False when even the widest bin overflows.
+         */
+        [[nodiscard]] bool pack_rects(const std::vector<ihdr_info_t>& headers, const std::vector<uint32_t>& order,
+                                      const atlas_options_t& options, std::vector<atlas_rect_t>& rects,
+                                      uint32_t& out_width, uint32_t& out_height)
+        {
+            const uint32_t pad{ options.padding };
+            const uint32_t max_width{ options.power_of_two ? std::bit_floor(options.max_width) : options.max_width };
+            const uint32_t max_height{ options.power_of_two ? std::bit_floor(options.max_height) : options.max_height };
+
+            uint64_t area{ 0 };
+            uint32_t widest{ 1 };
+            for (const ihdr_info_t& ihdr: headers)
+            {
+                area += static_cast<uint64_t>(ihdr.width + pad) * (ihdr.height + pad);
+                widest = std::max(widest, ihdr.width);
+            }
+
+            uint32_t width{
+                std::max(widest, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(area)))))
+            };
+            if (options.power_of_two) width = round_up_pow2(width);
+            width = std::min(width, max_width);
+
+            skyline_packer_t packer{ };
+
+            while (true)
+            {
+                // The bin is one padding wider and taller: the last column / row needs no gap after it
+                packer.reset(width + pad, max_height + pad);
+
+                bool packed{ true };
+                for (const uint32_t i: order)
+                {
+                    if (!packer.insert(headers[i].width + pad, headers[i].height + pad, rects[i].x, rects[i].y))
+                    {
+                        packed = false;
+                        break;
+                    }
+                }
+
+                if (packed) break;
+                if (width == max_width) return false;
+
+                width = std::min(options.power_of_two ? width * 2 : width + std::max(width / 2, 1u), max_width);
+            }
+
+            // The square estimate may leave a strip unused on the right
+            out_width = 0;
+            for (const uint32_t i: order)
+                out_width = std::max(out_width, rects[i].x + headers[i].width);
+
+            out_height = packer.used_height - pad;
+
+            if (options.power_of_two)
+            {
+                out_width = round_up_pow2(out_width);
+                out_height = round_up_pow2(out_height);
+            }
+
+            return true;
+        }
+    } // anonymous namespace
+
+    decode_error build_atlas(const std::span<const std::span<const uint8_t>> images, atlas_t& out_atlas,
+                             std::vector<uint8_t>& out_pixel_storage, const atlas_options_t& atlas_options,
+                             const decode_options_t& options) noexcept
+    {
+        out_atlas = { };
+        if (options.diagnostics) *options.diagnostics = { };
+
+        const uint32_t count{ static_cast<uint32_t>(images.size()) };
+        const uint32_t pixel_bytes{ bytes_per_pixel(options.format) };
+        if (pixel_bytes == 0)
+        {
+            return report_failure(options.diagnostics, { .error = decode_error::unsupported_output_format,
+                                                         .stage = decode_stage::validate,
+                                                         .reason = "unsupported output format" });
+        }
+
+        // Headers only: sizes are all the packer needs
+        std::vector<ihdr_info_t> headers(count);
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            const decode_error err{ read_ihdr_from_memory(images[i], headers[i]) };
+            if (err != decode_error::ok)
+            {
+                return report_failure(options.diagnostics, { .error = err, .stage = decode_stage::parse,
+                                                             .reason = "sprite header unreadable" });
+            }
+
+            if (headers[i].width > atlas_options.max_width || headers[i].height > atlas_options.max_height)
+            {
+                return report_failure(options.diagnostics, { .error = decode_error::atlas_overflow,
+                                                             .stage = decode_stage::validate,
+                                                             .reason = "sprite larger than the atlas" });
+            }
+        }
+
+        // Tallest first packs tightest on a skyline, and also starts the longest decodes first
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::ranges::stable_sort(order, [&](const uint32_t a, const uint32_t b) noexcept {
+            return headers[a].height != headers[b].height ? headers[a].height > headers[b].height
+                                                          : headers[a].width > headers[b].width;
+        });
+
+        std::vector<atlas_rect_t> rects(count);
+        uint32_t width{ 0 }, height{ 0 };
+
+        if (count != 0 && !pack_rects(headers, order, atlas_options, rects, width, height))
+        {
+            return report_failure(options.diagnostics, { .error = decode_error::atlas_overflow,
+                                                         .stage = decode_stage::validate,
+                                                         .reason = "sprites do not fit the atlas" });
+        }
+
+        const size_t stride{ static_cast<size_t>(width) * pixel_bytes };
+        out_pixel_storage.assign(stride * height, 0);   // padding stays transparent
+
+        decode_options_t sprite_options{ options };
+        sprite_options.compute_hashes = false;
+
+        // Sprites decode at the same time, so each one fills a record of its own
+        std::vector<decode_diagnostics_t> records(options.diagnostics ? count : 0);
+
+        // Rectangles are disjoint, so every image writes its own rows of the shared buffer
+        std::vector<decode_error> errors(count, decode_error::ok);
+        parallel_for(count, resolve_thread_count(options.worker_threads), [&](const uint32_t n) noexcept {
+            const uint32_t i{ order[n] };
+            const size_t offset{ rects[i].y * stride + static_cast<size_t>(rects[i].x) * pixel_bytes };
+
+            decode_options_t own_options{ sprite_options };
+            own_options.diagnostics = records.empty() ? nullptr : &records[i];
+
+            image_view_t view{ };
+            errors[i] = load_from_memory(images[i], view,
+                                         std::span<uint8_t>{ out_pixel_storage }.subspan(offset),
+                                         static_cast<uint32_t>(stride), own_options);
+        });
+
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            if (errors[i] != decode_error::ok)
+            {
+                out_pixel_storage.clear();
+                if (options.diagnostics) *options.diagnostics = records[i];
+                return errors[i];
+            }
+        }
+
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            atlas_rect_t& rect{ rects[i] };
+            rect.width = headers[i].width;
+            rect.height = headers[i].height;
+            rect.u0 = static_cast<float>(rect.x) / static_cast<float>(width);
+            rect.v0 = static_cast<float>(rect.y) / static_cast<float>(height);
+            rect.u1 = static_cast<float>(rect.x + rect.width) / static_cast<float>(width);
+            rect.v1 = static_cast<float>(rect.y + rect.height) / static_cast<float>(height);
+        }
+
+        out_atlas.view = {
+            .width = width,
+            .height = height,
+            .pixels = out_pixel_storage,
+            .stride_bytes = static_cast<uint32_t>(stride),
+            .format = options.format
+        };
+        out_atlas.rects = std::move(rects);
+
+        return decode_error::ok;
+    }
+} // namespace cpng
@@ -0,0 +1,255 @@
+//
+// Created by Zack Shrout on 3/27/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/chunks.h"
+
+#include "internal/chunk_parser.h"
+#include "internal/crc32.h"
+#include "internal/inflate.h"
+
+#include <algorithm>
+
+namespace cpng {
+    namespace {
+        /// @brief Splits off a null-terminated field starting at `pos`; false if there is no terminator.
+        [[nodiscard]] bool read_field(const std::span<const uint8_t> data, size_t& pos, std::string_view& out) noexcept
+        {
+            const auto begin{ data.begin() + static_cast<ptrdiff_t>(pos) };
+            const auto zero{ std::find(begin, data.end(), uint8_t{ 0 }) };
+            if (zero == data.end()) return false;
+
+            out = { reinterpret_cast<const char*>(data.data()) + pos, static_cast<size_t>(zero - begin) };
+            pos += out.size() + 1;
+            return true;
+        }
+
+        /// @brief Inflates a complete zlib stream of unknown length, below `max_size` bytes.
+        [[nodiscard]] decode_error inflate_metadata(const std::span<const uint8_t> zlib_data,
+                                                    std::vector<uint8_t>& out, const size_t max_size) noexcept
+        {
+            const decode_error err{ inflate_idat(zlib_data, out, max_size, inflate_size::at_most) };
+            if (err != decode_error::ok)
+            {
+                out.clear();
+                return decode_error::invalid_chunk_data;
+            }
+
+            return decode_error::ok;
+        }
+
+        [[nodiscard]] bool valid_keyword(const std::string_view keyword) noexcept
+        {
+            return !keyword.empty() && keyword.size() <= 79;
+        }
+    } // anonymous namespace
+
+    bool png_chunk_t::crc_ok() const noexcept
+    {
+        const uint8_t type_bytes[4]{
+            static_cast<uint8_t>(type >> 24), static_cast<uint8_t>(type >> 16),
+            static_cast<uint8_t>(type >> 8), static_cast<uint8_t>(type)
+        };
+
+        uint32_t state{ 0xFFFFFFFFu };
+        state = crc32_update(state, type_bytes);
+        state = crc32_update(state, data);
+
+        return crc32_finalize(state) == crc;
+    }
+
+    chunk_reader_t::chunk_reader_t(const std::span<const uint8_t> file) noexcept
+        : _file{ file }
+    {
+        if (!check_png_signature(file))
+        {
+            _error = decode_error::invalid_signature;
+            _done = true;
+        }
+    }
+
+    bool chunk_reader_t::next(png_chunk_t& out_chunk) noexcept
+    {
+        if (_done) return false;
+
+        const size_t remaining{ _file.size() - _pos };
+
+        if (remaining == 0)
+        {
+            _error = decode_error::no_iend;
+            _done = true;
+            return false;
+        }
+
+        // length(4) + type(4) + crc(4) around the payload
+        if (remaining < 12)
+        {
+            _error = decode_error::file_too_short;
+            _done = true;
+            return false;
+        }
+
+        const uint8_t* p{ _file.data() + _pos };
+        const uint32_t length{ peek_be_u32(p) };
+
+        if (length > 0x7FFFFFFFu || length > remaining - 12)
+        {
+            _error = decode_error::invalid_chunk_length;
+            _done = true;
+            return false;
+        }
+
+        out_chunk = {
+            .type = peek_be_u32(p + 4),
+            .data = { p + 8, length },
+            .crc = peek_be_u32(p + 8 + length),
+            .offset = _pos
+        };
+
+        _pos += 12u + length;
+
+        if (out_chunk.type == chunk_type("IEND")) _done = true;
+
+        return true;
+    }
+
+    decode_error read_icc_profile(const png_chunk_t& chunk, std::string_view& out_name,
+                                  std::vector<uint8_t>& out_profile, const size_t max_size) noexcept
+    {
+        out_name = { };
+        out_profile.clear();
+
+        if (chunk.type != chunk_type("iCCP")) return decode_error::invalid_chunk_data;
+
+        size_t pos{ 0 };
+        std::string_view name{ };
+        if (!read_field(chunk.data, pos, name) || !valid_keyword(name)) return decode_error::invalid_chunk_data;
+
+        // Compression method: 0 (zlib) is the only one defined
+        if (pos >= chunk.data.size() || chunk.data[pos] != 0) return decode_error::invalid_chunk_data;
+        ++pos;
+
+        const decode_error err{ inflate_metadata(chunk.data.subspan(pos), out_profile, max_size) };
+        if (err != decode_error::ok) return err;
+
+        out_name = name;
+        return decode_error::ok;
+    }
+
+    decode_error read_text(const png_chunk_t& chunk, text_entry_t& out_text, const size_t max_size) noexcept
+    {
+        out_text = { };
+
+        const std::span<const uint8_t> data{ chunk.data };
+        size_t pos{ 0 };
+
+        std::string_view keyword{ };
+        if (!read_field(data, pos, keyword) || !valid_keyword(keyword)) return decode_error::invalid_chunk_data;
+
+        text_entry_t entry{ };
+        entry.keyword = keyword;
+
+        bool compressed{ false };
+
+        if (chunk.type == chunk_type("zTXt"))
+        {
+            if (pos >= data.size() || data[pos] != 0) return decode_error::invalid_chunk_data;
+            ++pos;
+            compressed = true;
+        }
+        else if (chunk.type == chunk_type("iTXt"))
+        {
+            // compression flag, compression method, language tag\0, translated keyword\0
+            if (data.size() - pos < 2) return decode_error::invalid_chunk_data;
+
+            compressed = data[pos] != 0;
+            if (compressed && data[pos + 1] != 0) return decode_error::invalid_chunk_data;
+            pos += 2;
+
+            if (!read_field(data, pos, entry.language) || !read_field(data, pos, entry.translated_keyword))
+                return decode_error::invalid_chunk_data;
+        }
+        else if (chunk.type != chunk_type("tEXt"))
+        {
+            return decode_error::invalid_chunk_data;
+        }
+
+        const std::span<const uint8_t> body{ data.subspan(pos) };
+
+        if (compressed)
+        {
+            std::vector<uint8_t> inflated;
+            const decode_error err{ inflate_metadata(body, inflated, max_size) };
+            if (err != decode_error::ok) return err;
+
+            entry.text.assign(inflated.begin(), inflated.end());
+        }
+        else
+        {
+            entry.text.assign(body.begin(), body.end());
+        }
+
+        entry.compressed = compressed;
+        out_text = std::move(entry);
+
+        return decode_error::ok;
+    }
+
+    decode_error read_physical_size(const png_chunk_t& chunk, physical_size_t& out_size) noexcept
+    {
+        out_size = { };
+
+        if (chunk.type != chunk_type("pHYs") || chunk.data.size() != 9) return decode_error::invalid_chunk_data;
+
+        out_size = {
+            .pixels_per_unit_x = peek_be_u32(chunk.data.data()),
+            .pixels_per_unit_y = peek_be_u32(chunk.data.data() + 4),
+            .unit_is_meter = chunk.data[8] == 1
+        };
+
+        return decode_error::ok;
+    }
+
+    decode_error read_stripe_index(const png_chunk_t& chunk, std::vector<stripe_index_entry_t>& out_stripes) noexcept
+    {
+        out_stripes.clear();
+
+        constexpr size_t header_bytes{ 8 };
+        constexpr size_t entry_bytes{ 16 };
+
+        const std::span<const uint8_t> data{ chunk.data };
+        if (chunk.type != k_stripe_index_chunk || data.size() < header_bytes || data[0] != 1)
+            return decode_error::invalid_chunk_data;
+
+        const uint32_t count{ peek_be_u32(data.data() + 4) };
+        if (count == 0 || (data.size() - header_bytes) / entry_bytes != count ||
+            (data.size() - header_bytes) % entry_bytes != 0)
+            return decode_error::invalid_chunk_data;
+
+        out_stripes.resize(count);
+
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            const uint8_t* p{ data.data() + header_bytes + i * entry_bytes };
+
+            stripe_index_entry_t& e{ out_stripes[i] };
+            e.first_row = peek_be_u32(p);
+            e.zlib_offset = static_cast<uint64_t>(peek_be_u32(p + 4)) << 32 | peek_be_u32(p + 8);
+            e.adler = peek_be_u32(p + 12);
+
+            const bool ordered{
+                i == 0 ? e.first_row == 0
+                       : e.first_row > out_stripes[i - 1].first_row && e.zlib_offset > out_stripes[i - 1].zlib_offset
+            };
+
+            if (!ordered)
+            {
+                out_stripes.clear();
+                return decode_error::invalid_chunk_data;
+            }
+        }
+
+        return decode_error::ok;
+    }
+} // namespace cpng
@@ -0,0 +1,602 @@
+//
+// Created by Zack Shrout on 3/28/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/encoder.h"
+#include "cpng/chunks.h"
+#include "cpng/decode_cost.h"
+
+#include "internal/adam7.h"
+#include "internal/chunk_writer.h"
+#include "internal/deflate.h"
+#include "internal/deflate_scan.h"
+#include "internal/defilter.h"
+#include "internal/filter.h"
+#include "internal/inflate.h"
+#include "internal/parallel.h"
+#include "internal/png_format.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <limits>
+
+namespace cpng {
+    namespace {
+        /// @brief How input pixels map onto PNG scanlines.
+        struct png_layout_t
+        {
+            uint8_t     color_type{ };
+            uint8_t     bit_depth{ };
+            uint32_t    channels_in{ };
+            uint32_t    channels_out{ };    // channels_in, minus alpha when it is dropped
+            uint32_t    sample_bytes{ };    // 1 or 2
+        };
+
+        [[nodiscard]] bool layout_for(const pixel_format format, const bool drop_alpha, png_layout_t& out) noexcept
+        {
+            switch (format)
+            {
+                case pixel_format::r8:     out = { 0, 8, 1, 1, 1 }; break;
+                case pixel_format::rg8:    out = { 4, 8, 2, 2, 1 }; break;
+                case pixel_format::rgba8:  out = { 6, 8, 4, 4, 1 }; break;
+                case pixel_format::r16:    out = { 0, 16, 1, 1, 2 }; break;
+                case pixel_format::rg16:   out = { 4, 16, 2, 2, 2 }; break;
+                case pixel_format::rgba16: out = { 6, 16, 4, 4, 2 }; break;
+                default:                   return false;
+            }
+
+            if (drop_alpha && (out.color_type & 4u) != 0)
+            {
+                out.color_type &= static_cast<uint8_t>(~4u);
+                --out.channels_out;
+            }
+
+            return true;
+        }
+
+        /// @brief Copies one input row into PNG sample order: alpha dropped as asked, 16-bit samples big-endian.
+        void pack_row(const uint8_t* src, uint8_t* dst, const uint32_t width, const png_layout_t& layout) noexcept
+        {
+            const uint32_t in_pixel{ layout.channels_in * layout.sample_bytes };
+            const uint32_t out_pixel{ layout.channels_out * layout.sample_bytes };
+            const bool swap{ layout.sample_bytes == 2 && std::endian::native == std::endian::little };
+
+            for (uint32_t x{ 0 }; x < width; ++x, src += in_pixel, dst += out_pixel)
+            {
+                if (!swap)
+                {
+                    std::memcpy(dst, src, out_pixel);
+                    continue;
+                }
+
+                for (uint32_t b{ 0 }; b < out_pixel; b += 2)
+                {
+                    dst[b] = src[b + 1];
+                    dst[b + 1] = src[b];
+                }
+            }
+        }
+
+        void write_stripe_index(std::vector<uint8_t>& out, const std::span<const stripe_index_entry_t> stripes) noexcept
+        {
+            std::vector<uint8_t> data{ 1, 0, 0, 0 };
+            write_be_u32(data, static_cast<uint32_t>(stripes.size()));
+
+            for (const stripe_index_entry_t& s: stripes)
+            {
+                write_be_u32(data, s.first_row);
+                write_be_u32(data, static_cast<uint32_t>(s.zlib_offset >> 32));
+                write_be_u32(data, static_cast<uint32_t>(s.zlib_offset));
+                write_be_u32(data, s.adler);
+            }
+
+            write_chunk(out, k_stripe_index_chunk, data);
+        }
+
+        /// @brief Scanline bytes per stripe when the stripe height is picked automatically.
+        constexpr size_t k_auto_stripe_bytes{ 1u << 20 };
+
+        /// @brief What every stripe of one encode shares.
+        struct encode_job_t
+        {
+            const image_view_t&         image;
+            const encode_options_t&     options;
+            png_layout_t                layout{ };
+            size_t                      stride{ };
+            size_t                      row_bytes{ };   // packed PNG row, without the filter byte
+            uint32_t                    bpp{ };         // filter stride
+            uint8_t*                    scanlines{ };
+
+            // Re-encoding: unfiltered rows already in PNG sample order, `packed_stride` bytes apart
+            const uint8_t*              packed_rows{ };
+            size_t                      packed_stride{ };
+
+            // Per encode, so the decode speed profile can try several
+            encode_filter               filter{ };
+            float                       filter_slack{ };    // adaptive: see filter_rows
+            uint32_t                    block_tokens{ };
+        };
+
+        /// @brief Row `y` in PNG sample order: the input row itself, or packed into `buffer` when needed.
+        [[nodiscard]] const uint8_t* png_row(const encode_job_t& job, const uint32_t y, uint8_t* buffer) noexcept
+        {
+            if (job.packed_rows != nullptr) return job.packed_rows + y * job.packed_stride;
+
+            const uint8_t* row{ job.image.pixels.data() + y * job.stride };
+
+            if (job.layout.sample_bytes == 1 && job.layout.channels_in == job.layout.channels_out) return row;
+
+            pack_row(row, buffer, job.image.width, job.layout);
+            return buffer;
+        }
+
+        /**
+         * Filters rows [y0, y1) into their slots of the scanline buffer. Adaptive filtering takes
+         * the filter with the smallest cost; with a slack, the cheapest to reverse among those
+         * within `filter_slack` of it (None, Up, Sub, Average, Paeth, in that order).
+         */
+        void filter_rows(const encode_job_t& job, const uint32_t y0, const uint32_t y1) noexcept
+        {
+            const size_t row_bytes{ job.row_bytes };
+
+            std::vector<uint8_t> packed(2 * row_bytes);
+            const std::vector<uint8_t> zero_row(row_bytes, 0);
+
+            const bool adaptive{ job.filter == encode_filter::adaptive };
+            std::vector<uint8_t> trial(adaptive ? 5 * row_bytes : 0);
+
+            // Filters look one row up, across the stripe boundary too: only deflate restarts per stripe
+            const uint8_t* prior{
+                y0 == 0 ? zero_row.data() : png_row(job, y0 - 1, packed.data() + ((y0 - 1) & 1u) * row_bytes)
+            };
+
+            for (uint32_t y{ y0 }; y < y1; ++y)
+            {
+                const uint8_t* row{ png_row(job, y, packed.data() + (y & 1u) * row_bytes) };
+                uint8_t* out{ job.scanlines + y * (row_bytes + 1) };
+
+                if (adaptive)
+                {
+                    uint8_t best{ 0 };
+                    uint64_t costs[5]{ };
+
+                    for (uint8_t f{ 0 }; f < 5; ++f)
+                    {
+                        uint8_t* candidate{ trial.data() + f * row_bytes };
+                        filter_row(f, candidate, row, prior, row_bytes, job.bpp);
+
+                        costs[f] = filtered_row_cost(candidate, row_bytes);
+                        if (costs[f] < costs[best]) best = f;
+                    }
+
+                    if (job.filter_slack > 0.0f)
+                    {
+                        constexpr uint8_t decode_order[5]{ 0, 2, 1, 3, 4 };
+                        const auto limit{
+                            static_cast<uint64_t>(static_cast<double>(costs[best]) * (1.0 + job.filter_slack))
+                        };
+
+                        for (const uint8_t f: decode_order)
+                        {
+                            if (costs[f] <= limit)
+                            {
+                                best = f;
+                                break;
+                            }
+                        }
+                    }
+
+                    out[0] = best;
+                    std::memcpy(out + 1, trial.data() + best * row_bytes, row_bytes);
+                }
+                else
+                {
+                    out[0] = static_cast<uint8_t>(job.filter);
+                    filter_row(out[0], out + 1, row, prior, row_bytes, job.bpp);
+                }
+
+                prior = row;
+            }
+        }
+
+        /**
+         * Deflates the filtered rows [y0, y1) on their own, appending to `out`. Stripes other than
+         * the last end in a sync flush so the next one starts byte aligned. Returns their Adler-32.
+         */
+        uint32_t compress_stripe(const encode_job_t& job, const uint32_t y0, const uint32_t y1, const bool last,
+                                 std::vector<uint8_t>& out) noexcept
+        {
+            const std::span<const uint8_t> rows{
+                job.scanlines + y0 * (job.row_bytes + 1), static_cast<size_t>(y1 - y0) * (job.row_bytes + 1)
+            };
+
+            bit_writer_t writer{ out };
+
+            if (job.options.mode == compression_mode::stored)
+                write_stored_blocks(writer, rows, last);
+            else
+                deflate_fast(rows, writer, last, { .rle_distance = job.bpp, .block_tokens = job.block_tokens });
+
+            if (!last) write_sync_flush(writer);
+            writer.finish();
+
+            return adler32(rows);
+        }
+
+        /// @brief IDAT size limit the options ask for; the decode speed profile always writes one IDAT.
+        [[nodiscard]] uint32_t idat_limit(const encode_options_t& options) noexcept
+        {
+            return options.profile == encode_profile::decode_speed ? 0 : options.max_idat_bytes;
+        }
+
+        /**
+         * Filters and deflates every row into one zlib stream, striped as the options ask, using the
+         * filter and block size set on `job`. `out_stripes` receives the stripe index.
+         */
+        void encode_idat(const encode_job_t& job, std::vector<uint8_t>& out_zlib,
+                         std::vector<stripe_index_entry_t>& out_stripes) noexcept
+        {
+            const encode_options_t& options{ job.options };
+            const uint32_t height{ job.image.height };
+            const size_t scanline_size{ height * (job.row_bytes + 1) };
+
+            // Stripe layout; a single stripe is a plain stream
+            uint32_t stripe_rows{ height };
+            if (options.stripe_rows != 0)
+                stripe_rows = std::min(options.stripe_rows, height);
+            else if (options.worker_threads != 1)
+                stripe_rows = static_cast<uint32_t>(std::clamp<size_t>(k_auto_stripe_bytes / (job.row_bytes + 1), 1,
+                                                                      height));
+
+            const uint32_t stripe_count{ (height + stripe_rows - 1) / stripe_rows };
+
+            // zlib stream: stripe 0 is written straight after the header, later stripes into their own buffers
+            std::vector<uint8_t>& zlib{ out_zlib };
+            const bool stored{ options.mode == compression_mode::stored };
+
+            zlib.clear();
+            zlib.reserve(stored ? scanline_size + scanline_size / 65535 * 5 + 16 : scanline_size / 2 + 1024);
+            write_zlib_header(zlib, stored ? 0u : 1u);
+
+            std::vector<std::vector<uint8_t>> stripe_bytes(stripe_count);
+            std::vector<uint32_t> stripe_adler(stripe_count);
+
+            parallel_for(stripe_count, resolve_thread_count(options.worker_threads), [&](const uint32_t i) noexcept {
+                const uint32_t y0{ i * stripe_rows };
+                const uint32_t y1{ std::min(y0 + stripe_rows, height) };
+
+                filter_rows(job, y0, y1);
+                stripe_adler[i] = compress_stripe(job, y0, y1, i + 1 == stripe_count,
+                                                  i == 0 ? zlib : stripe_bytes[i]);
+            });
+
+            std::vector<stripe_index_entry_t>& stripes{ out_stripes };
+            stripes.assign(stripe_count, { });
+            uint32_t adler{ stripe_adler[0] };
+
+            for (uint32_t i{ 1 }; i < stripe_count; ++i)
+            {
+                const uint32_t y0{ i * stripe_rows };
+                const uint32_t y1{ std::min(y0 + stripe_rows, height) };
+
+                stripes[i] = { .first_row = y0, .zlib_offset = zlib.size(), .adler = stripe_adler[i] };
+                adler = adler32_combine(adler, stripe_adler[i], static_cast<uint64_t>(y1 - y0) * (job.row_bytes + 1));
+
+                zlib.insert(zlib.end(), stripe_bytes[i].begin(), stripe_bytes[i].end());
+                stripe_bytes[i] = { };
+            }
+
+            stripes[0] = { .first_row = 0, .zlib_offset = 2, .adler = stripe_adler[0] };
+            write_be_u32(zlib, adler);
+        }
+
+        /// @brief Tokens per deflate block for the decode speed profile: a table build per ~1 MiB of scanlines.
+        constexpr uint32_t k_decode_speed_block_tokens{ 1u << 18 };
+
+        /**
+         * Encodes the image with the options as given or, for the decode speed profile, picks the
+         * candidate encoding with the lowest predicted decode time whose size stays within the
+         * budget of the smallest candidate.
+         */
+        void compress_image(encode_job_t& job, std::vector<uint8_t>& out_zlib,
+                            std::vector<stripe_index_entry_t>& out_stripes) noexcept
+        {
+            const encode_options_t& options{ job.options };
+
+            if (options.profile != encode_profile::decode_speed)
+            {
+                job.filter = options.filter;
+                job.block_tokens = options.block_tokens;
+                encode_idat(job, out_zlib, out_stripes);
+                return;
+            }
+
+            struct candidate_t
+            {
+                encode_filter   filter{ };
+                float           slack{ };
+                uint32_t        block_tokens{ };
+            };
+
+            const float budget{ std::max(options.size_budget, 0.0f) };
+            const candidate_t candidates[]{
+                { encode_filter::adaptive, 0.0f, options.block_tokens },     // smallest, usually
+                { encode_filter::adaptive, 0.0f, k_decode_speed_block_tokens },
+                { encode_filter::adaptive, budget, k_decode_speed_block_tokens },
+                { encode_filter::adaptive, 4.0f * budget, k_decode_speed_block_tokens },
+                { encode_filter::up, 0.0f, k_decode_speed_block_tokens },
+                { encode_filter::sub, 0.0f, k_decode_speed_block_tokens },
+                { encode_filter::none, 0.0f, k_decode_speed_block_tokens },
+            };
+
+            struct result_t
+            {
+                std::vector<uint8_t>                zlib;
+                std::vector<stripe_index_entry_t>   stripes;
+                uint64_t                            decode_ns{ };
+            };
+
+            std::vector<result_t> results(std::size(candidates));
+            size_t smallest{ std::numeric_limits<size_t>::max() };
+
+            for (size_t i{ 0 }; i < results.size(); ++i)
+            {
+                job.filter = candidates[i].filter;
+                job.filter_slack = candidates[i].slack;
+                job.block_tokens = candidates[i].block_tokens;
+
+                result_t& r{ results[i] };
+                encode_idat(job, r.zlib, r.stripes);
+                smallest = std::min(smallest, r.zlib.size());
+
+                // Priced from the filter bytes just written and a walk over the blocks
+                decode_cost_t cost{ .idat_chunks = 1 };
+                for (uint32_t y{ 0 }; y < job.image.height; ++y)
+                    cost.filter_bytes[job.scanlines[y * (job.row_bytes + 1)]] += job.row_bytes;
+
+                r.decode_ns = scan_deflate_blocks(r.zlib, cost) == decode_error::ok
+                                  ? predict_decode_ns(cost) : std::numeric_limits<uint64_t>::max();
+            }
+
+            const auto size_limit{ static_cast<size_t>(static_cast<double>(smallest) * (1.0 + budget)) };
+            size_t pick{ 0 };
+
+            for (size_t i{ 1 }; i < results.size(); ++i)
+            {
+                const result_t& r{ results[i] };
+                if (r.zlib.size() > size_limit) continue;
+
+                if (results[pick].zlib.size() > size_limit || r.decode_ns < results[pick].decode_ns ||
+                    (r.decode_ns == results[pick].decode_ns && r.zlib.size() < results[pick].zlib.size()))
+                    pick = i;
+            }
+
+            out_zlib = std::move(results[pick].zlib);
+            out_stripes = std::move(results[pick].stripes);
+        }
+
+        /**
+         * De-filters the Adam7 passes in `raw` and scatters their pixels, still in the file's own
+         * sample encoding, into progressive rows that each keep a leading filter byte slot.
+         */
+        [[nodiscard]] decode_error deinterlace_rows(const ihdr_info_t& ihdr, const std::span<uint8_t> raw,
+                                                    std::vector<uint8_t>& out_rows) noexcept
+        {
+            const size_t row_bytes{ scanline_bytes(ihdr.width, ihdr.bit_depth, ihdr.color_type) };
+            const uint32_t bpp{ filter_bpp(ihdr.bit_depth, ihdr.color_type) };
+            const uint32_t pixel_bits{ channel_count(ihdr.color_type) * ihdr.bit_depth };
+            const uint32_t mask{ (1u << std::min(pixel_bits, 8u)) - 1u };
+
+            out_rows.assign(ihdr.height * (row_bytes + 1), 0);
+            size_t offset{ 0 };
+
+            for (const adam7_pass_t& pass: k_adam7_passes)
+            {
+                const uint32_t pw{ adam7_pass_width(pass, ihdr.width) };
+                const uint32_t ph{ adam7_pass_height(pass, ihdr.height) };
+
+                if (pw == 0 || ph == 0) continue;
+
+                const size_t pass_row_bytes{ scanline_bytes(pw, ihdr.bit_depth, ihdr.color_type) };
+                const size_t pass_size{ static_cast<size_t>(ph) * (1 + pass_row_bytes) };
+
+                const auto scatter_row{ [&](const uint32_t y, const uint8_t* pixels) noexcept {
+                    uint8_t* dst{ out_rows.data() + (pass.y0 + y * pass.dy) * (row_bytes + 1) + 1 };
+
+                    if (pixel_bits >= 8)
+                    {
+                        const size_t n{ pixel_bits / 8u };
+                        for (uint32_t x{ 0 }; x < pw; ++x)
+                            std::memcpy(dst + (pass.x0 + x * pass.dx) * n, pixels + x * n, n);
+                        return;
+                    }
+
+                    // Sub-byte gray: samples packed from the most significant bit
+                    for (uint32_t x{ 0 }; x < pw; ++x)
+                    {
+                        const size_t src_bit{ static_cast<size_t>(x) * pixel_bits };
+                        const size_t dst_bit{ static_cast<size_t>(pass.x0 + x * pass.dx) * pixel_bits };
+                        const uint32_t v{ (pixels[src_bit / 8] >> (8 - pixel_bits - src_bit % 8)) & mask };
+                        dst[dst_bit / 8] |= static_cast<uint8_t>(v << (8 - pixel_bits - dst_bit % 8));
+                    }
+                } };
+
+                const decode_error err{
+                    defilter_scanlines(raw.subspan(offset, pass_size), pass_row_bytes, ph, bpp, scatter_row)
+                };
+                if (err != decode_error::ok) return err;
+
+                offset += pass_size;
+            }
+
+            return decode_error::ok;
+        }
+    } // anonymous namespace
+
+    decode_error encode(const image_view_t& image, std::vector<uint8_t>& out_png,
+                        const encode_options_t& options) noexcept
+    {
+        out_png.clear();
+
+        encode_job_t job{ .image = image, .options = options };
+        if (!layout_for(image.format, options.drop_alpha, job.layout)) return decode_error::invalid_image_view;
+
+        constexpr uint32_t max_dimension{ 0x7FFFFFFFu };
+        if (image.width == 0 || image.height == 0 || image.width > max_dimension || image.height > max_dimension)
+            return decode_error::invalid_image_view;
+
+        const size_t in_row_bytes{ static_cast<size_t>(image.width) * bytes_per_pixel(image.format) };
+        job.stride = image.stride_bytes != 0 ? image.stride_bytes : in_row_bytes;
+
+        if (job.stride < in_row_bytes || image.pixels.size() < (image.height - 1) * job.stride + in_row_bytes)
+            return decode_error::invalid_image_view;
+
+        job.bpp = job.layout.channels_out * job.layout.sample_bytes;
+        job.row_bytes = static_cast<size_t>(image.width) * job.bpp;
+
+        if (job.row_bytes + 1 > std::numeric_limits<size_t>::max() / image.height)
+            return decode_error::invalid_image_view;
+
+        // Filtered scanlines: filter byte + row, for every row
+        std::vector<uint8_t> scanlines(image.height * (job.row_bytes + 1));
+        job.scanlines = scanlines.data();
+
+        std::vector<uint8_t> zlib;
+        std::vector<stripe_index_entry_t> stripes;
+        compress_image(job, zlib, stripes);
+
+        // File
+        const uint32_t max_idat_bytes{ idat_limit(options) };
+        const size_t idat_max{ max_idat_bytes != 0 ? max_idat_bytes : zlib.size() };
+        out_png.reserve(zlib.size() + (zlib.size() / idat_max + 1) * 12 + 64 + stripes.size() * 16);
+
+        write_png_header(out_png, image.width, image.height, job.layout.bit_depth, job.layout.color_type);
+
+        if (image.is_srgb)
+        {
+            constexpr uint8_t perceptual[1]{ 0 };
+            write_chunk(out_png, chunk_type("sRGB"), perceptual);
+        }
+
+        if (stripes.size() > 1) write_stripe_index(out_png, stripes);
+
+        write_idat_chunks(out_png, zlib, max_idat_bytes);
+        write_chunk(out_png, chunk_type("IEND"), { });
+
+        return decode_error::ok;
+    }
+
+    decode_error reencode(const std::span<const uint8_t> png, std::vector<uint8_t>& out_png,
+                          const encode_options_t& options) noexcept
+    {
+        out_png.clear();
+
+        ihdr_info_t ihdr{ };
+        std::vector<std::span<const uint8_t>> idat_spans;
+
+        decode_error err{ parse_png_chunks(png, ihdr, idat_spans) };
+        if (err != decode_error::ok) return err;
+
+        err = validate_png_format(ihdr.bit_depth, ihdr.color_type);
+        if (err != decode_error::ok) return err;
+
+        const bool interlaced{ ihdr.interlace_method != 0 };
+
+        std::vector<uint8_t> zlib_in;
+        err = concat_idat(idat_spans, zlib_in);
+        if (err != decode_error::ok) return err;
+
+        // Unfiltered in place, each row still behind its filter byte
+        const size_t row_bytes{ scanline_bytes(ihdr.width, ihdr.bit_depth, ihdr.color_type) };
+        const uint32_t bpp{ filter_bpp(ihdr.bit_depth, ihdr.color_type) };
+
+        std::vector<uint8_t> rows;
+        err = inflate_idat(zlib_in, rows, interlaced ? adam7_raw_size(ihdr, 7) : ihdr.height * (row_bytes + 1));
+        if (err != decode_error::ok) return err;
+
+        zlib_in = { };
+
+        if (interlaced)
+        {
+            // The passes are put back together; the new file is written progressive
+            std::vector<uint8_t> passes{ std::move(rows) };
+            err = deinterlace_rows(ihdr, passes, rows);
+        }
+        else
+        {
+            err = defilter_scanlines(rows, row_bytes, ihdr.height, bpp, [](uint32_t, const uint8_t*) noexcept { });
+        }
+        if (err != decode_error::ok) return err;
+
+        const image_view_t image{ .width = ihdr.width, .height = ihdr.height };
+        encode_job_t job{ .image = image, .options = options };
+        job.layout = { .color_type = ihdr.color_type, .bit_depth = ihdr.bit_depth };
+        job.row_bytes = row_bytes;
+        job.bpp = bpp;
+        job.packed_rows = rows.data() + 1;
+        job.packed_stride = row_bytes + 1;
+
+        std::vector<uint8_t> scanlines(rows.size());
+        job.scanlines = scanlines.data();
+
+        std::vector<uint8_t> zlib;
+        std::vector<stripe_index_entry_t> stripes;
+        compress_image(job, zlib, stripes);
+
+        // Every other chunk is copied as it was; the new IDAT chunks take the place of the old ones.
+        // A stale stripe index is dropped.
+        out_png.reserve(png.size() + zlib.size());
+        out_png.insert(out_png.end(), png.begin(), png.begin() + k_png_signature.size());
+
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        bool idat_written{ false };
+
+        while (reader.next(chunk))
+        {
+            if (chunk.type == chunk_type("IDAT"))
+            {
+                if (!idat_written)
+                {
+                    if (stripes.size() > 1) write_stripe_index(out_png, stripes);
+                    write_idat_chunks(out_png, zlib, idat_limit(options));
+                    idat_written = true;
+                }
+
+                continue;
+            }
+
+            if (chunk.type == k_stripe_index_chunk) continue;
+
+            if (interlaced && chunk.type == chunk_type("IHDR"))
+            {
+                std::array<uint8_t, 13> header{ };
+                std::ranges::copy(chunk.data.first(header.size()), header.begin());
+                header[12] = 0;     // interlace method
+                write_chunk(out_png, chunk_type("IHDR"), header);
+                continue;
+            }
+
+            const auto begin{ png.begin() + static_cast<std::ptrdiff_t>(chunk.offset) };
+            out_png.insert(out_png.end(), begin, begin + static_cast<std::ptrdiff_t>(12 + chunk.data.size()));
+        }
+
+        return reader.error();
+    }
+
+    decode_error encode_to_file(const char* path, const image_view_t& image, const encode_options_t& options) noexcept
+    {
+        std::vector<uint8_t> png;
+        const decode_error err{ encode(image, png, options) };
+        if (err != decode_error::ok) return err;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return decode_error::file_write_failed;
+
+        file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+
+        return file.good() ? decode_error::ok : decode_error::file_write_failed;
+    }
+} // namespace cpng
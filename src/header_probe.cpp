@@ -0,0 +1,137 @@
+//
+// Created by Zack Shrout on 3/25/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/header_probe.h"
+
+#include "internal/chunk_parser.h"
+#include "internal/file_io.h"
+#include "internal/parallel.h"
+
+namespace cpng {
+    namespace {
+        // Signature (8) + length(4) + type(4) + IHDR(13) + CRC(4)
+        constexpr size_t k_ihdr_end{ 8 + 4 + 4 + 13 + 4 };
+
+        // One read covers the header chunks of a typical file; later chunk headers are fetched as needed
+        constexpr size_t k_scan_window{ 4096 };
+
+        /// @brief Sliding read window over a file, refilled only when a request falls outside it.
+        struct read_window_t
+        {
+            const file_reader_t&    file;
+            uint8_t                 bytes[k_scan_window]{ };
+            uint64_t                offset{ 0 };
+            size_t                  length{ 0 };
+
+            [[nodiscard]] const uint8_t* fetch(const uint64_t at, const size_t count) noexcept
+            {
+                if (at >= offset && at - offset + count <= length)
+                    return bytes + (at - offset);
+
+                offset = at;
+                length = file.read_at(at, bytes);
+                return length >= count ? bytes : nullptr;
+            }
+        };
+
+        /// @brief Walks the chunk headers after IHDR, skipping chunk data.
+        [[nodiscard]] decode_error scan_chunks(read_window_t& window, header_probe_t& probe) noexcept
+        {
+            const uint64_t file_size{ window.file.size() };
+            uint64_t pos{ k_ihdr_end };
+
+            while (true)
+            {
+                const uint8_t* header{ window.fetch(pos, 8) };
+                if (!header) return pos >= file_size ? decode_error::no_iend : decode_error::file_too_short;
+
+                const uint32_t length{ peek_be_u32(header) };
+                const uint32_t type{ peek_be_u32(header + 4) };
+
+                if (length > 0x7FFFFFFFu) return decode_error::invalid_chunk_length;
+                if (file_size - pos < 12u + uint64_t{ length }) return decode_error::invalid_chunk_length;
+
+                const bool before_idat{ probe.idat_chunks == 0 };
+                ihdr_info_t& ihdr{ probe.ihdr };
+
+                switch (type)
+                {
+                    case 0x49484452u: // "IHDR"
+                        return decode_error::duplicate_ihdr;
+
+                    case 0x49444154u: // "IDAT"
+                        ++probe.idat_chunks;
+                        probe.idat_bytes += length;
+                        break;
+
+                    case 0x504C5445u: // "PLTE"
+                        probe.has_palette = true;
+                        break;
+
+                    case 0x73524742u: // "sRGB"
+                        if (before_idat && length == 1) ihdr.has_srgb = true;
+                        break;
+
+                    case 0x67414D41u: // "gAMA"
+                        if (before_idat && length == 4)
+                        {
+                            const uint8_t* payload{ window.fetch(pos + 8, 4) };
+                            if (!payload) return decode_error::file_too_short;
+
+                            ihdr.has_gamma = true;
+                            ihdr.gamma = static_cast<float>(peek_be_u32(payload)) / 100000.0f;
+                        }
+                        break;
+
+                    case 0x69434350u: // "iCCP"
+                        if (before_idat && length >= 4) ihdr.has_icc_profile = true;
+                        break;
+
+                    case 0x49454E44u: // "IEND"
+                        return probe.idat_chunks != 0 ? decode_error::ok : decode_error::no_idat_chunks;
+
+                    default:
+                        break;
+                }
+
+                pos += 12u + uint64_t{ length };
+            }
+        }
+
+        void probe_file(const char* path, const bool scan, header_probe_t& probe) noexcept
+        {
+            probe = { };
+
+            file_reader_t file{ };
+            if (!file.open(path))
+            {
+                probe.error = decode_error::file_not_found;
+                return;
+            }
+
+            probe.file_size = file.size();
+
+            read_window_t window{ file };
+            window.length = file.read_at(0, { window.bytes, scan ? k_scan_window : k_ihdr_end });
+
+            probe.error = read_ihdr_from_memory({ window.bytes, window.length }, probe.ihdr);
+            if (probe.error != decode_error::ok || !scan) return;
+
+            probe.error = scan_chunks(window, probe);
+        }
+    } // anonymous namespace
+
+    decode_error probe_headers(const std::span<const char* const> paths, const std::span<header_probe_t> out_probes,
+                               const probe_options_t& options) noexcept
+    {
+        if (out_probes.size() < paths.size()) return decode_error::output_buffer_too_small;
+
+        // Mostly waiting on I/O, so the pool overlaps reads more than it spreads CPU work
+        parallel_for(static_cast<uint32_t>(paths.size()), resolve_thread_count(options.worker_threads),
+                     [&](const uint32_t i) noexcept { probe_file(paths[i], options.scan_chunks, out_probes[i]); });
+
+        return decode_error::ok;
+    }
+} // namespace cpng
@@ -0,0 +1,284 @@
+//
+// Created by Zack Shrout on 3/22/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/image_cache.h"
+
+#include "internal/xxhash64.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cpng {
+    struct image_handle_t::entry_t
+    {
+        enum class state_t : uint8_t
+        {
+            header_only,    // not decoded, or evicted
+            decoding,       // a thread is decoding; others wait on the cache's condition variable
+            resident,       // held by the cache, in the LRU list
+            failed,         // decode error remembered in `error`
+        };
+
+        uint64_t                                                key{ };
+        ihdr_info_t                                             ihdr{ };
+        std::string                                             path{ };    // file source, or...
+        std::vector<uint8_t>                                    data{ };    // ...a copy of the memory source
+        state_t                                                 state{ state_t::header_only };
+        decode_error                                            error{ decode_error::ok };
+        decode_diagnostics_t                                    diagnostics{ };     // of the failed decode
+        std::shared_ptr<const decoded_image_t>                  image{ };   // set while resident
+        std::weak_ptr<const decoded_image_t>                    recent{ };  // survives eviction while referenced
+        std::list<std::shared_ptr<entry_t>>::iterator           lru_pos{ };
+        size_t                                                  bytes{ };
+    };
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // image_handle_t
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    uint64_t image_handle_t::key() const noexcept
+    {
+        return _entry ? _entry->key : 0;
+    }
+
+    const ihdr_info_t& image_handle_t::header() const noexcept
+    {
+        static constexpr ihdr_info_t k_empty{ };
+        return _entry ? _entry->ihdr : k_empty;
+    }
+
+    decode_error image_handle_t::pixels(std::shared_ptr<const decoded_image_t>& out_image) const noexcept
+    {
+        if (!_entry || !_cache) return decode_error::missing_ihdr;
+
+        return _cache->acquire(_entry, out_image);
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // image_cache_t
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    image_cache_t::image_cache_t(const size_t budget_bytes, const decode_options_t& options) noexcept
+        : _options{ options }, _budget{ budget_bytes }
+    {
+    }
+
+    decode_error image_cache_t::open_file(const char* path, image_handle_t& out_handle) noexcept
+    {
+        const uint64_t key{ xxh64({ reinterpret_cast<const uint8_t*>(path), std::strlen(path) }) };
+
+        {
+            std::lock_guard lock{ _mutex };
+            if (auto entry{ find(key) })
+            {
+                out_handle = { this, std::move(entry) };
+                return decode_error::ok;
+            }
+        }
+
+        ihdr_info_t ihdr{ };
+        const decode_error err{ read_ihdr_from_file(path, ihdr) };
+        if (err != decode_error::ok) return err;
+
+        return open(key, ihdr, path, { }, out_handle);
+    }
+
+    decode_error image_cache_t::open_memory(const std::span<const uint8_t> data, image_handle_t& out_handle) noexcept
+    {
+        uint64_t key{ };
+        const decode_error err{ compressed_hash_from_memory(data, key) };
+        if (err != decode_error::ok) return err;
+
+        return open_memory(data, key, out_handle);
+    }
+
+    decode_error image_cache_t::open_memory(const std::span<const uint8_t> data, const uint64_t key,
+                                            image_handle_t& out_handle) noexcept
+    {
+        {
+            std::lock_guard lock{ _mutex };
+            if (auto entry{ find(key) })
+            {
+                out_handle = { this, std::move(entry) };
+                return decode_error::ok;
+            }
+        }
+
+        ihdr_info_t ihdr{ };
+        const decode_error err{ read_ihdr_from_memory(data, ihdr) };
+        if (err != decode_error::ok) return err;
+
+        return open(key, ihdr, { }, data, out_handle);
+    }
+
+    decode_error image_cache_t::open(const uint64_t key, const ihdr_info_t& ihdr, std::string path,
+                                     const std::span<const uint8_t> data, image_handle_t& out_handle) noexcept
+    {
+        auto entry{ std::make_shared<entry_t>() };
+        entry->key = key;
+        entry->ihdr = ihdr;
+        entry->path = std::move(path);
+        entry->data.assign(data.begin(), data.end());
+
+        std::lock_guard lock{ _mutex };
+
+        // Another thread may have opened the same key while the header was being read
+        std::weak_ptr<entry_t>& slot{ _entries[key] };
+        if (auto existing{ slot.lock() })
+        {
+            out_handle = { this, std::move(existing) };
+            return decode_error::ok;
+        }
+
+        slot = entry;
+        out_handle = { this, std::move(entry) };
+
+        // Entries die with their last handle once they are not resident; drop their slots now and then
+        if (_entries.size() >= _sweep_at)
+        {
+            std::erase_if(_entries, [](const auto& item) { return item.second.expired(); });
+            _sweep_at = std::max<size_t>(64, _entries.size() * 2);
+        }
+
+        return decode_error::ok;
+    }
+
+    std::shared_ptr<image_cache_t::entry_t> image_cache_t::find(const uint64_t key) const noexcept
+    {
+        const auto it{ _entries.find(key) };
+        return it != _entries.end() ? it->second.lock() : nullptr;
+    }
+
+    decode_error image_cache_t::acquire(const std::shared_ptr<entry_t>& entry,
+                                        std::shared_ptr<const decoded_image_t>& out_image) noexcept
+    {
+        using state_t = entry_t::state_t;
+
+        std::unique_lock lock{ _mutex };
+
+        bool waited{ false };
+
+        while (true)
+        {
+            if (entry->state == state_t::failed)
+            {
+                if (_options.diagnostics) *_options.diagnostics = entry->diagnostics;
+                return entry->error;
+            }
+
+            if (entry->state == state_t::decoding)
+            {
+                if (!waited) ++_stats.coalesced;
+                waited = true;
+
+                _decoded.wait(lock, [&] { return entry->state != state_t::decoding; });
+                continue;
+            }
+
+            if (entry->state == state_t::resident)
+            {
+                _lru.splice(_lru.begin(), _lru, entry->lru_pos);
+                if (!waited) ++_stats.hits;
+
+                out_image = entry->image;
+                return decode_error::ok;
+            }
+
+            // Evicted, but a caller still holds it: share instead of decoding a second copy
+            if (auto alive{ entry->recent.lock() })
+            {
+                if (!waited) ++_stats.hits;
+
+                out_image = std::move(alive);
+                return decode_error::ok;
+            }
+
+            break;
+        }
+
+        entry->state = state_t::decoding;
+        ++_stats.misses;
+        lock.unlock();
+
+        // Decodes of different entries run at the same time: each fills the record of its entry
+        decode_options_t options{ _options };
+        if (options.diagnostics) options.diagnostics = &entry->diagnostics;
+
+        auto image{ std::make_shared<decoded_image_t>() };
+        const decode_error err{
+            entry->path.empty()
+                ? load_from_memory(entry->data, image->view, image->storage, options)
+                : load_from_file(entry->path.c_str(), image->view, image->storage, options)
+        };
+
+        lock.lock();
+
+        if (err != decode_error::ok)
+        {
+            entry->state = state_t::failed;
+            entry->error = err;
+            if (_options.diagnostics) *_options.diagnostics = entry->diagnostics;
+        }
+        else
+        {
+            entry->state = state_t::resident;
+            entry->image = image;
+            entry->recent = image;
+            entry->bytes = image->storage.size();
+
+            _lru.push_front(entry);
+            entry->lru_pos = _lru.begin();
+            _stats.resident_bytes += entry->bytes;
+
+            trim();
+            out_image = std::move(image);
+        }
+
+        _decoded.notify_all();
+        return err;
+    }
+
+    void image_cache_t::trim() noexcept
+    {
+        while (_stats.resident_bytes > _budget && !_lru.empty())
+        {
+            const std::shared_ptr<entry_t> victim{ _lru.back() };
+            _lru.pop_back();
+
+            victim->image.reset();
+            victim->state = entry_t::state_t::header_only;
+            _stats.resident_bytes -= victim->bytes;
+            ++_stats.evictions;
+        }
+    }
+
+    void image_cache_t::set_budget(const size_t budget_bytes) noexcept
+    {
+        std::lock_guard lock{ _mutex };
+        _budget = budget_bytes;
+        trim();
+    }
+
+    void image_cache_t::clear() noexcept
+    {
+        std::lock_guard lock{ _mutex };
+
+        const size_t budget{ _budget };
+        _budget = 0;
+        trim();
+        _budget = budget;
+    }
+
+    image_cache_stats_t image_cache_t::stats() const noexcept
+    {
+        std::lock_guard lock{ _mutex };
+
+        image_cache_stats_t stats{ _stats };
+        stats.entries = static_cast<size_t>(std::ranges::count_if(_entries, [](const auto& item) {
+            return !item.second.expired();
+        }));
+        return stats;
+    }
+} // namespace cpng
@@ -0,0 +1,130 @@
+//
+// Created by Zack Shrout on 3/12/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "png_format.h"
+
+#include <array>
+#include <cstring>
+
+namespace cpng {
+    struct adam7_pass_t
+    {
+        uint32_t x0;        // first column
+        uint32_t y0;        // first row
+        uint32_t dx;        // column step
+        uint32_t dy;        // row step
+        uint32_t block_w;   // area this pass's pixel stands for in a progressive preview
+        uint32_t block_h;
+    };
+
+    inline constexpr std::array<adam7_pass_t, 7> k_adam7_passes{ {
+        { 0, 0, 8, 8, 8, 8 },
+        { 4, 0, 8, 8, 4, 8 },
+        { 0, 4, 4, 8, 4, 4 },
+        { 2, 0, 4, 4, 2, 4 },
+        { 0, 2, 2, 4, 2, 2 },
+        { 1, 0, 2, 2, 1, 2 },
+        { 0, 1, 1, 2, 1, 1 },
+    } };
+
+    /// @brief Pass sub-image width in pixels (0 when the pass is empty for this image).
+    [[nodiscard]] constexpr uint32_t adam7_pass_width(const adam7_pass_t& pass, const uint32_t width) noexcept
+    {
+        return width > pass.x0 ? (width - pass.x0 + pass.dx - 1) / pass.dx : 0;
+    }
+
+    [[nodiscard]] constexpr uint32_t adam7_pass_height(const adam7_pass_t& pass, const uint32_t height) noexcept
+    {
+        return height > pass.y0 ? (height - pass.y0 + pass.dy - 1) / pass.dy : 0;
+    }
+
+    /// @brief Size of the filtered byte stream (filter bytes included) for the first `pass_count` passes.
+    [[nodiscard]] constexpr size_t adam7_raw_size(const ihdr_info_t& ihdr, const uint32_t pass_count) noexcept
+    {
+        size_t total{ 0 };
+
+        for (uint32_t p{ 0 }; p < pass_count; ++p)
+        {
+            const uint32_t pw{ adam7_pass_width(k_adam7_passes[p], ihdr.width) };
+            const uint32_t ph{ adam7_pass_height(k_adam7_passes[p], ihdr.height) };
+
+            if (pw == 0 || ph == 0) continue; // empty passes contribute no bytes, not even filter bytes
+
+            total += static_cast<size_t>(ph) * (1 + scanline_bytes(pw, ihdr.bit_depth, ihdr.color_type));
+        }
+
+        return total;
+    }
+
+    /**
+     * Writes one emitted pass row (`count` contiguous output pixels) to every `dx`-th pixel of
+     * `dst_row`, starting at column `x0`.
+     */
+    template <size_t PixelBytes>
+    inline void adam7_scatter_row(const uint8_t* src, uint8_t* dst_row, const uint32_t x0, const uint32_t dx,
+                                  const uint32_t count) noexcept
+    {
+        uint8_t* dst{ dst_row + static_cast<size_t>(x0) * PixelBytes };
+        const size_t step{ static_cast<size_t>(dx) * PixelBytes };
+
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            std::memcpy(dst, src, PixelBytes);
+            src += PixelBytes;
+            dst += step;
+        }
+    }
+
+    /**
+     * Progressive-preview variant: each pixel is replicated across its pass block width
+     * (clipped to the image). Rows below are filled by the caller with whole-row copies.
+     */
+    template <size_t PixelBytes>
+    inline void adam7_fill_row(const uint8_t* src, uint8_t* dst_row, const adam7_pass_t& pass,
+                               const uint32_t count, const uint32_t width) noexcept
+    {
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            const uint32_t x{ pass.x0 + i * pass.dx };
+            const uint32_t end{ std::min(x + pass.block_w, width) };
+
+            for (uint32_t bx{ x }; bx < end; ++bx)
+                std::memcpy(dst_row + static_cast<size_t>(bx) * PixelBytes, src, PixelBytes);
+
+            src += PixelBytes;
+        }
+    }
+
+    using adam7_scatter_fn = void (*)(const uint8_t*, uint8_t*, uint32_t, uint32_t, uint32_t) noexcept;
+    using adam7_fill_fn = void (*)(const uint8_t*, uint8_t*, const adam7_pass_t&, uint32_t, uint32_t) noexcept;
+
+    [[nodiscard]] constexpr adam7_scatter_fn select_adam7_scatter(const size_t pixel_bytes) noexcept
+    {
+        switch (pixel_bytes)
+        {
+            case 1: return adam7_scatter_row<1>;
+            case 2: return adam7_scatter_row<2>;
+            case 4: return adam7_scatter_row<4>;
+            case 8: return adam7_scatter_row<8>;
+            case 16: return adam7_scatter_row<16>;
+            default: return nullptr;
+        }
+    }
+
+    [[nodiscard]] constexpr adam7_fill_fn select_adam7_fill(const size_t pixel_bytes) noexcept
+    {
+        switch (pixel_bytes)
+        {
+            case 1: return adam7_fill_row<1>;
+            case 2: return adam7_fill_row<2>;
+            case 4: return adam7_fill_row<4>;
+            case 8: return adam7_fill_row<8>;
+            case 16: return adam7_fill_row<16>;
+            default: return nullptr;
+        }
+    }
+} // namespace cpng
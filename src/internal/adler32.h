@@ -0,0 +1,68 @@
+//
+// Created by Zack Shrout on 3/28/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace cpng {
+    inline constexpr uint32_t k_adler_mod{ 65521 };
+
+    /**
+     * Running Adler-32 (RFC 1950): start from 1 and feed the data in any number of pieces.
+     * The modulo is deferred over 5552-byte runs, the longest run that cannot overflow 32 bits.
+     */
+    [[nodiscard]] constexpr uint32_t adler32_update(const uint32_t adler, std::span<const uint8_t> data) noexcept
+    {
+        uint32_t s1{ adler & 0xFFFFu };
+        uint32_t s2{ adler >> 16 };
+
+        while (!data.empty())
+        {
+            const size_t run{ data.size() < 5552 ? data.size() : 5552 };
+
+            for (size_t i{ 0 }; i < run; ++i)
+            {
+                s1 += data[i];
+                s2 += s1;
+            }
+
+            s1 %= k_adler_mod;
+            s2 %= k_adler_mod;
+            data = data.subspan(run);
+        }
+
+        return s2 << 16 | s1;
+    }
+
+    [[nodiscard]] constexpr uint32_t adler32(const std::span<const uint8_t> data) noexcept
+    {
+        return adler32_update(1u, data);
+    }
+
+    /**
+     * Adler-32 of the concatenation A + B from adler32(A), adler32(B) and the length of B,
+     * as zlib's adler32_combine. Lets independently checksummed pieces form one stream.
+     */
+    [[nodiscard]] constexpr uint32_t adler32_combine(const uint32_t adler_a, const uint32_t adler_b,
+                                                     const uint64_t length_b) noexcept
+    {
+        const auto rem{ static_cast<uint32_t>(length_b % k_adler_mod) };
+
+        uint32_t s1{ adler_a & 0xFFFFu };
+        uint32_t s2{ rem * s1 % k_adler_mod };
+
+        s1 += (adler_b & 0xFFFFu) + k_adler_mod - 1;
+        s2 += (adler_a >> 16) + (adler_b >> 16) + k_adler_mod - rem;
+
+        if (s1 >= k_adler_mod) s1 -= k_adler_mod;
+        if (s1 >= k_adler_mod) s1 -= k_adler_mod;
+        if (s2 >= 2 * k_adler_mod) s2 -= 2 * k_adler_mod;
+        if (s2 >= k_adler_mod) s2 -= k_adler_mod;
+
+        return s2 << 16 | s1;
+    }
+} // namespace cpng
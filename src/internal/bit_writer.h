@@ -0,0 +1,95 @@
+//
+// Created by Zack Shrout on 3/28/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace cpng {
+    /**
+     * LSB-first bit packer for DEFLATE output, appending to a byte vector.
+     *
+     * The vector is grown ahead of the write position (@ref reserve) so the hot put_bits path
+     * is a plain store; @ref finish trims it back to the bytes actually written.
+     */
+    struct bit_writer_t
+    {
+        std::vector<uint8_t>* out{ nullptr };
+        size_t pos{ 0 };                // bytes written; `out` may be longer until finish()
+        uint64_t bit_buffer{ 0 };
+        uint32_t bits_in_buffer{ 0 };
+
+        explicit bit_writer_t(std::vector<uint8_t>& target) noexcept
+            : out{ &target }, pos{ target.size() }
+        {
+        }
+
+        /// @brief Makes room for `bytes` more output bytes; put_bits may only write into reserved room.
+        void reserve(const size_t bytes) noexcept
+        {
+            if (out->size() < pos + bytes + 8) out->resize(std::max(pos + bytes + 8, out->size() * 2));
+        }
+
+        /// @brief Appends the low `count` bits of `bits` (count <= 32).
+        void put_bits(const uint32_t bits, const uint32_t count) noexcept
+        {
+            bit_buffer |= static_cast<uint64_t>(bits) << bits_in_buffer;
+            bits_in_buffer += count;
+
+            if (bits_in_buffer >= 32)
+            {
+                uint8_t* const p{ out->data() + pos };
+                p[0] = static_cast<uint8_t>(bit_buffer);
+                p[1] = static_cast<uint8_t>(bit_buffer >> 8);
+                p[2] = static_cast<uint8_t>(bit_buffer >> 16);
+                p[3] = static_cast<uint8_t>(bit_buffer >> 24);
+
+                pos += 4;
+                bit_buffer >>= 32;
+                bits_in_buffer -= 32;
+            }
+        }
+
+        /// @brief Pads with zero bits to the next byte boundary and writes out every buffered byte.
+        void align_to_byte() noexcept
+        {
+            reserve(8);
+
+            while (bits_in_buffer > 0)
+            {
+                (*out)[pos++] = static_cast<uint8_t>(bit_buffer);
+                bit_buffer >>= 8;
+                bits_in_buffer = bits_in_buffer > 8 ? bits_in_buffer - 8 : 0;
+            }
+
+            bit_buffer = 0;
+        }
+
+        /// @brief Copies whole bytes; the writer must be byte aligned.
+        void put_bytes(const std::span<const uint8_t> bytes) noexcept
+        {
+            reserve(bytes.size());
+            if (!bytes.empty()) std::memcpy(out->data() + pos, bytes.data(), bytes.size());
+            pos += bytes.size();
+        }
+
+        /// @brief Byte aligns and trims the vector to the written bytes.
+        void finish() noexcept
+        {
+            align_to_byte();
+            out->resize(pos);
+        }
+
+        /// @brief Bits written so far, buffered ones included.
+        [[nodiscard]] uint64_t bit_count() const noexcept
+        {
+            return static_cast<uint64_t>(pos) * 8u + bits_in_buffer;
+        }
+    };
+} // namespace cpng
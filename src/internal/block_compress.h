@@ -0,0 +1,366 @@
+//
+// Created by Zack Shrout on 3/19/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace cpng {
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Single block encoders (fast range fit: endpoints from the block's bounding box)
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Per-channel minimum and maximum of 16 RGBA8 pixels (64 bytes).
+    inline void rgba_block_bounds(const uint8_t* block, uint8_t min_out[4], uint8_t max_out[4]) noexcept
+    {
+#if CPNG_HAS_SSE2
+        const __m128i* p{ reinterpret_cast<const __m128i*>(block) };
+        __m128i lo{ _mm_min_epu8(_mm_min_epu8(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                 _mm_min_epu8(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3))) };
+        __m128i hi{ _mm_max_epu8(_mm_max_epu8(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                 _mm_max_epu8(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3))) };
+
+        // Fold the 4 pixels of each register down to one
+        lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+        lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+        hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        const uint32_t min_bits{ static_cast<uint32_t>(_mm_cvtsi128_si32(lo)) };
+        const uint32_t max_bits{ static_cast<uint32_t>(_mm_cvtsi128_si32(hi)) };
+        std::memcpy(min_out, &min_bits, 4);
+        std::memcpy(max_out, &max_bits, 4);
+#else
+        for (uint32_t c{ 0 }; c < 4; ++c)
+        {
+            min_out[c] = 255;
+            max_out[c] = 0;
+        }
+
+        for (uint32_t i{ 0 }; i < 16; ++i)
+        {
+            for (uint32_t c{ 0 }; c < 4; ++c)
+            {
+                min_out[c] = std::min(min_out[c], block[i * 4 + c]);
+                max_out[c] = std::max(max_out[c], block[i * 4 + c]);
+            }
+        }
+#endif
+    }
+
+    [[nodiscard]] constexpr uint32_t quantize_bits(const uint32_t v, const uint32_t max) noexcept
+    {
+        return (v * max + 127u) / 255u;
+    }
+
+    [[nodiscard]] constexpr uint32_t pack_565(const uint32_t r, const uint32_t g, const uint32_t b) noexcept
+    {
+        return quantize_bits(r, 31) << 11 | quantize_bits(g, 63) << 5 | quantize_bits(b, 31);
+    }
+
+    /// @brief 565 back to 8 bits per channel, exactly as a decoder expands it.
+    constexpr void unpack_565(const uint32_t c, int32_t out[3]) noexcept
+    {
+        const uint32_t r{ c >> 11 & 31u };
+        const uint32_t g{ c >> 5 & 63u };
+        const uint32_t b{ c & 31u };
+
+        out[0] = static_cast<int32_t>(r << 3 | r >> 2);
+        out[1] = static_cast<int32_t>(g << 2 | g >> 4);
+        out[2] = static_cast<int32_t>(b << 3 | b >> 2);
+    }
+
+#if CPNG_HAS_SSE2
+    /**
+     * Packs 16 selectors, one per byte and each below 2^Bits (Bits <= 4), into the low 16 * Bits
+     * bits of the result, pixel 0 lowest: neighbors are merged pairwise at 16, 32 and 64 bits.
+     */
+    template <uint32_t Bits>
+    [[nodiscard]] inline uint64_t pack_selectors(__m128i s) noexcept
+    {
+        s = _mm_or_si128(_mm_and_si128(s, _mm_set1_epi16(0x00FF)), _mm_srli_epi16(s, 8 - Bits));
+        s = _mm_or_si128(_mm_and_si128(s, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(s, 16 - 2 * Bits));
+        s = _mm_or_si128(_mm_and_si128(s, _mm_set_epi32(0, -1, 0, -1)), _mm_srli_epi64(s, 32 - 4 * Bits));
+
+        const uint64_t lo{ static_cast<uint32_t>(_mm_cvtsi128_si32(s)) };
+        const uint64_t hi{ static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(s, 8))) };
+        return lo | hi << (8 * Bits);
+    }
+
+    /// @brief Swaps selectors 0 and 1 in every byte (the palettes list both endpoints first).
+    [[nodiscard]] inline __m128i swap_endpoint_selectors(const __m128i s) noexcept
+    {
+        return _mm_xor_si128(s, _mm_and_si128(_mm_cmplt_epi8(s, _mm_set1_epi8(2)), _mm_set1_epi8(1)));
+    }
+#endif
+
+    /// @brief BC1 color block (8 bytes) from 16 RGBA8 pixels; alpha is ignored, 4-color mode only.
+    inline void encode_bc1_block(const uint8_t* block, uint8_t* out) noexcept
+    {
+        uint8_t lo[4], hi[4];
+        rgba_block_bounds(block, lo, hi);
+
+        // Pull the endpoints in by 1/16 of the range: the box corners are rarely on the best line
+        int32_t e0[3], e1[3];
+        for (uint32_t c{ 0 }; c < 3; ++c)
+        {
+            const uint32_t inset{ static_cast<uint32_t>(hi[c] - lo[c]) >> 4 };
+            e0[c] = hi[c] - static_cast<int32_t>(inset);
+            e1[c] = lo[c] + static_cast<int32_t>(inset);
+        }
+
+        uint32_t c0{ pack_565(e0[0], e0[1], e0[2]) };
+        uint32_t c1{ pack_565(e1[0], e1[1], e1[2]) };
+
+        // 4-color mode requires color0 > color1
+        if (c0 < c1) std::swap(c0, c1);
+
+        uint32_t indices{ 0 };
+
+        if (c0 != c1)
+        {
+            int32_t p0[3], p1[3];
+            unpack_565(c0, p0);
+            unpack_565(c1, p1);
+
+            const int32_t dir[3]{ p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+            const int32_t len2{ dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2] };
+
+            // Position along c1 -> c0 in thirds, mapped to the BC1 palette order (c0, c1, 2/3, 1/3)
+#if CPNG_HAS_SSE2
+            // t counts the thresholds 6d >= (2k - 1) * len2 passed, k = 1..3, which is the rounded
+            // division below; the order is then (4 - t) & 3 with 0 and 1 swapped
+            const __m128i zero{ _mm_setzero_si128() };
+            const __m128i origin{ _mm_set_epi16(0, static_cast<int16_t>(p1[2]), static_cast<int16_t>(p1[1]),
+                                                static_cast<int16_t>(p1[0]), 0, static_cast<int16_t>(p1[2]),
+                                                static_cast<int16_t>(p1[1]), static_cast<int16_t>(p1[0])) };
+            const __m128i axis{ _mm_set_epi16(0, static_cast<int16_t>(dir[2]), static_cast<int16_t>(dir[1]),
+                                              static_cast<int16_t>(dir[0]), 0, static_cast<int16_t>(dir[2]),
+                                              static_cast<int16_t>(dir[1]), static_cast<int16_t>(dir[0])) };
+            const __m128i third{ _mm_set1_epi32(len2 - 1) };
+            const __m128i half{ _mm_set1_epi32(3 * len2 - 1) };
+            const __m128i two_thirds{ _mm_set1_epi32(5 * len2 - 1) };
+
+            __m128i t[4];
+            for (uint32_t q{ 0 }; q < 4; ++q)
+            {
+                // 4 pixels; madd leaves (r, g) and (b, a * 0) partial dot products side by side
+                const __m128i px{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + q * 16)) };
+                const __m128i a{ _mm_shuffle_epi32(_mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(px, zero), origin),
+                                                                    axis), _MM_SHUFFLE(3, 1, 2, 0)) };
+                const __m128i b{ _mm_shuffle_epi32(_mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(px, zero), origin),
+                                                                    axis), _MM_SHUFFLE(3, 1, 2, 0)) };
+                const __m128i d{ _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b)) };
+                const __m128i d6{ _mm_add_epi32(_mm_slli_epi32(d, 2), _mm_slli_epi32(d, 1)) };
+
+                t[q] = _mm_sub_epi32(_mm_sub_epi32(_mm_sub_epi32(zero, _mm_cmpgt_epi32(d6, third)),
+                                                   _mm_cmpgt_epi32(d6, half)), _mm_cmpgt_epi32(d6, two_thirds));
+            }
+
+            const __m128i steps{ _mm_packs_epi16(_mm_packs_epi32(t[0], t[1]), _mm_packs_epi32(t[2], t[3])) };
+            const __m128i order{ _mm_and_si128(_mm_sub_epi8(_mm_set1_epi8(4), steps), _mm_set1_epi8(3)) };
+            indices = static_cast<uint32_t>(pack_selectors<2>(swap_endpoint_selectors(order)));
+#else
+            constexpr uint32_t k_order[4]{ 1, 3, 2, 0 };
+
+            for (uint32_t i{ 0 }; i < 16; ++i)
+            {
+                const uint8_t* px{ block + i * 4 };
+                const int32_t d{
+                    (px[0] - p1[0]) * dir[0] + (px[1] - p1[1]) * dir[1] + (px[2] - p1[2]) * dir[2]
+                };
+
+                const int32_t t{ std::clamp((d * 6 + len2) / (2 * len2), 0, 3) };
+                indices |= k_order[t] << (i * 2);
+            }
+#endif
+        }
+
+        out[0] = static_cast<uint8_t>(c0);
+        out[1] = static_cast<uint8_t>(c0 >> 8);
+        out[2] = static_cast<uint8_t>(c1);
+        out[3] = static_cast<uint8_t>(c1 >> 8);
+
+        for (uint32_t b{ 0 }; b < 4; ++b)
+            out[4 + b] = static_cast<uint8_t>(indices >> (b * 8));
+    }
+
+    /// @brief BC4 block (8 bytes) from 16 single-channel values, 8-value mode.
+    inline void encode_bc4_block(const uint8_t* values, uint8_t* out) noexcept
+    {
+        uint8_t lo{ 255 }, hi{ 0 };
+
+#if CPNG_HAS_SSE2
+        __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)) };
+        __m128i vmin{ _mm_min_epu8(v, _mm_srli_si128(v, 8)) };
+        __m128i vmax{ _mm_max_epu8(v, _mm_srli_si128(v, 8)) };
+        vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 4));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+        vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 2));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+        vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 1));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+        lo = static_cast<uint8_t>(_mm_cvtsi128_si32(vmin));
+        hi = static_cast<uint8_t>(_mm_cvtsi128_si32(vmax));
+#else
+        for (uint32_t i{ 0 }; i < 16; ++i)
+        {
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+#endif
+
+        out[0] = hi;
+        out[1] = lo;
+
+        uint64_t indices{ 0 };
+
+        if (hi != lo)
+        {
+            const uint32_t range{ static_cast<uint32_t>(hi - lo) };
+
+            // Position along lo -> hi in sevenths, mapped to the BC4 palette order (hi, lo, 6/7 .. 1/7)
+#if CPNG_HAS_SSE2
+            // t counts the thresholds 14 (v - lo) >= (2k - 1) * range passed, k = 1..7, which is the
+            // rounded division below; the order is then (8 - t) & 7 with 0 and 1 swapped
+            const __m128i zero{ _mm_setzero_si128() };
+            const __m128i base{ _mm_set1_epi16(lo) };
+            const __m128i scale{ _mm_set1_epi16(14) };
+            const __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)) };
+            const __m128i d_lo{ _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v, zero), base), scale) };
+            const __m128i d_hi{ _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(v, zero), base), scale) };
+
+            __m128i t_lo{ zero };
+            __m128i t_hi{ zero };
+            for (uint32_t k{ 1 }; k < 8; ++k)
+            {
+                const __m128i threshold{ _mm_set1_epi16(static_cast<int16_t>((2 * k - 1) * range - 1)) };
+                t_lo = _mm_sub_epi16(t_lo, _mm_cmpgt_epi16(d_lo, threshold));
+                t_hi = _mm_sub_epi16(t_hi, _mm_cmpgt_epi16(d_hi, threshold));
+            }
+
+            const __m128i order{ _mm_and_si128(_mm_sub_epi8(_mm_set1_epi8(8), _mm_packus_epi16(t_lo, t_hi)),
+                                               _mm_set1_epi8(7)) };
+            indices = pack_selectors<3>(swap_endpoint_selectors(order));
+#else
+            constexpr uint64_t k_order[8]{ 1, 7, 6, 5, 4, 3, 2, 0 };
+
+            for (uint32_t i{ 0 }; i < 16; ++i)
+            {
+                const uint32_t t{ ((values[i] - lo) * 14u + range) / (2u * range) };
+                indices |= k_order[t] << (i * 3);
+            }
+#endif
+        }
+
+        for (uint32_t b{ 0 }; b < 6; ++b)
+            out[2 + b] = static_cast<uint8_t>(indices >> (b * 8));
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Block rows
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    [[nodiscard]] constexpr uint32_t block_source_channels(const block_format format) noexcept
+    {
+        switch (format)
+        {
+            case block_format::bc4: return 1;
+            case block_format::bc5: return 2;
+            default:                return 4;
+        }
+    }
+
+    [[nodiscard]] constexpr pixel_format block_source_format(const block_format format) noexcept
+    {
+        switch (format)
+        {
+            case block_format::bc4: return pixel_format::r8;
+            case block_format::bc5: return pixel_format::rg8;
+            default:                return pixel_format::rgba8;
+        }
+    }
+
+    /**
+     * Compresses one row of 4×4 blocks. `rows` are the 4 source rows (`Channels` bytes per
+     * pixel; the caller repeats the last row past the image bottom); columns past the right
+     * edge repeat the last pixel.
+     */
+    template <block_format Format>
+    inline void compress_block_row(const uint8_t* const rows[4], const uint32_t width, uint8_t* dst) noexcept
+    {
+        constexpr uint32_t channels{ block_source_channels(Format) };
+        const uint32_t blocks_x{ (width + 3) / 4 };
+
+        for (uint32_t bx{ 0 }; bx < blocks_x; ++bx)
+        {
+            // Gather the block as 16 pixels, one plane per channel for the single channel encoders
+            alignas(16) uint8_t pixels[16 * channels];
+
+            for (uint32_t y{ 0 }; y < 4; ++y)
+            {
+                for (uint32_t x{ 0 }; x < 4; ++x)
+                {
+                    const uint32_t sx{ std::min(bx * 4 + x, width - 1) };
+                    std::memcpy(pixels + (y * 4 + x) * channels, rows[y] + static_cast<size_t>(sx) * channels,
+                                channels);
+                }
+            }
+
+            if constexpr (Format == block_format::bc1)
+            {
+                encode_bc1_block(pixels, dst);
+                dst += 8;
+            }
+            else if constexpr (Format == block_format::bc3)
+            {
+                uint8_t alpha[16];
+                for (uint32_t i{ 0 }; i < 16; ++i)
+                    alpha[i] = pixels[i * 4 + 3];
+
+                encode_bc4_block(alpha, dst);
+                encode_bc1_block(pixels, dst + 8);
+                dst += 16;
+            }
+            else if constexpr (Format == block_format::bc4)
+            {
+                encode_bc4_block(pixels, dst);
+                dst += 8;
+            }
+            else
+            {
+                uint8_t red[16], green[16];
+                for (uint32_t i{ 0 }; i < 16; ++i)
+                {
+                    red[i] = pixels[i * 2];
+                    green[i] = pixels[i * 2 + 1];
+                }
+
+                encode_bc4_block(red, dst);
+                encode_bc4_block(green, dst + 8);
+                dst += 16;
+            }
+        }
+    }
+
+    using block_row_fn = void (*)(const uint8_t* const rows[4], uint32_t width, uint8_t* dst) noexcept;
+
+    [[nodiscard]] constexpr block_row_fn select_block_row_compressor(const block_format format) noexcept
+    {
+        switch (format)
+        {
+            case block_format::bc1: return compress_block_row<block_format::bc1>;
+            case block_format::bc3: return compress_block_row<block_format::bc3>;
+            case block_format::bc4: return compress_block_row<block_format::bc4>;
+            case block_format::bc5: return compress_block_row<block_format::bc5>;
+            default:                return nullptr;
+        }
+    }
+} // namespace cpng
@@ -7,6 +7,9 @@
 
 #include "cpng/CarrotPNG.h"
 #include "crc32.h"
+#include "decode_stats.h"
+#include "trace.h"
+#include "xxhash64.h"
 
 #include <array>
 #include <span>
@@ -39,11 +42,11 @@ namespace cpng {
         return data[pos++];
     }
 
+    inline constexpr std::array<uint8_t, 8> k_png_signature{ 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+
     [[nodiscard]] constexpr bool check_png_signature(std::span<const uint8_t> file_data) noexcept
     {
-        constexpr std::array<uint8_t, 8> signature{ 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
-
-        return file_data.size() >= 8 && std::equal(signature.begin(), signature.end(), file_data.begin());
+        return file_data.size() >= 8 && std::equal(k_png_signature.begin(), k_png_signature.end(), file_data.begin());
     }
 
     [[nodiscard]] constexpr uint32_t peek_be_u32(const uint8_t* p) noexcept
@@ -54,9 +57,19 @@ namespace cpng {
                static_cast<uint32_t>(p[3]) << 0;
     }
 
+    /**
+     * Walks and validates every chunk up to IEND, filling the header info and the IDAT spans.
+     * When `stream_hash` is given, the IHDR payload and then every IDAT payload are fed to it,
+     * giving a key for the encoded image that is known before anything is inflated.
+     * `stats` (see decode_stats.h) times the CRC checks and counts the IDAT chunks.
+     */
+    template <typename Stats>
     [[nodiscard]] constexpr decode_error parse_png_chunks(std::span<const uint8_t> file_data, ihdr_info_t& out_ihdr,
-                                                          std::vector<std::span<const uint8_t>>& out_idat_spans) noexcept
+                                                          std::vector<std::span<const uint8_t>>& out_idat_spans,
+                                                          xxh64_state_t* stream_hash, Stats& stats) noexcept
     {
+        const trace_zone_t zone{ "cpng parse chunks" };
+
         out_ihdr = { };
         out_idat_spans.clear();
         out_idat_spans.reserve(8);
@@ -96,9 +109,11 @@ namespace cpng {
             const uint32_t expected_crc{ *crc_opt };
 
             // crc(type + data) without allocations
+            const uint64_t crc_start{ stats.now() };
             uint32_t crc{ 0xFFFFFFFFu };
             crc = crc32_update(crc, std::span<const uint8_t>{ type_ptr, 4 });
             crc = crc32_update(crc, chunk_data);
+            stats.add_time(&decode_stats_t::crc_ns, crc_start);
 
             if (crc32_finalize(crc) != expected_crc)
                 return decode_error::crc_mismatch;
@@ -140,6 +155,7 @@ namespace cpng {
                         return decode_error::invalid_chunk_length;
 
                     seen_ihdr = true;
+                    if (stream_hash) stream_hash->update(chunk_data);
                     break;
                 }
 
@@ -148,6 +164,8 @@ namespace cpng {
                     if (!seen_ihdr) return decode_error::unexpected_chunk_order;
                     if (seen_iend) return decode_error::unexpected_chunk_order;
                     out_idat_spans.push_back(chunk_data);
+                    stats.record([](decode_stats_t& out) noexcept { ++out.idat_chunks; });
+                    if (stream_hash) stream_hash->update(chunk_data);
                     break;
                 }
 
@@ -223,4 +241,12 @@ namespace cpng {
 
         return decode_error::ok;
     }
+
+    [[nodiscard]] constexpr decode_error parse_png_chunks(std::span<const uint8_t> file_data, ihdr_info_t& out_ihdr,
+                                                          std::vector<std::span<const uint8_t>>& out_idat_spans,
+                                                          xxh64_state_t* stream_hash = nullptr) noexcept
+    {
+        no_decode_stats_t stats{ };
+        return parse_png_chunks(file_data, out_ihdr, out_idat_spans, stream_hash, stats);
+    }
 } // namespace cpng
@@ -0,0 +1,60 @@
+//
+// Created by Zack Shrout on 3/29/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/chunks.h"
+#include "chunk_parser.h"
+#include "crc32.h"
+#include "deflate.h"
+
+#include <span>
+#include <vector>
+
+namespace cpng {
+    /// @brief Appends one chunk: length, type, `data` and the CRC over type + data.
+    inline void write_chunk(std::vector<uint8_t>& out, const uint32_t type,
+                            const std::span<const uint8_t> data) noexcept
+    {
+        write_be_u32(out, static_cast<uint32_t>(data.size()));
+
+        const size_t type_pos{ out.size() };
+        write_be_u32(out, type);
+        out.insert(out.end(), data.begin(), data.end());
+
+        write_be_u32(out, crc32({ out.data() + type_pos, 4 + data.size() }));
+    }
+
+    /// @brief Appends the PNG signature and a non-interlaced IHDR.
+    inline void write_png_header(std::vector<uint8_t>& out, const uint32_t width, const uint32_t height,
+                                 const uint8_t bit_depth, const uint8_t color_type) noexcept
+    {
+        out.insert(out.end(), k_png_signature.begin(), k_png_signature.end());
+
+        uint8_t ihdr[13]{ };
+        for (uint32_t i{ 0 }; i < 4; ++i)
+        {
+            ihdr[i] = static_cast<uint8_t>(width >> (24 - 8 * i));
+            ihdr[4 + i] = static_cast<uint8_t>(height >> (24 - 8 * i));
+        }
+        ihdr[8] = bit_depth;
+        ihdr[9] = color_type;
+
+        write_chunk(out, chunk_type("IHDR"), ihdr);
+    }
+
+    /**
+     * @brief Appends the zlib stream as IDAT chunks of at most `max_bytes` each (0: one chunk).
+     * Chunks never exceed the PNG length limit of 2^31 - 1 bytes, whatever `max_bytes` says.
+     */
+    inline void write_idat_chunks(std::vector<uint8_t>& out, const std::span<const uint8_t> zlib,
+                                  const size_t max_bytes) noexcept
+    {
+        const size_t step{ std::min<size_t>(max_bytes != 0 ? max_bytes : zlib.size(), 0x7FFFFFFFu) };
+
+        for (size_t pos{ 0 }; pos < zlib.size(); pos += step)
+            write_chunk(out, chunk_type("IDAT"), zlib.subspan(pos, std::min(step, zlib.size() - pos)));
+    }
+} // namespace cpng
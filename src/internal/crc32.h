@@ -28,6 +28,18 @@ namespace cpng {
 
     inline constexpr std::array<uint32_t, 256> k_crc_table{ make_crc_table() };
 
+    // Slicing-by-8 tables: slice k advances a byte through k further zero bytes
+    inline constexpr std::array<std::array<uint32_t, 256>, 8> k_crc_slices{
+        []() {
+            std::array<std::array<uint32_t, 256>, 8> slices{ };
+            slices[0] = k_crc_table;
+            for (size_t k{ 1 }; k < 8; ++k)
+                for (size_t i{ 0 }; i < 256; ++i)
+                    slices[k][i] = (slices[k - 1][i] >> 8u) ^ k_crc_table[slices[k - 1][i] & 0xFFu];
+            return slices;
+        }()
+    };
+
     // ──────────────────────────────────────────────────────────────────────────────
     // Incremental CRC helpers (no final xor)
     // ──────────────────────────────────────────────────────────────────────────────
@@ -35,6 +47,20 @@ namespace cpng {
     /// @brief Updates a running CRC with additional bytes (does NOT apply final xor).
     [[nodiscard]] constexpr uint32_t crc32_update(uint32_t crc, std::span<const uint8_t> data) noexcept
     {
+        const auto& t{ k_crc_slices };
+
+        // Eight bytes per step through independent table lookups (large IDATs, encoder output)
+        while (data.size() >= 8)
+        {
+            crc ^= static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8u |
+                   static_cast<uint32_t>(data[2]) << 16u | static_cast<uint32_t>(data[3]) << 24u;
+
+            crc = t[7][crc & 0xFFu] ^ t[6][(crc >> 8u) & 0xFFu] ^ t[5][(crc >> 16u) & 0xFFu] ^ t[4][crc >> 24u] ^
+                  t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+
+            data = data.subspan(8);
+        }
+
         for (const uint8_t byte : data)
             crc = k_crc_table[(crc ^ byte) & 0xFFu] ^ (crc >> 8u);
 
@@ -0,0 +1,90 @@
+//
+// Created by Zack Shrout on 4/1/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace cpng {
+    /**
+     * Stats policy of a decode that records nothing. The decode stages are templates on
+     * their policy; with this one every hook is an empty constexpr call, so the instantiation
+     * compiles to the same code as before the hooks existed.
+     */
+    struct no_decode_stats_t
+    {
+        static constexpr bool enabled{ false };
+
+        [[nodiscard]] static constexpr uint64_t now() noexcept { return 0; }
+        constexpr uint64_t add_time(uint64_t decode_stats_t::*, uint64_t) noexcept { return 0; }
+        template <typename Fn> constexpr void record(Fn&&) noexcept { }
+        constexpr void on_literal() noexcept { }
+        constexpr void on_match(uint32_t) noexcept { }
+        constexpr void on_filter(uint8_t) noexcept { }
+        constexpr void scratch_alloc(size_t) noexcept { }
+        constexpr void scratch_free(size_t) noexcept { }
+    };
+
+    /// @brief Stats policy filling a @ref decode_stats_t.
+    struct decode_stats_recorder_t
+    {
+        static constexpr bool enabled{ true };
+
+        decode_stats_t& stats;
+        uint64_t        live_scratch{ 0 };
+
+        [[nodiscard]] static uint64_t now() noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /// @brief Adds the time since `start` (a value of @ref now) to a stage; returns the end time.
+        uint64_t add_time(uint64_t decode_stats_t::* stage, const uint64_t start) noexcept
+        {
+            const uint64_t end{ now() };
+            stats.*stage += end - start;
+            return end;
+        }
+
+        template <typename Fn>
+        void record(Fn&& fn) noexcept { fn(stats); }
+
+        void on_literal() noexcept { ++stats.literals; }
+
+        void on_match(const uint32_t length) noexcept
+        {
+            ++stats.matches;
+            stats.match_bytes += length;
+        }
+
+        void on_filter(const uint8_t filter) noexcept
+        {
+            if (filter < stats.filter_rows.size()) ++stats.filter_rows[filter];
+        }
+
+        void scratch_alloc(const size_t bytes) noexcept
+        {
+            stats.bytes_allocated += bytes;
+            live_scratch += bytes;
+            stats.peak_scratch_bytes = std::max(stats.peak_scratch_bytes, live_scratch);
+        }
+
+        void scratch_free(const size_t bytes) noexcept { live_scratch -= std::min<uint64_t>(bytes, live_scratch); }
+    };
+
+    /// @brief Frees `bytes` of scratch from `stats` when the buffer's scope ends, on every exit path.
+    template <typename Stats>
+    struct scratch_scope_t
+    {
+        Stats&  stats;
+        size_t  bytes;
+
+        ~scratch_scope_t() noexcept { stats.scratch_free(bytes); }
+    };
+} // namespace cpng
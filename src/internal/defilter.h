@@ -5,103 +5,283 @@
 
 #pragma once
 
+#include "cpng/CarrotPNG.h"
+#include "decode_stats.h"
+#include "diagnostics.h"
+#include "simd.h"
+#include "trace.h"
+
 #include <vector>
+#include <span>
 #include <algorithm>
+#include <utility>
 
 namespace cpng {
+#if CPNG_HAS_SSE2
     /**
-     * Reverses PNG scanline filtering in-place.
-     * Input: contiguous filtered data (filter byte + pixels per row) × height
-     * Output: same vector, but filter bytes removed, pixels reconstructed (pure RGBA/RGB)
-     *
-     * Supports only 8-bit truecolor (type 2) and truecolor+alpha (type 6) for MVP.
+     * SSE2 Sub/Average/Paeth reconstruction, one whole pixel per step.
+     * These filters carry a dependency on the pixel to the left, so the parallelism is across
+     * the bytes of a pixel: bpp 3/4 (8-bit RGB/RGBA) and 6/8 (16-bit RGB/RGBA).
      *
-     * Returns ok on success, or error code on unsupported format/filter/corruption.
+     * Every pixel but the last is loaded 4 or 8 bytes at a time: the lanes past `Bpp` pick up
+     * the next pixel, are computed independently and never stored. Exact 3 and 6 byte loads
+     * would go through the stack and stall on store forwarding.
      */
-    [[nodiscard]] inline decode_error defilter_scanlines(std::vector<uint8_t>& data, const uint32_t width,
-                                                         const uint32_t height, const uint8_t bit_depth,
-                                                         const uint8_t color_type) noexcept
+    template <uint32_t Bpp>
+    inline void defilter_row_sse2(const uint8_t filter, uint8_t* pixels, const uint8_t* prior,
+                                  const size_t length) noexcept
     {
-        if (bit_depth != 8) return decode_error::unsupported_bit_depth;
-        if (color_type != 2 && color_type != 6) return decode_error::unsupported_color_type;
+        const __m128i zero{ _mm_setzero_si128() };
+        __m128i a{ zero }; // reconstructed pixel to the left
 
-        const uint32_t bpp{ static_cast<uint32_t>(color_type == 6 ? 4 : 3) };
-        const uint32_t row_bytes{ 1 + width * bpp }; // filter + pixels
+        const size_t last{ length - Bpp };
+        const auto load{ [last](const uint8_t* p, const size_t x) noexcept {
+            return x < last ? load_over<Bpp>(p + x) : load_low<Bpp>(p + x);
+        } };
 
-        if (data.size() != height * row_bytes) return decode_error::invalid_idat_stream;
+        if (filter == 1) // sub
+        {
+            for (size_t x{ 0 }; x < length; x += Bpp)
+            {
+                a = _mm_add_epi8(load(pixels, x), a);
+                store_low<Bpp>(pixels + x, a);
+            }
+        }
+        else if (filter == 3) // average: floor((a + b) / 2), fixing up _mm_avg_epu8's round-up
+        {
+            const __m128i ones{ _mm_set1_epi8(1) };
 
-        std::vector<uint8_t> prior_row(width * bpp, 0); // previous reconstructed pixels
+            for (size_t x{ 0 }; x < length; x += Bpp)
+            {
+                const __m128i b{ load(prior, x) };
+                const __m128i avg{ _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), ones)) };
 
-        for (uint32_t y{ 0 }; y < height; ++y)
+                a = _mm_add_epi8(load(pixels, x), avg);
+                store_low<Bpp>(pixels + x, a);
+            }
+        }
+        else // paeth, evaluated in 16-bit lanes
         {
-            uint8_t* row{ data.data() + y * row_bytes };
-            const uint8_t filter{ row[0] };
-            uint8_t* pixels{ row + 1 }; // pixels start right after the filter byte
+            __m128i c{ zero }; // prior pixel to the left
 
-            if (filter == 0) // none
+            for (size_t x{ 0 }; x < length; x += Bpp)
             {
-                // already good
+                const __m128i b{ _mm_unpacklo_epi8(load(prior, x), zero) };
+
+                // pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+                __m128i pa{ _mm_sub_epi16(b, c) };
+                __m128i pb{ _mm_sub_epi16(a, c) };
+                __m128i pc{ _mm_add_epi16(pa, pb) };
+
+                pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+                pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+                pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+                const __m128i smallest{ _mm_min_epi16(pc, _mm_min_epi16(pa, pb)) };
+
+                // Tie-break order a, b, c as in the spec
+                const __m128i use_b{ _mm_cmpeq_epi16(smallest, pb) };
+                const __m128i use_a{ _mm_cmpeq_epi16(smallest, pa) };
+
+                __m128i nearest{ _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(use_b, c)) };
+                nearest = _mm_or_si128(_mm_and_si128(use_a, a), _mm_andnot_si128(use_a, nearest));
+
+                const __m128i d{ _mm_add_epi8(load(pixels, x), _mm_packus_epi16(nearest, nearest)) };
+                store_low<Bpp>(pixels + x, d);
+
+                a = _mm_unpacklo_epi8(d, zero);
+                c = b;
             }
-            else if (filter == 1) // sub
+        }
+    }
+#endif
+
+    /**
+     * Scalar reconstruction with the pixel stride known at compile time. The first pixel has
+     * no left neighbor and is peeled off, so the loops carry no bounds checks.
+     */
+    template <uint32_t Bpp>
+    inline void defilter_row_scalar(const uint8_t filter, uint8_t* pixels, const uint8_t* prior,
+                                    const size_t length) noexcept
+    {
+        const size_t head{ std::min<size_t>(Bpp, length) };
+
+        if (filter == 1) // sub
+        {
+            for (size_t x{ Bpp }; x < length; ++x)
+                pixels[x] += pixels[x - Bpp];
+        }
+        else if (filter == 2) // up
+        {
+            for (size_t x{ 0 }; x < length; ++x)
+                pixels[x] += prior[x];
+        }
+        else if (filter == 3) // average
+        {
+            for (size_t x{ 0 }; x < head; ++x)
+                pixels[x] += static_cast<uint8_t>(prior[x] / 2);
+
+            for (size_t x{ Bpp }; x < length; ++x)
+                pixels[x] += static_cast<uint8_t>((pixels[x - Bpp] + prior[x]) / 2);
+        }
+        else if (filter == 4) // paeth
+        {
+            // Without left neighbors the predictor is always the byte above
+            for (size_t x{ 0 }; x < head; ++x)
+                pixels[x] += prior[x];
+
+            for (size_t x{ Bpp }; x < length; ++x)
             {
-                for (uint32_t x{ bpp }; x < width * bpp; ++x)
-                {
-                    pixels[x] += pixels[x - bpp];
-                }
+                const uint8_t a{ pixels[x - Bpp] };
+                const uint8_t b{ prior[x] };
+                const uint8_t c{ prior[x - Bpp] };
+
+                const int p{ static_cast<int>(a) + b - c };
+                const int pa{ std::abs(p - static_cast<int>(a)) };
+                const int pb{ std::abs(p - static_cast<int>(b)) };
+                const int pc{ std::abs(p - static_cast<int>(c)) };
+
+                const uint8_t predictor{ pa <= pb && pa <= pc ? a : pb <= pc ? b : c };
+                pixels[x] += predictor;
             }
-            else if (filter == 2) // up
+        }
+    }
+
+    /**
+     * Reverses the PNG filter of a single scanline in-place.
+     * `pixels` points just past the filter byte, `prior` at the previous reconstructed
+     * scanline (all zeros for the first row). `Bpp` is the filter stride in bytes.
+     */
+    template <uint32_t Bpp>
+    [[nodiscard]] inline decode_error defilter_row(const uint8_t filter, uint8_t* pixels, const uint8_t* prior,
+                                                   const size_t length) noexcept
+    {
+        if (filter > 4) return decode_error::unsupported_filter;
+        if (filter == 0) return decode_error::ok; // none
+
+#if CPNG_HAS_SSE2
+        // Rows of whole-byte formats are always a multiple of bpp long.
+        if constexpr (Bpp >= 3)
+        {
+            if (filter != 2)
             {
-                for (uint32_t x{ 0 }; x < width * bpp; ++x)
-                {
-                    pixels[x] += prior_row[x];
-                }
+                defilter_row_sse2<Bpp>(filter, pixels, prior, length);
+                return decode_error::ok;
             }
-            else if (filter == 3) // average
+        }
+#endif
+
+        defilter_row_scalar<Bpp>(filter, pixels, prior, length);
+        return decode_error::ok;
+    }
+
+    /// @brief @ref defilter_scanlines for one filter stride, after the size check.
+    template <uint32_t Bpp, typename RowFn, typename Stats>
+    [[nodiscard]] decode_error defilter_rows(std::span<uint8_t> data, const size_t row_bytes, const uint32_t height,
+                                             RowFn&& on_row, Stats& stats, decode_diagnostics_t* diagnostics) noexcept
+    {
+        const size_t stride{ 1 + row_bytes }; // filter + pixels
+
+        const std::vector<uint8_t> zero_row(row_bytes, 0);
+        const uint8_t* prior_row{ zero_row.data() };
+        stats.scratch_alloc(row_bytes);
+        const scratch_scope_t<Stats> zero_row_scope{ stats, row_bytes };
+
+        // Bands of rows only exist to give profilers a zone per band (see trace.h)
+        for (uint32_t band{ 0 }; band < height; band += k_trace_band_rows)
+        {
+            const trace_zone_t zone{ "cpng defilter rows" };
+            const uint32_t band_end{ std::min(height - band, k_trace_band_rows) + band };
+
+            for (uint32_t y{ band }; y < band_end; ++y)
             {
-                for (uint32_t x{ 0 }; x < width * bpp; ++x)
+                uint8_t* row{ data.data() + y * stride };
+                uint8_t* pixels{ row + 1 }; // pixels start right after the filter byte
+
+                stats.on_filter(row[0]);
+
+                const uint64_t defilter_start{ stats.now() };
+                const decode_error err{ defilter_row<Bpp>(row[0], pixels, prior_row, row_bytes) };
+                if (err != decode_error::ok)
                 {
-                    const uint8_t left{ static_cast<uint8_t>(x >= bpp ? pixels[x - bpp] : 0) };
-                    pixels[x] += static_cast<uint8_t>((left + prior_row[x]) / 2);
+                    return report_failure(diagnostics, {
+                        .error = err,
+                        .stage = decode_stage::defilter,
+                        .reason = "unknown filter type",
+                        .byte_offset = y * stride,
+                        .row = y,
+                    });
                 }
-            }
-            else if (filter == 4) // paeth
-            {
-                for (uint32_t x{ 0 }; x < width * bpp; ++x)
-                {
-                    uint8_t a{ static_cast<uint8_t>(x >= bpp ? pixels[x - bpp] : 0) };
-                    uint8_t b{ prior_row[x] };
-                    uint8_t c{ static_cast<uint8_t>(x >= bpp ? prior_row[x - bpp] : 0) };
 
-                    const int p{ static_cast<int>(a) + b - c };
-                    const int pa{ std::abs(p - static_cast<int>(a)) };
-                    const int pb{ std::abs(p - static_cast<int>(b)) };
-                    const int pc{ std::abs(p - static_cast<int>(c)) };
+                const uint64_t convert_start{ stats.add_time(&decode_stats_t::defilter_ns, defilter_start) };
 
-                    const uint8_t predictor{ pa <= pb && pa <= pc ? a : pb <= pc ? b : c };
-                    pixels[x] += predictor;
-                }
-            }
-            else
-            {
-                return decode_error::unsupported_filter;
+                on_row(y, static_cast<const uint8_t*>(pixels));
+                stats.add_time(&decode_stats_t::convert_ns, convert_start);
+
+                prior_row = pixels;
             }
 
-            // Copy reconstructed pixels (skip filter byte) to prior_row for next row
-            std::copy(pixels, pixels + width * bpp, prior_row.begin());
+            trace_counter("cpng rows", band_end);
         }
 
-        // Compact: remove filter bytes from the entire buffer
-        std::vector<uint8_t> clean;
-        clean.reserve(height * width * bpp);
+        return decode_error::ok;
+    }
+
+    /**
+     * Reverses PNG scanline filtering in-place.
+     * Input: contiguous filtered data (filter byte + `row_bytes` packed bytes per row) × height
+     * Output: each row is reconstructed in place; `on_row(y, pixels)` is invoked as soon as a
+     * row is ready so the caller can unpack/convert it while it is still hot in cache.
+     *
+     * The previous row inside `data` serves as the prior scanline, so no copy is made.
+     *
+     * Returns ok on success, or error code on unsupported filter/corruption. `bpp` (1, 2, 3,
+     * 4, 6 or 8) picks the specialized row loop once per image.
+     * `stats` (see decode_stats.h) counts the rows of each filter type and times the
+     * de-filtering apart from `on_row`, which counts as conversion. A failure is described
+     * in `diagnostics` when given.
+     */
+    template <typename RowFn, typename Stats>
+    [[nodiscard]] decode_error defilter_scanlines(std::span<uint8_t> data, const size_t row_bytes,
+                                                  const uint32_t height, const uint32_t bpp, RowFn&& on_row,
+                                                  Stats& stats, decode_diagnostics_t* diagnostics = nullptr) noexcept
+    {
+        const size_t stride{ 1 + row_bytes }; // filter + pixels
 
-        for (uint32_t y{ 0 }; y < height; ++y)
+        if (data.size() != static_cast<size_t>(height) * stride)
         {
-            const uint8_t* row{ data.data() + y * row_bytes };
-            clean.insert(clean.end(), row + 1, row + 1 + width * bpp);
+            return report_failure(diagnostics, {
+                .error = decode_error::invalid_idat_stream,
+                .stage = decode_stage::defilter,
+                .reason = "scanline bytes do not match the image size",
+                .expected_size = static_cast<size_t>(height) * stride,
+                .actual_size = data.size(),
+            });
         }
 
-        data = std::move(clean);
+        // The stride is the one runtime choice left: each gets its own row loop with the filters inlined
+        switch (bpp)
+        {
+            case 1: return defilter_rows<1>(data, row_bytes, height, on_row, stats, diagnostics);
+            case 2: return defilter_rows<2>(data, row_bytes, height, on_row, stats, diagnostics);
+            case 3: return defilter_rows<3>(data, row_bytes, height, on_row, stats, diagnostics);
+            case 4: return defilter_rows<4>(data, row_bytes, height, on_row, stats, diagnostics);
+            case 6: return defilter_rows<6>(data, row_bytes, height, on_row, stats, diagnostics);
+            case 8: return defilter_rows<8>(data, row_bytes, height, on_row, stats, diagnostics);
+            default:
+                return report_failure(diagnostics, {
+                    .error = decode_error::unsupported_bit_depth,
+                    .stage = decode_stage::defilter,
+                    .reason = "no filter stride for this pixel size",
+                });
+        }
+    }
 
-        return decode_error::ok;
+    template <typename RowFn>
+    [[nodiscard]] decode_error defilter_scanlines(std::span<uint8_t> data, const size_t row_bytes,
+                                                  const uint32_t height, const uint32_t bpp, RowFn&& on_row) noexcept
+    {
+        no_decode_stats_t stats{ };
+        return defilter_scanlines(data, row_bytes, height, bpp, std::forward<RowFn>(on_row), stats);
     }
 } // namespace cpng
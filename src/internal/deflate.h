@@ -0,0 +1,685 @@
+//
+// Created by Zack Shrout on 3/28/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "adler32.h"
+#include "bit_reader.h"
+#include "bit_writer.h"
+#include "fixed_tables.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace cpng {
+    /// @brief One LZ77 step: a literal byte (`length` 0) or a back-reference of `length` bytes at `distance`.
+    struct lz_token_t
+    {
+        uint16_t    length{ };      // 0, or 3..258
+        uint16_t    value{ };       // literal byte, or distance 1..32768
+    };
+
+    inline constexpr uint32_t k_deflate_window{ 32768 };
+    inline constexpr uint32_t k_min_match{ 3 };
+    inline constexpr uint32_t k_max_match{ 258 };
+
+    // Match length (3..258) -> length code index 0..28
+    inline constexpr std::array<uint8_t, k_max_match + 1> k_length_code{
+        []() {
+            std::array<uint8_t, k_max_match + 1> codes{ };
+            for (uint32_t code{ 0 }; code < 29; ++code)
+            {
+                const uint32_t end{ code == 28 ? k_max_match + 1 : static_cast<uint32_t>(length_base[code + 1]) };
+                for (auto len{ static_cast<uint32_t>(length_base[code]) }; len < end; ++len)
+                    codes[len] = static_cast<uint8_t>(code);
+            }
+            return codes;
+        }()
+    };
+
+    // Distance - 1 -> distance code, direct for 1..512 and in steps of 128 above (codes >= 18 span 256+)
+    inline constexpr std::array<uint8_t, 512> k_dist_code_small{
+        []() {
+            std::array<uint8_t, 512> codes{ };
+            for (uint32_t code{ 0 }; code < 30; ++code)
+                for (auto d{ static_cast<uint32_t>(dist_base[code]) };
+                     d < static_cast<uint32_t>(dist_base[code]) + (1u << dist_extra[code]) && d <= 512; ++d)
+                    codes[d - 1] = static_cast<uint8_t>(code);
+            return codes;
+        }()
+    };
+
+    inline constexpr std::array<uint8_t, 256> k_dist_code_large{
+        []() {
+            std::array<uint8_t, 256> codes{ };
+            for (uint32_t code{ 18 }; code < 30; ++code)
+                for (auto d{ static_cast<uint32_t>(dist_base[code]) };
+                     d < static_cast<uint32_t>(dist_base[code]) + (1u << dist_extra[code]); d += 128)
+                    codes[(d - 1) >> 7] = static_cast<uint8_t>(code);
+            return codes;
+        }()
+    };
+
+    [[nodiscard]] constexpr uint32_t distance_code(const uint32_t distance) noexcept
+    {
+        return distance <= 512 ? k_dist_code_small[distance - 1] : k_dist_code_large[(distance - 1) >> 7];
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Huffman codes
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /**
+     * Optimal code lengths for `freqs`, limited to `max_bits`. Unused symbols get length 0.
+     * Lengths come from the in-place Moffat-Katajainen construction over the sorted
+     * frequencies; overlong codes are then shortened by rebalancing the per-length counts,
+     * which keeps the code complete.
+     */
+    inline void build_code_lengths(const std::span<const uint32_t> freqs, const std::span<uint8_t> out_lengths,
+                                   const uint32_t max_bits) noexcept
+    {
+        struct sym_t
+        {
+            uint32_t    freq;
+            uint16_t    symbol;
+        };
+
+        std::array<sym_t, 288> syms{ };
+        uint32_t n{ 0 };
+
+        std::fill(out_lengths.begin(), out_lengths.end(), uint8_t{ 0 });
+
+        for (size_t i{ 0 }; i < freqs.size(); ++i)
+            if (freqs[i] != 0) syms[n++] = { freqs[i], static_cast<uint16_t>(i) };
+
+        if (n == 0) return;
+
+        if (n == 1)
+        {
+            out_lengths[syms[0].symbol] = 1;
+            return;
+        }
+
+        std::sort(syms.begin(), syms.begin() + n, [](const sym_t& a, const sym_t& b) noexcept {
+            return a.freq != b.freq ? a.freq < b.freq : a.symbol < b.symbol;
+        });
+
+        // Moffat & Katajainen, "In-Place Calculation of Minimum-Redundancy Codes"
+        std::array<uint32_t, 288> a{ };
+        for (uint32_t i{ 0 }; i < n; ++i) a[i] = syms[i].freq;
+
+        a[0] += a[1];
+        uint32_t root{ 0 };
+        uint32_t leaf{ 2 };
+
+        for (uint32_t next{ 1 }; next < n - 1; ++next)
+        {
+            if (leaf >= n || a[root] < a[leaf])
+            {
+                a[next] = a[root];
+                a[root++] = next;
+            }
+            else
+            {
+                a[next] = a[leaf++];
+            }
+
+            if (leaf >= n || (root < next && a[root] < a[leaf]))
+            {
+                a[next] += a[root];
+                a[root++] = next;
+            }
+            else
+            {
+                a[next] += a[leaf++];
+            }
+        }
+
+        a[n - 2] = 0;
+        for (int next{ static_cast<int>(n) - 3 }; next >= 0; --next)
+            a[next] = a[a[next]] + 1;
+
+        int avail{ 1 };
+        int used{ 0 };
+        uint32_t depth{ 0 };
+        int root_i{ static_cast<int>(n) - 2 };
+        int next_i{ static_cast<int>(n) - 1 };
+
+        while (avail > 0)
+        {
+            while (root_i >= 0 && a[root_i] == depth)
+            {
+                ++used;
+                --root_i;
+            }
+
+            while (avail > used)
+            {
+                a[next_i--] = depth;
+                --avail;
+            }
+
+            avail = 2 * used;
+            ++depth;
+            used = 0;
+        }
+
+        // a[i] is now the length of syms[i] (longest first); count per length and limit
+        std::array<uint32_t, 33> count{ };
+        for (uint32_t i{ 0 }; i < n; ++i) ++count[std::min(a[i], 32u)];
+
+        for (uint32_t len{ max_bits + 1 }; len <= 32; ++len)
+        {
+            count[max_bits] += count[len];
+            count[len] = 0;
+        }
+
+        uint64_t kraft{ 0 };
+        for (uint32_t len{ 1 }; len <= max_bits; ++len)
+            kraft += static_cast<uint64_t>(count[len]) << (max_bits - len);
+
+        // Every step moves one leaf from the deepest level under a shallower leaf, which is split in two
+        while (kraft > (1ull << max_bits))
+        {
+            --count[max_bits];
+            for (uint32_t len{ max_bits - 1 }; len > 0; --len)
+            {
+                if (count[len] != 0)
+                {
+                    --count[len];
+                    count[len + 1] += 2;
+                    break;
+                }
+            }
+            --kraft;
+        }
+
+        // Longest codes go to the rarest symbols
+        uint32_t i{ 0 };
+        for (uint32_t len{ max_bits }; len > 0; --len)
+            for (uint32_t k{ 0 }; k < count[len]; ++k)
+                out_lengths[syms[i++].symbol] = static_cast<uint8_t>(len);
+    }
+
+    /// @brief Canonical codes for `lengths`, bit-reversed for LSB-first output.
+    constexpr void build_codes(const std::span<const uint8_t> lengths, const std::span<uint16_t> out_codes) noexcept
+    {
+        std::array<uint32_t, 16> bl_count{ };
+        for (const uint8_t len: lengths) ++bl_count[len];
+        bl_count[0] = 0;
+
+        std::array<uint32_t, 16> next_code{ };
+        uint32_t code{ 0 };
+        for (uint32_t bits{ 1 }; bits <= 15; ++bits)
+        {
+            code = (code + bl_count[bits - 1]) << 1;
+            next_code[bits] = code;
+        }
+
+        for (size_t sym{ 0 }; sym < lengths.size(); ++sym)
+        {
+            const uint8_t len{ lengths[sym] };
+            out_codes[sym] = len ? static_cast<uint16_t>(bit_reverse(next_code[len]++, len)) : uint16_t{ 0 };
+        }
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Block writer
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Symbol frequencies of one block; the end-of-block symbol is counted.
+    struct block_freqs_t
+    {
+        std::array<uint32_t, 286>   lit{ };
+        std::array<uint32_t, 30>    dist{ };
+    };
+
+    [[nodiscard]] inline block_freqs_t count_block_freqs(const std::span<const lz_token_t> tokens) noexcept
+    {
+        block_freqs_t f{ };
+
+        for (const lz_token_t t: tokens)
+        {
+            if (t.length == 0)
+            {
+                ++f.lit[t.value];
+            }
+            else
+            {
+                ++f.lit[257 + k_length_code[t.length]];
+                ++f.dist[distance_code(t.value)];
+            }
+        }
+
+        ++f.lit[256];
+        return f;
+    }
+
+    /// @brief Bits of the tokens themselves (no header, no end-of-block) under the given code lengths.
+    [[nodiscard]] inline uint64_t block_payload_bits(const block_freqs_t& f, const uint8_t* lit_lengths,
+                                                     const uint8_t* dist_lengths) noexcept
+    {
+        uint64_t bits{ 0 };
+
+        for (uint32_t s{ 0 }; s < 286; ++s)
+        {
+            bits += static_cast<uint64_t>(f.lit[s]) * lit_lengths[s];
+            if (s > 256) bits += static_cast<uint64_t>(f.lit[s]) * length_extra[s - 257];
+        }
+
+        for (uint32_t d{ 0 }; d < 30; ++d)
+            bits += static_cast<uint64_t>(f.dist[d]) * (dist_lengths[d] + dist_extra[d]);
+
+        return bits;
+    }
+
+    /// @brief A dynamic block header: both code length tables, run-length coded (symbols 16/17/18).
+    struct dynamic_header_t
+    {
+        std::array<uint8_t, 286>    lit_lengths{ };
+        std::array<uint8_t, 30>     dist_lengths{ };
+        uint32_t                    hlit{ 257 };
+        uint32_t                    hdist{ 1 };
+        uint32_t                    hclen{ 4 };
+        std::array<uint8_t, 19>     cl_lengths{ };
+        std::array<uint16_t, 19>    cl_codes{ };
+        std::array<uint16_t, 316>   rle{ };         // symbol | extra value << 5
+        uint32_t                    rle_count{ 0 };
+        uint64_t                    bits{ 0 };      // header size, 3-bit block type excluded
+    };
+
+    inline constexpr std::array<uint8_t, 19> k_cl_order{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    /// @brief Builds dynamic codes for `f` and encodes their header; the result is ready to write.
+    inline void build_dynamic_header(block_freqs_t f, dynamic_header_t& h) noexcept
+    {
+        // The decoder needs at least two codes per table, so pad sparse tables with dummies
+        const auto pad{
+            [](const std::span<uint32_t> freqs) noexcept {
+                uint32_t used{ static_cast<uint32_t>(std::ranges::count_if(freqs, [](const uint32_t v) { return v != 0; })) };
+                for (size_t i{ 0 }; used < 2 && i < freqs.size(); ++i)
+                    if (freqs[i] == 0) { freqs[i] = 1; ++used; }
+            }
+        };
+        pad(f.lit);
+        pad(f.dist);
+
+        build_code_lengths(f.lit, h.lit_lengths, 15);
+        build_code_lengths(f.dist, h.dist_lengths, 15);
+
+        h.hlit = 286;
+        while (h.hlit > 257 && h.lit_lengths[h.hlit - 1] == 0) --h.hlit;
+        h.hdist = 30;
+        while (h.hdist > 1 && h.dist_lengths[h.hdist - 1] == 0) --h.hdist;
+
+        // Both tables form one sequence for the run-length coding
+        std::array<uint8_t, 316> all{ };
+        std::copy_n(h.lit_lengths.begin(), h.hlit, all.begin());
+        std::copy_n(h.dist_lengths.begin(), h.hdist, all.begin() + h.hlit);
+        const uint32_t total{ h.hlit + h.hdist };
+
+        std::array<uint32_t, 19> cl_freqs{ };
+        h.rle_count = 0;
+
+        const auto emit{
+            [&](const uint32_t symbol, const uint32_t extra) noexcept {
+                h.rle[h.rle_count++] = static_cast<uint16_t>(symbol | extra << 5);
+                ++cl_freqs[symbol];
+            }
+        };
+
+        for (uint32_t i{ 0 }; i < total;)
+        {
+            const uint8_t len{ all[i] };
+            uint32_t run{ 1 };
+            while (i + run < total && all[i + run] == len) ++run;
+
+            if (len == 0)
+            {
+                uint32_t left{ run };
+                while (left >= 11) { const uint32_t r{ std::min(left, 138u) }; emit(18, r - 11); left -= r; }
+                if (left >= 3) { emit(17, left - 3); left = 0; }
+                while (left-- > 0) emit(0, 0);
+            }
+            else
+            {
+                emit(len, 0);
+                uint32_t left{ run - 1 };
+                while (left >= 3) { const uint32_t r{ std::min(left, 6u) }; emit(16, r - 3); left -= r; }
+                while (left-- > 0) emit(len, 0);
+            }
+
+            i += run;
+        }
+
+        build_code_lengths(cl_freqs, h.cl_lengths, 7);
+        build_codes(h.cl_lengths, h.cl_codes);
+
+        h.hclen = 19;
+        while (h.hclen > 4 && h.cl_lengths[k_cl_order[h.hclen - 1]] == 0) --h.hclen;
+
+        h.bits = 5 + 5 + 4 + 3ull * h.hclen;
+        for (uint32_t s{ 0 }; s < 19; ++s)
+            h.bits += static_cast<uint64_t>(cl_freqs[s]) * h.cl_lengths[s];
+        h.bits += 2ull * cl_freqs[16] + 3ull * cl_freqs[17] + 7ull * cl_freqs[18];
+    }
+
+    inline void write_dynamic_header(bit_writer_t& w, const dynamic_header_t& h) noexcept
+    {
+        w.reserve(static_cast<size_t>(h.bits / 8) + 8);
+
+        w.put_bits(h.hlit - 257, 5);
+        w.put_bits(h.hdist - 1, 5);
+        w.put_bits(h.hclen - 4, 4);
+
+        for (uint32_t i{ 0 }; i < h.hclen; ++i)
+            w.put_bits(h.cl_lengths[k_cl_order[i]], 3);
+
+        for (uint32_t i{ 0 }; i < h.rle_count; ++i)
+        {
+            const uint32_t symbol{ h.rle[i] & 31u };
+            const uint32_t extra{ static_cast<uint32_t>(h.rle[i] >> 5) };
+
+            w.put_bits(h.cl_codes[symbol], h.cl_lengths[symbol]);
+
+            if (symbol == 16) w.put_bits(extra, 2);
+            else if (symbol == 17) w.put_bits(extra, 3);
+            else if (symbol == 18) w.put_bits(extra, 7);
+        }
+    }
+
+    inline void write_tokens(bit_writer_t& w, const std::span<const lz_token_t> tokens, const uint16_t* lit_codes,
+                             const uint8_t* lit_lengths, const uint16_t* dist_codes,
+                             const uint8_t* dist_lengths) noexcept
+    {
+        // A match takes at most 15 + 5 + 15 + 13 bits
+        w.reserve(tokens.size() * 6 + 8);
+
+        // Work on a local copy: byte stores into the output may alias anything reachable through
+        // `w`, which would force the bit buffer back to memory after every flush
+        bit_writer_t local{ w };
+
+        for (const lz_token_t t: tokens)
+        {
+            if (t.length == 0)
+            {
+                local.put_bits(lit_codes[t.value], lit_lengths[t.value]);
+                continue;
+            }
+
+            const uint32_t lcode{ k_length_code[t.length] };
+            const uint32_t lsym{ 257 + lcode };
+            local.put_bits(lit_codes[lsym] | (t.length - static_cast<uint32_t>(length_base[lcode])) << lit_lengths[lsym],
+                       lit_lengths[lsym] + static_cast<uint32_t>(length_extra[lcode]));
+
+            const uint32_t distance{ t.value };
+            const uint32_t dcode{ distance_code(distance) };
+            local.put_bits(dist_codes[dcode] | (distance - static_cast<uint32_t>(dist_base[dcode])) << dist_lengths[dcode],
+                       dist_lengths[dcode] + static_cast<uint32_t>(dist_extra[dcode]));
+        }
+
+        local.put_bits(lit_codes[256], lit_lengths[256]);
+        w = local;
+    }
+
+    struct fixed_codes_t
+    {
+        std::array<uint8_t, 288>    lit_lengths{ };
+        std::array<uint16_t, 288>   lit_codes{ };
+        std::array<uint8_t, 30>     dist_lengths{ };
+        std::array<uint16_t, 30>    dist_codes{ };
+    };
+
+    inline constexpr fixed_codes_t k_fixed_codes{
+        []() {
+            fixed_codes_t c{ };
+            for (size_t i{ 0 }; i < 288; ++i) c.lit_lengths[i] = static_cast<uint8_t>(fixed_literal_lengths[i]);
+            c.dist_lengths.fill(5);
+            build_codes(c.lit_lengths, c.lit_codes);
+            build_codes(c.dist_lengths, c.dist_codes);
+            return c;
+        }()
+    };
+
+    /// @brief Writes `raw` as stored blocks (at most 65535 bytes each); only the last carries `final`.
+    inline void write_stored_blocks(bit_writer_t& w, std::span<const uint8_t> raw, const bool final) noexcept
+    {
+        do
+        {
+            const auto len{ static_cast<uint32_t>(std::min<size_t>(raw.size(), 65535)) };
+            const bool last{ len == raw.size() };
+
+            w.reserve(8);
+            w.put_bits(final && last ? 1u : 0u, 3);
+            w.align_to_byte();
+
+            const uint8_t header[4]{
+                static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+                static_cast<uint8_t>(~len), static_cast<uint8_t>(~len >> 8)
+            };
+            w.put_bytes(header);
+            w.put_bytes(raw.first(len));
+
+            raw = raw.subspan(len);
+        } while (!raw.empty());
+    }
+
+    /**
+     * Sync flush (as zlib's Z_SYNC_FLUSH): an empty stored block, which byte aligns the output
+     * without ending the stream. Streams that never reference data before the flush can be
+     * concatenated after it, and a decoder can start inflating at the next byte.
+     */
+    inline void write_sync_flush(bit_writer_t& w) noexcept
+    {
+        write_stored_blocks(w, { }, false);
+    }
+
+    /**
+     * Writes one block holding `tokens`, which must expand to exactly `raw`. The cheapest of
+     * dynamic Huffman, fixed Huffman and stored is chosen from exact bit counts.
+     */
+    inline void write_block(bit_writer_t& w, const std::span<const lz_token_t> tokens,
+                            const std::span<const uint8_t> raw, const bool final) noexcept
+    {
+        const block_freqs_t f{ count_block_freqs(tokens) };
+
+        dynamic_header_t h{ };
+        build_dynamic_header(f, h);
+
+        const uint64_t dynamic_bits{ h.bits + block_payload_bits(f, h.lit_lengths.data(), h.dist_lengths.data()) };
+        const uint64_t fixed_bits{
+            block_payload_bits(f, k_fixed_codes.lit_lengths.data(), k_fixed_codes.dist_lengths.data())
+        };
+        // Header, alignment padding (at most 7 bits, assume the worst) and LEN/NLEN per 64 KiB
+        const uint64_t stored_bits{ (raw.size() + 5 * (raw.size() / 65535 + 1)) * 8 + 7 };
+
+        if (stored_bits < dynamic_bits && stored_bits < fixed_bits)
+        {
+            write_stored_blocks(w, raw, final);
+        }
+        else if (fixed_bits <= dynamic_bits)
+        {
+            w.reserve(8);
+            w.put_bits(final ? 3u : 2u, 3); // BTYPE 01
+            write_tokens(w, tokens, k_fixed_codes.lit_codes.data(), k_fixed_codes.lit_lengths.data(),
+                         k_fixed_codes.dist_codes.data(), k_fixed_codes.dist_lengths.data());
+        }
+        else
+        {
+            std::array<uint16_t, 286> lit_codes{ };
+            std::array<uint16_t, 30> dist_codes{ };
+            build_codes(h.lit_lengths, lit_codes);
+            build_codes(h.dist_lengths, dist_codes);
+
+            w.reserve(8);
+            w.put_bits(final ? 5u : 4u, 3); // BTYPE 10
+            write_dynamic_header(w, h);
+            write_tokens(w, tokens, lit_codes.data(), h.lit_lengths.data(), dist_codes.data(),
+                         h.dist_lengths.data());
+        }
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Fast LZ77
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Length of the common prefix of `a` and `b`, up to `max`.
+    [[nodiscard]] inline uint32_t match_length(const uint8_t* a, const uint8_t* b, const uint32_t max) noexcept
+    {
+        uint32_t len{ 0 };
+
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            while (len + 8 <= max)
+            {
+                uint64_t x;
+                uint64_t y;
+                std::memcpy(&x, a + len, 8);
+                std::memcpy(&y, b + len, 8);
+
+                if (const uint64_t diff{ x ^ y }; diff != 0)
+                    return len + static_cast<uint32_t>(std::countr_zero(diff)) / 8;
+                len += 8;
+            }
+        }
+
+        while (len < max && a[len] == b[len]) ++len;
+        return len;
+    }
+
+    [[nodiscard]] inline uint32_t load_u32(const uint8_t* p) noexcept
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    struct deflate_fast_options_t
+    {
+        uint32_t    rle_distance{ 0 };      // extra match candidate, e.g. the pixel size; 0 for none
+        uint32_t    block_tokens{ 32768 };  // tokens per block (one Huffman table build each)
+    };
+
+    /**
+     * Single pass greedy LZ77 for filtered image data, fpng / QOI class speed.
+     *
+     * Each position tries two candidates: one hash table probe (last position with the same
+     * 4 bytes, no chains) and the fixed `rle_distance`. Filtered rows are dominated by runs
+     * of repeated pixels, which the second candidate finds without touching the table. After
+     * long stretches without a match, positions are skipped at a growing stride so noise
+     * passes through at memory speed.
+     *
+     * Blocks are written through @ref write_block, so runs of tokens that do not compress end
+     * up stored. With `final`, the last block ends the stream; otherwise the output ends on a
+     * block boundary (not byte aligned) and more blocks may follow.
+     */
+    inline void deflate_fast(const std::span<const uint8_t> data, bit_writer_t& w, const bool final,
+                             const deflate_fast_options_t& options = { }) noexcept
+    {
+        constexpr uint32_t hash_bits{ 15 };
+
+        std::vector<uint32_t> head(1u << hash_bits, 0u); // position + 1, 0 for empty
+        std::vector<lz_token_t> tokens;
+        tokens.reserve(options.block_tokens);
+
+        const uint8_t* const base{ data.data() };
+        const size_t n{ data.size() };
+        const uint32_t rle{ options.rle_distance };
+
+        const auto hash{
+            [](const uint32_t v) noexcept { return (v * 2654435761u) >> (32 - hash_bits); }
+        };
+
+        size_t block_start{ 0 };
+        size_t i{ 0 };
+        uint32_t misses{ 0 };
+
+        while (i < n)
+        {
+            uint32_t best_len{ 0 };
+            uint32_t best_dist{ 0 };
+
+            if (i + 4 <= n)
+            {
+                const auto max_len{ static_cast<uint32_t>(std::min<size_t>(k_max_match, n - i)) };
+
+                if (rle != 0 && i >= rle)
+                {
+                    best_len = match_length(base + i, base + i - rle, max_len);
+                    best_dist = rle;
+                }
+
+                const uint32_t h{ hash(load_u32(base + i)) };
+                const uint32_t candidate{ head[h] };
+                head[h] = static_cast<uint32_t>(i + 1);
+
+                if (candidate != 0)
+                {
+                    const size_t dist{ i - (candidate - 1) };
+                    if (dist <= k_deflate_window && dist != best_dist &&
+                        load_u32(base + candidate - 1) == load_u32(base + i))
+                    {
+                        const uint32_t len{ match_length(base + i, base + candidate - 1, max_len) };
+                        if (len > best_len)
+                        {
+                            best_len = len;
+                            best_dist = static_cast<uint32_t>(dist);
+                        }
+                    }
+                }
+            }
+
+            if (best_len >= k_min_match)
+            {
+                tokens.push_back({ static_cast<uint16_t>(best_len), static_cast<uint16_t>(best_dist) });
+
+                // Short matches index their interior so nearby repeats are found; long runs are skipped
+                if (best_len <= 16)
+                    for (size_t p{ i + 1 }; p < i + best_len && p + 4 <= n; ++p)
+                        head[hash(load_u32(base + p))] = static_cast<uint32_t>(p + 1);
+
+                i += best_len;
+                misses = 0;
+            }
+            else
+            {
+                const size_t step{ 1u + (misses++ >> 6) };
+                for (size_t end{ std::min(i + step, n) }; i < end; ++i)
+                    tokens.push_back({ 0, base[i] });
+            }
+
+            if (tokens.size() >= options.block_tokens)
+            {
+                write_block(w, tokens, data.subspan(block_start, i - block_start), false);
+                tokens.clear();
+                block_start = i;
+            }
+        }
+
+        if (!tokens.empty() || final)
+            write_block(w, tokens, data.subspan(block_start, i - block_start), final);
+    }
+
+    /// @brief zlib header (RFC 1950) for a 32 KiB window and the given FLEVEL (0 fastest .. 3 best).
+    inline void write_zlib_header(std::vector<uint8_t>& out, const uint32_t level) noexcept
+    {
+        constexpr uint32_t cmf{ 0x78 };
+        uint32_t flg{ level << 6 };
+        flg += 31 - (cmf << 8 | flg) % 31;
+
+        out.push_back(static_cast<uint8_t>(cmf));
+        out.push_back(static_cast<uint8_t>(flg));
+    }
+
+    inline void write_be_u32(std::vector<uint8_t>& out, const uint32_t v) noexcept
+    {
+        out.insert(out.end(), { static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16),
+                                static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) });
+    }
+} // namespace cpng
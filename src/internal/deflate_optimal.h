@@ -0,0 +1,483 @@
+//
+// Created by Zack Shrout on 3/29/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "deflate.h"
+#include "parallel.h"
+
+#include <cmath>
+#include <limits>
+
+namespace cpng {
+    struct deflate_optimal_options_t
+    {
+        uint32_t    iterations{ 15 };   // optimal parses per block, each priced with the last one's statistics
+        uint32_t    max_chain{ 4096 };  // hash chain candidates visited per position
+        uint32_t    max_blocks{ 15 };   // blocks each piece may be split into
+        uint32_t    threads{ 1 };       // pieces parsed in parallel
+    };
+
+    /// @brief Input bytes parsed together: one match cache, split into blocks independently of other pieces.
+    inline constexpr size_t k_optimal_piece_bytes{ 1u << 20 };
+
+    /**
+     * Every match worth considering at each position of a piece. The matches of position
+     * `begin + i` are `matches[first[i]..first[i + 1])`, by increasing length and distance:
+     * each is the closest match reaching its length, so a length L takes the distance of the
+     * first entry at least L long.
+     */
+    struct match_cache_t
+    {
+        size_t                      begin{ };
+        std::vector<uint32_t>       first;
+        std::vector<lz_token_t>     matches;
+        std::vector<uint16_t>       same;       // run of identical bytes starting at begin + i, capped
+    };
+
+    /**
+     * Fills `cache` for positions [begin, end) of `data`; matches may reach back into the 32 KiB
+     * before `begin` and run past `end`.
+     *
+     * Hash chains over 3-byte prefixes are walked from the closest candidate outwards. Runs of
+     * one byte value make those chains long and nearly useless, so once the best match covers
+     * the run at the current position, the walk switches to a second chain keyed by the run
+     * length as well (as zopfli does): only candidates in an equally long run can match further.
+     */
+    inline void find_matches(const std::span<const uint8_t> data, const size_t begin, const size_t end,
+                             const uint32_t max_chain, match_cache_t& cache)
+    {
+        constexpr uint32_t hash_bits{ 15 };
+        constexpr uint32_t hash_mask{ (1u << hash_bits) - 1 };
+        constexpr uint32_t window_mask{ k_deflate_window - 1 };
+
+        const uint8_t* const base{ data.data() };
+        const size_t n{ data.size() };
+        const size_t origin{ begin > k_deflate_window ? begin - k_deflate_window : 0 };
+        const size_t stop{ std::min(n, end + k_max_match) };
+
+        // Runs and hashes for [origin, stop); positions are stored as offset from origin + 1, 0 for none
+        std::vector<uint16_t> same(stop - origin);
+        for (size_t i{ stop }; i-- > origin;)
+        {
+            const bool repeats{ i + 1 < stop && base[i + 1] == base[i] };
+            same[i - origin] = repeats ? static_cast<uint16_t>(std::min(same[i + 1 - origin] + 1, 0xFFFF)) : 1;
+        }
+
+        std::vector<uint16_t> hash2(stop - origin);
+        std::vector<uint32_t> head(1u << hash_bits, 0u);
+        std::vector<uint32_t> head2(1u << hash_bits, 0u);
+        std::vector<uint32_t> prev(k_deflate_window, 0u);
+        std::vector<uint32_t> prev2(k_deflate_window, 0u);
+
+        const auto hash{
+            [&](const size_t i) noexcept {
+                return (static_cast<uint32_t>(base[i]) << 10 ^ static_cast<uint32_t>(base[i + 1]) << 5 ^
+                        base[i + 2]) & hash_mask;
+            }
+        };
+
+        const auto insert{
+            [&](const size_t i, const uint32_t h) noexcept {
+                const uint32_t h2{ (h ^ (same[i - origin] & 0xFFu) << 7) & hash_mask };
+                hash2[i - origin] = static_cast<uint16_t>(h2);
+
+                prev[i & window_mask] = head[h];
+                head[h] = static_cast<uint32_t>(i - origin + 1);
+                prev2[i & window_mask] = head2[h2];
+                head2[h2] = static_cast<uint32_t>(i - origin + 1);
+            }
+        };
+
+        for (size_t i{ origin }; i < begin && i + 3 <= n; ++i)
+            insert(i, hash(i));
+
+        cache.begin = begin;
+        cache.first.assign(end - begin + 1, 0);
+        cache.matches.clear();
+        cache.matches.reserve((end - begin) * 2);
+        cache.same.assign(same.begin() + static_cast<ptrdiff_t>(begin - origin),
+                          same.begin() + static_cast<ptrdiff_t>(end - origin));
+
+        for (size_t i{ begin }; i < end; ++i)
+        {
+            cache.first[i - begin] = static_cast<uint32_t>(cache.matches.size());
+            if (i + 3 > n) continue;
+
+            const auto max_len{ static_cast<uint32_t>(std::min<size_t>(k_max_match, n - i)) };
+            const uint32_t h{ hash(i) };
+
+            uint32_t best{ k_min_match - 1 };
+            bool run_chain{ false };
+            uint32_t node{ head[h] };
+
+            for (uint32_t hits{ 0 }; node != 0 && hits < max_chain; ++hits)
+            {
+                const size_t candidate{ origin + node - 1 };
+                const size_t distance{ i - candidate };
+                if (distance > k_deflate_window) break;
+
+                if (base[candidate + best] == base[i + best])
+                {
+                    if (const uint32_t len{ match_length(base + i, base + candidate, max_len) }; len > best)
+                    {
+                        cache.matches.push_back({ static_cast<uint16_t>(len), static_cast<uint16_t>(distance) });
+                        best = len;
+                        if (len == max_len) break;
+                    }
+                }
+
+                if (!run_chain && best >= same[i - origin] &&
+                    hash2[candidate - origin] == ((h ^ (same[i - origin] & 0xFFu) << 7) & hash_mask))
+                    run_chain = true;
+
+                const uint32_t next{ run_chain ? prev2[candidate & window_mask] : prev[candidate & window_mask] };
+                if (next == 0 || origin + next - 1 >= candidate) break; // slot reused by a newer position
+
+                node = next;
+            }
+
+            insert(i, h);
+        }
+
+        cache.first[end - begin] = static_cast<uint32_t>(cache.matches.size());
+    }
+
+    /// @brief Estimated bits per symbol under a block's statistics; lengths and distances include their extra bits.
+    struct symbol_costs_t
+    {
+        std::array<double, 256>             literal{ };
+        std::array<double, k_max_match + 1> length{ };
+        std::array<double, 30>              distance{ };
+    };
+
+    [[nodiscard]] inline symbol_costs_t costs_from_freqs(const block_freqs_t& f) noexcept
+    {
+        // Entropy, -log2(p); unseen symbols are priced as if seen once
+        const auto entropy{
+            [](const std::span<const uint32_t> freqs, const std::span<double> out) noexcept {
+                uint64_t total{ 0 };
+                for (const uint32_t v: freqs) total += v;
+
+                const double log_total{ std::log2(static_cast<double>(std::max<uint64_t>(total, 1))) };
+                for (size_t s{ 0 }; s < freqs.size(); ++s)
+                    out[s] = freqs[s] != 0 ? log_total - std::log2(static_cast<double>(freqs[s])) : log_total;
+            }
+        };
+
+        std::array<double, 286> lit{ };
+        std::array<double, 30> dist{ };
+        entropy(f.lit, lit);
+        entropy(f.dist, dist);
+
+        symbol_costs_t c{ };
+        std::copy_n(lit.begin(), 256, c.literal.begin());
+
+        for (uint32_t len{ k_min_match }; len <= k_max_match; ++len)
+            c.length[len] = lit[257 + k_length_code[len]] + length_extra[k_length_code[len]];
+
+        for (uint32_t d{ 0 }; d < 30; ++d)
+            c.distance[d] = dist[d] + dist_extra[d];
+
+        return c;
+    }
+
+    /// @brief Exact size of a block as @ref write_block would write it, block type bits included.
+    [[nodiscard]] inline uint64_t block_bits(const block_freqs_t& f, const size_t raw_bytes) noexcept
+    {
+        dynamic_header_t h{ };
+        build_dynamic_header(f, h);
+
+        const uint64_t dynamic_bits{ h.bits + block_payload_bits(f, h.lit_lengths.data(), h.dist_lengths.data()) };
+        const uint64_t fixed_bits{
+            block_payload_bits(f, k_fixed_codes.lit_lengths.data(), k_fixed_codes.dist_lengths.data())
+        };
+        const uint64_t stored_bits{ (raw_bytes + 5 * (raw_bytes / 65535 + 1)) * 8 + 7 };
+
+        return 3 + std::min({ dynamic_bits, fixed_bits, stored_bits });
+    }
+
+    /// @brief Greedy parse from the cache (longest match at every step); a starting point for the statistics.
+    inline void parse_greedy(const std::span<const uint8_t> data, const match_cache_t& cache, const size_t begin,
+                             const size_t end, std::vector<lz_token_t>& out)
+    {
+        out.clear();
+
+        for (size_t i{ begin }; i < end;)
+        {
+            const size_t at{ i - cache.begin };
+            const uint32_t first{ cache.first[at] };
+            const uint32_t last{ cache.first[at + 1] };
+
+            if (last != first && cache.matches[last - 1].length <= end - i)
+            {
+                out.push_back(cache.matches[last - 1]);
+                i += cache.matches[last - 1].length;
+            }
+            else
+            {
+                out.push_back({ 0, data[i] });
+                ++i;
+            }
+        }
+    }
+
+    /**
+     * Shortest path parse of [begin, end) under `costs`: every literal and every cached match
+     * length is a step, priced in bits. Long runs of one byte skip ahead a maximal match at a
+     * time instead of relaxing every length, as zopfli does.
+     */
+    inline void parse_optimal(const std::span<const uint8_t> data, const match_cache_t& cache,
+                              const symbol_costs_t& costs, const size_t begin, const size_t end,
+                              std::vector<double>& cost, std::vector<lz_token_t>& step,
+                              std::vector<lz_token_t>& out)
+    {
+        const size_t n{ end - begin };
+
+        cost.assign(n + 1, std::numeric_limits<double>::infinity());
+        step.assign(n + 1, { });
+        cost[0] = 0.0;
+
+        const double max_run_cost{ costs.length[k_max_match] + costs.distance[0] };
+
+        for (size_t k{ 0 }; k < n; ++k)
+        {
+            const size_t i{ begin + k };
+            const size_t at{ i - cache.begin };
+
+            // Inside a long run every position has a maximal match at distance 1
+            if (k > k_max_match + 1 && k + 2 * k_max_match + 1 < n && cache.same[at] > 2 * k_max_match &&
+                at >= k_max_match && cache.same[at - k_max_match] > k_max_match)
+            {
+                for (uint32_t r{ 0 }; r < k_max_match; ++r, ++k)
+                {
+                    cost[k + k_max_match] = cost[k] + max_run_cost;
+                    step[k + k_max_match] = { static_cast<uint16_t>(k_max_match), 1 };
+                }
+                --k;
+                continue;
+            }
+
+            const double here{ cost[k] };
+
+            if (const double c{ here + costs.literal[data[i]] }; c < cost[k + 1])
+            {
+                cost[k + 1] = c;
+                step[k + 1] = { 0, data[i] };
+            }
+
+            uint32_t len{ k_min_match };
+            const auto room{ static_cast<uint32_t>(std::min<size_t>(n - k, k_max_match)) };
+
+            for (uint32_t m{ cache.first[at] }; m < cache.first[at + 1] && len <= room; ++m)
+            {
+                const lz_token_t match{ cache.matches[m] };
+                const double base_cost{ here + costs.distance[distance_code(match.value)] };
+                const uint32_t top{ std::min<uint32_t>(match.length, room) };
+
+                for (; len <= top; ++len)
+                {
+                    if (const double c{ base_cost + costs.length[len] }; c < cost[k + len])
+                    {
+                        cost[k + len] = c;
+                        step[k + len] = { static_cast<uint16_t>(len), match.value };
+                    }
+                }
+            }
+        }
+
+        // Walk the cheapest path back from the end
+        out.clear();
+        for (size_t k{ n }; k > 0;)
+        {
+            const lz_token_t t{ step[k] };
+            out.push_back(t);
+            k -= t.length == 0 ? 1 : t.length;
+        }
+        std::ranges::reverse(out);
+    }
+
+    /**
+     * Block boundaries for the tokens of one piece, as token indices (first 0, last tokens.size()).
+     *
+     * The largest block is split where the two halves cost least, found by repeatedly narrowing
+     * a nine point search, and the split is kept only if it saves bits; until `max_blocks` are
+     * reached or nothing splits profitably.
+     */
+    inline std::vector<size_t> split_blocks(const std::span<const lz_token_t> tokens, const uint32_t max_blocks)
+    {
+        constexpr size_t min_block_tokens{ 1024 };
+
+        std::vector<size_t> offset(tokens.size() + 1, 0);
+        for (size_t t{ 0 }; t < tokens.size(); ++t)
+            offset[t + 1] = offset[t] + (tokens[t].length == 0 ? 1 : tokens[t].length);
+
+        const auto cost{
+            [&](const size_t a, const size_t b) noexcept {
+                return block_bits(count_block_freqs(tokens.subspan(a, b - a)), offset[b] - offset[a]);
+            }
+        };
+
+        struct range_t { size_t a; size_t b; bool done; };
+        std::vector<range_t> blocks{ { 0, tokens.size(), false } };
+
+        while (blocks.size() < max_blocks)
+        {
+            range_t* largest{ nullptr };
+            for (range_t& r: blocks)
+                if (!r.done && (largest == nullptr || r.b - r.a > largest->b - largest->a)) largest = &r;
+
+            if (largest == nullptr) break;
+
+            const size_t a{ largest->a };
+            const size_t b{ largest->b };
+
+            if (b - a < 2 * min_block_tokens)
+            {
+                largest->done = true;
+                continue;
+            }
+
+            size_t lo{ a + min_block_tokens };
+            size_t hi{ b - min_block_tokens };
+            size_t best{ lo };
+            uint64_t best_cost{ std::numeric_limits<uint64_t>::max() };
+
+            while (true)
+            {
+                constexpr size_t points{ 9 };
+                const size_t span{ hi - lo };
+                size_t best_point{ 0 };
+
+                for (size_t p{ 0 }; p < points && p <= span; ++p)
+                {
+                    const size_t s{ span <= points ? lo + p : lo + span * (p + 1) / (points + 1) };
+                    if (const uint64_t c{ cost(a, s) + cost(s, b) }; c < best_cost)
+                    {
+                        best_cost = c;
+                        best = s;
+                        best_point = p;
+                    }
+                }
+
+                if (span <= points) break;
+
+                // Narrow to the neighbours of the best point
+                const size_t next_lo{ best_point == 0 ? lo : lo + span * best_point / (points + 1) };
+                const size_t next_hi{ lo + span * (best_point + 2) / (points + 1) };
+                if (next_hi - next_lo >= span) break;
+
+                lo = next_lo;
+                hi = std::min(next_hi, hi);
+            }
+
+            if (best_cost < cost(a, b))
+            {
+                largest->b = best;
+                blocks.push_back({ best, b, false });
+            }
+            else
+            {
+                largest->done = true;
+            }
+        }
+
+        std::vector<size_t> bounds{ tokens.size() };
+        for (const range_t& r: blocks) bounds.push_back(r.a);
+        std::ranges::sort(bounds);
+
+        // Token indices to byte offsets
+        for (size_t& bound: bounds) bound = offset[bound];
+        return bounds;
+    }
+
+    /**
+     * Maximum-ratio DEFLATE in the style of zopfli, for offline use: many times slower than
+     * @ref deflate_fast.
+     *
+     * The input is cut into pieces of 1 MiB. Each piece gets a match cache, a greedy parse whose
+     * statistics split it into blocks, and then for every block a series of shortest path parses,
+     * each priced with the symbol statistics of the one before, keeping the smallest. Pieces are
+     * independent and run on `threads` threads; the output does not depend on the thread count.
+     *
+     * With `final`, the last block ends the stream; otherwise more blocks may follow.
+     */
+    inline void deflate_optimal(const std::span<const uint8_t> data, bit_writer_t& w, const bool final,
+                                const deflate_optimal_options_t& options = { })
+    {
+        struct block_t
+        {
+            size_t                      begin{ };
+            size_t                      end{ };
+            std::vector<lz_token_t>     tokens;
+        };
+
+        const auto piece_count{
+            static_cast<uint32_t>((data.size() + k_optimal_piece_bytes - 1) / k_optimal_piece_bytes) };
+        std::vector<std::vector<block_t>> pieces(piece_count);
+
+        parallel_for(piece_count, options.threads, [&](const uint32_t p) noexcept {
+            const size_t begin{ p * k_optimal_piece_bytes };
+            const size_t end{ std::min(begin + k_optimal_piece_bytes, data.size()) };
+
+            match_cache_t cache{ };
+            find_matches(data, begin, end, options.max_chain, cache);
+
+            std::vector<lz_token_t> greedy;
+            parse_greedy(data, cache, begin, end, greedy);
+            const std::vector<size_t> bounds{ split_blocks(greedy, options.max_blocks) };
+
+            std::vector<double> cost;
+            std::vector<lz_token_t> step;
+            std::vector<lz_token_t> trial;
+
+            for (size_t b{ 0 }; b + 1 < bounds.size(); ++b)
+            {
+                block_t block{ .begin = begin + bounds[b], .end = begin + bounds[b + 1], .tokens = { } };
+                const size_t raw_bytes{ block.end - block.begin };
+
+                parse_greedy(data, cache, block.begin, block.end, block.tokens);
+                block_freqs_t freqs{ count_block_freqs(block.tokens) };
+                uint64_t best_bits{ block_bits(freqs, raw_bytes) };
+                uint64_t last_bits{ 0 };
+
+                for (uint32_t it{ 0 }; it < options.iterations; ++it)
+                {
+                    parse_optimal(data, cache, costs_from_freqs(freqs), block.begin, block.end, cost, step, trial);
+
+                    freqs = count_block_freqs(trial);
+                    const uint64_t bits{ block_bits(freqs, raw_bytes) };
+
+                    if (bits < best_bits)
+                    {
+                        best_bits = bits;
+                        block.tokens = trial;
+                    }
+
+                    // The same statistics give the same parse again
+                    if (bits == last_bits) break;
+                    last_bits = bits;
+                }
+
+                pieces[p].push_back(std::move(block));
+            }
+        });
+
+        for (uint32_t p{ 0 }; p < piece_count; ++p)
+        {
+            for (size_t b{ 0 }; b < pieces[p].size(); ++b)
+            {
+                const block_t& block{ pieces[p][b] };
+                const bool last{ p + 1 == piece_count && b + 1 == pieces[p].size() };
+
+                write_block(w, block.tokens, data.subspan(block.begin, block.end - block.begin), final && last);
+            }
+
+            pieces[p] = { };
+        }
+
+        if (piece_count == 0 && final) write_block(w, { }, { }, true);
+    }
+} // namespace cpng
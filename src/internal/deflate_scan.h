@@ -0,0 +1,114 @@
+//
+// Created by Zack Shrout on 3/30/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/decode_cost.h"
+#include "inflate.h"
+
+namespace cpng {
+    /// @brief Counts the symbols of one Huffman coded block, up to and including end-of-block.
+    template <int LitLenBits, int DistBits>
+    [[nodiscard]] decode_error count_block_symbols(bit_reader_t& reader,
+                                                   const basic_huffman_table_t<LitLenBits>& lit_len,
+                                                   const basic_huffman_table_t<DistBits>& dist,
+                                                   decode_cost_t& cost) noexcept
+    {
+        while (true)
+        {
+            const int sym{ huffman_decode(reader, lit_len) };
+            if (sym < 0) return decode_error::invalid_idat_stream;
+
+            if (sym < 256)
+            {
+                ++cost.literals;
+                continue;
+            }
+
+            if (sym == 256) return decode_error::ok;
+
+            const int index{ sym - 257 };
+            if (index >= 29) return decode_error::invalid_idat_stream;
+
+            int len{ length_base[index] };
+            if (length_extra[index] > 0)
+            {
+                const std::optional<uint32_t> extra{ reader.get_bits(length_extra[index]) };
+                if (!extra) return decode_error::invalid_idat_stream;
+
+                len += static_cast<int>(*extra);
+            }
+
+            const int dist_sym{ huffman_decode(reader, dist) };
+            if (dist_sym < 0 || dist_sym >= 30) return decode_error::invalid_idat_stream;
+
+            if (dist_extra[dist_sym] > 0 && !reader.get_bits(dist_extra[dist_sym]))
+                return decode_error::invalid_idat_stream;
+
+            ++cost.matches;
+            cost.match_bytes += static_cast<uint64_t>(len);
+        }
+    }
+
+    /**
+     * Walks every block of a zlib stream, adding its blocks and symbols to `cost` without
+     * producing output. The Adler-32 is not checked.
+     */
+    [[nodiscard]] inline decode_error scan_deflate_blocks(const std::span<const uint8_t> zlib,
+                                                          decode_cost_t& cost) noexcept
+    {
+        if (zlib.size() < 6 || (zlib[0] & 0x0F) != 8 || (zlib[0] << 8 | zlib[1]) % 31 != 0)
+            return decode_error::invalid_idat_stream;
+
+        bit_reader_t reader{ };
+        reader.data = zlib.subspan(2, zlib.size() - 6);
+
+        // 64 KiB each; kept off the stack
+        std::vector<huffman_table_t> tables(2);
+
+        bool is_final{ false };
+        while (!is_final)
+        {
+            const std::optional<uint32_t> bfinal{ reader.get_bits(1) };
+            const std::optional<uint32_t> btype{ reader.get_bits(2) };
+            if (!bfinal || !btype) return decode_error::invalid_idat_stream;
+
+            is_final = *bfinal != 0;
+
+            if (*btype == 0)
+            {
+                reader.align_to_byte();
+
+                const std::optional<uint32_t> len{ reader.get_bits(16) };
+                const std::optional<uint32_t> nlen{ reader.get_bits(16) };
+                if (!len || !nlen || *len != (~*nlen & 0xFFFFu)) return decode_error::invalid_idat_stream;
+                if (reader.byte_pos + *len > reader.data.size()) return decode_error::invalid_idat_stream;
+
+                reader.byte_pos += *len;
+                ++cost.stored_blocks;
+                cost.stored_bytes += *len;
+            }
+            else if (*btype == 1)
+            {
+                ++cost.fixed_blocks;
+                if (count_block_symbols(reader, fixed_lit_len_table, fixed_dist_table, cost) != decode_error::ok)
+                    return decode_error::invalid_idat_stream;
+            }
+            else if (*btype == 2)
+            {
+                ++cost.dynamic_blocks;
+                if (read_dynamic_tables(reader, tables[0], tables[1]) != decode_error::ok ||
+                    count_block_symbols(reader, tables[0], tables[1], cost) != decode_error::ok)
+                    return decode_error::invalid_idat_stream;
+            }
+            else
+            {
+                return decode_error::invalid_idat_stream;
+            }
+        }
+
+        return decode_error::ok;
+    }
+} // namespace cpng
@@ -0,0 +1,22 @@
+//
+// Created by Zack Shrout on 4/3/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+
+namespace cpng {
+    /**
+     * Stores `record` in `diagnostics` (if the caller asked for them) and returns its error.
+     * The first failure recorded wins: inner stages know the most about what broke, and the
+     * outer ones that see the same error come later.
+     */
+    [[nodiscard]] constexpr decode_error report_failure(decode_diagnostics_t* diagnostics,
+                                                        const decode_diagnostics_t& record) noexcept
+    {
+        if (diagnostics && diagnostics->error == decode_error::ok) *diagnostics = record;
+        return record.error;
+    }
+} // namespace cpng
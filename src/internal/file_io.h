@@ -0,0 +1,121 @@
+//
+// Created by Zack Shrout on 3/25/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace cpng {
+    /**
+     * Read-only file with positional reads: one open, any number of pread-style reads, no
+     * stream state or buffering in between. Used where a handful of bytes are needed from
+     * many files and std::ifstream's setup cost would dominate.
+     */
+    class file_reader_t
+    {
+    public:
+        file_reader_t() = default;
+        ~file_reader_t() { close(); }
+
+        file_reader_t(const file_reader_t&) = delete;
+        file_reader_t& operator=(const file_reader_t&) = delete;
+
+        [[nodiscard]] bool open(const char* path) noexcept
+        {
+            close();
+
+#if defined(_WIN32)
+            _handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (_handle == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER size{ };
+            if (!GetFileSizeEx(_handle, &size))
+            {
+                close();
+                return false;
+            }
+
+            _size = static_cast<uint64_t>(size.QuadPart);
+#else
+            _fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (_fd < 0) return false;
+
+            struct stat st{ };
+            if (fstat(_fd, &st) != 0)
+            {
+                close();
+                return false;
+            }
+
+            _size = static_cast<uint64_t>(st.st_size);
+#endif
+
+            return true;
+        }
+
+        void close() noexcept
+        {
+#if defined(_WIN32)
+            if (_handle != INVALID_HANDLE_VALUE) CloseHandle(_handle);
+            _handle = INVALID_HANDLE_VALUE;
+#else
+            if (_fd >= 0) ::close(_fd);
+            _fd = -1;
+#endif
+            _size = 0;
+        }
+
+        [[nodiscard]] uint64_t size() const noexcept { return _size; }
+
+        /// @brief Reads up to out.size() bytes at `offset`; returns the byte count (short at end of file).
+        [[nodiscard]] size_t read_at(const uint64_t offset, const std::span<uint8_t> out) const noexcept
+        {
+            size_t done{ 0 };
+
+            while (done < out.size())
+            {
+#if defined(_WIN32)
+                OVERLAPPED at{ };
+                const uint64_t position{ offset + done };
+                at.Offset = static_cast<DWORD>(position);
+                at.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+                DWORD got{ 0 };
+                const DWORD want{ static_cast<DWORD>(std::min<size_t>(out.size() - done, 1u << 30)) };
+                if (!ReadFile(_handle, out.data() + done, want, &got, &at) || got == 0) break;
+#else
+                const ssize_t got{ pread(_fd, out.data() + done, out.size() - done, static_cast<off_t>(offset + done)) };
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) break;
+#endif
+                done += static_cast<size_t>(got);
+            }
+
+            return done;
+        }
+
+    private:
+#if defined(_WIN32)
+        HANDLE      _handle{ INVALID_HANDLE_VALUE };
+#else
+        int         _fd{ -1 };
+#endif
+        uint64_t    _size{ 0 };
+    };
+} // namespace cpng
@@ -9,23 +9,31 @@
 #include "fixed_tables.h"
 
 #include <array>
-#include <print>
 
 namespace cpng {
-    struct huffman_table_t
+    /**
+     * Decode table indexed by the next `Bits` input bits (LSB first), which must cover the
+     * longest code. Entry encoding: (len << 9) | symbol, len 1..15 and symbol 0..287;
+     * 0 marks bit patterns that start no code.
+     */
+    template <int Bits>
+    struct basic_huffman_table_t
     {
-        static constexpr int FAST_BITS{ 15 };
+        static constexpr int FAST_BITS{ Bits };
         static constexpr int FAST_MASK{ (1 << FAST_BITS) - 1 };
 
-        // Entry encoding: (len << 9) | symbol
-        // len: 1..15, symbol: 0..287 (fits in 9 bits)
         std::array<uint16_t, 1 << FAST_BITS> fast{ };
     };
 
+    /// @brief Table for dynamic block codes, which may be 15 bits long (64 KiB).
+    using huffman_table_t = basic_huffman_table_t<15>;
+
     // Build the canonical Huffman tables
-    [[nodiscard]] inline huffman_table_t build_huffman_table(const int* lengths, const int num_symbols) noexcept
+    template <int Bits = 15>
+    [[nodiscard]] constexpr basic_huffman_table_t<Bits> build_huffman_table(const int* lengths,
+                                                                            const int num_symbols) noexcept
     {
-        huffman_table_t t{ };
+        basic_huffman_table_t<Bits> t{ };
 
         // Count codes for each length
         std::array<int, 16> bl_count{ };
@@ -33,7 +41,7 @@ namespace cpng {
         {
             const int len{ lengths[i] };
 
-            if (len < 0 || len > 15) return t; // invalid -> table stays empty
+            if (len < 0 || len > Bits) return t; // invalid -> table stays empty
 
             if (len) ++bl_count[len];
         }
@@ -47,7 +55,7 @@ namespace cpng {
             next_code[bits] = code;
         }
 
-        // Fill the 15-bit decode table using bit-reversed codes (DEFLATE is LSB-first)
+        // Fill the decode table using bit-reversed codes (DEFLATE is LSB-first)
         for (int sym{ 0 }; sym < num_symbols; ++sym)
         {
             const int len{ lengths[sym] };
@@ -62,29 +70,108 @@ namespace cpng {
             // Because rev < (1<<len), stepping by (1<<len) enumerates all table entries
             // whose low 'len' bits match this code (LSB-first DEFLATE indexing).
             const int step{ 1 << len };
-            for (int j{ static_cast<int>(rev) }; j < 1 << huffman_table_t::FAST_BITS; j += step)
+            for (int j{ static_cast<int>(rev) }; j < 1 << Bits; j += step)
                 t.fast[j] = static_cast<uint16_t>((len << 9) | sym);
         }
 
         return t;
     }
 
-    inline const auto fixed_lit_len_table{
-        build_huffman_table(fixed_literal_lengths.data(), static_cast<int>(fixed_literal_lengths.size()))
+    // Fixed codes are at most 9 and 5 bits long: both tables are built by the compiler and take 1 KiB
+    inline constexpr auto fixed_lit_len_table{
+        build_huffman_table<9>(fixed_literal_lengths.data(), static_cast<int>(fixed_literal_lengths.size()))
+    };
+
+    inline constexpr auto fixed_dist_table{
+        build_huffman_table<5>(fixed_distance_lengths.data(), static_cast<int>(fixed_distance_lengths.size()))
+    };
+
+    enum class fixed_symbol_kind : uint8_t
+    {
+        literal,
+        length,
+        end_of_block,
+        invalid,    // length symbols 286 and 287 have codes but no meaning
+    };
+
+    /// @brief A fixed literal/length code, resolved to what the decoder needs from it.
+    struct fixed_literal_t
+    {
+        uint16_t            value;          // the byte for literals, the base length for lengths
+        uint8_t             code_bits;
+        uint8_t             extra_bits;
+        fixed_symbol_kind   kind;
+    };
+
+    /// @brief A fixed distance code; codes 30 and 31 are not valid.
+    struct fixed_distance_t
+    {
+        uint16_t    base;
+        uint8_t     extra_bits;
+        bool        valid;
+    };
+
+    /**
+     * Fixed-block tables indexed by the next 9 (5) input bits. Each entry carries the code
+     * length, the symbol's base value and its extra-bit count, so fixed blocks need no symbol
+     * lookups into length_base / dist_base at run time.
+     */
+    inline constexpr auto fixed_literal_symbols{
+        []() {
+            std::array<fixed_literal_t, 1 << 9> entries{ };
+            for (size_t i{ 0 }; i < entries.size(); ++i)
+            {
+                const int entry{ fixed_lit_len_table.fast[i] };
+                const int sym{ entry & 0x1FF };
+                auto& out{ entries[i] };
+
+                out.code_bits = static_cast<uint8_t>(entry >> 9);
+                if (sym < 256)
+                {
+                    out.value = static_cast<uint16_t>(sym);
+                    out.kind = fixed_symbol_kind::literal;
+                }
+                else if (sym == 256)
+                {
+                    out.kind = fixed_symbol_kind::end_of_block;
+                }
+                else if (sym < 257 + static_cast<int>(length_base.size()))
+                {
+                    out.value = length_base[sym - 257];
+                    out.extra_bits = length_extra[sym - 257];
+                    out.kind = fixed_symbol_kind::length;
+                }
+                else
+                {
+                    out.kind = fixed_symbol_kind::invalid;
+                }
+            }
+            return entries;
+        }()
     };
 
-    inline const auto fixed_dist_table{
-        build_huffman_table(fixed_distance_lengths.data(), static_cast<int>(fixed_distance_lengths.size()))
+    inline constexpr auto fixed_distance_symbols{
+        []() {
+            std::array<fixed_distance_t, 1 << 5> entries{ };
+            for (size_t i{ 0 }; i < entries.size(); ++i)
+            {
+                const int sym{ fixed_dist_table.fast[i] & 0x1FF };
+                if (sym < static_cast<int>(dist_base.size()))
+                    entries[i] = { dist_base[sym], dist_extra[sym], true };
+            }
+            return entries;
+        }()
     };
 
-    [[nodiscard]] inline int huffman_decode(bit_reader_t& reader, const huffman_table_t& table) noexcept
+    template <int Bits>
+    [[nodiscard]] inline int huffman_decode(bit_reader_t& reader, const basic_huffman_table_t<Bits>& table) noexcept
     {
         reader.fill_bits();
 
         if (reader.bits_in_buffer == 0) return -1;
 
-        // We can still peek 15 bits even if we have fewer; mask is safe.
-        const uint32_t peek{ reader.bit_buffer & huffman_table_t::FAST_MASK };
+        // We can still peek FAST_BITS bits even if we have fewer; mask is safe.
+        const uint32_t peek{ reader.bit_buffer & basic_huffman_table_t<Bits>::FAST_MASK };
         const uint16_t entry{ table.fast[peek] };
 
         const int len{ entry >> 9 };
@@ -0,0 +1,173 @@
+//
+// Created by Zack Shrout on 3/20/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+#include "transfer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace cpng {
+    /**
+     * Running content statistics, updated with each output row while it is still in cache.
+     * Flags that the source color type already answers are seeded up front and never scanned.
+     */
+    struct stats_state_t
+    {
+        float       min[4]{ 1.0f, 1.0f, 1.0f, 1.0f };  // normalized, RGBA order
+        float       max[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
+        bool        alpha_binary{ true };
+        bool        grayscale{ true };
+        bool        solid{ true };
+        bool        scan_alpha{ true };     // false when the source (or the output) has no alpha channel
+        bool        scan_gray{ true };      // false for grayscale sources
+        bool        have_first{ false };
+        uint8_t     first_pixel[16]{ };
+
+        void init(const uint8_t color_type, const uint32_t out_channels) noexcept
+        {
+            *this = { };
+            scan_alpha = (color_type == 4 || color_type == 6) && (out_channels == 2 || out_channels == 4);
+            scan_gray = color_type == 2 || color_type == 6;
+        }
+
+        [[nodiscard]] image_stats_t finish() const noexcept
+        {
+            image_stats_t stats{ };
+            stats.valid = true;
+            stats.grayscale = grayscale;
+            stats.solid = solid;
+
+            for (uint32_t c{ 0 }; c < 4; ++c)
+            {
+                stats.channel_min[c] = min[c];
+                stats.channel_max[c] = max[c];
+            }
+
+            if (!scan_alpha)
+            {
+                stats.channel_min[3] = 1.0f;
+                stats.channel_max[3] = 1.0f;
+            }
+
+            stats.alpha_opaque = stats.channel_min[3] == 1.0f;
+            stats.alpha_binary = !scan_alpha || alpha_binary;
+
+            return stats;
+        }
+    };
+
+    /// @brief Sample value of exactly 1.0 (half floats are stored as their bits).
+    template <typename T, bool IsHalf>
+    [[nodiscard]] constexpr T sample_one() noexcept
+    {
+        if constexpr (IsHalf)
+            return T{ 0x3C00 };
+        else if constexpr (std::is_floating_point_v<T>)
+            return T{ 1 };
+        else
+            return static_cast<T>(~T{ 0 });
+    }
+
+    template <typename T, bool IsHalf>
+    [[nodiscard]] constexpr float normalize_sample(const T v) noexcept
+    {
+        if constexpr (IsHalf)
+            return half_to_float(v);
+        else if constexpr (std::is_floating_point_v<T>)
+            return v;
+        else
+            return static_cast<float>(v) / static_cast<float>(sample_one<T, false>());
+    }
+
+    /// @brief Folds one output row (`Channels` samples of T per pixel) into the running statistics.
+    template <typename T, uint32_t Channels, bool IsHalf>
+    inline void accumulate_row_stats(const uint8_t* row, const uint32_t width, stats_state_t& state) noexcept
+    {
+        constexpr size_t px_bytes{ sizeof(T) * Channels };
+        constexpr bool has_alpha{ Channels == 2 || Channels == 4 };
+
+        constexpr T one{ sample_one<T, IsHalf>() };
+
+        if (width == 0) return;
+
+        if (!state.have_first)
+        {
+            std::memcpy(state.first_pixel, row, px_bytes);
+            state.have_first = true;
+        }
+
+        T lo[Channels], hi[Channels];
+        std::memcpy(lo, row, px_bytes);
+        std::memcpy(hi, row, px_bytes);
+
+        const bool check_alpha{ has_alpha && state.scan_alpha && state.alpha_binary };
+        const bool check_gray{ Channels == 4 && state.scan_gray && state.grayscale };
+        const bool check_solid{ state.solid };
+
+        bool binary{ true }, gray{ true }, solid{ true };
+
+        for (uint32_t x{ 0 }; x < width; ++x)
+        {
+            const uint8_t* p{ row + x * px_bytes };
+            T px[Channels];
+            std::memcpy(px, p, px_bytes);
+
+            for (uint32_t c{ 0 }; c < Channels; ++c)
+            {
+                lo[c] = std::min(lo[c], px[c]);
+                hi[c] = std::max(hi[c], px[c]);
+            }
+
+            if constexpr (has_alpha)
+                if (check_alpha) binary &= px[Channels - 1] == T{ 0 } || px[Channels - 1] == one;
+
+            if constexpr (Channels == 4)
+                if (check_gray) gray &= px[0] == px[1] && px[1] == px[2];
+
+            if (check_solid) solid &= std::memcmp(p, state.first_pixel, px_bytes) == 0;
+        }
+
+        state.alpha_binary &= binary;
+        state.grayscale &= gray;
+        state.solid &= solid;
+
+        // Half floats in 0..1 order like unsigned integers, so min/max above ran on the raw bits
+        const auto merge{
+            [&](const uint32_t dst, const uint32_t src) noexcept {
+                state.min[dst] = std::min(state.min[dst], normalize_sample<T, IsHalf>(lo[src]));
+                state.max[dst] = std::max(state.max[dst], normalize_sample<T, IsHalf>(hi[src]));
+            }
+        };
+
+        // Gray layouts are reported as gray replicated to RGB, like the RGBA8 expansion
+        for (uint32_t c{ 0 }; c < 3; ++c)
+            merge(c, Channels >= 3 ? c : 0);
+
+        if constexpr (has_alpha)
+            merge(3, Channels - 1);
+    }
+
+    using row_stats_fn = void (*)(const uint8_t* row, uint32_t width, stats_state_t& state) noexcept;
+
+    [[nodiscard]] constexpr row_stats_fn select_row_stats(const pixel_format format) noexcept
+    {
+        switch (format)
+        {
+            case pixel_format::rgba8:   return accumulate_row_stats<uint8_t, 4, false>;
+            case pixel_format::r8:      return accumulate_row_stats<uint8_t, 1, false>;
+            case pixel_format::rg8:     return accumulate_row_stats<uint8_t, 2, false>;
+            case pixel_format::rgba16:  return accumulate_row_stats<uint16_t, 4, false>;
+            case pixel_format::r16:     return accumulate_row_stats<uint16_t, 1, false>;
+            case pixel_format::rg16:    return accumulate_row_stats<uint16_t, 2, false>;
+            case pixel_format::rgba32f: return accumulate_row_stats<float, 4, false>;
+            case pixel_format::rgba16f: return accumulate_row_stats<uint16_t, 4, true>;
+            default:                    return nullptr;
+        }
+    }
+} // namespace cpng
@@ -5,11 +5,15 @@
 
 #pragma once
 
+#include "cpng/CarrotPNG.h"
+#include "adler32.h"
+#include "decode_stats.h"
+#include "diagnostics.h"
 #include "huffman.h"
-#include "defilter.h"
+#include "trace.h"
 
+#include <algorithm>
 #include <vector>
-#include <print>
 
 namespace cpng {
     [[nodiscard]] constexpr decode_error concat_idat(std::span<const std::span<const uint8_t>> idat_spans,
@@ -27,68 +31,234 @@ namespace cpng {
         return decode_error::ok;
     }
 
+    /// @brief Reads a dynamic block header (after BTYPE) and builds its literal/length and distance tables.
+    [[nodiscard]] inline decode_error read_dynamic_tables(bit_reader_t& reader, huffman_table_t& out_lit_len,
+                                                          huffman_table_t& out_dist) noexcept
+    {
+        // 1. Read HLIT, HDIST, HCLEN
+        auto hlit_opt{ reader.get_bits(5) };
+        auto hdist_opt{ reader.get_bits(5) };
+        auto hclen_opt{ reader.get_bits(4) };
+
+        if (!hlit_opt || !hdist_opt || !hclen_opt)
+            return decode_error::invalid_idat_stream;
+
+        const int n_lit_len{ static_cast<int>(*hlit_opt) + 257 }; // 257..286
+        const int n_dist{ static_cast<int>(*hdist_opt) + 1 }; // 1..30
+        const int n_clen{ static_cast<int>(*hclen_opt) + 4 }; // 4..19
+
+        if (n_lit_len > 286 || n_dist > 30 || n_clen > 19)
+            return decode_error::invalid_idat_stream;
+
+        // 2. Read code lengths for code-length alphabet (in weird order)
+        std::array<uint8_t, 19> clen_lengths{ }; // zero-initialized
+
+        for (int i = 0; i < n_clen; ++i)
+        {
+            constexpr std::array<int, 19> clen_order{
+                16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+            };
+            auto len_opt = reader.get_bits(3);
+
+            if (!len_opt) return decode_error::invalid_idat_stream;
+
+            clen_lengths[clen_order[i]] = static_cast<uint8_t>(*len_opt);
+        }
+
+        std::array<int, 19> clen_lengths_int{ };
+        std::copy(clen_lengths.begin(), clen_lengths.end(), clen_lengths_int.begin());
+
+        // 3. Build small Huffman table for code lengths (at most 7 bits long, so 128 entries cover them)
+        const auto clen_table{ build_huffman_table<7>(clen_lengths_int.data(), 19) };
+
+        // 4. Decode the actual lit/len + dist lengths
+        // Fixed-size scratch: one header per block, so no heap traffic for it
+        std::array<uint8_t, 286 + 30> all_lengths{ };
+        const size_t total_lengths{ static_cast<size_t>(n_lit_len + n_dist) };
+        size_t idx{ 0 };
+        uint8_t prev_len{ 0 };
+
+        while (idx < total_lengths)
+        {
+            int sym{ huffman_decode(reader, clen_table) };
+            if (sym < 0) return decode_error::invalid_idat_stream;
+
+            if (sym < 16)
+            {
+                // literal length
+                all_lengths[idx++] = static_cast<uint8_t>(sym);
+                prev_len = static_cast<uint8_t>(sym);
+            }
+            else if (sym == 16)
+            {
+                if (idx == 0) return decode_error::invalid_idat_stream; // no previous
+
+                auto extra_opt{ reader.get_bits(2) };
+                if (!extra_opt) return decode_error::invalid_idat_stream;
+
+                int repeat{ 3 + static_cast<int>(*extra_opt) }; // 3..6
+
+                for (int r{ 0 }; r < repeat && idx < total_lengths; ++r)
+                    all_lengths[idx++] = prev_len;
+            }
+            else if (sym == 17)
+            {
+                auto extra_opt{ reader.get_bits(3) };
+                if (!extra_opt) return decode_error::invalid_idat_stream;
+
+                int repeat{ 3 + static_cast<int>(*extra_opt) }; // 3..10
+
+                for (int r{ 0 }; r < repeat && idx < total_lengths; ++r)
+                    all_lengths[idx++] = 0;
+
+                prev_len = 0;
+            }
+            else if (sym == 18)
+            {
+                auto extra_opt{ reader.get_bits(7) };
+                if (!extra_opt) return decode_error::invalid_idat_stream;
+
+                int repeat{ 11 + static_cast<int>(*extra_opt) }; // 11..138
+
+                for (int r{ 0 }; r < repeat && idx < total_lengths; ++r)
+                    all_lengths[idx++] = 0;
+
+                prev_len = 0;
+            }
+            else
+            {
+                return decode_error::invalid_idat_stream; // impossible
+            }
+        }
+
+        // 5. Split into lit/len and distance lengths
+        std::span<const uint8_t> lit_len_lengths(all_lengths.data(), n_lit_len);
+        std::span<const uint8_t> dist_lengths(all_lengths.data() + n_lit_len, n_dist);
+
+        // Convert to int[] for build
+        constexpr int MAX_LIT_LEN{ 288 };
+        std::array<int, MAX_LIT_LEN> lit_len_int{ }; // pad with 0s
+        constexpr int MAX_DIST{ 30 };
+        std::array<int, MAX_DIST> dist_int{ };
+
+        std::copy(lit_len_lengths.begin(), lit_len_lengths.end(), lit_len_int.begin());
+        std::copy(dist_lengths.begin(), dist_lengths.end(), dist_int.begin());
+
+        // 6. Build the two tables
+        out_lit_len = build_huffman_table(lit_len_int.data(), MAX_LIT_LEN);
+        out_dist = build_huffman_table(dist_int.data(), MAX_DIST);
+
+        return decode_error::ok;
+    }
+
+    /// @brief How `expected_size` bounds the output of @ref inflate_idat.
+    enum class inflate_size : uint8_t
+    {
+        exact,      // at least expected_size bytes; up to inflate_trailing_slack more are dropped, beyond that fails
+        prefix,     // stop once expected_size bytes are out; the rest of the stream is not read
+        at_most,    // any length below expected_size (ancillary chunk payloads); reaching it is an error
+    };
+
+    /// Bytes an exact-size stream may run past the image before it is rejected, so that a small IDAT
+    /// expanding to gigabytes fails early instead of being inflated in full and then trimmed.
+    inline constexpr size_t inflate_trailing_slack{ 32768 };
+
+    /**
+     * Inflates a zlib stream. `stats` (see decode_stats.h) counts blocks, table builds,
+     * literals and matches, and times the block loop and the Adler-32 check separately.
+     * Each block is a trace zone (see trace.h). A failure is described in `diagnostics`
+     * when given (see diagnostics.h).
+     */
+    template <typename Stats>
     [[nodiscard]] constexpr decode_error inflate_idat(std::span<const uint8_t> zlib_data,
                                                       std::vector<uint8_t>& out_decompressed,
-                                                      const size_t expected_size, uint32_t width, uint32_t height,
-                                                      uint8_t bit_depth, uint8_t color_type) noexcept
+                                                      const size_t expected_size, const inflate_size mode,
+                                                      Stats& stats,
+                                                      decode_diagnostics_t* diagnostics = nullptr) noexcept
     {
-        if (zlib_data.size() < 6) return decode_error::invalid_idat_stream;
+        const bool prefix_only{ mode == inflate_size::prefix };
+
+        bit_reader_t reader{ };
+        uint32_t block_index{ 0 };
+        uint64_t symbol_index{ 0 };
+
+        // Error paths only: records the reader position and progress, then fails
+        const auto fail = [&](const char* reason) noexcept {
+            const size_t bit_pos{ reader.byte_pos * 8 - reader.bits_in_buffer };
+
+            return report_failure(diagnostics, {
+                .error = decode_error::invalid_idat_stream,
+                .stage = decode_stage::inflate,
+                .reason = reason,
+                .byte_offset = 2 + bit_pos / 8, // past the zlib header
+                .bit_offset = static_cast<uint8_t>(bit_pos % 8),
+                .block_index = block_index,
+                .symbol_index = symbol_index,
+                .expected_size = expected_size,
+                .actual_size = out_decompressed.size(),
+            });
+        };
+
+        if (zlib_data.size() < 6) return fail("zlib stream shorter than its header and trailer");
 
         const uint8_t cmf{ zlib_data[0] };
         const uint8_t flg{ zlib_data[1] };
 
-        if ((cmf & 0x0F) != 8) return decode_error::invalid_idat_stream;
+        if ((cmf & 0x0F) != 8) return fail("zlib compression method is not deflate");
 
         uint16_t check{ static_cast<uint16_t>(static_cast<uint16_t>(cmf) << 8 | flg) };
 
-        if (check % 31 != 0) return decode_error::invalid_idat_stream;
-        if (flg & 0x20) return decode_error::invalid_idat_stream; // no dict
+        if (check % 31 != 0) return fail("zlib header check bits");
+        if (flg & 0x20) return fail("zlib preset dictionary");
 
         std::span<const uint8_t> deflate_data{ zlib_data.begin() + 2, zlib_data.size() - 6 };
-
-        bit_reader_t reader{ };
         reader.data = deflate_data;
 
         out_decompressed.clear();
-        out_decompressed.reserve(expected_size);
+
+        // An upper bound is usually far above the real size; let the vector grow instead
+        out_decompressed.reserve(mode == inflate_size::at_most ? std::min(expected_size, zlib_data.size() * 4)
+                                                               : expected_size);
+
+        const uint64_t inflate_start{ stats.now() };
 
         while (true)
         {
             std::optional<uint32_t> bfinal_opt{ reader.get_bits(1) };
 
-            if (!bfinal_opt)
-            {
-                std::println(stderr, "Block header: not enough bits for BFINAL");
-                return decode_error::invalid_idat_stream;
-            }
+            if (!bfinal_opt) return fail("stream ends before BFINAL");
 
             const bool is_final{ *bfinal_opt != 0 };
 
             std::optional<uint32_t> btype_opt{ reader.get_bits(2) };
 
-            if (!btype_opt)
-            {
-                std::println(stderr, "Block header: not enough bits for BTYPE");
-                return decode_error::invalid_idat_stream;
-            }
+            if (!btype_opt) return fail("stream ends before BTYPE");
+
+            constexpr const char* block_zones[]{
+                "cpng inflate stored block", "cpng inflate fixed block", "cpng inflate dynamic block",
+                "cpng inflate invalid block",
+            };
+            const trace_zone_t block_zone{ block_zones[*btype_opt & 3] };
+            symbol_index = 0;
 
             if (*btype_opt == 0) // stored (uncompressed)
             {
+                stats.record([](decode_stats_t& out) noexcept { ++out.stored_blocks; });
                 reader.align_to_byte();
 
                 std::optional<uint32_t> len_opt{ reader.get_bits(16) };
-                if (!len_opt) return decode_error::invalid_idat_stream;
+                if (!len_opt) return fail("stream ends before stored LEN");
 
                 std::optional<uint32_t> nlen_opt{ reader.get_bits(16) };
-                if (!nlen_opt) return decode_error::invalid_idat_stream;
+                if (!nlen_opt) return fail("stream ends before stored NLEN");
 
                 const uint16_t len{ static_cast<uint16_t>(*len_opt) };
                 const uint16_t nlen{ static_cast<uint16_t>(*nlen_opt) };
 
-                if (len != static_cast<uint16_t>(~nlen)) return decode_error::invalid_idat_stream;
+                if (len != static_cast<uint16_t>(~nlen)) return fail("stored LEN does not match NLEN");
 
                 if (reader.byte_pos + len > deflate_data.size())
-                    return decode_error::invalid_idat_stream;
+                    return fail("stored block runs past the stream");
 
                 out_decompressed.insert(out_decompressed.end(), deflate_data.begin() + reader.byte_pos,
                                         deflate_data.begin() + reader.byte_pos + len);
@@ -96,207 +266,107 @@ namespace cpng {
             }
             else if (*btype_opt == 1) // fixed Huffman
             {
+                stats.record([](decode_stats_t& out) noexcept { ++out.fixed_blocks; });
+
+                // Runs to the end-of-block code like the dynamic case: stopping at expected_size would
+                // leave the reader mid-block whenever a later (empty or trailing) block follows.
+                // The baked tables give code length, base and extra bits in one lookup; a refill keeps
+                // at least 24 bits buffered, which covers a length code with its extra bits (14) and
+                // a distance code with its extra bits (18).
                 while (true)
                 {
-                    const int sym{ huffman_decode(reader, fixed_lit_len_table) };
+                    if (prefix_only && out_decompressed.size() >= expected_size) break;
+                    if (mode == inflate_size::at_most && out_decompressed.size() >= expected_size)
+                        return fail("output reaches the size limit");
+                    if (mode == inflate_size::exact && out_decompressed.size() > expected_size + inflate_trailing_slack)
+                        return fail("output runs past the image data");
 
-                    if (sym < 0)
-                    {
-                        if (out_decompressed.size() < expected_size)
-                        {
-                            std::println(stderr, "Premature EOF: got {} < {}", out_decompressed.size(), expected_size);
-                            return decode_error::invalid_idat_stream;
-                        }
+                    reader.fill_bits();
 
-                        break;
-                    }
+                    const fixed_literal_t lit{ fixed_literal_symbols[reader.bit_buffer & 0x1FF] };
+                    if (lit.code_bits > reader.bits_in_buffer) return fail("invalid or truncated literal/length code");
 
-                    if (sym == 256) break;
+                    reader.bit_buffer >>= lit.code_bits;
+                    reader.bits_in_buffer -= lit.code_bits;
 
-                    if (sym < 256)
+                    if (lit.kind == fixed_symbol_kind::literal)
                     {
-                        out_decompressed.push_back(static_cast<uint8_t>(sym));
-
-                        if (out_decompressed.size() >= expected_size) break;
+                        out_decompressed.push_back(static_cast<uint8_t>(lit.value));
+                        stats.on_literal();
+                        ++symbol_index;
+                        continue;
                     }
-                    else // length code 257..285
-                    {
-                        const int idx{ sym - 257 };
-                        if (idx >= 29) return decode_error::invalid_idat_stream;
 
-                        int len{ length_base[idx] };
-                        if (length_extra[idx])
-                        {
-                            std::optional<uint32_t> ex_opt{ reader.get_bits(length_extra[idx]) };
-                            if (!ex_opt) return decode_error::invalid_idat_stream;
+                    if (lit.kind == fixed_symbol_kind::end_of_block) break;
+                    if (lit.kind == fixed_symbol_kind::invalid) return fail("invalid length code");
 
-                            len += static_cast<int>(*ex_opt);
-                        }
+                    if (lit.extra_bits > reader.bits_in_buffer) return fail("stream ends in length extra bits");
 
-                        const int dist_sym{ huffman_decode(reader, fixed_dist_table) };
-                        if (dist_sym < 0 || dist_sym >= 30) return decode_error::invalid_idat_stream;
+                    const uint32_t len{ lit.value + (reader.bit_buffer & ((1u << lit.extra_bits) - 1u)) };
+                    reader.bit_buffer >>= lit.extra_bits;
+                    reader.bits_in_buffer -= lit.extra_bits;
 
-                        int dist{ dist_base[dist_sym] };
-                        if (dist_extra[dist_sym])
-                        {
-                            std::optional<uint32_t> ex_opt{ reader.get_bits(dist_extra[dist_sym]) };
-                            if (!ex_opt) return decode_error::invalid_idat_stream;
+                    reader.fill_bits();
 
-                            dist += static_cast<int>(*ex_opt);
-                        }
+                    const fixed_distance_t dist_code{ fixed_distance_symbols[reader.bit_buffer & 0x1F] };
+                    if (reader.bits_in_buffer < 5 || !dist_code.valid)
+                        return fail("invalid or truncated distance code");
 
-                        if (dist > static_cast<int>(out_decompressed.size()))
-                            return decode_error::invalid_idat_stream;
+                    reader.bit_buffer >>= 5;
+                    reader.bits_in_buffer -= 5;
 
-                        if (static_cast<int64_t>(out_decompressed.size()) < dist)
-                        {
-                            std::println(stderr, "Invalid distance: size={}, dist={}", out_decompressed.size(), dist);
-                            return decode_error::invalid_idat_stream;
-                        }
+                    if (dist_code.extra_bits > reader.bits_in_buffer)
+                        return fail("stream ends in distance extra bits");
 
-                        size_t dst_pos{ out_decompressed.size() };
+                    const size_t dist{ dist_code.base + (reader.bit_buffer & ((1u << dist_code.extra_bits) - 1u)) };
+                    reader.bit_buffer >>= dist_code.extra_bits;
+                    reader.bits_in_buffer -= dist_code.extra_bits;
 
-                        for (int i{ 0 }; i < len; ++i)
-                        {
-                            const size_t src_pos{ dst_pos - dist };
-                            out_decompressed.push_back(out_decompressed[src_pos]);
-                            ++dst_pos;
-                        }
-
-                        if (out_decompressed.size() >= expected_size) break;
-                    }
-                }
-            }
-            else if (*btype_opt == 2) // dynamic Huffman
-            {
-                // 1. Read HLIT, HDIST, HCLEN
-                auto hlit_opt{ reader.get_bits(5) };
-                auto hdist_opt{ reader.get_bits(5) };
-                auto hclen_opt{ reader.get_bits(4) };
-
-                if (!hlit_opt || !hdist_opt || !hclen_opt)
-                    return decode_error::invalid_idat_stream;
-
-                const int n_lit_len{ static_cast<int>(*hlit_opt) + 257 }; // 257..286
-                const int n_dist{ static_cast<int>(*hdist_opt) + 1 }; // 1..30
-                const int n_clen{ static_cast<int>(*hclen_opt) + 4 }; // 4..19
-
-                if (n_lit_len > 286 || n_dist > 30 || n_clen > 19)
-                    return decode_error::invalid_idat_stream;
+                    if (dist > out_decompressed.size())
+                        return fail("distance reaches before the start of the output");
 
-                // 2. Read code lengths for code-length alphabet (in weird order)
-                std::array<uint8_t, 19> clen_lengths{ }; // zero-initialized
-
-                for (int i = 0; i < n_clen; ++i)
-                {
-                    constexpr std::array<int, 19> clen_order{
-                        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
-                    };
-                    auto len_opt = reader.get_bits(3);
-
-                    if (!len_opt) return decode_error::invalid_idat_stream;
-
-                    clen_lengths[clen_order[i]] = static_cast<uint8_t>(*len_opt);
-                }
-
-                std::array<int, 19> clen_lengths_int{ };
-                std::copy(clen_lengths.begin(), clen_lengths.end(), clen_lengths_int.begin());
-
-                // 3. Build small Huffman table for code lengths
-                huffman_table_t clen_table{ build_huffman_table(clen_lengths_int.data(), 19) };
-
-                // 4. Decode the actual lit/len + dist lengths
-                std::vector<uint8_t> all_lengths(n_lit_len + n_dist, 0);
-                size_t idx{ 0 };
-                uint8_t prev_len{ 0 };
-
-                while (idx < all_lengths.size())
-                {
-                    int sym{ huffman_decode(reader, clen_table) };
-                    if (sym < 0) return decode_error::invalid_idat_stream;
+                    stats.on_match(len);
+                    size_t dst_pos{ out_decompressed.size() };
 
-                    if (sym < 16)
+                    for (uint32_t i{ 0 }; i < len; ++i)
                     {
-                        // literal length
-                        all_lengths[idx++] = static_cast<uint8_t>(sym);
-                        prev_len = static_cast<uint8_t>(sym);
+                        const size_t src_pos{ dst_pos - dist };
+                        out_decompressed.push_back(out_decompressed[src_pos]);
+                        ++dst_pos;
                     }
-                    else if (sym == 16)
-                    {
-                        if (idx == 0) return decode_error::invalid_idat_stream; // no previous
-
-                        auto extra_opt{ reader.get_bits(2) };
-                        if (!extra_opt) return decode_error::invalid_idat_stream;
-
-                        int repeat{ 3 + static_cast<int>(*extra_opt) }; // 3..6
-
-                        for (int r{ 0 }; r < repeat && idx < all_lengths.size(); ++r)
-                            all_lengths[idx++] = prev_len;
-                    }
-                    else if (sym == 17)
-                    {
-                        auto extra_opt{ reader.get_bits(3) };
-                        if (!extra_opt) return decode_error::invalid_idat_stream;
-
-                        int repeat{ 3 + static_cast<int>(*extra_opt) }; // 3..10
-
-                        for (int r{ 0 }; r < repeat && idx < all_lengths.size(); ++r)
-                            all_lengths[idx++] = 0;
-
-                        prev_len = 0;
-                    }
-                    else if (sym == 18)
-                    {
-                        auto extra_opt{ reader.get_bits(7) };
-                        if (!extra_opt) return decode_error::invalid_idat_stream;
-
-                        int repeat{ 11 + static_cast<int>(*extra_opt) }; // 11..138
-
-                        for (int r{ 0 }; r < repeat && idx < all_lengths.size(); ++r)
-                            all_lengths[idx++] = 0;
 
-                        prev_len = 0;
-                    }
-                    else
-                    {
-                        return decode_error::invalid_idat_stream; // impossible
-                    }
+                    ++symbol_index;
                 }
+            }
+            else if (*btype_opt == 2) // dynamic Huffman
+            {
+                huffman_table_t lit_len_table{ };
+                huffman_table_t dist_table{ };
 
-                // 5. Split into lit/len and distance lengths
-                std::span<const uint8_t> lit_len_lengths(all_lengths.data(), n_lit_len);
-                std::span<const uint8_t> dist_lengths(all_lengths.data() + n_lit_len, n_dist);
-
-                // Convert to int[] for build
-                constexpr int MAX_LIT_LEN{ 288 };
-                std::vector<int> lit_len_int(MAX_LIT_LEN, 0); // pad with 0s
-                constexpr int MAX_DIST{ 30 };
-                std::vector<int> dist_int(MAX_DIST, 0);
-
-                std::copy(lit_len_lengths.begin(), lit_len_lengths.end(), lit_len_int.begin());
-                std::copy(dist_lengths.begin(), dist_lengths.end(), dist_int.begin());
-
-                // 6. Build the two tables
-                huffman_table_t lit_len_table{ build_huffman_table(lit_len_int.data(), MAX_LIT_LEN) };
-                huffman_table_t dist_table{ build_huffman_table(dist_int.data(), MAX_DIST) };
+                if (read_dynamic_tables(reader, lit_len_table, dist_table) != decode_error::ok)
+                    return fail("invalid dynamic Huffman tables");
 
-                // 7. Now decode using these tables — almost identical to fixed case
-                int symbols_decoded{ 0 };
+                stats.record([](decode_stats_t& out) noexcept {
+                    ++out.dynamic_blocks;
+                    out.huffman_table_builds += 3; // code lengths, literal/length, distance
+                });
 
+                // Now decode using these tables — almost identical to fixed case
                 while (true)
                 {
-                    int sym{ huffman_decode(reader, lit_len_table) };
+                    if (prefix_only && out_decompressed.size() >= expected_size) break;
+                    if (mode == inflate_size::at_most && out_decompressed.size() >= expected_size)
+                        return fail("output reaches the size limit");
+                    if (mode == inflate_size::exact && out_decompressed.size() > expected_size + inflate_trailing_slack)
+                        return fail("output runs past the image data");
 
-                    if (sym < 0)
-                    {
-                        std::println("Decode failed at symbol {} ({} bytes so far)", symbols_decoded,
-                                     out_decompressed.size());
-                        return decode_error::invalid_idat_stream;
-                    }
+                    int sym{ huffman_decode(reader, lit_len_table) };
+                    if (sym < 0) return fail("invalid or truncated literal/length code");
 
                     if (sym < 256)
                     {
                         out_decompressed.push_back(static_cast<uint8_t>(sym));
+                        stats.on_literal();
                     }
                     else if (sym == 256)
                     {
@@ -305,52 +375,35 @@ namespace cpng {
                     else // length code 257–285
                     {
                         const int index{ sym - 257 };
-                        if (index >= 29)
-                        {
-                            std::println("Invalid length code {} at symbol {}", sym, symbols_decoded);
-                            return decode_error::invalid_idat_stream;
-                        }
+                        if (index >= 29) return fail("invalid length code");
 
                         int len{ length_base[index] };
                         if (length_extra[index] > 0)
                         {
                             auto ex_opt{ reader.get_bits(length_extra[index]) };
-                            if (!ex_opt)
-                            {
-                                std::println("Length extra underflow at symbol {} (need {} bits)", symbols_decoded,
-                                             length_extra[index]);
-                                return decode_error::invalid_idat_stream;
-                            }
+                            if (!ex_opt) return fail("stream ends in length extra bits");
+
                             len += static_cast<int>(*ex_opt);
                         }
 
                         // Distance
                         int dist_sym{ huffman_decode(reader, dist_table) };
-                        if (dist_sym < 0 || dist_sym >= 30)
-                        {
-                            std::println("Distance decode failed after length at symbol {}", symbols_decoded);
-                            return decode_error::invalid_idat_stream;
-                        }
+                        if (dist_sym < 0 || dist_sym >= 30) return fail("invalid or truncated distance code");
 
                         int dist{ dist_base[dist_sym] };
                         if (dist_extra[dist_sym] > 0)
                         {
                             auto ex_opt{ reader.get_bits(dist_extra[dist_sym]) };
-                            if (!ex_opt)
-                            {
-                                std::println("Distance extra underflow after length at symbol {}", symbols_decoded);
-                                return decode_error::invalid_idat_stream;
-                            }
+                            if (!ex_opt) return fail("stream ends in distance extra bits");
+
                             dist += static_cast<int>(*ex_opt);
                         }
 
                         // Safety: distance too large
                         if (dist > static_cast<int>(out_decompressed.size()))
-                        {
-                            std::println("Invalid distance {} > current size {} at symbol {}", dist,
-                                         out_decompressed.size(), symbols_decoded);
-                            return decode_error::invalid_idat_stream;
-                        }
+                            return fail("distance reaches before the start of the output");
+
+                        stats.on_match(static_cast<uint32_t>(len));
 
                         for (int i{ 0 }; i < len; ++i)
                         {
@@ -359,15 +412,33 @@ namespace cpng {
                         }
                     }
 
-                    symbols_decoded++;
+                    ++symbol_index;
                 }
             }
             else
             {
-                return decode_error::invalid_idat_stream;
+                return fail("reserved block type 3");
             }
 
+            trace_counter("cpng inflated bytes", static_cast<int64_t>(out_decompressed.size()));
+
             if (is_final) break;
+
+            ++block_index;
+
+            // Only the first `expected_size` bytes were requested; the rest of the stream is skipped.
+            if (prefix_only && out_decompressed.size() >= expected_size) break;
+        }
+
+        stats.add_time(&decode_stats_t::inflate_ns, inflate_start);
+
+        if (prefix_only)
+        {
+            // The trailer cannot be verified without inflating everything, so Adler-32 is skipped.
+            if (out_decompressed.size() < expected_size) return fail("stream ends before the requested prefix");
+
+            out_decompressed.resize(expected_size);
+            return decode_error::ok;
         }
 
         // ───────────────────────────────────────────────────────────────
@@ -379,15 +450,9 @@ namespace cpng {
         if (reader.bits_in_buffer > 0)
             consumed_bytes += 1;
 
-        if (consumed_bytes > deflate_data.size() + 1)
-        {
-            std::println(stderr, "Severe over-consume: byte_pos={}, bits_left={}", reader.byte_pos,
-                         reader.bits_in_buffer);
-            return decode_error::invalid_idat_stream;
-        }
+        if (consumed_bytes > deflate_data.size() + 1) return fail("deflate data runs into the Adler-32 trailer");
 
         // Adler-32 verification (source of truth)
-        if (zlib_data.size() < 4) return decode_error::invalid_idat_stream;
 
         const uint32_t adler_expected{
             static_cast<uint32_t>(zlib_data[zlib_data.size() - 4]) << 24 |
@@ -396,36 +461,42 @@ namespace cpng {
             static_cast<uint32_t>(zlib_data[zlib_data.size() - 1])
         };
 
-        uint32_t s1{ 1 };
-        uint32_t s2{ 0 };
-        for (const uint8_t b: out_decompressed)
-        {
-            s1 = (s1 + b) % 65521;
-            s2 = (s2 + s1) % 65521;
-        }
+        const uint64_t adler_start{ stats.now() };
+        const uint32_t adler_computed{ adler32(out_decompressed) };
+        stats.add_time(&decode_stats_t::adler_ns, adler_start);
 
-        if (const uint32_t adler_computed{ s2 << 16 | s1 }; adler_computed != adler_expected)
+        if (adler_computed != adler_expected)
         {
-            std::println(stderr, "Alder-32 mismatch: computed={}, expected={}", adler_computed, adler_expected);
-            return decode_error::invalid_idat_stream;
+            return report_failure(diagnostics, {
+                .error = decode_error::invalid_idat_stream,
+                .stage = decode_stage::adler32,
+                .reason = "Adler-32 mismatch",
+                .byte_offset = zlib_data.size() - 4,
+                .expected_size = expected_size,
+                .actual_size = out_decompressed.size(),
+            });
         }
 
         // Final size handling
-        if (out_decompressed.size() < expected_size)
-        {
-            std::println(stderr, "Underrun: got {}, expected {}", out_decompressed.size(), expected_size);
-            return decode_error::invalid_idat_stream;
-        }
+        if (mode == inflate_size::at_most)
+            return out_decompressed.size() < expected_size ? decode_error::ok : fail("output reaches the size limit");
+
+        if (out_decompressed.size() < expected_size) return fail("stream ends before the image data");
 
         if (out_decompressed.size() > expected_size)
         {
             out_decompressed.resize(expected_size);
         }
 
-        const decode_error defilter_err{ defilter_scanlines(out_decompressed, width, height, bit_depth, color_type) };
-
-        if (defilter_err != decode_error::ok) return defilter_err;
-
         return decode_error::ok;
     }
+
+    [[nodiscard]] constexpr decode_error inflate_idat(std::span<const uint8_t> zlib_data,
+                                                      std::vector<uint8_t>& out_decompressed,
+                                                      const size_t expected_size,
+                                                      const inflate_size mode = inflate_size::exact) noexcept
+    {
+        no_decode_stats_t stats{ };
+        return inflate_idat(zlib_data, out_decompressed, expected_size, mode, stats);
+    }
 } // namespace cpng
@@ -0,0 +1,194 @@
+//
+// Created by Zack Shrout on 3/26/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__linux__) && !defined(CPNG_DISABLE_IO_URING) && __has_include(<linux/io_uring.h>)
+    #define CPNG_HAS_IO_URING 1
+#else
+    #define CPNG_HAS_IO_URING 0
+#endif
+
+#if CPNG_HAS_IO_URING
+    #include <algorithm>
+    #include <atomic>
+    #include <cerrno>
+    #include <cstring>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace cpng {
+#if CPNG_HAS_IO_URING
+    /**
+     * Minimal io_uring wrapper on the raw syscalls (no liburing): one submission queue of
+     * vectored reads and one completion queue, driven by a single thread.
+     *
+     * init() fails on kernels without io_uring or where it is blocked (seccomp, containers);
+     * callers then fall back to blocking reads.
+     */
+    class io_ring_t
+    {
+    public:
+        struct completion_t
+        {
+            uint64_t    user_data{ };
+            int32_t     result{ };      // bytes read, or -errno
+        };
+
+        io_ring_t() = default;
+        ~io_ring_t() { close(); }
+
+        io_ring_t(const io_ring_t&) = delete;
+        io_ring_t& operator=(const io_ring_t&) = delete;
+
+        [[nodiscard]] bool init(const uint32_t entries) noexcept
+        {
+            io_uring_params params{ };
+            _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (_fd < 0) return false;
+
+            _sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            _cq_ring_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            // Kernels with SINGLE_MMAP share one mapping between both rings
+            const bool single{ (params.features & IORING_FEAT_SINGLE_MMAP) != 0 };
+            if (single) _sq_ring_bytes = _cq_ring_bytes = std::max(_sq_ring_bytes, _cq_ring_bytes);
+
+            _sq_ring = map(_sq_ring_bytes, IORING_OFF_SQ_RING);
+            _cq_ring = single ? _sq_ring : map(_cq_ring_bytes, IORING_OFF_CQ_RING);
+            _sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+            _sqes = static_cast<io_uring_sqe*>(map(_sqes_bytes, IORING_OFF_SQES));
+
+            if (!_sq_ring || !_cq_ring || !_sqes)
+            {
+                close();
+                return false;
+            }
+
+            auto* const sq{ static_cast<uint8_t*>(_sq_ring) };
+            _sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+            _sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+            _sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+            _sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+            _sq_entries = params.sq_entries;
+
+            auto* const cq{ static_cast<uint8_t*>(_cq_ring) };
+            _cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+            _cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+            _cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+            _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            return true;
+        }
+
+        void close() noexcept
+        {
+            if (_sqes) munmap(_sqes, _sqes_bytes);
+            if (_cq_ring && _cq_ring != _sq_ring) munmap(_cq_ring, _cq_ring_bytes);
+            if (_sq_ring) munmap(_sq_ring, _sq_ring_bytes);
+            if (_fd >= 0) ::close(_fd);
+
+            _sqes = nullptr;
+            _sq_ring = _cq_ring = nullptr;
+            _fd = -1;
+        }
+
+        [[nodiscard]] uint32_t capacity() const noexcept { return _sq_entries; }
+
+        /// @brief Queues a read of `iov` at `offset`; false when the submission queue is full.
+        [[nodiscard]] bool queue_readv(const int fd, const iovec* iov, const uint64_t offset,
+                                       const uint64_t user_data) noexcept
+        {
+            const uint32_t tail{ *_sq_tail };   // only this thread writes the tail
+            const uint32_t head{ std::atomic_ref{ *_sq_head }.load(std::memory_order_acquire) };
+            if (tail - head >= _sq_entries) return false;
+
+            const uint32_t index{ tail & _sq_mask };
+            io_uring_sqe& sqe{ _sqes[index] };
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(iov);
+            sqe.len = 1;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+
+            _sq_array[index] = index;
+            std::atomic_ref{ *_sq_tail }.store(tail + 1, std::memory_order_release);
+            ++_unsubmitted;
+
+            return true;
+        }
+
+        /// @brief Submits queued reads; with `wait`, blocks until at least one completion is available.
+        [[nodiscard]] bool submit(const bool wait) noexcept
+        {
+            while (true)
+            {
+                const long done{
+                    syscall(__NR_io_uring_enter, _fd, _unsubmitted, wait ? 1u : 0u,
+                            wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0)
+                };
+
+                if (done >= 0)
+                {
+                    _unsubmitted -= static_cast<uint32_t>(done);
+                    if (_unsubmitted == 0 || !wait) return true;
+                    continue;
+                }
+
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+            }
+        }
+
+        /// @brief Pops one completion if available.
+        [[nodiscard]] bool pop(completion_t& out) noexcept
+        {
+            const uint32_t head{ *_cq_head };   // only this thread writes the head
+            if (head == std::atomic_ref{ *_cq_tail }.load(std::memory_order_acquire)) return false;
+
+            const io_uring_cqe& cqe{ _cqes[head & _cq_mask] };
+            out = { cqe.user_data, cqe.res };
+
+            std::atomic_ref{ *_cq_head }.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        [[nodiscard]] void* map(const size_t bytes, const uint64_t offset) const noexcept
+        {
+            void* const p{ mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                                static_cast<off_t>(offset)) };
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        int             _fd{ -1 };
+        void*           _sq_ring{ nullptr };
+        void*           _cq_ring{ nullptr };
+        io_uring_sqe*   _sqes{ nullptr };
+        size_t          _sq_ring_bytes{ 0 };
+        size_t          _cq_ring_bytes{ 0 };
+        size_t          _sqes_bytes{ 0 };
+
+        uint32_t*       _sq_head{ nullptr };
+        uint32_t*       _sq_tail{ nullptr };
+        uint32_t*       _sq_array{ nullptr };
+        uint32_t        _sq_mask{ 0 };
+        uint32_t        _sq_entries{ 0 };
+        uint32_t        _unsubmitted{ 0 };
+
+        uint32_t*       _cq_head{ nullptr };
+        uint32_t*       _cq_tail{ nullptr };
+        uint32_t        _cq_mask{ 0 };
+        io_uring_cqe*   _cqes{ nullptr };
+    };
+#endif
+} // namespace cpng
@@ -0,0 +1,240 @@
+//
+// Created by Zack Shrout on 3/18/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+#include "transfer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace cpng {
+    /// @brief Number of levels in a full chain down to 1×1.
+    [[nodiscard]] constexpr uint32_t full_mip_count(const uint32_t width, const uint32_t height) noexcept
+    {
+        return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // 2×2 box filter kernels
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /**
+     * Averages rows `r0` and `r1` (`src_width` pixels each) into `dst` (`dst_width` pixels).
+     * Column pairs are (2x, 2x+1), or (0, 0) for a 1 pixel wide source; an odd trailing
+     * column is dropped, like an odd trailing row.
+     */
+    template <typename T, uint32_t Channels>
+    inline void box_filter_row(const uint8_t* r0, const uint8_t* r1, uint8_t* dst, const uint32_t src_width,
+                               const uint32_t dst_width) noexcept
+    {
+        constexpr size_t px{ sizeof(T) * Channels };
+        const uint32_t step{ src_width > 1 ? 1u : 0u };
+
+        for (uint32_t x{ 0 }; x < dst_width; ++x)
+        {
+            T a[Channels], b[Channels], c[Channels], d[Channels], out[Channels];
+            std::memcpy(a, r0 + (2 * x) * px, px);
+            std::memcpy(b, r0 + (2 * x + step) * px, px);
+            std::memcpy(c, r1 + (2 * x) * px, px);
+            std::memcpy(d, r1 + (2 * x + step) * px, px);
+
+            for (uint32_t ch{ 0 }; ch < Channels; ++ch)
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                    out[ch] = (a[ch] + b[ch] + c[ch] + d[ch]) * 0.25f;
+                else
+                    out[ch] = static_cast<T>((static_cast<uint32_t>(a[ch]) + b[ch] + c[ch] + d[ch] + 2u) >> 2);
+            }
+
+            std::memcpy(dst + x * px, out, px);
+        }
+    }
+
+    /// @brief Tables for gamma-correct averaging of 8-bit sRGB samples.
+    struct srgb_mip_tables_t
+    {
+        static constexpr uint32_t k_linear_bits{ 14 };
+        static constexpr uint32_t k_linear_max{ (1u << k_linear_bits) - 1u };
+
+        std::array<float, 256>                  to_linear{ };
+        std::array<uint8_t, k_linear_max + 1>   to_srgb{ };
+
+        void build() noexcept
+        {
+            for (uint32_t i{ 0 }; i < 256; ++i)
+                to_linear[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+
+            for (uint32_t i{ 0 }; i <= k_linear_max; ++i)
+                to_srgb[i] = encode_normalized<uint8_t, false>(
+                    linear_to_srgb(static_cast<float>(i) / static_cast<float>(k_linear_max)));
+        }
+    };
+
+    /// @brief sRGB-correct variant: color channels are averaged in linear light, alpha linearly.
+    template <uint32_t Channels>
+    inline void box_filter_row_srgb(const uint8_t* r0, const uint8_t* r1, uint8_t* dst, const uint32_t src_width,
+                                    const uint32_t dst_width, const srgb_mip_tables_t& tables) noexcept
+    {
+        constexpr uint32_t alpha{ Channels == 2 || Channels == 4 ? Channels - 1 : Channels };
+        const uint32_t step{ src_width > 1 ? Channels : 0u };
+
+        for (uint32_t x{ 0 }; x < dst_width; ++x)
+        {
+            const uint32_t i{ 2 * x * Channels };
+
+            for (uint32_t ch{ 0 }; ch < Channels; ++ch)
+            {
+                if (ch == alpha)
+                {
+                    dst[x * Channels + ch] = static_cast<uint8_t>(
+                        (r0[i + ch] + r0[i + step + ch] + r1[i + ch] + r1[i + step + ch] + 2u) >> 2);
+                    continue;
+                }
+
+                const float lin{
+                    (tables.to_linear[r0[i + ch]] + tables.to_linear[r0[i + step + ch]] +
+                     tables.to_linear[r1[i + ch]] + tables.to_linear[r1[i + step + ch]]) * 0.25f
+                };
+
+                dst[x * Channels + ch] = tables.to_srgb[static_cast<uint32_t>(
+                    lin * static_cast<float>(srgb_mip_tables_t::k_linear_max) + 0.5f)];
+            }
+        }
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Streaming chain builder
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /**
+     * Builds a mip chain in one contiguous allocation while level 0 rows are being emitted.
+     * Every completed odd row of level N (together with the even row above it, both already
+     * in the output buffer) produces one row of level N+1, which may cascade further down.
+     */
+    struct mip_chain_builder_t
+    {
+        struct level_t
+        {
+            uint32_t    width;
+            uint32_t    height;
+            size_t      offset;     // from the start of the chain storage
+            size_t      stride;
+        };
+
+        std::vector<level_t>    levels{ };
+        size_t                  total_bytes{ 0 };
+        uint8_t*                base{ nullptr };
+        srgb_mip_tables_t*      srgb{ nullptr };
+
+        using filter_fn = void (*)(const uint8_t*, const uint8_t*, uint8_t*, uint32_t, uint32_t,
+                                   const srgb_mip_tables_t*) noexcept;
+        filter_fn               filter{ nullptr };
+
+        /// @brief Lays out `count` levels (already clamped) and picks the filter kernel for `format`.
+        [[nodiscard]] decode_error init(const uint32_t width, const uint32_t height, const uint32_t count,
+                                        const pixel_format format, srgb_mip_tables_t* srgb_tables) noexcept
+        {
+            srgb = srgb_tables;
+            filter = select_filter(format, srgb_tables != nullptr);
+            if (!filter) return decode_error::unsupported_output_format;
+
+            const size_t px{ bytes_per_pixel(format) };
+
+            levels.clear();
+            total_bytes = 0;
+
+            uint32_t w{ width };
+            uint32_t h{ height };
+
+            for (uint32_t i{ 0 }; i < count; ++i)
+            {
+                levels.push_back({ w, h, total_bytes, w * px });
+                total_bytes += static_cast<size_t>(w) * h * px;
+
+                w = std::max(1u, w / 2);
+                h = std::max(1u, h / 2);
+            }
+
+            return decode_error::ok;
+        }
+
+        [[nodiscard]] uint8_t* row(const size_t level, const uint32_t y) const noexcept
+        {
+            return base + levels[level].offset + y * levels[level].stride;
+        }
+
+        /// @brief Call once a row of `level` is final; produces every row it completes below.
+        void on_row(size_t level, uint32_t y) noexcept
+        {
+            while (level + 1 < levels.size())
+            {
+                const level_t& src{ levels[level] };
+                const level_t& dst{ levels[level + 1] };
+
+                uint32_t r0{ };
+                if (src.height == 1)
+                    r0 = 0;
+                else if ((y & 1u) && y / 2 < dst.height)
+                    r0 = y - 1;
+                else
+                    return; // waiting for the second row of the pair (or an odd leftover row)
+
+                const uint32_t r1{ src.height == 1 ? r0 : r0 + 1 };
+
+                filter(row(level, r0), row(level, r1), row(level + 1, r0 / 2), src.width, dst.width, srgb);
+
+                y = r0 / 2;
+                ++level;
+            }
+        }
+
+    private:
+        template <typename T, uint32_t Channels>
+        static void linear_filter(const uint8_t* r0, const uint8_t* r1, uint8_t* dst, const uint32_t src_width,
+                                  const uint32_t dst_width, const srgb_mip_tables_t*) noexcept
+        {
+            box_filter_row<T, Channels>(r0, r1, dst, src_width, dst_width);
+        }
+
+        template <uint32_t Channels>
+        static void srgb_filter(const uint8_t* r0, const uint8_t* r1, uint8_t* dst, const uint32_t src_width,
+                                const uint32_t dst_width, const srgb_mip_tables_t* tables) noexcept
+        {
+            box_filter_row_srgb<Channels>(r0, r1, dst, src_width, dst_width, *tables);
+        }
+
+        [[nodiscard]] static constexpr filter_fn select_filter(const pixel_format format, const bool srgb) noexcept
+        {
+            if (srgb)
+            {
+                switch (format)
+                {
+                    case pixel_format::r8:      return srgb_filter<1>;
+                    case pixel_format::rg8:     return srgb_filter<2>;
+                    case pixel_format::rgba8:   return srgb_filter<4>;
+                    default:                    return nullptr;
+                }
+            }
+
+            switch (format)
+            {
+                case pixel_format::r8:      return linear_filter<uint8_t, 1>;
+                case pixel_format::rg8:     return linear_filter<uint8_t, 2>;
+                case pixel_format::rgba8:   return linear_filter<uint8_t, 4>;
+                case pixel_format::r16:     return linear_filter<uint16_t, 1>;
+                case pixel_format::rg16:    return linear_filter<uint16_t, 2>;
+                case pixel_format::rgba16:  return linear_filter<uint16_t, 4>;
+                case pixel_format::rgba32f: return linear_filter<float, 4>;
+                default:                    return nullptr;
+            }
+        }
+    };
+} // namespace cpng
@@ -0,0 +1,181 @@
+//
+// Created by Zack Shrout on 3/19/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace cpng {
+    /// @brief Resolves a requested worker count: 0 means one per hardware thread.
+    [[nodiscard]] inline uint32_t resolve_thread_count(const uint32_t requested) noexcept
+    {
+        if (requested != 0) return requested;
+
+        const uint32_t hw{ std::thread::hardware_concurrency() };
+        return hw != 0 ? hw : 1u;
+    }
+
+    /**
+     * Runs fn(i) for every i in [0, count) on up to `threads` threads (the caller included).
+     * Work items are handed out through a shared counter, so uneven items balance themselves.
+     * Falls back to running inline when a worker thread cannot be started.
+     */
+    template <typename Fn>
+    inline void parallel_for(const uint32_t count, const uint32_t threads, Fn&& fn) noexcept
+    {
+        const uint32_t workers{ std::min(threads, count) };
+
+        if (workers <= 1)
+        {
+            for (uint32_t i{ 0 }; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        std::atomic<uint32_t> next{ 0 };
+        const auto drain{
+            [&]() noexcept {
+                for (uint32_t i{ next.fetch_add(1, std::memory_order_relaxed) }; i < count;
+                     i = next.fetch_add(1, std::memory_order_relaxed))
+                    fn(i);
+            }
+        };
+
+        std::vector<std::jthread> pool;
+
+        try
+        {
+            pool.reserve(workers - 1);
+            for (uint32_t t{ 1 }; t < workers; ++t)
+                pool.emplace_back(drain);
+        }
+        catch (...)
+        {
+            // Whatever could be started still helps; the calling thread drains the rest
+        }
+
+        drain();
+    }
+
+    /**
+     * Workers started once and handed one batch of work items at a time, for callers that run
+     * many short batches back to back (a thread start per batch would dominate the work).
+     * Items are handed out through a shared counter as in @ref parallel_for; the calling thread
+     * drains too, so `threads` counts it. Runs inline when no worker thread could be started.
+     */
+    class worker_pool_t
+    {
+    public:
+        explicit worker_pool_t(const uint32_t threads) noexcept
+        {
+            try
+            {
+                _threads.reserve(threads > 1 ? threads - 1 : 0);
+                for (uint32_t t{ 1 }; t < threads; ++t)
+                    _threads.emplace_back([this](const std::stop_token stop) noexcept { work_loop(stop); });
+            }
+            catch (...)
+            {
+                // Whatever could be started still helps
+            }
+        }
+
+        /// @brief Stops and joins the workers; no batch may be running.
+        ~worker_pool_t()
+        {
+            for (std::jthread& thread: _threads)
+                thread.request_stop();
+            _threads.clear();
+        }
+
+        worker_pool_t(const worker_pool_t&) = delete;
+        worker_pool_t& operator=(const worker_pool_t&) = delete;
+
+        /// @brief Runs fn(i) for every i in [0, count) and returns once all of them have finished.
+        template <typename Fn>
+        void run(const uint32_t count, Fn&& fn) noexcept
+        {
+            if (_threads.empty() || count <= 1)
+            {
+                for (uint32_t i{ 0 }; i < count; ++i)
+                    fn(i);
+                return;
+            }
+
+            {
+                std::lock_guard lock{ _mutex };
+                _job = job_t{
+                    .invoke = [](void* context, const uint32_t i) noexcept { (*static_cast<Fn*>(context))(i); },
+                    .context = &fn,
+                    .count = count
+                };
+                _next.store(0, std::memory_order_relaxed);
+                _busy = static_cast<uint32_t>(_threads.size());
+                ++_generation;
+            }
+            _work_ready.notify_all();
+
+            drain(_job);
+
+            // Every worker checks in, so none can still be looking at this batch once run returns
+            std::unique_lock lock{ _mutex };
+            _done.wait(lock, [this] { return _busy == 0; });
+        }
+
+    private:
+        struct job_t
+        {
+            void        (*invoke)(void* context, uint32_t i) noexcept{ };
+            void*       context{ };
+            uint32_t    count{ };
+        };
+
+        void drain(const job_t& job) noexcept
+        {
+            for (uint32_t i{ _next.fetch_add(1, std::memory_order_relaxed) }; i < job.count;
+                 i = _next.fetch_add(1, std::memory_order_relaxed))
+                job.invoke(job.context, i);
+        }
+
+        void work_loop(const std::stop_token stop) noexcept
+        {
+            uint64_t seen{ 0 };
+
+            for (;;)
+            {
+                job_t job{ };
+                {
+                    std::unique_lock lock{ _mutex };
+                    if (!_work_ready.wait(lock, stop, [&] { return _generation != seen; })) return;
+
+                    seen = _generation;
+                    job = _job;
+                }
+
+                drain(job);
+
+                std::lock_guard lock{ _mutex };
+                if (--_busy == 0) _done.notify_one();
+            }
+        }
+
+        std::mutex                      _mutex;
+        std::condition_variable_any     _work_ready;    // a new batch was published, or stop was requested
+        std::condition_variable         _done;          // every worker finished the batch
+        job_t                           _job{ };
+        std::atomic<uint32_t>           _next{ 0 };
+        uint32_t                        _busy{ 0 };     // workers still on the current batch
+        uint64_t                        _generation{ 0 };
+
+        std::vector<std::jthread>       _threads;       // last: joined before the state above goes away
+    };
+} // namespace cpng
@@ -0,0 +1,53 @@
+//
+// Created by Zack Shrout on 3/9/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+
+#include <algorithm>
+
+namespace cpng {
+    /// @brief Number of samples per pixel for a PNG color type (0 when the type is unknown/unsupported).
+    [[nodiscard]] constexpr uint32_t channel_count(const uint8_t color_type) noexcept
+    {
+        switch (color_type)
+        {
+            case 0: return 1; // grayscale
+            case 2: return 3; // RGB
+            case 4: return 2; // grayscale + alpha
+            case 6: return 4; // RGBA
+            default: return 0;
+        }
+    }
+
+    /// @brief Validates a (bit depth, color type) pair against what the decoder implements.
+    [[nodiscard]] constexpr decode_error validate_png_format(const uint8_t bit_depth, const uint8_t color_type) noexcept
+    {
+        if (channel_count(color_type) == 0) return decode_error::unsupported_color_type;
+
+        // Sub-byte depths are only legal for grayscale (and palette, which is not supported).
+        if (bit_depth == 1 || bit_depth == 2 || bit_depth == 4)
+            return color_type == 0 ? decode_error::ok : decode_error::unsupported_bit_depth;
+
+        if (bit_depth != 8 && bit_depth != 16) return decode_error::unsupported_bit_depth;
+
+        return decode_error::ok;
+    }
+
+    /// @brief Filter stride in bytes ("bpp" in the PNG spec). Sub-byte formats use 1.
+    [[nodiscard]] constexpr uint32_t filter_bpp(const uint8_t bit_depth, const uint8_t color_type) noexcept
+    {
+        return std::max(1u, channel_count(color_type) * bit_depth / 8u);
+    }
+
+    /// @brief Packed scanline size in bytes, excluding the leading filter byte.
+    [[nodiscard]] constexpr size_t scanline_bytes(const uint32_t width, const uint8_t bit_depth,
+                                                  const uint8_t color_type) noexcept
+    {
+        const size_t bits{ static_cast<size_t>(width) * channel_count(color_type) * bit_depth };
+        return (bits + 7u) / 8u;
+    }
+} // namespace cpng
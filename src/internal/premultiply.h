@@ -0,0 +1,123 @@
+//
+// Created by Zack Shrout on 3/16/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "simd.h"
+#include "transfer.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace cpng {
+    /// @brief round(x * a / 255) for x, a in 0..255, exact for every input pair.
+    [[nodiscard]] constexpr uint8_t mul_div255(const uint32_t x, const uint32_t a) noexcept
+    {
+        return static_cast<uint8_t>((x * a + 128u) * 257u >> 16);
+    }
+
+    /// @brief Premultiplies an RGBA8 row in place; alpha is left untouched.
+    inline void premultiply_rgba8(uint8_t* row, const uint32_t width) noexcept
+    {
+        uint32_t x{ 0 };
+
+#if CPNG_HAS_SSE2
+        // 16 pixels per step: each register holds 4 pixels, widened to two halves of 2 pixels.
+        const __m128i zero{ _mm_setzero_si128() };
+        const __m128i bias{ _mm_set1_epi16(128) };
+        const __m128i k257{ _mm_set1_epi16(257) };
+        const __m128i alpha_lanes{ _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0) };
+        const __m128i k255{ _mm_and_si128(_mm_set1_epi16(255), alpha_lanes) };
+
+        const auto premultiply_half{
+            [&](const __m128i px) noexcept {
+                // Broadcast each pixel's alpha across its 4 lanes; alpha lanes multiply by 255 (identity).
+                __m128i a{ _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)),
+                                               _MM_SHUFFLE(3, 3, 3, 3)) };
+                a = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), k255);
+
+                const __m128i t{ _mm_add_epi16(_mm_mullo_epi16(px, a), bias) };
+                return _mm_mulhi_epu16(t, k257);
+            }
+        };
+
+        for (; x + 16 <= width; x += 16)
+        {
+            uint8_t* p{ row + static_cast<size_t>(x) * 4 };
+
+            for (uint32_t i{ 0 }; i < 4; ++i)
+            {
+                const __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16)) };
+                const __m128i lo{ premultiply_half(_mm_unpacklo_epi8(v, zero)) };
+                const __m128i hi{ premultiply_half(_mm_unpackhi_epi8(v, zero)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i * 16), _mm_packus_epi16(lo, hi));
+            }
+        }
+#endif
+
+        for (; x < width; ++x)
+        {
+            uint8_t* p{ row + static_cast<size_t>(x) * 4 };
+            const uint32_t a{ p[3] };
+
+            p[0] = mul_div255(p[0], a);
+            p[1] = mul_div255(p[1], a);
+            p[2] = mul_div255(p[2], a);
+        }
+    }
+
+    inline void premultiply_rg8(uint8_t* row, const uint32_t width) noexcept
+    {
+        for (uint32_t x{ 0 }; x < width; ++x)
+            row[x * 2] = mul_div255(row[x * 2], row[x * 2 + 1]);
+    }
+
+    /// @brief 16-bit samples in native order: round(x * a / 65535).
+    template <uint32_t Channels>
+    inline void premultiply_u16(uint8_t* row, const uint32_t width) noexcept
+    {
+        for (uint32_t x{ 0 }; x < width; ++x)
+        {
+            uint16_t px[Channels];
+            std::memcpy(px, row + x * sizeof(px), sizeof(px));
+
+            const uint32_t a{ px[Channels - 1] };
+            for (uint32_t c{ 0 }; c + 1 < Channels; ++c)
+                px[c] = static_cast<uint16_t>((px[c] * a + 32767u) / 65535u);
+
+            std::memcpy(row + x * sizeof(px), px, sizeof(px));
+        }
+    }
+
+    inline void premultiply_rgba32f(uint8_t* row, const uint32_t width) noexcept
+    {
+        for (uint32_t x{ 0 }; x < width; ++x)
+        {
+            float px[4];
+            std::memcpy(px, row + x * sizeof(px), sizeof(px));
+
+            px[0] *= px[3];
+            px[1] *= px[3];
+            px[2] *= px[3];
+
+            std::memcpy(row + x * sizeof(px), px, sizeof(px));
+        }
+    }
+
+    /// @brief Narrows a float row to half floats (used when premultiplying half output in float).
+    inline void float_row_to_half(const uint8_t* src, uint8_t* dst, const size_t samples) noexcept
+    {
+        for (size_t i{ 0 }; i < samples; ++i)
+        {
+            float f;
+            std::memcpy(&f, src + i * 4, 4);
+
+            const uint16_t h{ float_to_half(f) };
+            std::memcpy(dst + i * 2, &h, 2);
+        }
+    }
+
+    using premultiply_fn = void (*)(uint8_t* row, uint32_t width) noexcept;
+} // namespace cpng
@@ -0,0 +1,221 @@
+//
+// Created by Zack Shrout on 3/14/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+#include "image_stats.h"
+#include "png_format.h"
+#include "premultiply.h"
+#include "transfer.h"
+#include "unpack.h"
+
+#include <cmath>
+#include <vector>
+
+namespace cpng {
+    using lut_apply_fn = void (*)(const uint8_t* src, uint8_t* dst, uint32_t width, const void* color_lut,
+                                  const void* alpha_lut) noexcept;
+
+    template <typename In, typename Out, uint32_t Channels>
+    inline void apply_lut_erased(const uint8_t* src, uint8_t* dst, const uint32_t width, const void* color_lut,
+                                 const void* alpha_lut) noexcept
+    {
+        apply_transfer_lut<In, Out, Channels>(src, dst, width, static_cast<const Out*>(color_lut),
+                                              static_cast<const Out*>(alpha_lut));
+    }
+
+    /// @brief Channel count of an output format.
+    [[nodiscard]] constexpr uint32_t format_channels(const pixel_format format) noexcept
+    {
+        switch (format)
+        {
+            case pixel_format::r8:
+            case pixel_format::r16:     return 1;
+            case pixel_format::rg8:
+            case pixel_format::rg16:    return 2;
+            default:                    return 4;
+        }
+    }
+
+    /**
+     * The row emission stage: turns one reconstructed PNG scanline into one output row.
+     *
+     * Integer formats without a transform are produced by a single unpack kernel. Float
+     * formats and transfer functions add a table stage: the row is first unpacked into a
+     * cache-resident integer scratch row, then mapped through per-channel LUTs. Alpha
+     * premultiplication runs last, on the freshly written output row.
+     */
+    struct row_pipeline_t
+    {
+        row_emit_fn             emit{ nullptr };
+        lut_apply_fn            apply_lut{ nullptr };
+        std::vector<uint8_t>    scratch{ };
+        std::vector<uint8_t>    lut_storage{ };     // color table followed by alpha table
+        const void*             color_lut{ nullptr };
+        const void*             alpha_lut{ nullptr };
+        premultiply_fn          premultiply{ nullptr };
+        std::vector<uint8_t>    float_row{ };       // half output + premultiply: work in float, then narrow
+        bool                    output_linear{ false };
+        row_stats_fn            stats{ nullptr };
+        stats_state_t           stats_state{ };
+
+        [[nodiscard]] decode_error init(const ihdr_info_t& ihdr, const decode_options_t& options) noexcept
+        {
+            const pixel_format format{ options.format };
+            const bool float_out{ format == pixel_format::rgba32f || format == pixel_format::rgba16f };
+
+            // Exponent applied to normalized color samples; 1 means identity
+            float exponent{ 1.0f };
+            bool srgb_curve{ false };
+
+            if (options.transform == color_transform::srgb_to_linear)
+            {
+                srgb_curve = true;
+                output_linear = true;
+            }
+            else if (options.transform == color_transform::gamma && (ihdr.has_srgb || ihdr.has_gamma))
+            {
+                const float file_gamma{ ihdr.has_srgb ? 1.0f / 2.2f : ihdr.gamma };
+
+                if (file_gamma > 0.0f && options.display_gamma > 0.0f)
+                {
+                    exponent = 1.0f / (file_gamma * options.display_gamma);
+                    output_linear = std::abs(options.display_gamma - 1.0f) < 0.01f;
+                }
+            }
+
+            const bool identity{ !srgb_curve && std::abs(exponent - 1.0f) < 1e-4f };
+
+            if (options.compute_stats)
+            {
+                stats = select_row_stats(format);
+                stats_state.init(ihdr.color_type, format_channels(format));
+            }
+
+            // Without a real alpha channel (color types 0 and 2) alpha is implicitly opaque: no-op
+            if (options.premultiply_alpha && (ihdr.color_type == 4 || ihdr.color_type == 6))
+            {
+                switch (format)
+                {
+                    case pixel_format::rgba8:   premultiply = premultiply_rgba8; break;
+                    case pixel_format::rg8:     premultiply = premultiply_rg8; break;
+                    case pixel_format::rgba16:  premultiply = premultiply_u16<4>; break;
+                    case pixel_format::rg16:    premultiply = premultiply_u16<2>; break;
+                    case pixel_format::rgba32f:
+                    case pixel_format::rgba16f: premultiply = premultiply_rgba32f; break;
+                    default: break; // single channel formats carry no alpha
+                }
+            }
+
+            if (!float_out && identity)
+            {
+                emit = select_row_emitter(ihdr.bit_depth, ihdr.color_type, format);
+                return emit ? decode_error::ok : decode_error::unsupported_output_format;
+            }
+
+            // Unpack into integer samples of the source precision, then map through the tables
+            const bool wide{ ihdr.bit_depth == 16 };
+            const uint32_t channels{ format_channels(format) };
+
+            constexpr pixel_format narrow_formats[]{ pixel_format::r8, pixel_format::rg8, pixel_format::rgba8 };
+            constexpr pixel_format wide_formats[]{ pixel_format::r16, pixel_format::rg16, pixel_format::rgba16 };
+            const uint32_t layout{ channels == 1 ? 0u : channels == 2 ? 1u : 2u };
+
+            const pixel_format intermediate{ wide ? wide_formats[layout] : narrow_formats[layout] };
+
+            emit = select_row_emitter(ihdr.bit_depth, ihdr.color_type, intermediate);
+            if (!emit) return decode_error::unsupported_output_format;
+
+            scratch.resize(static_cast<size_t>(ihdr.width) * bytes_per_pixel(intermediate));
+
+            const auto curve{
+                [=](const float v) noexcept {
+                    if (srgb_curve) return srgb_to_linear(v);
+                    return exponent == 1.0f ? v : std::pow(v, exponent);
+                }
+            };
+            const auto linear{ [](const float v) noexcept { return v; } };
+
+            switch (format)
+            {
+                case pixel_format::r8:
+                case pixel_format::rg8:
+                case pixel_format::rgba8:   return build<uint8_t, false>(wide, channels, curve, linear);
+                case pixel_format::r16:
+                case pixel_format::rg16:
+                case pixel_format::rgba16:  return build<uint16_t, false>(wide, channels, curve, linear);
+                case pixel_format::rgba32f: return build<float, false>(wide, channels, curve, linear);
+                case pixel_format::rgba16f:
+                    if (!premultiply) return build<uint16_t, true>(wide, channels, curve, linear);
+
+                    float_row.resize(static_cast<size_t>(ihdr.width) * 4 * sizeof(float));
+                    return build<float, false>(wide, channels, curve, linear);
+                default:                    return decode_error::unsupported_output_format;
+            }
+        }
+
+        /// @brief Emits one reconstructed scanline (`width` pixels) into `dst`.
+        void write_row(const uint8_t* pixels, uint8_t* dst, const uint32_t width) noexcept
+        {
+            if (!apply_lut)
+            {
+                emit(pixels, dst, width);
+            }
+            else if (float_row.empty())
+            {
+                emit(pixels, scratch.data(), width);
+                apply_lut(scratch.data(), dst, width, color_lut, alpha_lut);
+            }
+            else
+            {
+                emit(pixels, scratch.data(), width);
+                apply_lut(scratch.data(), float_row.data(), width, color_lut, alpha_lut);
+                premultiply(float_row.data(), width);
+                float_row_to_half(float_row.data(), dst, static_cast<size_t>(width) * 4);
+            }
+
+            if (premultiply && float_row.empty()) premultiply(dst, width);
+
+            // Statistics see the final row while it is still in cache
+            if (stats) stats(dst, width, stats_state);
+        }
+
+        [[nodiscard]] image_stats_t finish_stats() const noexcept
+        {
+            return stats ? stats_state.finish() : image_stats_t{ };
+        }
+
+    private:
+        template <typename Out, bool IsHalf, typename ColorCurve, typename AlphaCurve>
+        [[nodiscard]] decode_error build(const bool wide, const uint32_t channels, ColorCurve&& color,
+                                         AlphaCurve&& alpha) noexcept
+        {
+            const size_t entries{ wide ? 65536u : 256u };
+
+            lut_storage.resize(entries * 2 * sizeof(Out));
+
+            const std::span<Out> color_table{ reinterpret_cast<Out*>(lut_storage.data()), entries };
+            const std::span<Out> alpha_table{ color_table.data() + entries, entries };
+
+            build_transfer_lut<Out, IsHalf>(color_table, color);
+            build_transfer_lut<Out, IsHalf>(alpha_table, alpha);
+
+            color_lut = color_table.data();
+            alpha_lut = alpha_table.data();
+
+            if (wide)
+                apply_lut = channels == 1 ? apply_lut_erased<uint16_t, Out, 1>
+                          : channels == 2 ? apply_lut_erased<uint16_t, Out, 2>
+                                          : apply_lut_erased<uint16_t, Out, 4>;
+            else
+                apply_lut = channels == 1 ? apply_lut_erased<uint8_t, Out, 1>
+                          : channels == 2 ? apply_lut_erased<uint8_t, Out, 2>
+                                          : apply_lut_erased<uint8_t, Out, 4>;
+
+            return decode_error::ok;
+        }
+    };
+} // namespace cpng
@@ -0,0 +1,68 @@
+//
+// Created by Zack Shrout on 3/11/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+// SSE2 is part of the x86-64 baseline, so no extra compiler flags are needed to enable it.
+// Define CPNG_DISABLE_SIMD (CMake: -DCARROTPNG_ENABLE_SIMD=OFF) to force the scalar kernels.
+#if !defined(CPNG_DISABLE_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CPNG_HAS_SSE2 1
+#include <emmintrin.h>
+#else
+#define CPNG_HAS_SSE2 0
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+namespace cpng {
+#if CPNG_HAS_SSE2
+    /// @brief Loads `N` bytes (N <= 8) into the low lanes of an SSE register without over-reading.
+    template <uint32_t N>
+    [[nodiscard]] inline __m128i load_low(const uint8_t* p) noexcept
+    {
+        uint64_t v{ 0 };
+        std::memcpy(&v, p, N);
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v));
+    }
+
+    /**
+     * Loads `N` bytes (N <= 8) into the low lanes of an SSE register by reading 4 or 8 bytes:
+     * the caller guarantees they are readable, and ignores the lanes past `N`.
+     */
+    template <uint32_t N>
+    [[nodiscard]] inline __m128i load_over(const uint8_t* p) noexcept
+    {
+        if constexpr (N <= 4)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            return _mm_cvtsi32_si128(static_cast<int>(v));
+        }
+        else
+        {
+            return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        }
+    }
+
+    /// @brief Stores the low `N` bytes (N <= 8) of an SSE register without over-writing.
+    template <uint32_t N>
+    inline void store_low(uint8_t* p, const __m128i v) noexcept
+    {
+        if constexpr (N <= 4)
+        {
+            const uint32_t tmp{ static_cast<uint32_t>(_mm_cvtsi128_si32(v)) };
+            std::memcpy(p, &tmp, N);
+        }
+        else
+        {
+            uint64_t tmp;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&tmp), v);
+            std::memcpy(p, &tmp, N);
+        }
+    }
+#endif
+} // namespace cpng
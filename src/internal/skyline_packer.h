@@ -0,0 +1,135 @@
+//
+// Created by Zack Shrout on 3/24/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace cpng {
+    /**
+     * Skyline bottom-left rectangle packer. The skyline is the top edge of everything placed
+     * so far, kept as horizontal segments sorted by x; each rectangle goes where its top edge
+     * ends up lowest (ties: the narrowest segment, which wastes the least width).
+     */
+    struct skyline_packer_t
+    {
+        struct segment_t
+        {
+            uint32_t    x{ };
+            uint32_t    y{ };
+            uint32_t    width{ };
+        };
+
+        std::vector<segment_t>  skyline{ };
+        uint32_t                bin_width{ };
+        uint32_t                bin_height{ };
+        uint32_t                used_height{ };
+
+        void reset(const uint32_t width, const uint32_t height)
+        {
+            skyline.assign(1, { 0, 0, width });
+            bin_width = width;
+            bin_height = height;
+            used_height = 0;
+        }
+
+        /// @brief Places a width × height rectangle; false if it does not fit anywhere.
+        [[nodiscard]] bool insert(const uint32_t width, const uint32_t height, uint32_t& out_x, uint32_t& out_y)
+        {
+            size_t best{ skyline.size() };
+            uint32_t best_top{ std::numeric_limits<uint32_t>::max() };
+            uint32_t best_segment_width{ std::numeric_limits<uint32_t>::max() };
+            uint32_t best_y{ 0 };
+
+            for (size_t i{ 0 }; i < skyline.size(); ++i)
+            {
+                uint32_t y{ 0 };
+                if (!fits(i, width, height, y)) continue;
+
+                const uint32_t top{ y + height };
+                if (top < best_top || (top == best_top && skyline[i].width < best_segment_width))
+                {
+                    best = i;
+                    best_top = top;
+                    best_segment_width = skyline[i].width;
+                    best_y = y;
+                }
+            }
+
+            if (best == skyline.size()) return false;
+
+            out_x = skyline[best].x;
+            out_y = best_y;
+            place(best, width, best_top);
+
+            used_height = std::max(used_height, best_top);
+            return true;
+        }
+
+    private:
+        /// @brief Resting height of a rectangle whose left edge sits at segment `index`.
+        [[nodiscard]] bool fits(const size_t index, const uint32_t width, const uint32_t height,
+                                uint32_t& out_y) const noexcept
+        {
+            const uint32_t x{ skyline[index].x };
+            if (width > bin_width - x) return false;
+
+            uint32_t y{ 0 };
+            uint32_t remaining{ width };
+
+            for (size_t i{ index }; remaining > 0; ++i)
+            {
+                y = std::max(y, skyline[i].y);
+                if (height > bin_height - y) return false;
+
+                remaining -= std::min(remaining, skyline[i].width);
+            }
+
+            out_y = y;
+            return true;
+        }
+
+        void place(const size_t index, const uint32_t width, const uint32_t top)
+        {
+            const uint32_t x{ skyline[index].x };
+            skyline.insert(skyline.begin() + static_cast<ptrdiff_t>(index), { x, top, width });
+
+            // Trim or drop the segments now covered by the new one
+            const uint32_t right{ x + width };
+            size_t i{ index + 1 };
+            while (i < skyline.size() && skyline[i].x < right)
+            {
+                const uint32_t segment_right{ skyline[i].x + skyline[i].width };
+                if (segment_right <= right)
+                {
+                    skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(i));
+                    continue;
+                }
+
+                skyline[i].width = segment_right - right;
+                skyline[i].x = right;
+                break;
+            }
+
+            // Merge neighbors at the same height
+            for (size_t j{ 0 }; j + 1 < skyline.size();)
+            {
+                if (skyline[j].y == skyline[j + 1].y)
+                {
+                    skyline[j].width += skyline[j + 1].width;
+                    skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(j + 1));
+                }
+                else
+                {
+                    ++j;
+                }
+            }
+        }
+    };
+} // namespace cpng
@@ -0,0 +1,60 @@
+//
+// Created by Zack Shrout on 4/2/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+// Trace points are compiled in only with CPNG_ENABLE_TRACE (CMake: -DCARROTPNG_ENABLE_TRACE=ON).
+// Otherwise the zone type is empty and every call below is an empty constexpr function.
+#if defined(CPNG_ENABLE_TRACE)
+#define CPNG_HAS_TRACE 1
+#else
+#define CPNG_HAS_TRACE 0
+#endif
+
+#include "cpng/trace.h"
+
+namespace cpng {
+#if CPNG_HAS_TRACE
+    /// @brief The hooks installed with set_trace_hooks, or null.
+    [[nodiscard]] const trace_hooks_t* active_trace_hooks() noexcept;
+
+    /// @brief Scoped zone: begins on construction, ends on destruction.
+    class trace_zone_t
+    {
+    public:
+        explicit trace_zone_t(const char* name) noexcept : _hooks{ active_trace_hooks() }, _name{ name }
+        {
+            if (_hooks) _hooks->begin_zone(_hooks->user, _name);
+        }
+
+        ~trace_zone_t() noexcept
+        {
+            if (_hooks) _hooks->end_zone(_hooks->user, _name);
+        }
+
+        trace_zone_t(const trace_zone_t&) = delete;
+        trace_zone_t& operator=(const trace_zone_t&) = delete;
+
+    private:
+        const trace_hooks_t*    _hooks;
+        const char*             _name;
+    };
+
+    inline void trace_counter(const char* name, const int64_t value) noexcept
+    {
+        if (const trace_hooks_t* hooks{ active_trace_hooks() }) hooks->counter(hooks->user, name, value);
+    }
+#else
+    struct trace_zone_t
+    {
+        explicit constexpr trace_zone_t(const char*) noexcept { }
+    };
+
+    constexpr void trace_counter(const char*, int64_t) noexcept { }
+#endif
+
+    /// @brief Rows per "cpng defilter rows" zone.
+    inline constexpr uint32_t k_trace_band_rows{ 32 };
+} // namespace cpng
@@ -0,0 +1,150 @@
+//
+// Created by Zack Shrout on 3/14/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace cpng {
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Transfer curves (normalized 0..1 in and out)
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    [[nodiscard]] inline float srgb_to_linear(const float c) noexcept
+    {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    [[nodiscard]] inline float linear_to_srgb(const float c) noexcept
+    {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    /// @brief IEEE 754 binary32 -> binary16 with round-to-nearest-even (handles denormals, inf and NaN).
+    [[nodiscard]] constexpr uint16_t float_to_half(const float f) noexcept
+    {
+        const uint32_t bits{ std::bit_cast<uint32_t>(f) };
+        const uint32_t sign{ bits >> 16 & 0x8000u };
+        const uint32_t exp{ bits >> 23 & 0xFFu };
+        uint32_t mant{ bits & 0x7FFFFFu };
+
+        if (exp == 0xFFu) // inf / NaN
+            return static_cast<uint16_t>(sign | 0x7C00u | (mant ? 0x200u : 0u));
+
+        const int32_t e{ static_cast<int32_t>(exp) - 127 + 15 };
+
+        if (e >= 31) return static_cast<uint16_t>(sign | 0x7C00u); // overflow -> inf
+
+        if (e <= 0) // denormal or zero
+        {
+            if (e < -10) return static_cast<uint16_t>(sign);
+
+            mant |= 0x800000u;
+            const uint32_t shift{ static_cast<uint32_t>(14 - e) };
+            uint32_t half{ mant >> shift };
+            const uint32_t rem{ mant & ((1u << shift) - 1u) };
+            const uint32_t halfway{ 1u << (shift - 1) };
+
+            if (rem > halfway || (rem == halfway && (half & 1u))) ++half;
+
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half{ static_cast<uint32_t>(e) << 10 | mant >> 13 };
+        const uint32_t rem{ mant & 0x1FFFu };
+
+        // Carry out of the mantissa correctly bumps the exponent (up to inf)
+        if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) ++half;
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    /// @brief IEEE 754 binary16 -> binary32 (exact).
+    [[nodiscard]] constexpr float half_to_float(const uint16_t h) noexcept
+    {
+        const uint32_t sign{ static_cast<uint32_t>(h & 0x8000u) << 16 };
+        uint32_t exp{ h >> 10 & 0x1Fu };
+        uint32_t mant{ h & 0x3FFu };
+
+        if (exp == 0x1Fu) return std::bit_cast<float>(sign | 0x7F800000u | mant << 13);
+
+        if (exp == 0)
+        {
+            if (mant == 0) return std::bit_cast<float>(sign);
+
+            // Denormal: normalize the mantissa
+            exp = 1;
+            while (!(mant & 0x400u))
+            {
+                mant <<= 1;
+                --exp;
+            }
+            mant &= 0x3FFu;
+        }
+
+        return std::bit_cast<float>(sign | (exp + 127u - 15u) << 23 | mant << 13);
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Lookup tables
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Output sample for a normalized value: integers are rounded, half is stored as bits.
+    template <typename Out, bool IsHalf>
+    [[nodiscard]] inline Out encode_normalized(const float v) noexcept
+    {
+        if constexpr (IsHalf)
+            return float_to_half(v);
+        else if constexpr (std::is_floating_point_v<Out>)
+            return v;
+        else
+        {
+            constexpr float max{ static_cast<float>(static_cast<Out>(~Out{ 0 })) };
+            const float clamped{ v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v };
+            return static_cast<Out>(clamped * max + 0.5f);
+        }
+    }
+
+    /**
+     * Fills `lut` (one entry per input code, 256 or 65536) with curve(code / max) encoded as Out.
+     * The table is built once per decode; each output sample then costs a single load.
+     */
+    template <typename Out, bool IsHalf, typename Curve>
+    inline void build_transfer_lut(std::span<Out> lut, Curve&& curve) noexcept
+    {
+        const float scale{ 1.0f / static_cast<float>(lut.size() - 1) };
+
+        for (size_t i{ 0 }; i < lut.size(); ++i)
+            lut[i] = encode_normalized<Out, IsHalf>(curve(static_cast<float>(i) * scale));
+    }
+
+    /**
+     * Maps one row of native-endian integer samples through per-channel tables. Color channels
+     * use `color_lut`; the alpha channel (last channel of 2/4 channel layouts) uses `alpha_lut`.
+     */
+    template <typename In, typename Out, uint32_t Channels>
+    inline void apply_transfer_lut(const uint8_t* src, uint8_t* dst, const uint32_t width, const Out* color_lut,
+                                   const Out* alpha_lut) noexcept
+    {
+        constexpr bool has_alpha{ Channels == 2 || Channels == 4 };
+
+        for (uint32_t x{ 0 }; x < width; ++x)
+        {
+            In in[Channels];
+            Out out[Channels];
+            std::memcpy(in, src + x * sizeof(in), sizeof(in));
+
+            for (uint32_t c{ 0 }; c < Channels; ++c)
+                out[c] = has_alpha && c == Channels - 1 ? alpha_lut[in[c]] : color_lut[in[c]];
+
+            std::memcpy(dst + x * sizeof(out), out, sizeof(out));
+        }
+    }
+} // namespace cpng
@@ -0,0 +1,281 @@
+//
+// Created by Zack Shrout on 3/9/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include "cpng/CarrotPNG.h"
+#include "simd.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace cpng {
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Sub-byte expansion tables
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /**
+     * For a packed byte holding 8/Depth grayscale samples (MSB first), the table entry holds
+     * those samples already scaled to the full 0..255 range (×255, ×85, ×17 for 1/2/4 bits).
+     */
+    template <uint32_t Depth>
+    constexpr std::array<std::array<uint8_t, 8 / Depth>, 256> make_unpack_table() noexcept
+    {
+        constexpr uint32_t samples{ 8 / Depth };
+        constexpr uint32_t mask{ (1u << Depth) - 1u };
+        constexpr uint32_t scale{ 255u / mask };
+
+        std::array<std::array<uint8_t, samples>, 256> table{ };
+
+        for (uint32_t byte{ 0 }; byte < 256; ++byte)
+            for (uint32_t i{ 0 }; i < samples; ++i)
+                table[byte][i] = static_cast<uint8_t>((byte >> (8 - Depth * (i + 1)) & mask) * scale);
+
+        return table;
+    }
+
+    template <uint32_t Depth>
+    inline constexpr auto k_unpack_table{ make_unpack_table<Depth>() };
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Sample conversion
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    /// @brief Rounds a 16-bit sample to 8 bits: round(v * 255 / 65535), exact for all inputs.
+    [[nodiscard]] constexpr uint8_t round_16_to_8(const uint32_t v) noexcept
+    {
+        return static_cast<uint8_t>((v * 255u + 32895u) >> 16);
+    }
+
+    /// @brief Reads one PNG sample (8-bit, or 16-bit big-endian) and converts it to the output sample type.
+    template <uint32_t SrcDepth, typename Out>
+    [[nodiscard]] inline Out load_sample(const uint8_t* p) noexcept
+    {
+        if constexpr (SrcDepth == 8)
+        {
+            if constexpr (sizeof(Out) == 1) return p[0];
+            else return static_cast<Out>(p[0] * 257u);
+        }
+        else
+        {
+            const uint32_t v{ static_cast<uint32_t>(p[0]) << 8 | p[1] };
+            if constexpr (sizeof(Out) == 1) return round_16_to_8(v);
+            else return static_cast<Out>(v);
+        }
+    }
+
+    /// @brief Writes an output sample in native byte order (the destination may be unaligned).
+    template <typename Out>
+    inline void store_sample(uint8_t* dst, const Out v) noexcept
+    {
+        std::memcpy(dst, &v, sizeof(Out));
+    }
+
+    template <typename Out>
+    inline constexpr Out k_sample_max{ static_cast<Out>(~Out{ 0 }) };
+
+    /// @brief Swaps big-endian 16-bit samples into native order (SSE2 when available).
+    inline void byteswap16_row(const uint8_t* src, uint8_t* dst, const size_t samples) noexcept
+    {
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            std::memcpy(dst, src, samples * 2);
+        }
+        else
+        {
+            size_t i{ 0 };
+#if CPNG_HAS_SSE2
+            for (; i + 8 <= samples; i += 8)
+            {
+                const __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2),
+                                 _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+            }
+#endif
+            for (; i < samples; ++i)
+                store_sample(dst + i * 2, static_cast<uint16_t>(src[i * 2] << 8 | src[i * 2 + 1]));
+        }
+    }
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Row emitters: one reconstructed (defiltered) scanline -> one output row
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    using row_emit_fn = void (*)(const uint8_t* src, uint8_t* dst, uint32_t width) noexcept;
+
+    /// @brief Writes one gray sample as 1 (R), 2 (RG, opaque) or 4 (RGBA, opaque) output samples.
+    template <uint32_t OutChannels, typename Out>
+    inline void store_gray(uint8_t* dst, const Out v) noexcept
+    {
+        constexpr size_t n{ sizeof(Out) };
+
+        store_sample<Out>(dst, v);
+
+        if constexpr (OutChannels == 2)
+        {
+            store_sample<Out>(dst + n, k_sample_max<Out>);
+        }
+        else if constexpr (OutChannels == 4)
+        {
+            store_sample<Out>(dst + n, v);
+            store_sample<Out>(dst + 2 * n, v);
+            store_sample<Out>(dst + 3 * n, k_sample_max<Out>);
+        }
+    }
+
+    /// @brief Grayscale at 1/2/4 bits per sample, expanded through @ref k_unpack_table.
+    template <uint32_t Depth, uint32_t OutChannels, typename Out>
+    inline void emit_gray_packed(const uint8_t* src, uint8_t* dst, const uint32_t width) noexcept
+    {
+        constexpr uint32_t samples{ 8 / Depth };
+        constexpr size_t out_pixel{ OutChannels * sizeof(Out) };
+        constexpr uint32_t widen{ sizeof(Out) == 1 ? 1u : 257u };
+
+        const uint32_t full_bytes{ width / samples };
+        for (uint32_t i{ 0 }; i < full_bytes; ++i)
+        {
+            const auto& s{ k_unpack_table<Depth>[src[i]] };
+            for (uint32_t k{ 0 }; k < samples; ++k)
+            {
+                store_gray<OutChannels, Out>(dst, static_cast<Out>(s[k] * widen));
+                dst += out_pixel;
+            }
+        }
+
+        // Trailing partial byte (padding bits are ignored)
+        const uint32_t tail{ width % samples };
+        if (tail)
+        {
+            const auto& s{ k_unpack_table<Depth>[src[full_bytes]] };
+            for (uint32_t k{ 0 }; k < tail; ++k)
+            {
+                store_gray<OutChannels, Out>(dst, static_cast<Out>(s[k] * widen));
+                dst += out_pixel;
+            }
+        }
+    }
+
+    /**
+     * Whole-byte samples (8 or 16 bits): maps SrcChannels (1 gray, 2 gray+alpha, 3 RGB, 4 RGBA)
+     * onto OutChannels (1, 2 or 4), converting the sample width on the way.
+     */
+    template <uint32_t SrcChannels, uint32_t SrcDepth, uint32_t OutChannels, typename Out>
+    inline void emit_pixels(const uint8_t* src, uint8_t* dst, const uint32_t width) noexcept
+    {
+        constexpr size_t in{ SrcDepth / 8 };
+        constexpr size_t n{ sizeof(Out) };
+
+        // Same channel layout and sample width: straight copy (8-bit) or byte swap (16-bit)
+        if constexpr (SrcChannels == OutChannels && SrcDepth == n * 8)
+        {
+            if constexpr (SrcDepth == 8) std::memcpy(dst, src, static_cast<size_t>(width) * SrcChannels);
+            else byteswap16_row(src, dst, static_cast<size_t>(width) * SrcChannels);
+        }
+        else
+        {
+            for (uint32_t x{ 0 }; x < width; ++x)
+            {
+                const uint8_t* s{ src + x * SrcChannels * in };
+                uint8_t* d{ dst + x * OutChannels * n };
+
+                if constexpr (SrcChannels <= 2)
+                {
+                    const Out g{ load_sample<SrcDepth, Out>(s) };
+                    const Out a{ SrcChannels == 2 ? load_sample<SrcDepth, Out>(s + in) : k_sample_max<Out> };
+
+                    store_sample<Out>(d, g);
+                    if constexpr (OutChannels == 2)
+                    {
+                        store_sample<Out>(d + n, a);
+                    }
+                    else if constexpr (OutChannels == 4)
+                    {
+                        store_sample<Out>(d + n, g);
+                        store_sample<Out>(d + 2 * n, g);
+                        store_sample<Out>(d + 3 * n, a);
+                    }
+                }
+                else
+                {
+                    static_assert(OutChannels == 4, "color sources can only be emitted as RGBA");
+
+                    store_sample<Out>(d, load_sample<SrcDepth, Out>(s));
+                    store_sample<Out>(d + n, load_sample<SrcDepth, Out>(s + in));
+                    store_sample<Out>(d + 2 * n, load_sample<SrcDepth, Out>(s + 2 * in));
+                    store_sample<Out>(d + 3 * n,
+                                      SrcChannels == 4 ? load_sample<SrcDepth, Out>(s + 3 * in) : k_sample_max<Out>);
+                }
+            }
+        }
+    }
+
+    template <uint32_t OutChannels, typename Out>
+    [[nodiscard]] constexpr row_emit_fn emit_gray_packed_dispatch(const uint8_t bit_depth) noexcept
+    {
+        switch (bit_depth)
+        {
+            case 1: return emit_gray_packed<1, OutChannels, Out>;
+            case 2: return emit_gray_packed<2, OutChannels, Out>;
+            case 4: return emit_gray_packed<4, OutChannels, Out>;
+            default: return nullptr;
+        }
+    }
+
+    template <uint32_t OutChannels, typename Out>
+    [[nodiscard]] constexpr row_emit_fn select_emitter(const uint8_t bit_depth, const uint8_t color_type) noexcept
+    {
+        const bool is_gray{ color_type == 0 || color_type == 4 };
+
+        if (bit_depth < 8)
+            return color_type == 0 ? emit_gray_packed_dispatch<OutChannels, Out>(bit_depth) : nullptr;
+
+        if (!is_gray && OutChannels != 4) return nullptr;
+
+        if (bit_depth == 8)
+        {
+            switch (color_type)
+            {
+                case 0: return emit_pixels<1, 8, OutChannels, Out>;
+                case 4: return emit_pixels<2, 8, OutChannels, Out>;
+                case 2: if constexpr (OutChannels == 4) return emit_pixels<3, 8, OutChannels, Out>; else break;
+                case 6: if constexpr (OutChannels == 4) return emit_pixels<4, 8, OutChannels, Out>; else break;
+                default: break;
+            }
+        }
+        else if (bit_depth == 16)
+        {
+            switch (color_type)
+            {
+                case 0: return emit_pixels<1, 16, OutChannels, Out>;
+                case 4: return emit_pixels<2, 16, OutChannels, Out>;
+                case 2: if constexpr (OutChannels == 4) return emit_pixels<3, 16, OutChannels, Out>; else break;
+                case 6: if constexpr (OutChannels == 4) return emit_pixels<4, 16, OutChannels, Out>; else break;
+                default: break;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Picks the row kernel for a validated (bit depth, color type) and the requested output format.
+     * Returns nullptr when the combination cannot be produced (e.g. R8 output from an RGB image).
+     */
+    [[nodiscard]] constexpr row_emit_fn select_row_emitter(const uint8_t bit_depth, const uint8_t color_type,
+                                                           const pixel_format format) noexcept
+    {
+        switch (format)
+        {
+            case pixel_format::r8:      return select_emitter<1, uint8_t>(bit_depth, color_type);
+            case pixel_format::rg8:     return select_emitter<2, uint8_t>(bit_depth, color_type);
+            case pixel_format::rgba8:   return select_emitter<4, uint8_t>(bit_depth, color_type);
+            case pixel_format::r16:     return select_emitter<1, uint16_t>(bit_depth, color_type);
+            case pixel_format::rg16:    return select_emitter<2, uint16_t>(bit_depth, color_type);
+            case pixel_format::rgba16:  return select_emitter<4, uint16_t>(bit_depth, color_type);
+            default:                    return nullptr;
+        }
+    }
+} // namespace cpng
@@ -0,0 +1,163 @@
+//
+// Created by Zack Shrout on 3/21/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace cpng {
+    // ──────────────────────────────────────────────────────────────────────────────
+    // XXH64 (streaming), bit-exact with the reference implementation
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    inline constexpr uint64_t k_xxh_prime1{ 0x9E3779B185EBCA87ull };
+    inline constexpr uint64_t k_xxh_prime2{ 0xC2B2AE3D27D4EB4Full };
+    inline constexpr uint64_t k_xxh_prime3{ 0x165667B19E3779F9ull };
+    inline constexpr uint64_t k_xxh_prime4{ 0x85EBCA77C2B2AE63ull };
+    inline constexpr uint64_t k_xxh_prime5{ 0x27D4EB2F165667C5ull };
+
+    [[nodiscard]] constexpr uint64_t read_le64(const uint8_t* p) noexcept
+    {
+        uint64_t v{ 0 };
+        for (uint32_t i{ 0 }; i < 8; ++i)
+            v |= static_cast<uint64_t>(p[i]) << (i * 8);
+        return v;
+    }
+
+    [[nodiscard]] constexpr uint32_t read_le32(const uint8_t* p) noexcept
+    {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    [[nodiscard]] constexpr uint64_t xxh64_round(uint64_t acc, const uint64_t input) noexcept
+    {
+        acc += input * k_xxh_prime2;
+        acc = std::rotl(acc, 31);
+        return acc * k_xxh_prime1;
+    }
+
+    [[nodiscard]] constexpr uint64_t xxh64_merge_round(uint64_t acc, const uint64_t value) noexcept
+    {
+        acc ^= xxh64_round(0, value);
+        return acc * k_xxh_prime1 + k_xxh_prime4;
+    }
+
+    /**
+     * Incremental XXH64: feed any number of spans with update(), read the hash with digest().
+     * The result equals XXH64 of all bytes concatenated, whatever the split.
+     */
+    struct xxh64_state_t
+    {
+        std::array<uint64_t, 4>     acc{ k_xxh_prime1 + k_xxh_prime2, k_xxh_prime2, 0, 0 - k_xxh_prime1 };
+        std::array<uint8_t, 32>     buffer{ };
+        uint64_t                    total_length{ 0 };
+        uint64_t                    seed{ 0 };
+        uint32_t                    buffered{ 0 };
+
+        constexpr void reset(const uint64_t new_seed = 0) noexcept
+        {
+            seed = new_seed;
+            acc = { seed + k_xxh_prime1 + k_xxh_prime2, seed + k_xxh_prime2, seed, seed - k_xxh_prime1 };
+            total_length = 0;
+            buffered = 0;
+        }
+
+        constexpr void update(const std::span<const uint8_t> data) noexcept
+        {
+            const uint8_t* p{ data.data() };
+            const uint8_t* const end{ p + data.size() };
+
+            total_length += data.size();
+
+            // Top up a partial stripe first
+            if (buffered != 0)
+            {
+                while (buffered < 32 && p < end)
+                    buffer[buffered++] = *p++;
+
+                if (buffered < 32) return;
+
+                consume_stripe(buffer.data());
+                buffered = 0;
+            }
+
+            for (; end - p >= 32; p += 32)
+                consume_stripe(p);
+
+            while (p < end)
+                buffer[buffered++] = *p++;
+        }
+
+        [[nodiscard]] constexpr uint64_t digest() const noexcept
+        {
+            uint64_t h{ };
+
+            if (total_length >= 32)
+            {
+                h = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+                for (const uint64_t v: acc)
+                    h = xxh64_merge_round(h, v);
+            }
+            else
+            {
+                h = seed + k_xxh_prime5;
+            }
+
+            h += total_length;
+
+            const uint8_t* p{ buffer.data() };
+            const uint8_t* const end{ p + buffered };
+
+            for (; end - p >= 8; p += 8)
+            {
+                h ^= xxh64_round(0, read_le64(p));
+                h = std::rotl(h, 27) * k_xxh_prime1 + k_xxh_prime4;
+            }
+
+            if (end - p >= 4)
+            {
+                h ^= static_cast<uint64_t>(read_le32(p)) * k_xxh_prime1;
+                h = std::rotl(h, 23) * k_xxh_prime2 + k_xxh_prime3;
+                p += 4;
+            }
+
+            for (; p < end; ++p)
+            {
+                h ^= *p * k_xxh_prime5;
+                h = std::rotl(h, 11) * k_xxh_prime1;
+            }
+
+            h ^= h >> 33;
+            h *= k_xxh_prime2;
+            h ^= h >> 29;
+            h *= k_xxh_prime3;
+            h ^= h >> 32;
+
+            return h;
+        }
+
+    private:
+        constexpr void consume_stripe(const uint8_t* p) noexcept
+        {
+            for (uint32_t lane{ 0 }; lane < 4; ++lane)
+                acc[lane] = xxh64_round(acc[lane], read_le64(p + lane * 8));
+        }
+    };
+
+    /// @brief One-shot XXH64.
+    [[nodiscard]] constexpr uint64_t xxh64(const std::span<const uint8_t> data, const uint64_t seed = 0) noexcept
+    {
+        xxh64_state_t state{ };
+        state.reset(seed);
+        state.update(data);
+        return state.digest();
+    }
+
+    static_assert(xxh64({ }) == 0xEF46DB3751D8E999ull);
+} // namespace cpng
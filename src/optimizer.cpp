@@ -0,0 +1,414 @@
+//
+// Created by Zack Shrout on 3/29/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/optimizer.h"
+#include "cpng/chunks.h"
+
+#include "internal/chunk_writer.h"
+#include "internal/deflate_optimal.h"
+#include "internal/filter.h"
+#include "internal/parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace cpng {
+    namespace {
+        /// @brief Decoded pixels, RGBA16 native endian: every source decodes to it exactly.
+        struct pixels_t
+        {
+            const uint8_t*  data{ };
+            uint32_t        width{ };
+            uint32_t        height{ };
+
+            [[nodiscard]] uint16_t sample(const size_t pixel, const uint32_t channel) const noexcept
+            {
+                uint16_t v;
+                std::memcpy(&v, data + (pixel * 4 + channel) * 2, 2);
+                return v;
+            }
+        };
+
+        /// @brief Step between the values a bit depth can hold, on the 16-bit scale (1-bit: 0 and 65535).
+        [[nodiscard]] constexpr uint32_t depth_step(const uint32_t depth) noexcept
+        {
+            return 65535u / ((1u << depth) - 1u);
+        }
+
+        /// @brief What the pixels allow: the facts every lossless layout is derived from.
+        struct analysis_t
+        {
+            bool                        opaque{ true };
+            bool                        gray{ true };
+            bool                        fits8{ true };      // every sample is v * 257
+            uint8_t                     gray_depth{ 1 };    // smallest depth holding every R sample
+        };
+
+        [[nodiscard]] analysis_t analyze(const pixels_t& px) noexcept
+        {
+            analysis_t a{ };
+
+            const size_t count{ static_cast<size_t>(px.width) * px.height };
+            uint32_t depth_ok{ 0x1F }; // bit i: depth 1 << i holds every R sample
+
+            for (size_t i{ 0 }; i < count; ++i)
+            {
+                const uint16_t r{ px.sample(i, 0) };
+                const uint16_t g{ px.sample(i, 1) };
+                const uint16_t b{ px.sample(i, 2) };
+                const uint16_t alpha{ px.sample(i, 3) };
+
+                if (alpha != 0xFFFF) a.opaque = false;
+                if (r != g || g != b) a.gray = false;
+                if (r % 257 != 0 || g % 257 != 0 || b % 257 != 0 || alpha % 257 != 0) a.fits8 = false;
+
+                for (uint32_t d{ 0 }; d < 4; ++d)
+                    if (r % depth_step(1u << d) != 0) depth_ok &= ~(1u << d);
+            }
+
+            a.gray_depth = static_cast<uint8_t>(1u << std::countr_zero(depth_ok));
+
+            return a;
+        }
+
+        /// @brief A PNG pixel layout that holds the image without loss.
+        struct layout_t
+        {
+            uint8_t                     color_type{ };
+            uint8_t                     bit_depth{ };
+            bool                        keyed{ false };     // tRNS color key (color types 0 and 2)
+            std::array<uint16_t, 3>     key{ };             // 16-bit scale
+
+            [[nodiscard]] uint32_t channels() const noexcept
+            {
+                switch (color_type)
+                {
+                    case 0:     return 1;
+                    case 4:     return 2;
+                    case 2:     return 3;
+                    default:    return 4;
+                }
+            }
+        };
+
+        /**
+         * The smallest layout that holds the pixels: gray before color, no alpha before alpha, 8 bits
+         * before 16 and, for gray without alpha, the smallest exact sub-byte depth. Without `reduce`
+         * the file's own color type and bit depth.
+         *
+         * A tRNS color key is carried over when the layout can still express it. One it cannot (a
+         * colored key on gray pixels, a value between the steps of the smaller depth) matched no
+         * pixel in the first place.
+         */
+        [[nodiscard]] layout_t choose_layout(const analysis_t& a, const ihdr_info_t& ihdr,
+                                             const std::optional<std::array<uint16_t, 3>>& key,
+                                             const bool reduce) noexcept
+        {
+            const auto wide_depth{ static_cast<uint8_t>(a.fits8 ? 8 : 16) };
+
+            layout_t l{ .color_type = ihdr.color_type, .bit_depth = ihdr.bit_depth };
+
+            if (reduce && a.gray)
+                l = a.opaque ? layout_t{ .color_type = 0, .bit_depth = a.gray_depth }
+                             : layout_t{ .color_type = 4, .bit_depth = wide_depth };
+            else if (reduce)
+                l = { .color_type = static_cast<uint8_t>(a.opaque ? 2 : 6), .bit_depth = wide_depth };
+
+            if (key.has_value() && (l.color_type == 0 || l.color_type == 2))
+            {
+                const uint32_t step{ l.bit_depth < 16 ? depth_step(l.bit_depth) : 1u };
+                const bool gray_key{ (*key)[0] == (*key)[1] && (*key)[1] == (*key)[2] };
+
+                l.keyed = (l.color_type == 2 || gray_key) &&
+                          std::ranges::all_of(*key, [&](const uint16_t v) { return v % step == 0; });
+                l.key = *key;
+            }
+
+            return l;
+        }
+
+        /// @brief The tRNS color key of a gray or RGB file on the 16-bit scale, if it has one.
+        [[nodiscard]] std::optional<std::array<uint16_t, 3>> read_color_key(const std::span<const uint8_t> png,
+                                                                            const ihdr_info_t& ihdr) noexcept
+        {
+            if (ihdr.color_type != 0 && ihdr.color_type != 2) return std::nullopt;
+
+            const size_t samples{ ihdr.color_type == 0 ? 1u : 3u };
+            const uint32_t step{ ihdr.bit_depth < 16 ? depth_step(ihdr.bit_depth) : 1u };
+            const uint32_t mask{ (1u << ihdr.bit_depth) - 1u };
+
+            chunk_reader_t reader{ png };
+            png_chunk_t chunk{ };
+
+            while (reader.next(chunk))
+            {
+                if (chunk.type != chunk_type("tRNS") || chunk.data.size() < samples * 2) continue;
+
+                std::array<uint16_t, 3> key{ };
+                for (size_t c{ 0 }; c < 3; ++c)
+                {
+                    const size_t at{ (samples == 1 ? 0 : c) * 2 };
+                    const uint32_t v{ (static_cast<uint32_t>(chunk.data[at]) << 8 | chunk.data[at + 1]) & mask };
+                    key[c] = static_cast<uint16_t>(v * step);
+                }
+
+                return key;
+            }
+
+            return std::nullopt;
+        }
+
+        [[nodiscard]] size_t row_bytes_for(const layout_t& l, const uint32_t width) noexcept
+        {
+            return (static_cast<size_t>(width) * l.channels() * l.bit_depth + 7) / 8;
+        }
+
+        /// @brief Filter stride in bytes (1 for sub-byte pixels).
+        [[nodiscard]] uint32_t filter_bpp(const layout_t& l) noexcept
+        {
+            return std::max(1u, l.channels() * l.bit_depth / 8);
+        }
+
+        /// @brief Writes the image in layout `l` as unfiltered scanlines, without filter bytes.
+        void pack_image(const pixels_t& px, const layout_t& l, std::vector<uint8_t>& out)
+        {
+            const size_t row_bytes{ row_bytes_for(l, px.width) };
+            out.assign(row_bytes * px.height, 0);
+
+            // RGBA16 channels written for each color type, in PNG sample order
+            static constexpr uint32_t k_channels[7][4]{ { 0 }, { }, { 0, 1, 2 }, { }, { 0, 3 }, { }, { 0, 1, 2, 3 } };
+            const uint32_t channels{ l.channels() };
+            const uint32_t step{ l.bit_depth < 16 ? depth_step(l.bit_depth) : 1u };
+
+            for (uint32_t y{ 0 }; y < px.height; ++y)
+            {
+                uint8_t* row{ out.data() + y * row_bytes };
+                size_t bit{ 0 };
+
+                for (uint32_t x{ 0 }; x < px.width; ++x)
+                {
+                    const size_t p{ static_cast<size_t>(y) * px.width + x };
+
+                    for (uint32_t c{ 0 }; c < channels; ++c)
+                    {
+                        const uint32_t v{ px.sample(p, k_channels[l.color_type][c]) / step };
+
+                        if (l.bit_depth == 16)
+                        {
+                            row[bit / 8] = static_cast<uint8_t>(v >> 8);
+                            row[bit / 8 + 1] = static_cast<uint8_t>(v);
+                        }
+                        else
+                        {
+                            // Sub-byte samples fill each byte from the high bits down
+                            row[bit / 8] |= static_cast<uint8_t>(v << (8 - l.bit_depth - bit % 8));
+                        }
+
+                        bit += l.bit_depth;
+                    }
+                }
+            }
+        }
+
+        /// @brief Bytes a quick deflate_fast pass makes of `data`: the yardstick for every trial.
+        [[nodiscard]] size_t trial_bytes(const std::span<const uint8_t> data, const uint32_t bpp,
+                                         std::vector<uint8_t>& scratch) noexcept
+        {
+            scratch.clear();
+            bit_writer_t writer{ scratch };
+            deflate_fast(data, writer, true, { .rle_distance = bpp });
+            writer.finish();
+            return scratch.size();
+        }
+
+        /// @brief Filters `raw` (rows of `row_bytes`) into `out`, filter byte + row for every row.
+        void filter_image(const std::span<const uint8_t> raw, const size_t row_bytes, const uint32_t height,
+                          const uint32_t bpp, const filter_strategy strategy, std::vector<uint8_t>& out)
+        {
+            // Context a brute force trial compresses the candidate row after
+            constexpr size_t brute_force_context{ 16u << 10 };
+
+            const size_t line{ row_bytes + 1 };
+            out.assign(line * height, 0);
+
+            const std::vector<uint8_t> zero_row(row_bytes, 0);
+            std::vector<uint8_t> trial(5 * row_bytes);
+            std::vector<uint8_t> window;
+            std::vector<uint8_t> scratch;
+
+            for (uint32_t y{ 0 }; y < height; ++y)
+            {
+                const uint8_t* row{ raw.data() + y * row_bytes };
+                const uint8_t* prior{ y == 0 ? zero_row.data() : row - row_bytes };
+                uint8_t* dst{ out.data() + y * line };
+
+                if (strategy < filter_strategy::min_sum)
+                {
+                    dst[0] = static_cast<uint8_t>(strategy);
+                    filter_row(dst[0], dst + 1, row, prior, row_bytes, bpp);
+                    continue;
+                }
+
+                uint8_t best{ 0 };
+                uint64_t best_cost{ std::numeric_limits<uint64_t>::max() };
+
+                const size_t context_begin{ y * line > brute_force_context ? y * line - brute_force_context : 0 };
+
+                for (uint8_t f{ 0 }; f < 5; ++f)
+                {
+                    uint8_t* candidate{ trial.data() + f * row_bytes };
+                    filter_row(f, candidate, row, prior, row_bytes, bpp);
+
+                    uint64_t cost;
+                    if (strategy == filter_strategy::min_sum)
+                    {
+                        cost = filtered_row_cost(candidate, row_bytes);
+                    }
+                    else
+                    {
+                        window.assign(out.data() + context_begin, dst);
+                        window.push_back(f);
+                        window.insert(window.end(), candidate, candidate + row_bytes);
+                        cost = trial_bytes(window, bpp, scratch);
+                    }
+
+                    if (cost < best_cost)
+                    {
+                        best = f;
+                        best_cost = cost;
+                    }
+                }
+
+                dst[0] = best;
+                std::memcpy(dst + 1, trial.data() + best * row_bytes, row_bytes);
+            }
+        }
+
+        /// @brief Color space chunks: independent of the pixel encoding, so they survive it.
+        [[nodiscard]] bool is_color_chunk(const uint32_t type) noexcept
+        {
+            return type == chunk_type("iCCP") || type == chunk_type("sRGB") || type == chunk_type("gAMA") ||
+                   type == chunk_type("cHRM") || type == chunk_type("cICP");
+        }
+
+        /// @brief Safe-to-copy bit: lower case fourth letter. Other chunks depend on the image data.
+        [[nodiscard]] constexpr bool is_safe_to_copy(const uint32_t type) noexcept
+        {
+            return (type & 0x20u) != 0;
+        }
+    } // anonymous namespace
+
+    decode_error optimize_png(const std::span<const uint8_t> png, std::vector<uint8_t>& out_png,
+                              optimize_report_t& out_report, const optimize_options_t& options) noexcept
+    {
+        out_png.clear();
+        out_report = { .input_bytes = png.size() };
+
+        ihdr_info_t ihdr{ };
+        if (const decode_error err{ read_ihdr_from_memory(png, ihdr) }; err != decode_error::ok) return err;
+
+        image_view_t image{ };
+        std::vector<uint8_t> storage;
+        if (const decode_error err{ load_from_memory(png, image, storage, { .format = pixel_format::rgba16 }) };
+            err != decode_error::ok)
+            return err;
+
+        const pixels_t px{ .data = storage.data(), .width = image.width, .height = image.height };
+        const analysis_t analysis{ analyze(px) };
+        const layout_t layout{ choose_layout(analysis, ihdr, read_color_key(png, ihdr), options.reduce) };
+        const size_t row_bytes{ row_bytes_for(layout, image.width) };
+        const uint32_t bpp{ filter_bpp(layout) };
+
+        std::vector<uint8_t> packed;
+        pack_image(px, layout, packed);
+        storage = { };
+
+        // Every filter strategy, sized by a fast trial compression
+        constexpr uint32_t strategies{ 7 };
+        std::array<size_t, strategies> trial_size{ };
+
+        const uint32_t threads{ resolve_thread_count(options.worker_threads) };
+
+        parallel_for(strategies, threads, [&](const uint32_t t) noexcept {
+            std::vector<uint8_t> filtered;
+            std::vector<uint8_t> scratch;
+
+            filter_image(packed, row_bytes, image.height, bpp, static_cast<filter_strategy>(t), filtered);
+            trial_size[t] = trial_bytes(filtered, bpp, scratch);
+        });
+
+        const auto strategy{ static_cast<filter_strategy>(std::ranges::min_element(trial_size) - trial_size.begin()) };
+
+        std::vector<uint8_t> filtered;
+        filter_image(packed, row_bytes, image.height, bpp, strategy, filtered);
+        packed = { };
+
+        std::vector<uint8_t> zlib;
+        write_zlib_header(zlib, 3);
+        {
+            bit_writer_t writer{ zlib };
+            deflate_optimal(filtered, writer, true,
+                            { .iterations = options.iterations, .max_chain = options.max_chain, .threads = threads });
+            writer.finish();
+        }
+        write_be_u32(zlib, adler32(filtered));
+
+        // File: color chunks, tRNS, other kept chunks, IDAT
+        write_png_header(out_png, image.width, image.height, layout.bit_depth, layout.color_type);
+
+        std::vector<png_chunk_t> kept;
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+
+        while (reader.next(chunk))
+        {
+            // A color key is written anew for the output layout
+            if (chunk.is_critical() || (layout.keyed && chunk.type == chunk_type("tRNS"))) continue;
+
+            const bool keep{
+                is_color_chunk(chunk.type)
+                    ? options.keep_color_chunks
+                    : is_safe_to_copy(chunk.type) && std::ranges::find(options.keep_chunks, chunk.type) !=
+                                                     options.keep_chunks.end()
+            };
+
+            if (keep) kept.push_back(chunk);
+            else ++out_report.chunks_removed;
+        }
+
+        for (const png_chunk_t& c: kept)
+            if (is_color_chunk(c.type)) write_chunk(out_png, c.type, c.data);
+
+        if (layout.keyed)
+        {
+            // Key samples on the layout's scale, 16-bit big-endian each
+            const uint32_t step{ layout.bit_depth < 16 ? depth_step(layout.bit_depth) : 1u };
+            std::vector<uint8_t> trns;
+
+            for (uint32_t c{ 0 }; c < (layout.color_type == 0 ? 1u : 3u); ++c)
+            {
+                const uint32_t v{ layout.key[c] / step };
+                trns.insert(trns.end(), { static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) });
+            }
+
+            write_chunk(out_png, chunk_type("tRNS"), trns);
+        }
+
+        for (const png_chunk_t& c: kept)
+            if (!is_color_chunk(c.type)) write_chunk(out_png, c.type, c.data);
+
+        write_idat_chunks(out_png, zlib, 0);
+        write_chunk(out_png, chunk_type("IEND"), { });
+
+        out_report.output_bytes = out_png.size();
+        out_report.color_type = layout.color_type;
+        out_report.bit_depth = layout.bit_depth;
+        out_report.filter = strategy;
+
+        return decode_error::ok;
+    }
+} // namespace cpng
@@ -0,0 +1,153 @@
+//
+// Created by Zack Shrout on 4/2/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+#include "cpng/trace.h"
+
+#include "internal/trace.h"
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace cpng {
+    namespace {
+        trace_hooks_t       g_hooks{ };
+        std::atomic<bool>   g_hooks_installed{ false };
+
+        [[nodiscard]] uint64_t steady_ns() noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /// @brief Appends `name` as a JSON string; zone names are literals, but quote them properly anyway.
+        void append_json_string(std::string& out, const char* name)
+        {
+            out += '"';
+            for (const char* c{ name }; *c != '\0'; ++c)
+            {
+                if (*c == '"' || *c == '\\') out += '\\';
+                if (static_cast<unsigned char>(*c) >= 0x20) out += *c;
+            }
+            out += '"';
+        }
+
+        template <typename T>
+        void append_number(std::string& out, const T value)
+        {
+            char buffer[32];
+            const auto [end, ec]{ std::to_chars(buffer, buffer + sizeof(buffer), value) };
+            out.append(buffer, ec == std::errc{ } ? end : buffer);
+        }
+    } // anonymous namespace
+
+#if CPNG_HAS_TRACE
+    const trace_hooks_t* active_trace_hooks() noexcept
+    {
+        return g_hooks_installed.load(std::memory_order_acquire) ? &g_hooks : nullptr;
+    }
+#endif
+
+    bool trace_compiled_in() noexcept
+    {
+        return CPNG_HAS_TRACE != 0;
+    }
+
+    void set_trace_hooks(const trace_hooks_t& hooks) noexcept
+    {
+        g_hooks_installed.store(false, std::memory_order_release);
+
+        if (!hooks.begin_zone || !hooks.end_zone || !hooks.counter) return;
+
+        g_hooks = hooks;
+        g_hooks_installed.store(true, std::memory_order_release);
+    }
+
+    chrome_trace_writer_t::chrome_trace_writer_t() noexcept : _origin_ns{ steady_ns() }
+    {
+    }
+
+    trace_hooks_t chrome_trace_writer_t::hooks() noexcept
+    {
+        return {
+            .begin_zone = [](void* user, const char* name) noexcept {
+                static_cast<chrome_trace_writer_t*>(user)->record(name, 'B', 0);
+            },
+            .end_zone = [](void* user, const char* name) noexcept {
+                static_cast<chrome_trace_writer_t*>(user)->record(name, 'E', 0);
+            },
+            .counter = [](void* user, const char* name, const int64_t value) noexcept {
+                static_cast<chrome_trace_writer_t*>(user)->record(name, 'C', value);
+            },
+            .user = this
+        };
+    }
+
+    size_t chrome_trace_writer_t::event_count() const noexcept
+    {
+        const std::lock_guard lock{ _mutex };
+        return _events.size();
+    }
+
+    void chrome_trace_writer_t::clear() noexcept
+    {
+        const std::lock_guard lock{ _mutex };
+        _events.clear();
+    }
+
+    void chrome_trace_writer_t::record(const char* name, const char phase, const int64_t value) noexcept
+    {
+        const uint64_t now{ steady_ns() };
+        const auto thread{ static_cast<uint32_t>(std::hash<std::thread::id>{ }(std::this_thread::get_id())) };
+
+        const std::lock_guard lock{ _mutex };
+        _events.push_back({ .name = name, .time_ns = now, .value = value, .thread = thread, .phase = phase });
+    }
+
+    decode_error chrome_trace_writer_t::write(const char* path) const noexcept
+    {
+        std::string json{ "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" };
+
+        {
+            const std::lock_guard lock{ _mutex };
+            json.reserve(json.size() + _events.size() * 96);
+
+            for (size_t i{ 0 }; i < _events.size(); ++i)
+            {
+                const event_t& event{ _events[i] };
+
+                json += i == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+                append_json_string(json, event.name);
+                json += ",\"cat\":\"cpng\",\"ph\":\"";
+                json += event.phase;
+                json += "\",\"pid\":1,\"tid\":";
+                append_number(json, event.thread);
+                json += ",\"ts\":"; // microseconds
+                append_number(json, static_cast<double>(event.time_ns - _origin_ns) / 1000.0);
+
+                if (event.phase == 'C')
+                {
+                    json += ",\"args\":{\"value\":";
+                    append_number(json, event.value);
+                    json += '}';
+                }
+
+                json += '}';
+            }
+        }
+
+        json += "\n]}\n";
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return decode_error::file_write_failed;
+
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        return file.good() ? decode_error::ok : decode_error::file_write_failed;
+    }
+} // namespace cpng
@@ -0,0 +1,169 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Adam7 decodes: full decodes match the reference pixels for every layout and for images small
+// enough to have empty passes; pass-limited previews replicate each pixel over its block and
+// read only the part of the stream their passes need.
+
+#include "test_support.h"
+
+#include <cstring>
+
+using namespace cpng;
+
+namespace {
+    /// @brief Block each pass's pixels stand for in a preview, as width and height.
+    constexpr std::array<std::array<uint32_t, 2>, 7> k_blocks{ {
+        { 8, 8 }, { 4, 8 }, { 4, 4 }, { 2, 4 }, { 2, 2 }, { 1, 2 }, { 1, 1 },
+    } };
+
+    /// @brief Reference preview: passes painted in order, each pixel filling its clipped block.
+    std::vector<uint8_t> expected_preview(const uint32_t width, const uint32_t height,
+                                          const std::vector<uint8_t>& rgba, const uint32_t passes)
+    {
+        std::vector<uint8_t> out(rgba.size(), 0);
+        for (uint32_t p{ 0 }; p < passes; ++p)
+        {
+            const auto [x0, y0, dx, dy]{ test::adam7_passes[p] };
+            for (uint32_t y{ y0 }; y < height; y += dy)
+            {
+                for (uint32_t x{ x0 }; x < width; x += dx)
+                {
+                    for (uint32_t by{ y }; by < std::min(y + k_blocks[p][1], height); ++by)
+                    {
+                        for (uint32_t bx{ x }; bx < std::min(x + k_blocks[p][0], width); ++bx)
+                        {
+                            std::copy_n(rgba.begin() + (static_cast<size_t>(y) * width + x) * 4, 4,
+                                        out.begin() + (static_cast<size_t>(by) * width + bx) * 4);
+                        }
+                    }
+                }
+            }
+        }
+        return out;
+    }
+
+    /// @brief Filtered bytes of the first `passes` passes of an interlaced image.
+    size_t pass_prefix_size(const test::png_spec_t& spec, const uint32_t passes)
+    {
+        size_t total{ 0 };
+        const uint32_t bits{ test::channel_count(spec.color_type) * spec.bit_depth };
+        for (uint32_t p{ 0 }; p < passes; ++p)
+        {
+            const auto [x0, y0, dx, dy]{ test::adam7_passes[p] };
+            const uint32_t w{ spec.width > x0 ? (spec.width - x0 + dx - 1) / dx : 0 };
+            const uint32_t h{ spec.height > y0 ? (spec.height - y0 + dy - 1) / dy : 0 };
+            if (w && h) total += h * (1 + (static_cast<size_t>(w) * bits + 7) / 8);
+        }
+        return total;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x028 };
+
+    constexpr std::array<std::pair<uint8_t, uint8_t>, 9> layouts{ {
+        { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 }, { 2, 8 }, { 4, 8 }, { 6, 8 }, { 6, 16 },
+    } };
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 8> sizes{ {
+        { 1, 1 }, { 2, 2 }, { 3, 1 }, { 1, 5 }, { 5, 3 }, { 8, 8 }, { 13, 21 }, { 40, 33 },
+    } };
+
+    // Full decodes
+    for (const auto& [color_type, depth]: layouts)
+    {
+        for (const auto& [w, h]: sizes)
+        {
+            const test::png_spec_t spec{ .width = w, .height = h, .bit_depth = depth, .color_type = color_type,
+                                         .interlace = 1 };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+
+            image_view_t view{ };
+            std::vector<uint8_t> storage;
+            CPNG_CHECK_OK(load_from_memory(png, view, storage));
+            CPNG_CHECK(test::equal_bytes(view.pixels, test::expected_rgba8(spec, samples)));
+
+            // Other output formats take the same scatter path
+            std::vector<uint8_t> wide;
+            CPNG_CHECK_OK(load_from_memory(png, view, wide, { .format = pixel_format::rgba16 }));
+            bool widened{ wide.size() == storage.size() * 2 };
+            for (size_t i{ 0 }; widened && i < storage.size(); ++i)
+            {
+                uint16_t v{ };
+                std::memcpy(&v, wide.data() + i * 2, 2);
+                widened = depth == 16 ? test::to_8bit(v, 16) == storage[i] : v == storage[i] * 257u;
+            }
+            CPNG_CHECK(widened);
+        }
+    }
+
+    // Previews
+    for (const auto& [w, h]: { std::pair<uint32_t, uint32_t>{ 1, 1 }, { 7, 5 }, { 16, 16 }, { 37, 29 } })
+    {
+        const test::png_spec_t spec{ .width = w, .height = h, .interlace = 1 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        const std::vector<uint8_t> rgba{ test::expected_rgba8(spec, samples) };
+
+        for (uint8_t passes{ 1 }; passes <= 7; ++passes)
+        {
+            image_view_t view{ };
+            std::vector<uint8_t> storage;
+            CPNG_CHECK_OK(load_from_memory(png, view, storage, { .adam7_passes = passes }));
+            CPNG_CHECK(storage == expected_preview(w, h, rgba, passes));
+        }
+
+        // 0 means a full decode
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .adam7_passes = 0 }));
+        CPNG_CHECK(storage == rgba);
+    }
+
+    // A preview stops reading after its passes: the rest of this stream is a reserved block type
+    {
+        const test::png_spec_t spec{ .width = 32, .height = 32, .interlace = 1 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> raw{ test::scanlines(spec, samples) };
+        const size_t prefix{ pass_prefix_size(spec, 2) };
+
+        std::vector<uint8_t> zlib{ 0x78, 0x01, 0x00, static_cast<uint8_t>(prefix), static_cast<uint8_t>(prefix >> 8),
+                                   static_cast<uint8_t>(~prefix), static_cast<uint8_t>(~prefix >> 8) };
+        zlib.insert(zlib.end(), raw.begin(), raw.begin() + static_cast<ptrdiff_t>(prefix));
+        zlib.insert(zlib.end(), { 0x07, 0, 0, 0, 0 });
+        const std::vector<uint8_t> png{ test::make_png(spec, zlib) };
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .adam7_passes = 2 }));
+        CPNG_CHECK(storage == expected_preview(32, 32, test::expected_rgba8(spec, samples), 2));
+        CPNG_CHECK(load_from_memory(png, view, storage, { .adam7_passes = 3 }) == decode_error::invalid_idat_stream);
+        CPNG_CHECK(load_from_memory(png, view, storage) == decode_error::invalid_idat_stream);
+    }
+
+    // Previews are ignored for non-interlaced images
+    {
+        const test::png_spec_t spec{ .width = 9, .height = 9 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, { .adam7_passes = 1 }));
+        CPNG_CHECK(storage == test::expected_rgba8(spec, samples));
+    }
+
+    // Interlace methods other than none and Adam7 are rejected
+    {
+        const test::png_spec_t spec{ .width = 2, .height = 2, .interlace = 2 };
+        const std::vector<uint8_t> raw(2 * 9, 0);
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(load_from_memory(test::make_png(spec, test::zlib_stored(raw)), view, storage) ==
+                   decode_error::unsupported_interlace);
+    }
+
+    return test::finish("adam7");
+}
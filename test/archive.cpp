@@ -0,0 +1,232 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Packed archives: write / open round trips with byte-exact entry data, index order, headers
+// from the index, lookups and decodes by name from several threads, and rejected inputs
+// (duplicate names, bad PNGs, missing, truncated or corrupted archives).
+
+#include "test_support.h"
+
+#include "cpng/archive.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace cpng;
+
+namespace {
+    struct source_t
+    {
+        std::string             name;
+        std::vector<uint8_t>    png;
+        std::vector<uint8_t>    rgba;
+        test::png_spec_t        spec;
+        bool                    has_gamma;  // gAMA of 1.0
+        bool                    has_srgb;
+    };
+
+    std::filesystem::path temp_path(const char* name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    std::vector<uint8_t> read_file(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{ } };
+    }
+
+    void write_file(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<archive_source_t> as_sources(const std::vector<source_t>& sources)
+    {
+        std::vector<archive_source_t> out;
+        for (const source_t& s: sources) out.push_back({ .name = s.name, .png = s.png });
+        return out;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x036 };
+    const std::filesystem::path path{ temp_path("carrotpng_archive.cpak") };
+
+    std::vector<source_t> sources;
+    for (uint32_t i{ 0 }; i < 40; ++i)
+    {
+        constexpr std::array<std::pair<uint8_t, uint8_t>, 5> layouts{ {
+            { 0, 1 }, { 0, 8 }, { 2, 8 }, { 4, 16 }, { 6, 8 },
+        } };
+        const auto& [color_type, depth]{ layouts[i % layouts.size()] };
+        const test::png_spec_t spec{ .width = 1 + rng.below(40), .height = 1 + rng.below(30), .bit_depth = depth,
+                                     .color_type = color_type, .interlace = static_cast<uint8_t>(i % 7 == 3) };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+
+        std::vector<test::extra_chunk_t> extra;
+        if (i % 4 == 1) extra.push_back({ "gAMA", { 0, 1, 0x86, 0xA0 } });    // 1.0
+        if (i % 4 == 2) extra.push_back({ "sRGB", { 0 } });
+
+        sources.push_back({ .name = "textures/" + std::to_string(i) + (i % 5 == 0 ? "_é.png" : ".png"),
+                            .png = test::make_png(spec, samples, extra),
+                            .rgba = test::expected_rgba8(spec, samples),
+                            .spec = spec,
+                            .has_gamma = i % 4 == 1,
+                            .has_srgb = i % 4 == 2 });
+    }
+
+    // Round trip
+    {
+        CPNG_CHECK_OK(write_archive(path.string().c_str(), as_sources(sources)));
+
+        archive_t archive{ };
+        CPNG_CHECK_OK(archive.open(path.string().c_str()));
+        CPNG_CHECK(archive.is_open() && archive.size() == sources.size());
+
+        // Index order is by name hash, every entry 8 byte aligned and inside the file
+        bool ordered{ true };
+        const uint64_t file_size{ std::filesystem::file_size(path) };
+        for (uint32_t i{ 0 }; i < archive.size(); ++i)
+        {
+            const archive_entry_t e{ archive.entry(i) };
+            ordered &= i == 0 || archive.entry(i - 1).name_hash <= e.name_hash;
+            ordered &= e.offset % 8 == 0 && e.offset + e.size <= file_size;
+        }
+        CPNG_CHECK(ordered);
+        CPNG_CHECK(archive.entry(archive.size()).name.empty());
+
+        for (const source_t& s: sources)
+        {
+            archive_entry_t e{ };
+            if (!CPNG_CHECK(archive.find(s.name, e))) continue;
+
+            CPNG_CHECK(e.name == s.name && e.size == s.png.size());
+            CPNG_CHECK(test::equal_bytes(archive.data(e), s.png));
+            CPNG_CHECK(e.ihdr.width == s.spec.width && e.ihdr.height == s.spec.height &&
+                       e.ihdr.bit_depth == s.spec.bit_depth && e.ihdr.color_type == s.spec.color_type &&
+                       e.ihdr.interlace_method == s.spec.interlace);
+
+            CPNG_CHECK(e.ihdr.has_gamma == s.has_gamma && e.ihdr.has_srgb == s.has_srgb);
+            CPNG_CHECK(!s.has_gamma || std::abs(e.ihdr.gamma - 1.0f) < 1e-5f);
+
+            image_view_t view{ };
+            std::vector<uint8_t> storage;
+            CPNG_CHECK_OK(archive.load(s.name, view, storage));
+            CPNG_CHECK(test::equal_bytes(view.pixels, s.rgba));
+        }
+
+        archive_entry_t e{ };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(!archive.find("textures/40.png", e) && !archive.find("", e));
+        CPNG_CHECK(archive.load("textures/40.png", view, storage) == decode_error::file_not_found);
+
+        // Lookups are const and lock free: decode every entry from several threads at once
+        std::atomic<uint32_t> mismatches{ 0 };
+        {
+            std::vector<std::jthread> threads;
+            for (uint32_t t{ 0 }; t < 4; ++t)
+            {
+                threads.emplace_back([&, t] {
+                    std::vector<uint8_t> pixels;
+                    for (size_t i{ t }; i < sources.size(); i += 2)
+                    {
+                        image_view_t v{ };
+                        if (archive.load(sources[i].name, v, pixels) != decode_error::ok ||
+                            !test::equal_bytes(v.pixels, sources[i].rgba))
+                            ++mismatches;
+                    }
+                });
+            }
+        }
+        CPNG_CHECK(mismatches == 0);
+
+        // Moves hand the mapping over
+        archive_t moved{ std::move(archive) };
+        CPNG_CHECK(!archive.is_open() && moved.size() == sources.size() && moved.find(sources[0].name, e));
+        archive = std::move(moved);
+        CPNG_CHECK(archive.is_open() && !moved.is_open());
+        archive.close();
+        CPNG_CHECK(!archive.is_open() && archive.size() == 0 && !archive.find(sources[0].name, e));
+    }
+
+    // An empty archive is valid
+    {
+        CPNG_CHECK_OK(write_archive(path.string().c_str(), { }));
+        archive_t archive{ };
+        CPNG_CHECK_OK(archive.open(path.string().c_str()));
+        archive_entry_t e{ };
+        CPNG_CHECK(archive.size() == 0 && !archive.find("a", e));
+    }
+
+    // Writer rejections
+    {
+        std::vector<archive_source_t> duplicate{ as_sources(sources) };
+        duplicate.push_back(duplicate[3]);
+        CPNG_CHECK(write_archive(path.string().c_str(), duplicate) == decode_error::invalid_archive);
+
+        std::vector<uint8_t> bad_crc{ sources[0].png };
+        bad_crc[29] ^= 1;   // IHDR CRC
+        const archive_source_t bad[]{ { .name = "bad.png", .png = bad_crc } };
+        CPNG_CHECK(write_archive(path.string().c_str(), bad) == decode_error::crc_mismatch);
+
+        const std::filesystem::path unwritable{ temp_path("carrotpng_no_such_dir") / "a.cpak" };
+        CPNG_CHECK(write_archive(unwritable.string().c_str(), as_sources(sources)) == decode_error::file_write_failed);
+    }
+
+    // Reader rejections: every malformed file is refused without reading out of bounds
+    {
+        CPNG_CHECK_OK(write_archive(path.string().c_str(), as_sources(sources)));
+        const std::vector<uint8_t> good{ read_file(path) };
+        const std::filesystem::path broken{ temp_path("carrotpng_archive_broken.cpak") };
+        archive_t archive{ };
+
+        CPNG_CHECK(archive.open(temp_path("carrotpng_missing.cpak").string().c_str()) == decode_error::file_not_found);
+
+        const auto rejects{ [&](const std::vector<uint8_t>& bytes) {
+            write_file(broken, bytes);
+            return archive.open(broken.string().c_str()) == decode_error::invalid_archive && !archive.is_open();
+        } };
+
+        CPNG_CHECK(rejects({ good.begin(), good.begin() + 16 }));               // shorter than the header
+        CPNG_CHECK(rejects({ good.begin(), good.end() - 1 }));                  // names cut short
+        CPNG_CHECK(rejects({ good.begin(), good.begin() + static_cast<ptrdiff_t>(good.size() / 2) }));
+
+        std::vector<uint8_t> bytes{ good };
+        bytes[0] = 'X';
+        CPNG_CHECK(rejects(bytes));
+
+        bytes = good;
+        bytes[4] = 2;   // version
+        CPNG_CHECK(rejects(bytes));
+
+        bytes = good;
+        bytes[8] += 1;  // entry count
+        CPNG_CHECK(rejects(bytes));
+
+        // An index record pointing past the index
+        bytes = good;
+        const size_t index_offset{ static_cast<size_t>(good[16] | good[17] << 8 | good[18] << 16) };
+        bytes[index_offset + 15] = 0x7F;
+        CPNG_CHECK(rejects(bytes));
+
+        // Out of order hashes
+        bytes = good;
+        std::swap_ranges(bytes.begin() + static_cast<ptrdiff_t>(index_offset),
+                         bytes.begin() + static_cast<ptrdiff_t>(index_offset + 8),
+                         bytes.begin() + static_cast<ptrdiff_t>(index_offset + 48));
+        CPNG_CHECK(rejects(bytes));
+
+        std::filesystem::remove(broken);
+    }
+
+    std::filesystem::remove(path);
+    return test::finish("archive");
+}
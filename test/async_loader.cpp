@@ -0,0 +1,198 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Asynchronous loads on both backends: single and batched loads decoding to the same pixels as
+// load_from_memory, decode options passed through, missing and truncated files, shallow queues,
+// callbacks that queue more work, and the destructor finishing what is queued.
+
+#include "test_support.h"
+
+#include "cpng/async_loader.h"
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+using namespace cpng;
+
+namespace {
+    struct loaded_file_t
+    {
+        std::string             path;
+        std::vector<uint8_t>    rgba;
+        std::vector<uint8_t>    rgba16;
+    };
+
+    std::string temp_path(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("carrotpng_async_" + name)).string();
+    }
+
+    void write_file(const std::string& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    /// @brief Collects batch results from the decode workers.
+    struct results_t
+    {
+        std::mutex                                      mutex;
+        std::vector<decode_error>                       errors;
+        std::vector<std::shared_ptr<decoded_image_t>>   images;
+        std::vector<uint32_t>                           calls;
+
+        explicit results_t(const size_t count) : errors(count, decode_error::ok), images(count), calls(count, 0) { }
+
+        batch_load_callback_t callback()
+        {
+            return [this](const size_t i, const decode_error err, std::shared_ptr<decoded_image_t> image) {
+                const std::scoped_lock lock{ mutex };
+                errors[i] = err;
+                images[i] = std::move(image);
+                ++calls[i];
+            };
+        }
+    };
+
+    void run_backend(const bool use_io_uring, const std::vector<loaded_file_t>& files)
+    {
+        std::vector<const char*> paths;
+        for (const loaded_file_t& f: files) paths.push_back(f.path.c_str());
+
+        const std::string missing{ temp_path("missing.png") };
+        const std::string truncated{ temp_path("truncated.png") };
+        write_file(truncated, { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n', 0, 0 });
+
+        // Batches, with I/O failures mixed in
+        {
+            async_loader_t loader{ { .decode_threads = 3, .queue_depth = 8, .use_io_uring = use_io_uring } };
+            if (!use_io_uring) CPNG_CHECK(!loader.uses_io_uring());
+
+            std::vector<const char*> batch{ paths };
+            batch.push_back(missing.c_str());
+            batch.push_back(truncated.c_str());
+
+            results_t results{ batch.size() };
+            loader.load_batch(batch, results.callback());
+            loader.wait();
+
+            bool decoded{ true };
+            for (size_t i{ 0 }; i < files.size(); ++i)
+            {
+                decoded &= results.calls[i] == 1 && results.errors[i] == decode_error::ok && results.images[i];
+                decoded &= results.images[i] && test::equal_bytes(results.images[i]->view.pixels, files[i].rgba);
+            }
+            CPNG_CHECK(decoded);
+
+            const size_t n{ files.size() };
+            CPNG_CHECK(results.calls[n] == 1 && !results.images[n]);
+            CPNG_CHECK(results.errors[n] == decode_error::file_not_found);
+            CPNG_CHECK(results.calls[n + 1] == 1 && results.errors[n + 1] == decode_error::file_too_short);
+
+            // Options reach the decode
+            results_t wide{ paths.size() };
+            loader.load_batch(paths, wide.callback(), { .format = pixel_format::rgba16 });
+            loader.wait();
+
+            bool options{ true };
+            for (size_t i{ 0 }; i < files.size(); ++i)
+                options &= wide.images[i] && wide.images[i]->view.format == pixel_format::rgba16 &&
+                           test::equal_bytes(wide.images[i]->view.pixels, files[i].rgba16);
+            CPNG_CHECK(options);
+        }
+
+        // Single loads, a queue one file deep, and callbacks that queue more loads
+        {
+            async_loader_t loader{ { .decode_threads = 2, .queue_depth = 1, .use_io_uring = use_io_uring } };
+
+            std::mutex mutex;
+            std::vector<uint32_t> calls(files.size(), 0);
+            uint32_t mismatches{ 0 };
+
+            for (size_t i{ 0 }; i < files.size(); ++i)
+            {
+                loader.load(paths[i], [&, i](const decode_error err, std::shared_ptr<decoded_image_t> image) {
+                    const bool ok{ err == decode_error::ok && test::equal_bytes(image->view.pixels, files[i].rgba) };
+
+                    // The first file queues every other one a second time
+                    if (i == 0)
+                    {
+                        for (size_t j{ 1 }; j < files.size(); ++j)
+                        {
+                            loader.load(paths[j], [&, j](const decode_error e, std::shared_ptr<decoded_image_t> img) {
+                                const bool same{ e == decode_error::ok &&
+                                                 test::equal_bytes(img->view.pixels, files[j].rgba) };
+                                const std::scoped_lock lock{ mutex };
+                                ++calls[j];
+                                mismatches += !same;
+                            });
+                        }
+                    }
+
+                    const std::scoped_lock lock{ mutex };
+                    ++calls[i];
+                    mismatches += !ok;
+                });
+            }
+            loader.wait();
+
+            bool counted{ calls[0] == 1 };
+            for (size_t i{ 1 }; i < calls.size(); ++i) counted &= calls[i] == 2;
+            CPNG_CHECK(counted && mismatches == 0);
+
+            // Nothing queued: returns at once
+            loader.wait();
+        }
+
+        // The destructor finishes queued loads before returning
+        {
+            results_t results{ paths.size() };
+            {
+                async_loader_t loader{ { .decode_threads = 1, .use_io_uring = use_io_uring } };
+                loader.load_batch(paths, results.callback());
+            }
+
+            bool finished{ true };
+            for (size_t i{ 0 }; i < files.size(); ++i) finished &= results.calls[i] == 1 && results.images[i];
+            CPNG_CHECK(finished);
+        }
+
+        std::filesystem::remove(truncated);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x039 };
+
+    std::vector<loaded_file_t> files;
+    for (uint32_t i{ 0 }; i < 48; ++i)
+    {
+        const bool large{ i % 8 == 7 };
+        const test::png_spec_t spec{ .width = 1 + rng.below(large ? 300 : 40),
+                                     .height = 1 + rng.below(large ? 200 : 30),
+                                     .color_type = static_cast<uint8_t>(i % 2 == 0 ? 0 : 6),
+                                     .interlace = static_cast<uint8_t>(i % 5 == 2) };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+
+        loaded_file_t f{ .path = temp_path(std::to_string(i) + ".png"), .rgba = test::expected_rgba8(spec, samples),
+                         .rgba16 = { } };
+        image_view_t view{ };
+        CPNG_CHECK_OK(load_from_memory(png, view, f.rgba16, { .format = pixel_format::rgba16 }));
+
+        write_file(f.path, png);
+        files.push_back(std::move(f));
+    }
+
+    // io_uring when the kernel allows it (it falls back to the thread pool otherwise), then the pool forced
+    run_backend(true, files);
+    run_backend(false, files);
+
+    for (const loaded_file_t& f: files) std::filesystem::remove(f.path);
+    return test::finish("async_loader");
+}
@@ -0,0 +1,223 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Atlases: rectangles inside the atlas and apart by the padding, every sprite's pixels in place
+// with zero padding around them, UVs, power of two sizes within the maximums, overflow, failed
+// inputs leaving the atlas empty, and the same result for any number of worker threads.
+
+#include "test_support.h"
+
+#include "cpng/atlas.h"
+
+#include <bit>
+
+using namespace cpng;
+
+namespace {
+    struct sprite_t
+    {
+        std::vector<uint8_t>    png;
+        std::vector<uint8_t>    rgba;
+        uint32_t                width;
+        uint32_t                height;
+    };
+
+    std::vector<sprite_t> make_sprites(const uint32_t count, test::rng_t& rng)
+    {
+        std::vector<sprite_t> sprites;
+        for (uint32_t i{ 0 }; i < count; ++i)
+        {
+            const test::png_spec_t spec{ .width = 1 + rng.below(24), .height = 1 + rng.below(24),
+                                         .color_type = static_cast<uint8_t>(i % 3 == 0 ? 2 : 6),
+                                         .interlace = static_cast<uint8_t>(i % 5 == 4) };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            sprites.push_back({ test::make_png(spec, samples), test::expected_rgba8(spec, samples),
+                                spec.width, spec.height });
+        }
+        return sprites;
+    }
+
+    std::vector<std::span<const uint8_t>> as_spans(const std::vector<sprite_t>& sprites)
+    {
+        std::vector<std::span<const uint8_t>> out;
+        for (const sprite_t& s: sprites) out.emplace_back(s.png);
+        return out;
+    }
+
+    /// @brief Checks placement, pixels, padding and UVs of a built atlas.
+    void check_atlas(const atlas_t& atlas, const std::vector<sprite_t>& sprites, const uint32_t padding)
+    {
+        const image_view_t& view{ atlas.view };
+        if (!CPNG_CHECK(atlas.rects.size() == sprites.size() && view.stride_bytes == view.width * 4)) return;
+        CPNG_CHECK(view.pixels.size() == size_t{ view.stride_bytes } * view.height);
+
+        bool inside{ true }, apart{ true }, placed{ true }, uvs{ true };
+        std::vector<uint8_t> covered(size_t{ view.width } * view.height, 0);
+        for (size_t i{ 0 }; i < sprites.size(); ++i)
+        {
+            const atlas_rect_t& r{ atlas.rects[i] };
+            inside &= r.width == sprites[i].width && r.height == sprites[i].height;
+            inside &= r.x + r.width <= view.width && r.y + r.height <= view.height;
+            if (!inside) break;
+
+            // Padded rectangles may touch but not overlap
+            for (size_t j{ 0 }; j < i; ++j)
+            {
+                const atlas_rect_t& o{ atlas.rects[j] };
+                apart &= r.x + r.width + padding <= o.x || o.x + o.width + padding <= r.x ||
+                         r.y + r.height + padding <= o.y || o.y + o.height + padding <= r.y;
+            }
+
+            for (uint32_t y{ 0 }; y < r.height; ++y)
+            {
+                const size_t offset{ size_t{ r.y + y } * view.stride_bytes + size_t{ r.x } * 4 };
+                placed &= std::equal(sprites[i].rgba.begin() + y * r.width * 4,
+                                     sprites[i].rgba.begin() + (y + 1) * r.width * 4, view.pixels.begin() + offset);
+                std::fill_n(covered.begin() + size_t{ r.y + y } * view.width + r.x, r.width, uint8_t{ 1 });
+            }
+
+            uvs &= r.u0 == static_cast<float>(r.x) / static_cast<float>(view.width);
+            uvs &= r.v0 == static_cast<float>(r.y) / static_cast<float>(view.height);
+            uvs &= r.u1 == static_cast<float>(r.x + r.width) / static_cast<float>(view.width);
+            uvs &= r.v1 == static_cast<float>(r.y + r.height) / static_cast<float>(view.height);
+        }
+        CPNG_CHECK(inside && apart && placed && uvs);
+
+        // Everything outside the sprites is transparent black
+        bool clear{ true };
+        for (size_t p{ 0 }; inside && p < covered.size(); ++p)
+        {
+            if (covered[p] == 0)
+                clear &= std::all_of(view.pixels.begin() + p * 4, view.pixels.begin() + p * 4 + 4,
+                                     [](const uint8_t b) { return b == 0; });
+        }
+        CPNG_CHECK(clear);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x037 };
+
+    // Packing and contents for several paddings
+    for (const uint32_t padding: { 0u, 1u, 3u })
+    {
+        const std::vector<sprite_t> sprites{ make_sprites(40, rng) };
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(build_atlas(as_spans(sprites), atlas, storage, { .padding = padding }));
+        check_atlas(atlas, sprites, padding);
+
+        // The atlas is not much larger than its sprites
+        uint64_t area{ 0 };
+        for (const sprite_t& s: sprites) area += uint64_t{ s.width + padding } * (s.height + padding);
+        CPNG_CHECK(uint64_t{ atlas.view.width } * atlas.view.height <= area * 2);
+    }
+
+    // Power of two sizes
+    {
+        const std::vector<sprite_t> sprites{ make_sprites(25, rng) };
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(build_atlas(as_spans(sprites), atlas, storage, { .power_of_two = true }));
+        CPNG_CHECK(std::has_single_bit(atlas.view.width) && std::has_single_bit(atlas.view.height));
+        check_atlas(atlas, sprites, 1);
+    }
+
+    // Power of two sizes stay within maximums that are not powers of two
+    {
+        std::vector<sprite_t> sprites;
+        for (uint32_t i{ 0 }; i < 5; ++i)
+        {
+            const test::png_spec_t spec{ .width = 16, .height = 16, .color_type = 6 };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            sprites.push_back({ test::make_png(spec, samples), test::expected_rgba8(spec, samples), 16, 16 });
+        }
+
+        // Two rows of a 64 wide bin; 100 x 40 allows 64 x 32
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(build_atlas(as_spans(sprites), atlas, storage,
+                                  { .max_width = 100, .max_height = 40, .padding = 0, .power_of_two = true }));
+        CPNG_CHECK(atlas.view.width == 64 && atlas.view.height == 32);
+        check_atlas(atlas, sprites, 0);
+
+        // One row of 80 would round up to 128, past the maximum
+        CPNG_CHECK(build_atlas(as_spans(sprites), atlas, storage,
+                               { .max_width = 100, .max_height = 20, .padding = 0, .power_of_two = true }) ==
+                   decode_error::atlas_overflow);
+        CPNG_CHECK(atlas.rects.empty() && atlas.view.pixels.empty());
+    }
+
+    // The same atlas for any number of workers
+    {
+        const std::vector<sprite_t> sprites{ make_sprites(60, rng) };
+        atlas_t serial{ }, parallel{ };
+        std::vector<uint8_t> serial_storage, parallel_storage;
+        CPNG_CHECK_OK(build_atlas(as_spans(sprites), serial, serial_storage, { }, { .worker_threads = 1 }));
+        CPNG_CHECK_OK(build_atlas(as_spans(sprites), parallel, parallel_storage, { }, { .worker_threads = 4 }));
+        CPNG_CHECK(serial.view.width == parallel.view.width && serial.view.height == parallel.view.height);
+        CPNG_CHECK(serial_storage == parallel_storage);
+
+        bool same_rects{ true };
+        for (size_t i{ 0 }; i < sprites.size(); ++i)
+            same_rects &= serial.rects[i].x == parallel.rects[i].x && serial.rects[i].y == parallel.rects[i].y;
+        CPNG_CHECK(same_rects);
+        check_atlas(parallel, sprites, 1);
+    }
+
+    // Nothing to pack is an empty atlas
+    {
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage(16, 1);
+        CPNG_CHECK_OK(build_atlas({ }, atlas, storage));
+        CPNG_CHECK(atlas.view.width == 0 && atlas.view.height == 0 && atlas.rects.empty() && storage.empty());
+    }
+
+    // Overflow: a sprite larger than the limits, or sprites that do not fit together
+    {
+        const test::png_spec_t spec{ .width = 40, .height = 40 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        const std::vector<std::span<const uint8_t>> one{ png };
+        const std::vector<std::span<const uint8_t>> five(5, png);
+
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(build_atlas(one, atlas, storage, { .max_width = 32 }) == decode_error::atlas_overflow);
+        CPNG_CHECK(build_atlas(one, atlas, storage, { .max_height = 39 }) == decode_error::atlas_overflow);
+        CPNG_CHECK(build_atlas(five, atlas, storage, { .max_width = 100, .max_height = 100 }) ==
+                   decode_error::atlas_overflow);
+        CPNG_CHECK(atlas.rects.empty() && atlas.view.width == 0);
+
+        // Exactly fitting with no padding
+        CPNG_CHECK_OK(build_atlas(std::vector<std::span<const uint8_t>>(4, png), atlas, storage,
+                                  { .max_width = 80, .max_height = 80, .padding = 0 }));
+        CPNG_CHECK(atlas.view.width == 80 && atlas.view.height == 80);
+    }
+
+    // A failing sprite fails the atlas and leaves it empty
+    {
+        std::vector<sprite_t> sprites{ make_sprites(12, rng) };
+        sprites[7].png[sprites[7].png.size() - 20] ^= 0x40;     // inside the last IDAT
+
+        atlas_t atlas{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(build_atlas(as_spans(sprites), atlas, storage, { }, { .worker_threads = 3 }) != decode_error::ok);
+        CPNG_CHECK(atlas.rects.empty() && atlas.view.width == 0 && atlas.view.pixels.empty() && storage.empty());
+
+        // A bad header is found before anything is decoded
+        sprites[3].png[12] = 'X';
+        CPNG_CHECK(build_atlas(as_spans(sprites), atlas, storage) != decode_error::ok);
+        CPNG_CHECK(atlas.rects.empty() && atlas.view.width == 0);
+
+        // Unsupported output formats are refused
+        sprites = make_sprites(2, rng);
+        const decode_options_t unsupported{ .format = static_cast<pixel_format>(0xFF) };
+        CPNG_CHECK(build_atlas(as_spans(sprites), atlas, storage, { }, unsupported) ==
+                   decode_error::unsupported_output_format);
+    }
+
+    return test::finish("atlas");
+}
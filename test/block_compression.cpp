@@ -0,0 +1,317 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Block compression: BC1/BC3/BC4/BC5 output run through a reference block decoder and held to
+// per-block error bounds, exact solid colors, block layout and edge replication, rejected
+// source / format pairs, and identical output for every thread count and for interlaced sources.
+
+#include "test_support.h"
+
+using namespace cpng;
+
+namespace {
+    void expand_565(const uint32_t c, int32_t out[3])
+    {
+        const uint32_t r{ c >> 11 & 31u };
+        const uint32_t g{ c >> 5 & 63u };
+        const uint32_t b{ c & 31u };
+        out[0] = static_cast<int32_t>(r << 3 | r >> 2);
+        out[1] = static_cast<int32_t>(g << 2 | g >> 4);
+        out[2] = static_cast<int32_t>(b << 3 | b >> 2);
+    }
+
+    /// @brief Reference BC1 color block decode into 16 RGB triplets (alpha untouched).
+    void decode_bc1(const uint8_t* block, uint8_t* rgba, const uint32_t pixel_stride)
+    {
+        const uint32_t c0{ block[0] | static_cast<uint32_t>(block[1]) << 8u };
+        const uint32_t c1{ block[2] | static_cast<uint32_t>(block[3]) << 8u };
+        int32_t palette[4][3];
+        expand_565(c0, palette[0]);
+        expand_565(c1, palette[1]);
+        for (uint32_t c{ 0 }; c < 3; ++c)
+        {
+            if (c0 > c1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        uint32_t indices{ 0 };
+        for (uint32_t b{ 0 }; b < 4; ++b)
+            indices |= static_cast<uint32_t>(block[4 + b]) << (b * 8);
+        for (uint32_t i{ 0 }; i < 16; ++i)
+        {
+            for (uint32_t c{ 0 }; c < 3; ++c)
+                rgba[i * pixel_stride + c] = static_cast<uint8_t>(palette[indices >> (i * 2) & 3u][c]);
+        }
+    }
+
+    /// @brief Reference BC4 block decode into 16 values, `stride` bytes apart.
+    void decode_bc4(const uint8_t* block, uint8_t* out, const uint32_t stride)
+    {
+        const uint32_t v0{ block[0] };
+        const uint32_t v1{ block[1] };
+        uint32_t palette[8]{ v0, v1 };
+        if (v0 > v1)
+        {
+            for (uint32_t k{ 1 }; k < 7; ++k)
+                palette[k + 1] = ((7 - k) * v0 + k * v1) / 7;
+        }
+        else
+        {
+            for (uint32_t k{ 1 }; k < 5; ++k)
+                palette[k + 1] = ((5 - k) * v0 + k * v1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices{ 0 };
+        for (uint32_t b{ 0 }; b < 6; ++b)
+            indices |= static_cast<uint64_t>(block[2 + b]) << (b * 8);
+        for (uint32_t i{ 0 }; i < 16; ++i)
+            out[i * stride] = static_cast<uint8_t>(palette[indices >> (i * 3) & 7u]);
+    }
+
+    /// @brief Decodes a whole image to blocks_x * 4 by blocks_y * 4 pixels of `channels` bytes.
+    std::vector<uint8_t> decode_blocks(const compressed_image_t& image, const uint32_t channels)
+    {
+        const uint32_t w{ image.blocks_x * 4 };
+        std::vector<uint8_t> out(static_cast<size_t>(w) * image.blocks_y * 4 * channels, 255);
+        uint8_t block[16 * 4];
+        std::fill_n(block, sizeof(block), uint8_t{ 255 }); // BC1 leaves alpha opaque
+
+        for (uint32_t by{ 0 }; by < image.blocks_y; ++by)
+        {
+            for (uint32_t bx{ 0 }; bx < image.blocks_x; ++bx)
+            {
+                const uint8_t* src{ image.blocks.data() + by * image.row_pitch_bytes +
+                                    bx * block_bytes(image.format) };
+                switch (image.format)
+                {
+                    case block_format::bc1: decode_bc1(src, block, channels); break;
+                    case block_format::bc3:
+                        decode_bc4(src, block + 3, 4);
+                        decode_bc1(src + 8, block, 4);
+                        break;
+                    case block_format::bc4: decode_bc4(src, block, 1); break;
+                    case block_format::bc5:
+                        decode_bc4(src, block, 2);
+                        decode_bc4(src + 8, block + 1, 2);
+                        break;
+                }
+
+                for (uint32_t y{ 0 }; y < 4; ++y)
+                {
+                    std::copy_n(block + y * 4 * channels, 4 * channels,
+                                out.begin() + ((static_cast<size_t>(by) * 4 + y) * w + bx * 4) * channels);
+                }
+            }
+        }
+        return out;
+    }
+
+    /// @brief Largest channel range of the 4×4 block holding pixel (x, y), edges repeated.
+    uint32_t block_range(const std::vector<uint8_t>& pixels, const uint32_t width, const uint32_t height,
+                         const uint32_t channels, const uint32_t x, const uint32_t y, const uint32_t c)
+    {
+        uint32_t lo{ 255 }, hi{ 0 };
+        for (uint32_t dy{ 0 }; dy < 4; ++dy)
+        {
+            for (uint32_t dx{ 0 }; dx < 4; ++dx)
+            {
+                const uint32_t sx{ std::min(x / 4 * 4 + dx, width - 1) };
+                const uint32_t sy{ std::min(y / 4 * 4 + dy, height - 1) };
+                const uint32_t v{ pixels[(static_cast<size_t>(sy) * width + sx) * channels + c] };
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+        }
+        return hi - lo;
+    }
+
+    compressed_image_t compress(const std::vector<uint8_t>& png, std::vector<uint8_t>& storage,
+                                const block_format format, const uint32_t threads = 1)
+    {
+        compressed_image_t image{ };
+        CPNG_CHECK_OK(load_compressed_from_memory(png, image, storage, format, { .worker_threads = threads }));
+        return image;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x032 };
+
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 5> sizes{ {
+        { 1, 1 }, { 5, 3 }, { 16, 16 }, { 37, 21 }, { 64, 9 },
+    } };
+
+    for (const auto& [w, h]: sizes)
+    {
+        // Layout: block counts, pitch and padding that repeats the last column and row
+        for (const block_format format: { block_format::bc1, block_format::bc3 })
+        {
+            const test::png_spec_t spec{ .width = w, .height = h };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            std::vector<uint8_t> storage;
+            const compressed_image_t image{ compress(test::make_png(spec, samples), storage, format) };
+
+            CPNG_CHECK(image.width == w && image.height == h && image.format == format);
+            CPNG_CHECK(image.blocks_x == (w + 3) / 4 && image.blocks_y == (h + 3) / 4);
+            CPNG_CHECK(image.row_pitch_bytes == image.blocks_x * block_bytes(format));
+            CPNG_CHECK(image.blocks.size() == image.row_pitch_bytes * image.blocks_y &&
+                       image.blocks.size() == compressed_size_bytes({ .width = w, .height = h }, format));
+
+            const std::vector<uint8_t> decoded{ decode_blocks(image, 4) };
+            const uint32_t dw{ image.blocks_x * 4 };
+            bool padded{ true };
+            for (uint32_t y{ 0 }; y < image.blocks_y * 4; ++y)
+            {
+                for (uint32_t x{ 0 }; x < dw; ++x)
+                {
+                    const size_t edge{ (static_cast<size_t>(std::min(y, h - 1)) * dw + std::min(x, w - 1)) * 4 };
+                    padded &= std::equal(decoded.begin() + (static_cast<ptrdiff_t>(y) * dw + x) * 4,
+                                         decoded.begin() + (static_cast<ptrdiff_t>(y) * dw + x) * 4 + 4,
+                                         decoded.begin() + static_cast<ptrdiff_t>(edge));
+                }
+            }
+            CPNG_CHECK(padded);
+        }
+
+        // Single channel blocks: within range / 14 (half a palette step) plus palette rounding
+        for (const auto& [format, color_type]: { std::pair{ block_format::bc4, uint8_t{ 0 } },
+                                                 std::pair{ block_format::bc5, uint8_t{ 4 } },
+                                                 std::pair{ block_format::bc3, uint8_t{ 6 } } })
+        {
+            const test::png_spec_t spec{ .width = w, .height = h, .color_type = color_type };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            std::vector<uint8_t> storage;
+            const compressed_image_t image{ compress(test::make_png(spec, samples), storage, format) };
+
+            const uint32_t channels{ format == block_format::bc4 ? 1u : format == block_format::bc5 ? 2u : 4u };
+            std::vector<uint8_t> source(samples.begin(), samples.end());
+            const std::vector<uint8_t> decoded{ decode_blocks(image, channels) };
+            const uint32_t dw{ image.blocks_x * 4 };
+
+            bool bounded{ true };
+            for (uint32_t y{ 0 }; y < h; ++y)
+            {
+                for (uint32_t x{ 0 }; x < w; ++x)
+                {
+                    for (uint32_t c{ format == block_format::bc3 ? 3u : 0u }; c < channels; ++c)
+                    {
+                        const int32_t expected{ source[(static_cast<size_t>(y) * w + x) * channels + c] };
+                        const int32_t actual{ decoded[(static_cast<size_t>(y) * dw + x) * channels + c] };
+                        const uint32_t range{ block_range(source, w, h, channels, x, y, c) };
+                        bounded &= static_cast<uint32_t>(std::abs(actual - expected)) <= range / 14 + 1;
+                    }
+                }
+            }
+            CPNG_CHECK(bounded);
+        }
+    }
+
+    // BC1 on smooth content: a gradient along one color axis stays close, 565 solid colors are exact
+    {
+        const test::png_spec_t spec{ .width = 64, .height = 64, .color_type = 2 };
+        std::vector<uint16_t> samples(64 * 64 * 3);
+        for (uint32_t y{ 0 }; y < 64; ++y)
+        {
+            for (uint32_t x{ 0 }; x < 64; ++x)
+            {
+                uint16_t* p{ samples.data() + (y * 64 + x) * 3 };
+                p[0] = static_cast<uint16_t>((x + y) * 2);
+                p[1] = static_cast<uint16_t>(x + y + 64);
+                p[2] = static_cast<uint16_t>(255 - (x + y) * 2);
+            }
+        }
+        std::vector<uint8_t> storage;
+        const compressed_image_t image{ compress(test::make_png(spec, samples), storage, block_format::bc1) };
+        const std::vector<uint8_t> decoded{ decode_blocks(image, 4) };
+
+        // Endpoints are rounded to 565 (up to 4 off per channel) and every pixel snaps to a third
+        int32_t worst{ 0 };
+        int64_t total{ 0 };
+        for (size_t i{ 0 }; i < 64 * 64; ++i)
+        {
+            for (size_t c{ 0 }; c < 3; ++c)
+            {
+                const int32_t error{ std::abs(decoded[i * 4 + c] - static_cast<int32_t>(samples[i * 3 + c])) };
+                worst = std::max(worst, error);
+                total += error;
+            }
+        }
+        CPNG_CHECK(worst <= 12 && total <= 64 * 64 * 3 * 3);
+
+        // (16, 32, 31) in 565 expand to (132, 130, 255)
+        const test::png_spec_t solid_spec{ .width = 6, .height = 6, .color_type = 2 };
+        std::vector<uint16_t> solid(6 * 6 * 3);
+        for (size_t i{ 0 }; i < solid.size(); i += 3)
+        {
+            solid[i] = 132;
+            solid[i + 1] = 130;
+            solid[i + 2] = 255;
+        }
+        const compressed_image_t flat{ compress(test::make_png(solid_spec, solid), storage, block_format::bc1) };
+        const std::vector<uint8_t> flat_pixels{ decode_blocks(flat, 4) };
+        bool exact{ true };
+        for (size_t i{ 0 }; i < flat_pixels.size(); i += 4)
+            exact &= flat_pixels[i] == 132 && flat_pixels[i + 1] == 130 && flat_pixels[i + 2] == 255;
+        CPNG_CHECK(exact);
+    }
+
+    // Thread count and interlacing do not change a single byte
+    {
+        const test::png_spec_t spec{ .width = 67, .height = 203 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        test::png_spec_t interlaced{ spec };
+        interlaced.interlace = 1;
+        const std::vector<uint8_t> adam7_png{ test::make_png(interlaced, samples) };
+
+        for (const block_format format: { block_format::bc1, block_format::bc3 })
+        {
+            std::vector<uint8_t> reference;
+            compress(png, reference, format, 1);
+
+            for (const uint32_t threads: { 2u, 3u, 8u, 0u })
+            {
+                std::vector<uint8_t> storage;
+                compress(png, storage, format, threads);
+                CPNG_CHECK(storage == reference);
+                compress(adam7_png, storage, format, threads);
+                CPNG_CHECK(storage == reference);
+            }
+        }
+    }
+
+    // BC4 / BC5 need a grayscale source; unknown formats are rejected
+    {
+        compressed_image_t image{ };
+        std::vector<uint8_t> storage;
+        for (const uint8_t color_type: { 2, 6 })
+        {
+            const test::png_spec_t spec{ .width = 4, .height = 4, .color_type = color_type };
+            const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+            CPNG_CHECK(load_compressed_from_memory(png, image, storage, block_format::bc4) ==
+                       decode_error::unsupported_output_format);
+            CPNG_CHECK(load_compressed_from_memory(png, image, storage, block_format::bc5) ==
+                       decode_error::unsupported_output_format);
+        }
+
+        const test::png_spec_t spec{ .width = 4, .height = 4 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        CPNG_CHECK(load_compressed_from_memory(png, image, storage, static_cast<block_format>(9)) ==
+                   decode_error::unsupported_output_format);
+    }
+
+    return test::finish("block_compression");
+}
@@ -0,0 +1,261 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Chunk access: the reader's types, names, payload spans, offsets and lazy CRCs, why iteration
+// stops on broken files, and the iCCP / tEXt / zTXt / iTXt / pHYs / stripe index decoders on
+// good, malformed and oversized payloads.
+
+#include "test_support.h"
+
+#include "cpng/chunks.h"
+
+#include <string>
+
+using namespace cpng;
+using namespace std::string_view_literals;
+
+namespace {
+    uint32_t get_u32(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+               static_cast<uint32_t>(p[2]) << 8 | p[3];
+    }
+
+    std::vector<uint8_t> bytes_of(const std::string_view text)
+    {
+        return { text.begin(), text.end() };
+    }
+
+    /// @brief `head`, then `body` as a stored zlib stream.
+    std::vector<uint8_t> with_zlib(std::vector<uint8_t> head, const std::string_view body)
+    {
+        const std::vector<uint8_t> zlib{ test::zlib_stored(bytes_of(body)) };
+        head.insert(head.end(), zlib.begin(), zlib.end());
+        return head;
+    }
+
+    /// @brief A chunk over `data`, as the reader would return it from a file.
+    struct framed_chunk_t
+    {
+        std::vector<uint8_t>    bytes;
+        png_chunk_t             chunk;
+
+        framed_chunk_t(const char (&type)[5], const std::vector<uint8_t>& data)
+        {
+            test::put_chunk(bytes, type, data);
+            chunk = { .type = get_u32(bytes.data() + 4), .data = { bytes.data() + 8, data.size() },
+                      .crc = get_u32(bytes.data() + 8 + data.size()), .offset = 0 };
+        }
+    };
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x040 };
+
+    static_assert(chunk_type("IDAT") == 0x49444154u && chunk_type("tEXt") == 0x74455874u);
+
+    // Walking a file: every chunk in order, payloads pointing into the buffer
+    {
+        const test::png_spec_t spec{ .width = 9, .height = 7 };
+        const std::vector<uint8_t> zlib{ test::zlib_stored(test::scanlines(spec, test::random_samples(spec, rng))) };
+        const std::vector<uint8_t> png{ test::make_png(spec, zlib, {
+            { "gAMA", { 0, 0, 0xB1, 0x8F } },
+            { "tEXt", bytes_of("Title\0Carrot"sv) },
+            { "eNGn", { } },
+        }, 100) };
+
+        const std::vector<std::string> expected{ "IHDR", "gAMA", "tEXt", "eNGn", "IDAT", "IDAT", "IDAT", "IEND" };
+        std::vector<std::string> names;
+        bool framed{ true };
+        size_t offset{ 8 };
+
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        while (reader.next(chunk))
+        {
+            names.push_back(chunk.name());
+            framed &= chunk.offset == offset && chunk.data.data() == png.data() + offset + 8;
+            framed &= chunk.type == get_u32(png.data() + offset + 4) && chunk.crc_ok();
+            framed &= chunk.is_critical() == (chunk.name()[0] >= 'A' && chunk.name()[0] <= 'Z');
+            offset += 12 + chunk.data.size();
+        }
+        CPNG_CHECK(reader.error() == decode_error::ok && names == expected && framed && offset == png.size());
+
+        // The name comes from the type alone, so a chunk outside any file has one too
+        png_chunk_t loose{ .type = chunk_type("eNGn") };
+        CPNG_CHECK(loose.name() == "eNGn" && png_chunk_t{ }.name() == std::string(4, '\0'));
+
+        // Done after IEND, even with trailing bytes
+        std::vector<uint8_t> trailing{ png };
+        trailing.insert(trailing.end(), { 1, 2, 3 });
+        chunk_reader_t tail{ trailing };
+        size_t count{ 0 };
+        while (tail.next(chunk)) ++count;
+        CPNG_CHECK(count == expected.size() && tail.error() == decode_error::ok && !tail.next(chunk));
+
+        // CRCs are only checked on request: a bad one still iterates
+        std::vector<uint8_t> corrupt{ png };
+        corrupt[33 + 8] ^= 1;     // gAMA payload
+        chunk_reader_t bad_crc{ corrupt };
+        CPNG_CHECK(bad_crc.next(chunk) && chunk.crc_ok());
+        CPNG_CHECK(bad_crc.next(chunk) && chunk.type == chunk_type("gAMA") && !chunk.crc_ok());
+        while (bad_crc.next(chunk)) { }
+        CPNG_CHECK(bad_crc.error() == decode_error::ok);
+
+        // Why iteration stops
+        const auto stops_with{ [](const std::vector<uint8_t>& bytes) {
+            chunk_reader_t r{ bytes };
+            png_chunk_t c{ };
+            while (r.next(c)) { }
+            return r.error();
+        } };
+
+        std::vector<uint8_t> bytes{ png };
+        bytes[1] = 'Q';
+        CPNG_CHECK(stops_with(bytes) == decode_error::invalid_signature);
+        CPNG_CHECK(stops_with({ png.begin(), png.end() - 12 }) == decode_error::no_iend);
+        CPNG_CHECK(stops_with({ png.begin(), png.end() - 5 }) == decode_error::file_too_short);
+        CPNG_CHECK(stops_with({ png.begin(), png.end() - 14 }) == decode_error::invalid_chunk_length);
+
+        bytes = png;
+        bytes[33] = 0x80;   // a length with the top bit set
+        CPNG_CHECK(stops_with(bytes) == decode_error::invalid_chunk_length);
+    }
+
+    // iCCP
+    {
+        const std::string profile(3000, 'p');
+        const framed_chunk_t icc{ "iCCP", with_zlib(bytes_of("Display P3\0\0"sv), profile) };
+
+        std::string_view name{ };
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(read_icc_profile(icc.chunk, name, out));
+        CPNG_CHECK(name == "Display P3" && std::string(out.begin(), out.end()) == profile);
+
+        // Inflating to the limit or past it is refused
+        CPNG_CHECK_OK(read_icc_profile(icc.chunk, name, out, profile.size() + 1));
+        CPNG_CHECK(read_icc_profile(icc.chunk, name, out, profile.size()) == decode_error::invalid_chunk_data);
+        CPNG_CHECK(name.empty() && out.empty());
+
+        const framed_chunk_t method{ "iCCP", with_zlib(bytes_of("p\0\1"sv), profile) };
+        const framed_chunk_t no_name{ "iCCP", with_zlib(bytes_of("\0\0"sv), profile) };
+        const framed_chunk_t unterminated{ "iCCP", bytes_of("profile") };
+        const framed_chunk_t broken{ "iCCP", bytes_of("p\0\0\x78\x01\x05"sv) };
+        const framed_chunk_t text{ "tEXt", with_zlib(bytes_of("p\0\0"sv), profile) };
+        for (const framed_chunk_t* bad: { &method, &no_name, &unterminated, &broken, &text })
+            CPNG_CHECK(read_icc_profile(bad->chunk, name, out) == decode_error::invalid_chunk_data);
+    }
+
+    // tEXt, zTXt and iTXt
+    {
+        text_entry_t entry{ };
+
+        const framed_chunk_t plain{ "tEXt", bytes_of("Author\0Zack \xE9"sv) };
+        CPNG_CHECK_OK(read_text(plain.chunk, entry));
+        CPNG_CHECK(entry.keyword == "Author" && entry.text == "Zack \xE9" && !entry.compressed);
+        CPNG_CHECK(entry.language.empty() && entry.translated_keyword.empty());
+
+        const framed_chunk_t empty_text{ "tEXt", bytes_of("Comment\0"sv) };
+        CPNG_CHECK_OK(read_text(empty_text.chunk, entry));
+        CPNG_CHECK(entry.keyword == "Comment" && entry.text.empty());
+
+        const std::string long_text(5000, 'z');
+        const framed_chunk_t ztxt{ "zTXt", with_zlib(bytes_of("Description\0\0"sv), long_text) };
+        CPNG_CHECK_OK(read_text(ztxt.chunk, entry));
+        CPNG_CHECK(entry.keyword == "Description" && entry.text == long_text && entry.compressed);
+        CPNG_CHECK(read_text(ztxt.chunk, entry, long_text.size()) == decode_error::invalid_chunk_data);
+
+        const framed_chunk_t itxt{ "iTXt", bytes_of("Title\0\0\0fr\0Titre\0Carotte \xC3\xA9"sv) };
+        CPNG_CHECK_OK(read_text(itxt.chunk, entry));
+        CPNG_CHECK(entry.keyword == "Title" && entry.language == "fr" && entry.translated_keyword == "Titre");
+        CPNG_CHECK(entry.text == "Carotte \xC3\xA9" && !entry.compressed);
+
+        const framed_chunk_t itxt_z{ "iTXt", with_zlib(bytes_of("Title\0\1\0\0\0"sv), long_text) };
+        CPNG_CHECK_OK(read_text(itxt_z.chunk, entry));
+        CPNG_CHECK(entry.text == long_text && entry.compressed && entry.language.empty());
+
+        const std::string keyword(80, 'k');
+        const framed_chunk_t long_keyword{ "tEXt", bytes_of(keyword + std::string(1, '\0') + "t") };
+        const framed_chunk_t no_keyword{ "tEXt", bytes_of("\0text"sv) };
+        const framed_chunk_t no_separator{ "tEXt", bytes_of("keyword") };
+        const framed_chunk_t ztxt_method{ "zTXt", with_zlib(bytes_of("k\0\1"sv), "t") };
+        const framed_chunk_t itxt_method{ "iTXt", with_zlib(bytes_of("k\0\1\1\0\0"sv), "t") };
+        const framed_chunk_t itxt_short{ "iTXt", bytes_of("k\0\0"sv) };
+        const framed_chunk_t itxt_fields{ "iTXt", bytes_of("k\0\0\0en"sv) };
+        const framed_chunk_t not_text{ "pHYs", bytes_of("k\0t"sv) };
+        for (const framed_chunk_t* bad: { &long_keyword, &no_keyword, &no_separator, &ztxt_method, &itxt_method,
+                                          &itxt_short, &itxt_fields, &not_text })
+        {
+            CPNG_CHECK(read_text(bad->chunk, entry) == decode_error::invalid_chunk_data);
+            CPNG_CHECK(entry.keyword.empty() && entry.text.empty());
+        }
+    }
+
+    // pHYs
+    {
+        physical_size_t size{ };
+        const framed_chunk_t meters{ "pHYs", { 0, 0, 0x0B, 0x13, 0, 0, 0x0B, 0x14, 1 } };
+        CPNG_CHECK_OK(read_physical_size(meters.chunk, size));
+        CPNG_CHECK(size.pixels_per_unit_x == 2835 && size.pixels_per_unit_y == 2836 && size.unit_is_meter);
+
+        const framed_chunk_t aspect{ "pHYs", { 0, 0, 0, 1, 0, 0, 0, 2, 0 } };
+        CPNG_CHECK_OK(read_physical_size(aspect.chunk, size));
+        CPNG_CHECK(size.pixels_per_unit_x == 1 && size.pixels_per_unit_y == 2 && !size.unit_is_meter);
+
+        const framed_chunk_t short_phys{ "pHYs", { 0, 0, 0, 1, 0, 0, 0, 2 } };
+        const framed_chunk_t wrong_type{ "oFFs", { 0, 0, 0, 1, 0, 0, 0, 2, 0 } };
+        CPNG_CHECK(read_physical_size(short_phys.chunk, size) == decode_error::invalid_chunk_data);
+        CPNG_CHECK(read_physical_size(wrong_type.chunk, size) == decode_error::invalid_chunk_data);
+        CPNG_CHECK(size.pixels_per_unit_x == 0);
+    }
+
+    // Stripe index
+    {
+        const auto index{ [](const std::vector<stripe_index_entry_t>& stripes, const uint8_t version = 1) {
+            std::vector<uint8_t> data{ version, 0, 0, 0 };
+            test::put_u32(data, static_cast<uint32_t>(stripes.size()));
+            for (const stripe_index_entry_t& s: stripes)
+            {
+                test::put_u32(data, s.first_row);
+                test::put_u32(data, static_cast<uint32_t>(s.zlib_offset >> 32));
+                test::put_u32(data, static_cast<uint32_t>(s.zlib_offset));
+                test::put_u32(data, s.adler);
+            }
+            return data;
+        } };
+
+        const std::vector<stripe_index_entry_t> stripes{
+            { 0, 2, 0x11111111u }, { 64, 0x1'0000'0000ull, 0x22222222u }, { 128, 0x1'0000'0100ull, 3 },
+        };
+        std::vector<stripe_index_entry_t> out;
+        const framed_chunk_t good{ "cpIX", index(stripes) };
+        CPNG_CHECK(good.chunk.type == k_stripe_index_chunk && !good.chunk.is_critical());
+        CPNG_CHECK_OK(read_stripe_index(good.chunk, out));
+
+        bool same{ out.size() == stripes.size() };
+        for (size_t i{ 0 }; same && i < out.size(); ++i)
+            same &= out[i].first_row == stripes[i].first_row && out[i].zlib_offset == stripes[i].zlib_offset &&
+                    out[i].adler == stripes[i].adler;
+        CPNG_CHECK(same);
+
+        std::vector<uint8_t> extra_byte{ index(stripes) };
+        extra_byte.push_back(0);
+        const framed_chunk_t version{ "cpIX", index(stripes, 2) };
+        const framed_chunk_t none{ "cpIX", index({ }) };
+        const framed_chunk_t sized{ "cpIX", extra_byte };
+        const framed_chunk_t late_start{ "cpIX", index({ { 1, 2, 0 } }) };
+        const framed_chunk_t rows_back{ "cpIX", index({ { 0, 2, 0 }, { 64, 10, 0 }, { 64, 20, 0 } }) };
+        const framed_chunk_t offsets_back{ "cpIX", index({ { 0, 2, 0 }, { 64, 10, 0 }, { 128, 10, 0 } }) };
+        const framed_chunk_t other{ "tEXt", index(stripes) };
+        for (const framed_chunk_t* bad: { &version, &none, &sized, &late_start, &rows_back, &offsets_back, &other })
+        {
+            CPNG_CHECK(read_stripe_index(bad->chunk, out) == decode_error::invalid_chunk_data);
+            CPNG_CHECK(out.empty());
+        }
+    }
+
+    return test::finish("chunks");
+}
@@ -0,0 +1,122 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// 16-bit decodes: exact native-endian RGBA16 / R16 / RG16 output, rounding to 8 bits for the
+// 8-bit formats, and exact widening (v * 257) of 8-bit sources to the 16-bit formats.
+
+#include "test_support.h"
+
+#include <cstring>
+
+using namespace cpng;
+
+namespace {
+    /// @brief Reference 16-bit output: channels picked as for RGBA8, samples widened to 16 bits.
+    std::vector<uint16_t> expected_16(const test::png_spec_t& spec, const std::span<const uint16_t> samples,
+                                      const pixel_format format)
+    {
+        const uint32_t channels{ test::channel_count(spec.color_type) };
+        const uint32_t out_channels{ format == pixel_format::r16 ? 1u : format == pixel_format::rg16 ? 2u : 4u };
+        const bool gray{ channels <= 2 };
+        const bool alpha{ channels == 2 || channels == 4 };
+        const size_t pixels{ static_cast<size_t>(spec.width) * spec.height };
+        const auto widen = [&](const uint16_t v) {
+            return spec.bit_depth == 16 ? v : static_cast<uint16_t>(test::to_8bit(v, spec.bit_depth) * 257u);
+        };
+
+        std::vector<uint16_t> out(pixels * out_channels);
+        for (size_t i{ 0 }; i < pixels; ++i)
+        {
+            const uint16_t* s{ samples.data() + i * channels };
+            const uint16_t a{ alpha ? widen(s[channels - 1]) : uint16_t{ 65535 } };
+            uint16_t* o{ out.data() + i * out_channels };
+
+            if (out_channels == 4)
+            {
+                for (uint32_t c{ 0 }; c < 3; ++c) o[c] = widen(s[gray ? 0 : c]);
+                o[3] = a;
+            }
+            else
+            {
+                o[0] = widen(s[0]);
+                if (out_channels == 2) o[1] = a;
+            }
+        }
+        return out;
+    }
+
+    bool pixels_equal(const image_view_t& view, const std::vector<uint16_t>& expected)
+    {
+        return view.pixels.size() == expected.size() * 2 &&
+               std::memcmp(view.pixels.data(), expected.data(), view.pixels.size()) == 0;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x027 };
+
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 5> sizes{ {
+        { 1, 1 }, { 3, 5 }, { 17, 9 }, { 64, 3 }, { 100, 40 },
+    } };
+
+    for (const uint8_t color_type: { 0, 2, 4, 6 })
+    {
+        for (const auto& [w, h]: sizes)
+        {
+            const test::png_spec_t spec{ .width = w, .height = h, .bit_depth = 16, .color_type = color_type };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+
+            image_view_t view{ };
+            std::vector<uint8_t> storage;
+
+            // Rounded to 8 bits: round(v * 255 / 65535)
+            CPNG_CHECK_OK(load_from_memory(png, view, storage));
+            CPNG_CHECK(test::equal_bytes(view.pixels, test::expected_rgba8(spec, samples)));
+
+            CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::rgba16 }));
+            CPNG_CHECK(view.format == pixel_format::rgba16 && view.stride_bytes == w * 8);
+            CPNG_CHECK(pixels_equal(view, expected_16(spec, samples, pixel_format::rgba16)));
+
+            const bool gray{ color_type == 0 || color_type == 4 };
+            for (const pixel_format format: { pixel_format::r16, pixel_format::rg16 })
+            {
+                const decode_error err{ load_from_memory(png, view, storage, { .format = format }) };
+                if (!gray)
+                {
+                    CPNG_CHECK(err == decode_error::unsupported_output_format);
+                    continue;
+                }
+                CPNG_CHECK_OK(err);
+                CPNG_CHECK(pixels_equal(view, expected_16(spec, samples, format)));
+            }
+        }
+    }
+
+    // Rounding boundaries: round(v / 257) changes between 128 and 129, and between 65406 and 65407
+    {
+        const test::png_spec_t spec{ .width = 6, .height = 1, .bit_depth = 16, .color_type = 0 };
+        const std::vector<uint16_t> samples{ 0, 128, 129, 385, 65406, 65535 };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, { .format = pixel_format::r8 }));
+        CPNG_CHECK(storage == std::vector<uint8_t>({ 0, 0, 1, 1, 254, 255 }));
+    }
+
+    // 8-bit and sub-byte sources widen exactly to the 16-bit formats
+    for (const auto& [color_type, depth]: { std::pair<uint8_t, uint8_t>{ 0, 2 }, { 4, 8 }, { 2, 8 }, { 6, 8 } })
+    {
+        const test::png_spec_t spec{ .width = 13, .height = 7, .bit_depth = depth, .color_type = color_type };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage,
+                                       { .format = pixel_format::rgba16 }));
+        CPNG_CHECK(pixels_equal(view, expected_16(spec, samples, pixel_format::rgba16)));
+    }
+
+    return test::finish("decode_16bit");
+}
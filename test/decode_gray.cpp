@@ -0,0 +1,118 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Grayscale, gray + alpha and sub-byte decodes against the reference expansion, in RGBA8,
+// R8 and RG8, through the vector, caller buffer and strided overloads.
+
+#include "test_support.h"
+
+using namespace cpng;
+
+namespace {
+    void check_decode(const test::png_spec_t& spec, test::rng_t& rng)
+    {
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        const std::vector<uint8_t> rgba{ test::expected_rgba8(spec, samples) };
+        const size_t pixels{ static_cast<size_t>(spec.width) * spec.height };
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        if (!CPNG_CHECK_OK(load_from_memory(png, view, storage))) return;
+        CPNG_CHECK(view.width == spec.width && view.height == spec.height);
+        CPNG_CHECK(view.format == pixel_format::rgba8 && view.stride_bytes == spec.width * 4);
+        CPNG_CHECK(test::equal_bytes(view.pixels, rgba));
+
+        std::vector<uint8_t> r8(pixels);
+        std::vector<uint8_t> rg8(pixels * 2);
+        for (size_t i{ 0 }; i < pixels; ++i)
+        {
+            r8[i] = rgba[i * 4];
+            rg8[i * 2] = rgba[i * 4];
+            rg8[i * 2 + 1] = rgba[i * 4 + 3];
+        }
+
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::r8 }));
+        CPNG_CHECK(view.format == pixel_format::r8 && test::equal_bytes(view.pixels, r8));
+
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::rg8 }));
+        CPNG_CHECK(view.format == pixel_format::rg8 && test::equal_bytes(view.pixels, rg8));
+
+        // Caller buffer: exact size works, one byte short is rejected
+        std::vector<uint8_t> buffer(pixels * 4);
+        CPNG_CHECK_OK(load_from_memory(png, view, std::span{ buffer }));
+        CPNG_CHECK(buffer == rgba);
+        CPNG_CHECK(load_from_memory(png, view, std::span{ buffer }.first(buffer.size() - 1)) ==
+                   decode_error::output_buffer_too_small);
+
+        // Strided rows leave the padding bytes alone
+        const uint32_t stride{ spec.width * 4 + 3 };
+        std::vector<uint8_t> strided((spec.height - 1) * size_t{ stride } + spec.width * 4, 0xAB);
+        CPNG_CHECK_OK(load_from_memory(png, view, std::span{ strided }, stride));
+        bool rows_match{ true };
+        for (uint32_t y{ 0 }; y < spec.height; ++y)
+        {
+            rows_match &= std::equal(rgba.begin() + y * spec.width * 4, rgba.begin() + (y + 1) * spec.width * 4,
+                                     strided.begin() + y * size_t{ stride });
+            if (y + 1 < spec.height)
+                rows_match &= strided[y * size_t{ stride } + spec.width * 4] == 0xAB;
+        }
+        CPNG_CHECK(rows_match);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x026 };
+
+    constexpr std::array<std::pair<uint8_t, uint8_t>, 5> layouts{ {
+        { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 4, 8 },
+    } };
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 7> sizes{ {
+        { 1, 1 }, { 3, 5 }, { 7, 3 }, { 8, 2 }, { 16, 16 }, { 33, 17 }, { 100, 40 },
+    } };
+
+    for (const auto& [color_type, depth]: layouts)
+    {
+        for (const auto& [w, h]: sizes)
+            check_decode({ .width = w, .height = h, .bit_depth = depth, .color_type = color_type }, rng);
+    }
+
+    // Sub-byte scaling covers the full range: 0 and the top code map to 0 and 255
+    for (const uint8_t depth: { 1, 2, 4 })
+    {
+        const test::png_spec_t spec{ .width = 2, .height = 1, .bit_depth = depth, .color_type = 0 };
+        const std::vector<uint16_t> samples{ 0, static_cast<uint16_t>((1u << depth) - 1) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, { .format = pixel_format::r8 }));
+        CPNG_CHECK(storage.size() == 2 && storage[0] == 0 && storage[1] == 255);
+    }
+
+    // Single channel formats need a grayscale source
+    {
+        test::rng_t color_rng{ 1 };
+        const test::png_spec_t spec{ .width = 4, .height = 4, .color_type = 2 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, color_rng)) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(load_from_memory(png, view, storage, { .format = pixel_format::r8 }) ==
+                   decode_error::unsupported_output_format);
+        CPNG_CHECK(load_from_memory(png, view, storage, { .format = pixel_format::rg8 }) ==
+                   decode_error::unsupported_output_format);
+    }
+
+    // Sub-byte depths are only defined for grayscale
+    {
+        const test::png_spec_t spec{ .width = 4, .height = 1, .bit_depth = 4, .color_type = 4 };
+        const std::vector<uint16_t> samples(8, 1);
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(load_from_memory(test::make_png(spec, samples), view, storage) ==
+                   decode_error::unsupported_bit_depth);
+    }
+
+    return test::finish("decode_gray");
+}
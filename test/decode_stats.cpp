@@ -0,0 +1,180 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Decode statistics: chunk, block and symbol counts that agree with decode_cost.h, the filter
+// histogram of progressive and Adam7 images, memory counters, stats reset between decodes, and
+// counts up to the failing row when a decode stops early. Timings are only checked for presence.
+
+#include "test_support.h"
+
+#include "cpng/decode_cost.h"
+#include "cpng/encoder.h"
+
+using namespace cpng;
+
+namespace {
+    decode_error decode(const std::vector<uint8_t>& png, decode_stats_t& stats, std::vector<uint8_t>& out,
+                        const decode_options_t& options = { })
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        const decode_error err{ load_from_memory(png, view, storage, options, stats) };
+        out.assign(view.pixels.begin(), view.pixels.end());
+        return err;
+    }
+
+    /// @brief Everything but the timings, which differ from run to run.
+    bool same_counts(const decode_stats_t& a, const decode_stats_t& b)
+    {
+        return a.idat_chunks == b.idat_chunks && a.stored_blocks == b.stored_blocks &&
+               a.fixed_blocks == b.fixed_blocks && a.dynamic_blocks == b.dynamic_blocks &&
+               a.huffman_table_builds == b.huffman_table_builds && a.literals == b.literals &&
+               a.matches == b.matches && a.match_bytes == b.match_bytes && a.filter_rows == b.filter_rows &&
+               a.bytes_allocated == b.bytes_allocated && a.peak_scratch_bytes == b.peak_scratch_bytes;
+    }
+
+    uint64_t total_ns(const decode_stats_t& s)
+    {
+        return s.parse_ns + s.crc_ns + s.concat_ns + s.inflate_ns + s.adler_ns + s.defilter_ns + s.convert_ns;
+    }
+
+    uint64_t total_rows(const decode_stats_t& s)
+    {
+        uint64_t rows{ 0 };
+        for (const uint64_t n: s.filter_rows) rows += n;
+        return rows;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x046 };
+
+    // Stored blocks across several IDATs: no symbols, one histogram entry per scanline
+    {
+        const test::png_spec_t spec{ .width = 20, .height = 10 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> raw{ test::scanlines(spec, samples) };
+        const std::vector<uint8_t> zlib{ test::zlib_stored(raw) };
+        const std::vector<uint8_t> png{ test::make_png(spec, zlib, { }, 300) };
+
+        decode_stats_t stats{ };
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(png, stats, out));
+        CPNG_CHECK(out == test::expected_rgba8(spec, samples));
+
+        CPNG_CHECK(stats.idat_chunks == (zlib.size() + 299) / 300 && stats.stored_blocks == 1);
+        CPNG_CHECK(stats.fixed_blocks == 0 && stats.dynamic_blocks == 0 && stats.huffman_table_builds == 0);
+        CPNG_CHECK(stats.literals == 0 && stats.matches == 0 && stats.match_bytes == 0);
+
+        std::array<uint64_t, 5> histogram{ };
+        for (uint32_t y{ 0 }; y < spec.height; ++y) ++histogram[raw[y * (spec.width * 4 + 1)]];
+        CPNG_CHECK(stats.filter_rows == histogram);
+
+        // Output storage counts as allocated; scratch is part of it
+        CPNG_CHECK(stats.bytes_allocated >= out.size() + raw.size());
+        CPNG_CHECK(stats.peak_scratch_bytes >= raw.size() && stats.peak_scratch_bytes <= stats.bytes_allocated);
+    }
+
+    // Compressed files: the counters match the cost estimate of the same file
+    for (const encode_filter filter: { encode_filter::none, encode_filter::paeth, encode_filter::adaptive })
+    {
+        for (const uint32_t block_tokens: { 16u, 32768u })
+        {
+            const uint32_t width{ 64 }, height{ 48 };
+            std::vector<uint8_t> rgba(size_t{ width } * height * 4);
+            for (size_t i{ 0 }; i < rgba.size(); ++i)
+                rgba[i] = static_cast<uint8_t>(i % 4 == 3 ? 255 : (i / 4 % width) / 3 * 9 + rng.below(2));
+
+            std::vector<uint8_t> png;
+            CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rgba }, png,
+                                 { .filter = filter, .block_tokens = block_tokens, .max_idat_bytes = 2000 }));
+
+            decode_stats_t stats{ };
+            std::vector<uint8_t> out;
+            CPNG_CHECK_OK(decode(png, stats, out));
+            CPNG_CHECK(out == rgba);
+
+            decode_cost_t cost{ };
+            CPNG_CHECK_OK(estimate_decode_cost(png, cost));
+            CPNG_CHECK(stats.idat_chunks == cost.idat_chunks && stats.stored_blocks == cost.stored_blocks);
+            CPNG_CHECK(stats.fixed_blocks == cost.fixed_blocks && stats.dynamic_blocks == cost.dynamic_blocks);
+            CPNG_CHECK(stats.huffman_table_builds == 3 * stats.dynamic_blocks);
+            CPNG_CHECK(stats.literals == cost.literals && stats.matches == cost.matches);
+            CPNG_CHECK(stats.match_bytes == cost.match_bytes && stats.matches > 0);
+
+            bool filters{ total_rows(stats) == height };
+            for (size_t f{ 0 }; f < 5; ++f) filters &= stats.filter_rows[f] * width * 4 == cost.filter_bytes[f];
+            CPNG_CHECK(filters);
+
+            // Small blocks mean many of them
+            if (block_tokens == 16) CPNG_CHECK(stats.fixed_blocks + stats.dynamic_blocks > 100);
+        }
+    }
+
+    // Adam7: one histogram entry per pass row, fewer when a preview stops early
+    {
+        const test::png_spec_t spec{ .width = 13, .height = 11, .color_type = 2, .interlace = 1 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+
+        uint64_t pass_rows{ 0 };
+        for (const auto& [x0, y0, dx, dy]: test::adam7_passes)
+            if (spec.width > x0 && spec.height > y0) pass_rows += (spec.height - y0 + dy - 1) / dy;
+
+        decode_stats_t full{ }, preview{ };
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(png, full, out));
+        CPNG_CHECK(total_rows(full) == pass_rows);
+
+        CPNG_CHECK_OK(decode(png, preview, out, { .adam7_passes = 2 }));
+        CPNG_CHECK(total_rows(preview) == 4);   // rows 0 and 8 of passes 1 and 2
+        CPNG_CHECK(preview.bytes_allocated > 0 && preview.peak_scratch_bytes <= preview.bytes_allocated);
+    }
+
+    // Stats are reset by each decode, and do not change the pixels
+    {
+        const test::png_spec_t spec{ .width = 37, .height = 29, .bit_depth = 16, .color_type = 4 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+
+        decode_stats_t first{ }, second{ };
+        std::vector<uint8_t> out, again;
+        CPNG_CHECK_OK(decode(png, first, out));
+        second = first;
+        CPNG_CHECK_OK(decode(png, second, again));
+        CPNG_CHECK(same_counts(first, second) && out == again && total_ns(second) > 0);
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage));
+        CPNG_CHECK(test::equal_bytes(view.pixels, out));
+
+        // A caller buffer is not counted as allocated
+        decode_stats_t into{ };
+        std::vector<uint8_t> buffer(out.size());
+        CPNG_CHECK_OK(load_from_memory(png, view, buffer, 0, { }, into));
+        CPNG_CHECK(test::equal_bytes(view.pixels, out) && into.bytes_allocated + out.size() <= first.bytes_allocated);
+    }
+
+    // A failing decode reports what it got through
+    {
+        const test::png_spec_t spec{ .width = 16, .height = 12 };
+        std::vector<uint8_t> raw{ test::scanlines(spec, test::random_samples(spec, rng)) };
+        raw[5 * (16 * 4 + 1)] = 7;      // filter type of row 5
+
+        decode_stats_t stats{ };
+        stats.literals = 12345;
+        std::vector<uint8_t> out, png{ test::make_png(spec, test::zlib_stored(raw)) };
+        CPNG_CHECK(decode(png, stats, out) == decode_error::unsupported_filter);
+        CPNG_CHECK(stats.literals == 0 && stats.idat_chunks == 1 && stats.stored_blocks == 1);
+        CPNG_CHECK(total_rows(stats) == 5 && stats.peak_scratch_bytes >= raw.size());
+
+        // Parsing stops before inflating
+        png[29] ^= 1;
+        CPNG_CHECK(decode(png, stats, out) == decode_error::crc_mismatch);
+        CPNG_CHECK(stats.stored_blocks == 0 && total_rows(stats) == 0);
+    }
+
+    return test::finish("decode_stats");
+}
@@ -0,0 +1,262 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Diagnostics records: the stage, reason, offsets and sizes of each kind of failure, records
+// reset by a successful decode, and the atlas, image cache and async loader (both backends),
+// which decode in parallel and must hand back the record of the file that failed.
+
+#include "test_support.h"
+
+#include "cpng/async_loader.h"
+#include "cpng/atlas.h"
+#include "cpng/image_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace cpng;
+
+namespace {
+    decode_diagnostics_t diagnose(const std::vector<uint8_t>& png, const decode_error expected,
+                                  const decode_options_t& options = { })
+    {
+        decode_diagnostics_t diag{ .error = decode_error::no_iend, .row = 99 };    // stale on purpose
+        decode_options_t with_record{ options };
+        with_record.diagnostics = &diag;
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(load_from_memory(png, view, storage, with_record) == expected);
+        CPNG_CHECK(diag.error == expected && diag.reason != nullptr);
+        return diag;
+    }
+
+    std::string temp_path(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("carrotpng_diag_" + name)).string();
+    }
+
+    void write_file(const std::string& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x048 };
+
+    const test::png_spec_t spec{ .width = 12, .height = 9 };
+    const std::vector<uint8_t> raw{ test::scanlines(spec, test::random_samples(spec, rng)) };
+    const std::vector<uint8_t> zlib{ test::zlib_stored(raw) };
+    const std::vector<uint8_t> good{ test::make_png(spec, zlib) };
+    const size_t stride{ 12 * 4 + 1 };
+
+    // Success resets the record
+    {
+        const decode_diagnostics_t diag{ diagnose(good, decode_error::ok) };
+        CPNG_CHECK(diag.stage == decode_stage::none && diag.row == 0 && diag.byte_offset == 0);
+    }
+
+    // Parse and validate failures
+    {
+        std::vector<uint8_t> png{ good };
+        png[0] = 0;
+        CPNG_CHECK(diagnose(png, decode_error::invalid_signature).stage == decode_stage::parse);
+
+        png = good;
+        png[29] ^= 1;   // IHDR CRC
+        CPNG_CHECK(diagnose(png, decode_error::crc_mismatch).stage == decode_stage::parse);
+
+        const test::png_spec_t odd{ .width = 4, .height = 4, .bit_depth = 3, .color_type = 0 };
+        const std::vector<uint8_t> png_odd{ test::make_png(odd, test::zlib_stored(std::vector<uint8_t>(8))) };
+        const decode_diagnostics_t diag{ diagnose(png_odd, decode_error::unsupported_bit_depth) };
+        CPNG_CHECK(diag.stage == decode_stage::validate);
+    }
+
+    // Inflate: a reserved block type right after the stored block header would be read
+    {
+        std::vector<uint8_t> bad{ zlib };
+        bad[2] = 0x07;  // BFINAL = 1, BTYPE = 3
+        const decode_diagnostics_t diag{ diagnose(test::make_png(spec, bad), decode_error::invalid_idat_stream) };
+        CPNG_CHECK(diag.stage == decode_stage::inflate && diag.block_index == 0);
+        CPNG_CHECK(diag.byte_offset == 2 && diag.bit_offset == 3 && diag.actual_size == 0);
+        CPNG_CHECK(diag.expected_size == raw.size() && std::string_view{ diag.reason } == "reserved block type 3");
+
+        // A stored block longer than the stream
+        std::vector<uint8_t> cut{ zlib.begin(), zlib.end() - 20 };
+        test::put_u32(cut, 0);
+        const decode_diagnostics_t short_diag{ diagnose(test::make_png(spec, cut), decode_error::invalid_idat_stream) };
+        CPNG_CHECK(short_diag.stage == decode_stage::inflate && short_diag.expected_size == raw.size());
+    }
+
+    // Adler-32: the offset of the trailer
+    {
+        std::vector<uint8_t> bad{ zlib };
+        bad.back() ^= 1;
+        const decode_diagnostics_t diag{ diagnose(test::make_png(spec, bad), decode_error::invalid_idat_stream) };
+        CPNG_CHECK(diag.stage == decode_stage::adler32 && diag.byte_offset == bad.size() - 4);
+        CPNG_CHECK(diag.actual_size == raw.size());
+    }
+
+    // De-filter: the row and its offset in the scanlines, within its pass for Adam7
+    {
+        std::vector<uint8_t> bad{ raw };
+        bad[6 * stride] = 9;
+        const decode_diagnostics_t diag{
+            diagnose(test::make_png(spec, test::zlib_stored(bad)), decode_error::unsupported_filter)
+        };
+        CPNG_CHECK(diag.stage == decode_stage::defilter && diag.row == 6 && diag.byte_offset == 6 * stride);
+
+        test::png_spec_t interlaced{ spec };
+        interlaced.interlace = 1;
+        std::vector<uint8_t> passes{ test::scanlines(interlaced, test::random_samples(interlaced, rng)) };
+
+        // Passes 1 to 3 of a 12x9 image: 2 rows of 2, 2 rows of 1 and 1 row of 3 pixels
+        const size_t pass4{ 2 * (1 + 2 * 4) + 2 * (1 + 1 * 4) + 1 * (1 + 3 * 4) };
+        passes[pass4 + (1 + 3 * 4)] = 5;    // second row of pass 4 (3 pixels wide)
+        const decode_diagnostics_t adam7{
+            diagnose(test::make_png(interlaced, test::zlib_stored(passes)), decode_error::unsupported_filter)
+        };
+        CPNG_CHECK(adam7.stage == decode_stage::defilter && adam7.row == 1);
+        CPNG_CHECK(adam7.byte_offset == pass4 + 1 + 3 * 4);
+    }
+
+    // Output: a caller buffer too small, and missing files
+    {
+        decode_diagnostics_t diag{ };
+        image_view_t view{ };
+        std::vector<uint8_t> small(100);
+        CPNG_CHECK(load_from_memory(good, view, small, 0, { .diagnostics = &diag }) ==
+                   decode_error::output_buffer_too_small);
+        CPNG_CHECK(diag.stage == decode_stage::output && diag.actual_size == 100);
+        CPNG_CHECK(diag.expected_size == size_t{ 12 } * 9 * 4);
+
+        std::vector<uint8_t> storage;
+        CPNG_CHECK(load_from_file("/nonexistent_carrotpng_dir/x.png", view, storage, { .diagnostics = &diag }) ==
+                   decode_error::file_not_found);
+        CPNG_CHECK(diag.stage == decode_stage::read && diag.error == decode_error::file_not_found);
+    }
+
+    // Sprites of an atlas decode in parallel; the record is the failing sprite's. File 7 gets a
+    // copy with a broken Adler-32 for the cache and loader below.
+    std::vector<std::vector<uint8_t>> files;
+    std::vector<uint8_t> adler_broken;
+    for (uint32_t i{ 0 }; i < 12; ++i)
+    {
+        const test::png_spec_t sprite{ .width = 8 + i, .height = 5 + i % 4 };
+        const std::vector<uint16_t> samples{ test::random_samples(sprite, rng) };
+        std::vector<uint8_t> sprite_zlib{ test::zlib_stored(test::scanlines(sprite, samples)) };
+        files.push_back(test::make_png(sprite, sprite_zlib));
+
+        if (i != 7) continue;
+        sprite_zlib.back() ^= 1;
+        adler_broken = test::make_png(sprite, sprite_zlib);
+    }
+    {
+        std::vector<uint8_t> crc_broken{ files[3] };
+        crc_broken[crc_broken.size() - 13] ^= 1;  // last byte of the IDAT CRC
+
+        for (const uint32_t threads: { 1u, 4u })
+        {
+            std::vector<std::span<const uint8_t>> images(files.begin(), files.end());
+            images[3] = crc_broken;
+
+            decode_diagnostics_t diag{ };
+            atlas_t atlas{ };
+            std::vector<uint8_t> storage;
+            const decode_options_t options{ .worker_threads = threads, .diagnostics = &diag };
+            CPNG_CHECK(build_atlas(images, atlas, storage, { }, options) == decode_error::crc_mismatch);
+            CPNG_CHECK(diag.error == decode_error::crc_mismatch && diag.stage == decode_stage::parse);
+            CPNG_CHECK(storage.empty() && atlas.rects.empty());
+
+            // Every sprite fine: the record is reset
+            images[3] = files[3];
+            CPNG_CHECK_OK(build_atlas(images, atlas, storage, { }, options));
+            CPNG_CHECK(diag.error == decode_error::ok && diag.stage == decode_stage::none);
+
+            // Header and packing failures are recorded too
+            images[5] = std::span{ files[5] }.first(20);
+            CPNG_CHECK(build_atlas(images, atlas, storage, { }, options) == decode_error::file_too_short);
+            CPNG_CHECK(diag.error == decode_error::file_too_short && diag.stage == decode_stage::parse);
+
+            images[5] = files[5];
+            CPNG_CHECK(build_atlas(images, atlas, storage, { .max_width = 16, .max_height = 16 }, options) ==
+                       decode_error::atlas_overflow);
+            CPNG_CHECK(diag.error == decode_error::atlas_overflow && diag.stage == decode_stage::validate);
+        }
+    }
+
+    // The image cache copies the failing entry's record, again on each request for it
+    {
+        decode_diagnostics_t diag{ };
+        image_cache_t cache{ 1u << 20, { .diagnostics = &diag } };
+
+        image_handle_t broken{ }, fine{ };
+        CPNG_CHECK_OK(cache.open_memory(adler_broken, broken));
+        CPNG_CHECK_OK(cache.open_memory(files[0], fine));
+
+        std::shared_ptr<const decoded_image_t> image;
+        CPNG_CHECK(broken.pixels(image) == decode_error::invalid_idat_stream);
+        CPNG_CHECK(diag.error == decode_error::invalid_idat_stream && diag.stage == decode_stage::adler32);
+
+        // Successful requests do not touch it
+        CPNG_CHECK_OK(fine.pixels(image));
+        CPNG_CHECK(diag.stage == decode_stage::adler32);
+
+        diag = { };
+        CPNG_CHECK(broken.pixels(image) == decode_error::invalid_idat_stream);
+        CPNG_CHECK(diag.stage == decode_stage::adler32);
+    }
+
+    // The async loader, on both backends
+    std::vector<std::string> paths;
+    for (size_t i{ 0 }; i < files.size(); ++i)
+    {
+        paths.push_back(temp_path(std::to_string(i) + ".png"));
+        write_file(paths.back(), i == 7 ? adler_broken : files[i]);
+    }
+    std::vector<const char*> path_ptrs;
+    for (const std::string& path: paths) path_ptrs.push_back(path.c_str());
+
+    for (const bool io_uring: { true, false })
+    {
+        async_loader_t loader{ { .decode_threads = 4, .queue_depth = 3, .use_io_uring = io_uring } };
+
+        decode_diagnostics_t diag{ .error = decode_error::no_iend };
+        std::vector<decode_error> errors(paths.size());
+        loader.load_batch(path_ptrs, [&](const size_t i, const decode_error err, std::shared_ptr<decoded_image_t>) {
+            errors[i] = err;
+        }, { .diagnostics = &diag });
+        loader.wait();
+
+        CPNG_CHECK(errors[7] == decode_error::invalid_idat_stream && errors[6] == decode_error::ok);
+        CPNG_CHECK(diag.error == decode_error::invalid_idat_stream && diag.stage == decode_stage::adler32);
+
+        // A file that cannot be read is a read failure
+        decode_diagnostics_t missing{ };
+        decode_error missing_error{ };
+        loader.load("/nonexistent_carrotpng_dir/x.png", [&](const decode_error err, std::shared_ptr<decoded_image_t>) {
+            missing_error = err;
+        }, { .diagnostics = &missing });
+        loader.wait();
+        CPNG_CHECK(missing_error == decode_error::file_not_found && missing.error == decode_error::file_not_found);
+        CPNG_CHECK(missing.stage == decode_stage::read);
+
+        // A batch without failures leaves the record reset
+        path_ptrs[7] = path_ptrs[6];
+        loader.load_batch(path_ptrs, [](size_t, decode_error, std::shared_ptr<decoded_image_t>) { },
+                          { .diagnostics = &diag });
+        loader.wait();
+        CPNG_CHECK(diag.error == decode_error::ok);
+        path_ptrs[7] = paths[7].c_str();
+    }
+
+    for (const std::string& path: paths) std::filesystem::remove(path);
+
+    return test::finish("diagnostics");
+}
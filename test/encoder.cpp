@@ -0,0 +1,261 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Encoder round trips: every input format, filter and compression mode decodes back to the same
+// pixels, over noise, gradients, flat areas and repeats; strided input, dropped alpha, the header
+// and sRGB chunk written, IDAT splitting, files on disk, and rejected views.
+
+#include "test_support.h"
+
+#include "cpng/chunks.h"
+#include "cpng/encoder.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace cpng;
+
+namespace {
+    enum class content_t : uint8_t { noise, gradient, flat, repeat };
+
+    std::vector<uint8_t> make_pixels(const uint32_t width, const uint32_t height, const uint32_t stride,
+                                     const uint32_t pixel_bytes, const content_t content, test::rng_t& rng)
+    {
+        std::vector<uint8_t> pixels(size_t{ stride } * height, 0xCD);
+        for (uint32_t y{ 0 }; y < height; ++y)
+        {
+            for (uint32_t x{ 0 }; x < width * pixel_bytes; ++x)
+            {
+                uint8_t& p{ pixels[size_t{ y } * stride + x] };
+                switch (content)
+                {
+                    case content_t::noise:    p = static_cast<uint8_t>(rng.below(256)); break;
+                    case content_t::gradient: p = static_cast<uint8_t>(x / pixel_bytes + y * 3 + x % 4); break;
+                    case content_t::flat:     p = static_cast<uint8_t>(x % pixel_bytes * 40 + (x > width / 2)); break;
+                    case content_t::repeat:   p = static_cast<uint8_t>((x % 24) * 11 ^ (y % 5)); break;
+                }
+            }
+        }
+        return pixels;
+    }
+
+    /// @brief The packed rows of a possibly strided view.
+    std::vector<uint8_t> packed(const image_view_t& view)
+    {
+        const size_t row{ size_t{ view.width } * bytes_per_pixel(view.format) };
+        const size_t stride{ view.stride_bytes != 0 ? view.stride_bytes : row };
+        std::vector<uint8_t> out;
+        for (uint32_t y{ 0 }; y < view.height; ++y)
+        {
+            const auto begin{ view.pixels.begin() + static_cast<ptrdiff_t>(y * stride) };
+            out.insert(out.end(), begin, begin + static_cast<ptrdiff_t>(row));
+        }
+        return out;
+    }
+
+    bool round_trips(const image_view_t& image, const std::vector<uint8_t>& png)
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        return load_from_memory(png, view, storage, { .format = image.format }) == decode_error::ok &&
+               view.width == image.width && view.height == image.height &&
+               test::equal_bytes(view.pixels, packed(image));
+    }
+
+    std::vector<png_chunk_t> chunks_of(const std::vector<uint8_t>& png)
+    {
+        std::vector<png_chunk_t> out;
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        while (reader.next(chunk)) out.push_back(chunk);
+        return out;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x041 };
+
+    struct layout_t
+    {
+        pixel_format    format;
+        uint8_t         color_type;
+        uint8_t         bit_depth;
+    };
+    constexpr std::array<layout_t, 6> layouts{ {
+        { pixel_format::r8, 0, 8 }, { pixel_format::rg8, 4, 8 }, { pixel_format::rgba8, 6, 8 },
+        { pixel_format::r16, 0, 16 }, { pixel_format::rg16, 4, 16 }, { pixel_format::rgba16, 6, 16 },
+    } };
+
+    // Every format, filter, mode and kind of content
+    for (const layout_t& layout: layouts)
+    {
+        bool exact{ true }, header{ true };
+        for (const content_t content: { content_t::noise, content_t::gradient, content_t::flat, content_t::repeat })
+        {
+            const uint32_t width{ 1 + rng.below(70) }, height{ 1 + rng.below(40) };
+            const uint32_t pixel_bytes{ bytes_per_pixel(layout.format) };
+            const std::vector<uint8_t> pixels{ make_pixels(width, height, width * pixel_bytes, pixel_bytes, content,
+                                                           rng) };
+            const image_view_t image{ .width = width, .height = height, .pixels = pixels, .stride_bytes = 0,
+                                      .format = layout.format };
+
+            for (const encode_filter filter: { encode_filter::none, encode_filter::sub, encode_filter::up,
+                                               encode_filter::average, encode_filter::paeth, encode_filter::adaptive })
+            {
+                for (const compression_mode mode: { compression_mode::stored, compression_mode::fast })
+                {
+                    std::vector<uint8_t> png;
+                    exact &= encode(image, png, { .mode = mode, .filter = filter }) == decode_error::ok;
+                    exact &= round_trips(image, png);
+
+                    ihdr_info_t ihdr{ };
+                    header &= read_ihdr_from_memory(png, ihdr) == decode_error::ok && ihdr.width == width &&
+                              ihdr.color_type == layout.color_type && ihdr.bit_depth == layout.bit_depth &&
+                              ihdr.interlace_method == 0;
+                }
+            }
+        }
+        CPNG_CHECK(exact && header);
+    }
+
+    // Compression: smooth and repeating content shrinks, noise stays close to stored
+    {
+        const uint32_t width{ 256 }, height{ 128 };
+        for (const content_t content: { content_t::noise, content_t::gradient, content_t::flat, content_t::repeat })
+        {
+            const std::vector<uint8_t> pixels{ make_pixels(width, height, width * 4, 4, content, rng) };
+            const image_view_t image{ .width = width, .height = height, .pixels = pixels };
+
+            std::vector<uint8_t> stored, fast;
+            CPNG_CHECK_OK(encode(image, stored, { .mode = compression_mode::stored }));
+            CPNG_CHECK_OK(encode(image, fast, { .filter = encode_filter::adaptive }));
+            CPNG_CHECK(round_trips(image, fast));
+            CPNG_CHECK(content == content_t::noise ? fast.size() <= stored.size() + stored.size() / 50
+                                                   : fast.size() * 4 < stored.size());
+        }
+    }
+
+    // Small blocks: many deflate blocks in one stream
+    {
+        const uint32_t width{ 300 }, height{ 200 };
+        const std::vector<uint8_t> pixels{ make_pixels(width, height, width * 4, 4, content_t::repeat, rng) };
+        const image_view_t image{ .width = width, .height = height, .pixels = pixels };
+        for (const uint32_t block_tokens: { 1u, 100u, 4096u })
+        {
+            std::vector<uint8_t> png;
+            CPNG_CHECK_OK(encode(image, png, { .block_tokens = block_tokens }));
+            CPNG_CHECK(round_trips(image, png));
+        }
+    }
+
+    // Strided input: only the image bytes are read
+    {
+        const uint32_t width{ 33 }, height{ 21 }, stride{ 33 * 4 + 20 };
+        const std::vector<uint8_t> pixels{ make_pixels(width, height, stride, 4, content_t::noise, rng) };
+        const image_view_t image{ .width = width, .height = height,
+                                  .pixels = std::span<const uint8_t>{ pixels }.first(size_t{ stride } * 20 + width * 4),
+                                  .stride_bytes = stride };
+        std::vector<uint8_t> png;
+        CPNG_CHECK_OK(encode(image, png));
+        CPNG_CHECK(round_trips(image, png));
+    }
+
+    // Dropping alpha writes RGB / gray and keeps the color channels
+    {
+        const uint32_t width{ 19 }, height{ 11 };
+        std::vector<uint8_t> rgba{ make_pixels(width, height, width * 4, 4, content_t::noise, rng) };
+        std::vector<uint8_t> png;
+        CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rgba }, png, { .drop_alpha = true }));
+
+        ihdr_info_t ihdr{ };
+        CPNG_CHECK_OK(read_ihdr_from_memory(png, ihdr));
+        CPNG_CHECK(ihdr.color_type == 2 && ihdr.bit_depth == 8);
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage));
+        for (size_t i{ 3 }; i < rgba.size(); i += 4) rgba[i] = 255;
+        CPNG_CHECK(test::equal_bytes(view.pixels, rgba));
+
+        const std::vector<uint8_t> rg16{ make_pixels(width, height, width * 4, 4, content_t::noise, rng) };
+        CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rg16, .format = pixel_format::rg16 }, png,
+                             { .drop_alpha = true }));
+        CPNG_CHECK_OK(read_ihdr_from_memory(png, ihdr));
+        CPNG_CHECK(ihdr.color_type == 0 && ihdr.bit_depth == 16);
+
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::r16 }));
+        bool gray{ true };
+        for (size_t i{ 0 }; i < size_t{ width } * height; ++i)
+            gray &= view.pixels[i * 2] == rg16[i * 4] && view.pixels[i * 2 + 1] == rg16[i * 4 + 1];
+        CPNG_CHECK(gray);
+    }
+
+    // Chunk layout: sRGB when asked for, IDAT split at max_idat_bytes
+    {
+        const uint32_t width{ 64 }, height{ 64 };
+        const std::vector<uint8_t> pixels{ make_pixels(width, height, width * 4, 4, content_t::noise, rng) };
+        image_view_t image{ .width = width, .height = height, .pixels = pixels };
+
+        std::vector<uint8_t> png;
+        CPNG_CHECK_OK(encode(image, png));
+        std::vector<png_chunk_t> chunks{ chunks_of(png) };
+        CPNG_CHECK(chunks.size() == 4 && chunks[1].type == chunk_type("sRGB") && chunks[2].type == chunk_type("IDAT"));
+
+        image.is_srgb = false;
+        CPNG_CHECK_OK(encode(image, png, { .max_idat_bytes = 1000 }));
+        chunks = chunks_of(png);
+
+        bool split{ chunks.front().type == chunk_type("IHDR") && chunks.back().type == chunk_type("IEND") };
+        size_t total{ 0 };
+        for (size_t i{ 1 }; i + 1 < chunks.size(); ++i)
+        {
+            split &= chunks[i].type == chunk_type("IDAT") && chunks[i].crc_ok() && chunks[i].data.size() <= 1000;
+            split &= i + 2 == chunks.size() || chunks[i].data.size() == 1000;
+            total += chunks[i].data.size();
+        }
+        CPNG_CHECK(split && chunks.size() == 2 + (total + 999) / 1000 && round_trips(image, png));
+    }
+
+    // Files
+    {
+        const std::filesystem::path path{ std::filesystem::temp_directory_path() / "carrotpng_encoder.png" };
+        const std::vector<uint8_t> pixels{ make_pixels(10, 10, 40, 4, content_t::gradient, rng) };
+        const image_view_t image{ .width = 10, .height = 10, .pixels = pixels };
+
+        CPNG_CHECK_OK(encode_to_file(path.string().c_str(), image));
+        std::vector<uint8_t> png;
+        CPNG_CHECK_OK(encode(image, png));
+        std::ifstream file{ path, std::ios::binary };
+        CPNG_CHECK(std::vector<uint8_t>(std::istreambuf_iterator<char>{ file }, { }) == png);
+        file.close();
+        std::filesystem::remove(path);
+
+        const std::filesystem::path missing{ path.parent_path() / "carrotpng_no_such_dir" / "a.png" };
+        CPNG_CHECK(encode_to_file(missing.string().c_str(), image) == decode_error::file_write_failed);
+        CPNG_CHECK(encode_to_file(path.string().c_str(), { }) == decode_error::invalid_image_view);
+    }
+
+    // Rejected views
+    {
+        const std::vector<uint8_t> pixels(64 * 4, 0);
+        std::vector<uint8_t> png{ 1, 2, 3 };
+        const auto rejects{ [&](const image_view_t& image) {
+            return encode(image, png) == decode_error::invalid_image_view;
+        } };
+
+        CPNG_CHECK(rejects({ .width = 0, .height = 8, .pixels = pixels }));
+        CPNG_CHECK(rejects({ .width = 8, .height = 0, .pixels = pixels }));
+        CPNG_CHECK(rejects({ .width = 8, .height = 9, .pixels = pixels }));
+        CPNG_CHECK(rejects({ .width = 8, .height = 8, .pixels = pixels, .stride_bytes = 31 }));
+        CPNG_CHECK(rejects({ .width = 8, .height = 8, .pixels = pixels, .stride_bytes = 40 }));
+        CPNG_CHECK(rejects({ .width = 4, .height = 4, .pixels = pixels, .format = pixel_format::rgba32f }));
+        CPNG_CHECK(rejects({ .width = 4, .height = 4, .pixels = pixels, .format = pixel_format::rgba16f }));
+        CPNG_CHECK(rejects({ .width = 1u << 31, .height = 1, .pixels = pixels, .format = pixel_format::r8 }));
+        CPNG_CHECK(encode({ .width = 8, .height = 8, .pixels = pixels }, png) == decode_error::ok);
+    }
+
+    return test::finish("encoder");
+}
@@ -0,0 +1,145 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Specialized decode loops: every source color type and bit depth into every integer output
+// format it supports, at widths around the vector widths so each loop's tail runs, with all
+// five filter types, into packed storage and into caller buffers whose row padding stays intact.
+
+#include "test_support.h"
+
+#include <cstring>
+
+using namespace cpng;
+
+namespace {
+    struct format_t
+    {
+        uint8_t     color_type;
+        uint8_t     bit_depth;
+    };
+
+    constexpr std::array<format_t, 11> k_sources{ {
+        { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 }, { 2, 8 }, { 2, 16 },
+        { 4, 8 }, { 4, 16 }, { 6, 8 }, { 6, 16 },
+    } };
+
+    /// @brief Reference output: channels picked as documented, samples widened to 16 bits, then stored.
+    std::vector<uint8_t> expected_pixels(const test::png_spec_t& spec, const std::span<const uint16_t> samples,
+                                         const pixel_format format)
+    {
+        const uint32_t channels{ test::channel_count(spec.color_type) };
+        const bool alpha{ channels == 2 || channels == 4 };
+        const bool wide{ format == pixel_format::rgba16 || format == pixel_format::r16 ||
+                         format == pixel_format::rg16 };
+        const uint32_t out_channels{ format == pixel_format::r8 || format == pixel_format::r16   ? 1u
+                                     : format == pixel_format::rg8 || format == pixel_format::rg16 ? 2u
+                                                                                                   : 4u };
+        const size_t pixels{ static_cast<size_t>(spec.width) * spec.height };
+
+        const auto sample = [&](const uint16_t v) -> uint16_t {
+            if (spec.bit_depth == 16) return wide ? v : test::to_8bit(v, 16);
+            const uint8_t v8{ test::to_8bit(v, spec.bit_depth) };
+            return wide ? static_cast<uint16_t>(v8 * 257u) : v8;
+        };
+
+        std::vector<uint8_t> out;
+        out.reserve(pixels * out_channels * (wide ? 2 : 1));
+
+        for (size_t i{ 0 }; i < pixels; ++i)
+        {
+            const uint16_t* s{ samples.data() + i * channels };
+            const uint16_t opaque{ wide ? uint16_t{ 65535 } : uint16_t{ 255 } };
+            const uint16_t a{ alpha ? sample(s[channels - 1]) : opaque };
+
+            std::array<uint16_t, 4> o{ };
+            if (out_channels == 4)
+                o = { sample(s[0]), sample(s[channels >= 3 ? 1 : 0]), sample(s[channels >= 3 ? 2 : 0]), a };
+            else
+                o = { sample(s[0]), a, 0, 0 };
+
+            for (uint32_t c{ 0 }; c < out_channels; ++c)
+            {
+                if (!wide)
+                {
+                    out.push_back(static_cast<uint8_t>(o[c]));
+                    continue;
+                }
+
+                uint8_t bytes[2];
+                std::memcpy(bytes, &o[c], 2);   // native endian
+                out.insert(out.end(), bytes, bytes + 2);
+            }
+        }
+        return out;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x049 };
+
+    for (const format_t& source: k_sources)
+    {
+        const bool gray{ source.color_type == 0 || source.color_type == 4 };
+        std::vector<pixel_format> outputs{ pixel_format::rgba8, pixel_format::rgba16 };
+        if (gray) outputs.insert(outputs.end(), { pixel_format::r8, pixel_format::rg8, pixel_format::r16,
+                                                  pixel_format::rg16 });
+
+        for (const uint32_t width: { 1u, 2u, 3u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, 33u, 64u, 67u })
+        {
+            // Ten rows: every filter type twice, each row above a differently filtered one
+            const test::png_spec_t spec{ .width = width, .height = 10, .bit_depth = source.bit_depth,
+                                         .color_type = source.color_type };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+
+            bool packed{ true }, strided{ true };
+            for (const pixel_format format: outputs)
+            {
+                const std::vector<uint8_t> expected{ expected_pixels(spec, samples, format) };
+
+                image_view_t view{ };
+                std::vector<uint8_t> storage;
+                packed &= load_from_memory(png, view, storage, { .format = format }) == decode_error::ok &&
+                          test::equal_bytes(view.pixels, expected);
+
+                // Rows 3 bytes apart from each other plus a guard byte pattern in the padding
+                const size_t row_bytes{ expected.size() / spec.height };
+                const size_t stride{ row_bytes + 3 };
+                std::vector<uint8_t> buffer(stride * spec.height, 0xA5);
+                if (load_from_memory(png, view, buffer, static_cast<uint32_t>(stride), { .format = format }) !=
+                    decode_error::ok)
+                {
+                    strided = false;
+                    continue;
+                }
+
+                for (uint32_t y{ 0 }; y < spec.height; ++y)
+                {
+                    const uint8_t* row{ buffer.data() + y * stride };
+                    strided &= std::memcmp(row, expected.data() + y * row_bytes, row_bytes) == 0;
+                    strided &= row[row_bytes] == 0xA5 && row[row_bytes + 1] == 0xA5 && row[row_bytes + 2] == 0xA5;
+                }
+            }
+            CPNG_CHECK(packed);
+            CPNG_CHECK(strided);
+        }
+    }
+
+    // Color sources have no single-channel output
+    {
+        const test::png_spec_t spec{ .width = 4, .height = 4, .color_type = 2 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        for (const pixel_format format: { pixel_format::r8, pixel_format::rg8, pixel_format::r16, pixel_format::rg16 })
+        {
+            image_view_t view{ };
+            std::vector<uint8_t> storage;
+            CPNG_CHECK(load_from_memory(png, view, storage, { .format = format }) ==
+                       decode_error::unsupported_output_format);
+        }
+    }
+
+    return test::finish("format_dispatch");
+}
@@ -0,0 +1,151 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Pixel and source hashes: XXH64 reference vectors across the 32-byte stripe and row boundaries,
+// agreement between every decode path, strided decodes hashing only image bytes, and source
+// hashes that follow the pixel data but ignore IDAT splits and ancillary chunks.
+
+#include "test_support.h"
+
+using namespace cpng;
+
+namespace {
+    /// @brief Deterministic bytes for the reference vectors: (i * 37 + 11) mod 256.
+    std::vector<uint16_t> pattern(const size_t count)
+    {
+        std::vector<uint16_t> out(count);
+        for (size_t i{ 0 }; i < count; ++i) out[i] = static_cast<uint16_t>((i * 37 + 11) & 0xFF);
+        return out;
+    }
+
+    image_view_t decode(const std::vector<uint8_t>& png, std::vector<uint8_t>& storage, decode_options_t options = { })
+    {
+        options.compute_hashes = true;
+        image_view_t view{ };
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, options));
+        return view;
+    }
+
+    struct vector_t
+    {
+        uint32_t    width;
+        uint32_t    height;
+        uint64_t    hash;   // XXH64, seed 0, of `pattern(width * height)`
+    };
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x034 };
+    std::vector<uint8_t> storage;
+
+    // Reference vectors through R8 output, where the hashed bytes are the samples themselves
+    {
+        const test::png_spec_t one{ .width = 1, .height = 1, .color_type = 0 };
+        CPNG_CHECK(decode(test::make_png(one, std::vector<uint16_t>{ 'a' }), storage,
+                          { .format = pixel_format::r8 }).pixel_hash == 0xd24ec4f1a98c6e5bull);
+
+        const test::png_spec_t three{ .width = 3, .height = 1, .color_type = 0 };
+        CPNG_CHECK(decode(test::make_png(three, std::vector<uint16_t>{ 'a', 'b', 'c' }), storage,
+                          { .format = pixel_format::r8 }).pixel_hash == 0x44bc2cf5ad770999ull);
+
+        constexpr std::array<vector_t, 6> vectors{ {
+            { 31, 1, 0xe4a0e629e519a4aeull },
+            { 32, 1, 0xcc6b8aaada790b2dull },
+            { 33, 1, 0x35ec49850475a832ull },
+            { 7, 9, 0xbf9f0ba3cf95b28aull },    // rows end mid-stripe
+            { 40, 25, 0x128da10cfbdc59d9ull },
+            { 3, 100, 0x8923b28a8498a506ull },  // many rows shorter than a stripe
+        } };
+
+        for (const vector_t& v: vectors)
+        {
+            const test::png_spec_t spec{ .width = v.width, .height = v.height, .color_type = 0 };
+            const std::vector<uint8_t> png{ test::make_png(spec, pattern(size_t{ v.width } * v.height)) };
+            CPNG_CHECK(decode(png, storage, { .format = pixel_format::r8 }).pixel_hash == v.hash);
+
+            // Interlaced rows are hashed once the image is complete, in the same order
+            test::png_spec_t interlaced{ spec };
+            interlaced.interlace = 1;
+            const std::vector<uint8_t> adam7{ test::make_png(interlaced, pattern(size_t{ v.width } * v.height)) };
+            CPNG_CHECK(decode(adam7, storage, { .format = pixel_format::r8 }).pixel_hash == v.hash);
+        }
+    }
+
+    // Source hash: XXH64 of the IHDR payload followed by the IDAT payloads
+    {
+        const test::png_spec_t spec{ .width = 1, .height = 1, .color_type = 0 };
+        const std::vector<uint8_t> raw{ 0, 'a' };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::zlib_stored(raw)) };
+
+        uint64_t hash{ };
+        CPNG_CHECK_OK(compressed_hash_from_memory(png, hash));
+        CPNG_CHECK(hash == 0xf0414086a52fea1bull);
+        CPNG_CHECK(decode(png, storage).source_hash == hash);
+    }
+
+    // Every decode path agrees on the pixel hash of the same output
+    for (const uint8_t color_type: { 0, 2, 4, 6 })
+    {
+        const test::png_spec_t spec{ .width = 29, .height = 17, .color_type = color_type };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        const uint64_t packed{ decode(png, storage).pixel_hash };
+
+        test::png_spec_t interlaced{ spec };
+        interlaced.interlace = 1;
+        CPNG_CHECK(decode(test::make_png(interlaced, samples), storage).pixel_hash == packed);
+
+        // Into a wider buffer: the padding between rows is not hashed
+        const uint32_t stride{ spec.width * 4 + 12 };
+        std::vector<uint8_t> wide((spec.height - 1) * stride + spec.width * 4, 0xCD);
+        image_view_t view{ };
+        CPNG_CHECK_OK(load_from_memory(png, view, wide, stride, { .compute_hashes = true }));
+        CPNG_CHECK(view.pixel_hash == packed);
+
+        // The statistics overload hashes the same way
+        decode_stats_t stats{ };
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .compute_hashes = true }, stats));
+        CPNG_CHECK(view.pixel_hash == packed);
+
+        // Output options change the pixels, so they change the hash
+        CPNG_CHECK(decode(png, storage, { .format = pixel_format::rgba16 }).pixel_hash != packed);
+    }
+
+    // The source hash follows the pixel data, not how it is chunked or annotated
+    {
+        const test::png_spec_t spec{ .width = 40, .height = 30 };
+        std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> zlib{ test::zlib_stored(test::scanlines(spec, samples)) };
+
+        uint64_t single{ }, split{ }, annotated{ };
+        CPNG_CHECK_OK(compressed_hash_from_memory(test::make_png(spec, zlib), single));
+        CPNG_CHECK_OK(compressed_hash_from_memory(test::make_png(spec, zlib, { }, 100), split));
+        CPNG_CHECK_OK(compressed_hash_from_memory(
+            test::make_png(spec, zlib, { { "gAMA", { 0, 0, 0xB1, 0x8F } }, { "tEXt", { 'k', 0, 'v' } } }), annotated));
+        CPNG_CHECK(single == split && single == annotated);
+
+        samples[0] ^= 1;
+        uint64_t changed{ };
+        const std::vector<uint8_t> edited{ test::make_png(spec, test::zlib_stored(test::scanlines(spec, samples))) };
+        CPNG_CHECK_OK(compressed_hash_from_memory(edited, changed));
+        CPNG_CHECK(changed != single);
+
+        // A chunk level error is reported instead of a hash
+        std::vector<uint8_t> corrupt{ test::make_png(spec, zlib) };
+        corrupt[20] ^= 0xFF;
+        CPNG_CHECK(compressed_hash_from_memory(corrupt, changed) != decode_error::ok);
+    }
+
+    // Hashes are left at 0 unless requested
+    {
+        const test::png_spec_t spec{ .width = 5, .height = 5 };
+        image_view_t view{ };
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, test::random_samples(spec, rng)), view, storage));
+        CPNG_CHECK(view.pixel_hash == 0 && view.source_hash == 0);
+    }
+
+    return test::finish("hashes");
+}
@@ -0,0 +1,216 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Header probes: IHDR fields and file sizes for many files at once, the chunk scan's color
+// space, palette and IDAT totals (including files larger than the read window), and per-file
+// errors for missing files, broken headers and broken chunk layouts.
+
+#include "test_support.h"
+
+#include "cpng/header_probe.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace cpng;
+
+namespace {
+    struct probe_file_t
+    {
+        std::string             path;
+        std::vector<uint8_t>    png;
+        test::png_spec_t        spec;
+        bool                    srgb;
+        bool                    gamma;      // gAMA of 0.45455
+        bool                    icc;
+        bool                    palette;
+        uint32_t                idat_chunks;
+        uint64_t                idat_bytes;
+    };
+
+    std::string temp_path(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("carrotpng_probe_" + name)).string();
+    }
+
+    void write_file(const std::string& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<header_probe_t> probe(const std::vector<std::string>& paths, const probe_options_t& options)
+    {
+        std::vector<const char*> c_paths;
+        for (const std::string& p: paths) c_paths.push_back(p.c_str());
+
+        std::vector<header_probe_t> probes(paths.size());
+        CPNG_CHECK_OK(probe_headers(c_paths, probes, options));
+        return probes;
+    }
+
+    decode_error probe_one(const std::string& name, const std::vector<uint8_t>& bytes)
+    {
+        const std::string path{ temp_path(name) };
+        write_file(path, bytes);
+        const decode_error err{ probe({ path }, { .scan_chunks = true })[0].error };
+        std::filesystem::remove(path);
+        return err;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x038 };
+
+    std::vector<probe_file_t> files;
+    for (uint32_t i{ 0 }; i < 30; ++i)
+    {
+        constexpr std::array<std::pair<uint8_t, uint8_t>, 5> layouts{ {
+            { 0, 1 }, { 2, 8 }, { 3, 8 }, { 4, 16 }, { 6, 8 },
+        } };
+        const auto& [color_type, depth]{ layouts[i % layouts.size()] };
+
+        // Some files are far larger than one read window, with many IDAT chunks to step over
+        const bool large{ i % 6 == 5 };
+        const test::png_spec_t spec{ .width = 1 + rng.below(large ? 200 : 30), .height = 1 + rng.below(large ? 60 : 20),
+                                     .bit_depth = depth, .color_type = color_type,
+                                     .interlace = static_cast<uint8_t>(i % 4 == 3) };
+
+        std::vector<uint16_t> samples(test::random_samples(spec, rng));
+        if (color_type == 3) for (uint16_t& s: samples) s %= 4;
+        const std::vector<uint8_t> zlib{ test::zlib_stored(test::scanlines(spec, samples)) };
+
+        probe_file_t f{ .path = temp_path(std::to_string(i) + ".png"), .png = { }, .spec = spec,
+                        .srgb = i % 3 == 1, .gamma = i % 4 == 2, .icc = i % 7 == 0, .palette = color_type == 3,
+                        .idat_chunks = 0, .idat_bytes = zlib.size() };
+
+        std::vector<test::extra_chunk_t> extra;
+        if (f.srgb) extra.push_back({ "sRGB", { 0 } });
+        if (f.gamma) extra.push_back({ "gAMA", { 0, 0, 0xB1, 0x8F } });
+        if (f.icc) extra.push_back({ "iCCP", { 'p', 0, 0, 0x78, 0x01 } });
+        if (f.palette) extra.push_back({ "PLTE", std::vector<uint8_t>(12, 0x80) });
+        extra.push_back({ "tEXt", std::vector<uint8_t>(large ? 5000 : 10, 'x') });
+
+        const size_t idat_size{ large ? 97u : i % 2 == 0 ? 0u : 16u };
+        f.idat_chunks = static_cast<uint32_t>(idat_size ? (zlib.size() + idat_size - 1) / idat_size : 1);
+        f.png = test::make_png(spec, zlib, extra, idat_size);
+
+        write_file(f.path, f.png);
+        files.push_back(std::move(f));
+    }
+
+    std::vector<std::string> paths;
+    for (const probe_file_t& f: files) paths.push_back(f.path);
+
+    // Headers only: IHDR fields and sizes, no chunk fields
+    {
+        const std::vector<header_probe_t> probes{ probe(paths, { .worker_threads = 4 }) };
+        bool headers{ true }, untouched{ true };
+        for (size_t i{ 0 }; i < files.size(); ++i)
+        {
+            const header_probe_t& p{ probes[i] };
+            const test::png_spec_t& spec{ files[i].spec };
+            headers &= p.error == decode_error::ok && p.file_size == files[i].png.size();
+            headers &= p.ihdr.width == spec.width && p.ihdr.height == spec.height &&
+                       p.ihdr.bit_depth == spec.bit_depth && p.ihdr.color_type == spec.color_type &&
+                       p.ihdr.interlace_method == spec.interlace;
+            untouched &= !p.ihdr.has_srgb && !p.ihdr.has_gamma && !p.ihdr.has_icc_profile && !p.has_palette;
+            untouched &= p.idat_chunks == 0 && p.idat_bytes == 0;
+        }
+        CPNG_CHECK(headers && untouched);
+    }
+
+    // Chunk scan, serial and parallel alike
+    for (const uint32_t threads: { 1u, 0u })
+    {
+        const std::vector<header_probe_t> probes{ probe(paths, { .scan_chunks = true, .worker_threads = threads }) };
+        bool chunks{ true };
+        for (size_t i{ 0 }; i < files.size(); ++i)
+        {
+            const header_probe_t& p{ probes[i] };
+            const probe_file_t& f{ files[i] };
+            chunks &= p.error == decode_error::ok && p.ihdr.width == f.spec.width;
+            chunks &= p.ihdr.has_srgb == f.srgb && p.ihdr.has_gamma == f.gamma && p.ihdr.has_icc_profile == f.icc;
+            chunks &= !f.gamma || std::abs(p.ihdr.gamma - 0.45455f) < 1e-5f;
+            chunks &= p.has_palette == f.palette;
+            chunks &= p.idat_chunks == f.idat_chunks && p.idat_bytes == f.idat_bytes;
+        }
+        CPNG_CHECK(chunks);
+    }
+
+    // Color chunks after the image data do not count
+    {
+        const test::png_spec_t spec{ .width = 3, .height = 3 };
+        std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        std::vector<uint8_t> tail;
+        test::put_chunk(tail, "sRGB", std::vector<uint8_t>{ 0 });
+        test::put_chunk(tail, "gAMA", std::vector<uint8_t>{ 0, 0, 0xB1, 0x8F });
+        png.insert(png.end() - 12, tail.begin(), tail.end());
+
+        const std::string path{ temp_path("late.png") };
+        write_file(path, png);
+        const header_probe_t p{ probe({ path }, { .scan_chunks = true })[0] };
+        CPNG_CHECK(p.error == decode_error::ok && !p.ihdr.has_srgb && !p.ihdr.has_gamma);
+        std::filesystem::remove(path);
+    }
+
+    // Per-file failures do not stop the batch
+    {
+        std::vector<std::string> mixed{ paths[0], temp_path("missing.png"), paths[1] };
+        const std::vector<header_probe_t> probes{ probe(mixed, { .scan_chunks = true }) };
+        CPNG_CHECK(probes[0].error == decode_error::ok && probes[2].error == decode_error::ok);
+        CPNG_CHECK(probes[1].error == decode_error::file_not_found && probes[1].file_size == 0);
+
+        const std::vector<uint8_t>& good{ files[0].png };
+        const size_t end{ good.size() - 12 };   // start of IEND
+
+        std::vector<uint8_t> bytes{ good };
+        bytes[0] = 'X';
+        CPNG_CHECK(probe_one("signature.png", bytes) == decode_error::invalid_signature);
+
+        bytes = good;
+        bytes[29] ^= 1;
+        CPNG_CHECK(probe_one("ihdr_crc.png", bytes) == decode_error::crc_mismatch);
+
+        CPNG_CHECK(probe_one("short.png", { good.begin(), good.begin() + 20 }) != decode_error::ok);
+        CPNG_CHECK(probe_one("no_iend.png", { good.begin(), good.begin() + static_cast<ptrdiff_t>(end) }) ==
+                   decode_error::no_iend);
+        CPNG_CHECK(probe_one("cut.png", { good.begin(), good.end() - 5 }) == decode_error::file_too_short);
+        CPNG_CHECK(probe_one("cut_idat.png", { good.begin(), good.end() - 14 }) == decode_error::invalid_chunk_length);
+
+        // A length running past the end of the file
+        bytes = good;
+        bytes[33] = 0x10;
+        CPNG_CHECK(probe_one("length.png", bytes) == decode_error::invalid_chunk_length);
+
+        // IEND straight after the header
+        bytes.assign(good.begin(), good.begin() + 33);
+        bytes.insert(bytes.end(), good.begin() + static_cast<ptrdiff_t>(end), good.end());
+        CPNG_CHECK(probe_one("no_idat.png", bytes) == decode_error::no_idat_chunks);
+
+        // A second IHDR
+        bytes.assign(good.begin(), good.begin() + 33);
+        bytes.insert(bytes.end(), good.begin() + 8, good.end());
+        CPNG_CHECK(probe_one("two_ihdr.png", bytes) == decode_error::duplicate_ihdr);
+
+        // Without the chunk scan only the header is read, so a broken tail is not seen
+        const std::string path{ temp_path("tail.png") };
+        write_file(path, { good.begin(), good.end() - 5 });
+        CPNG_CHECK(probe({ path }, { })[0].error == decode_error::ok);
+        std::filesystem::remove(path);
+    }
+
+    // Too few outputs is refused up front
+    {
+        const char* one[]{ paths[0].c_str(), paths[1].c_str() };
+        header_probe_t probes[1]{ };
+        CPNG_CHECK(probe_headers(one, probes) == decode_error::output_buffer_too_small);
+    }
+
+    for (const std::string& path: paths) std::filesystem::remove(path);
+    return test::finish("header_probe");
+}
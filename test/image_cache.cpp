@@ -0,0 +1,227 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Image cache: lazy handles, content and caller keys, hits / misses / coalescing, LRU eviction
+// under the budget, re-decoding evicted in-memory images after the caller's bytes are gone,
+// remembered failures, and keys forgotten once nothing refers to them.
+
+#include "test_support.h"
+
+#include "cpng/image_cache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace cpng;
+
+namespace {
+    struct sample_png_t
+    {
+        std::vector<uint8_t>    png;
+        std::vector<uint8_t>    rgba;
+    };
+
+    sample_png_t make_sample(const uint32_t width, const uint32_t height, test::rng_t& rng)
+    {
+        const test::png_spec_t spec{ .width = width, .height = height };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        return { test::make_png(spec, samples), test::expected_rgba8(spec, samples) };
+    }
+
+    bool pixels_match(const image_handle_t& handle, const std::vector<uint8_t>& rgba)
+    {
+        std::shared_ptr<const decoded_image_t> image;
+        return handle.pixels(image) == decode_error::ok && test::equal_bytes(image->view.pixels, rgba);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x035 };
+
+    // Lazy handles: the header is there before any decode, pixels decode once and are shared
+    {
+        const sample_png_t a{ make_sample(16, 8, rng) };
+        image_cache_t cache{ 1u << 20 };
+
+        image_handle_t handle{ };
+        std::shared_ptr<const decoded_image_t> none;
+        CPNG_CHECK(!handle.valid() && handle.pixels(none) == decode_error::missing_ihdr);
+        CPNG_CHECK_OK(cache.open_memory(a.png, handle));
+        CPNG_CHECK(handle.valid() && handle.header().width == 16 && handle.header().height == 8);
+        CPNG_CHECK(cache.stats().misses == 0 && cache.stats().resident_bytes == 0);
+
+        uint64_t content_key{ };
+        CPNG_CHECK_OK(compressed_hash_from_memory(a.png, content_key));
+        CPNG_CHECK(handle.key() == content_key);
+
+        std::shared_ptr<const decoded_image_t> first, second;
+        CPNG_CHECK_OK(handle.pixels(first));
+        CPNG_CHECK_OK(handle.pixels(second));
+        CPNG_CHECK(first == second && test::equal_bytes(first->view.pixels, a.rgba));
+
+        // Identical bytes from another buffer share the entry
+        const std::vector<uint8_t> copy{ a.png };
+        image_handle_t other{ };
+        CPNG_CHECK_OK(cache.open_memory(copy, other));
+        CPNG_CHECK_OK(other.pixels(second));
+        CPNG_CHECK(second == first);
+
+        const image_cache_stats_t stats{ cache.stats() };
+        CPNG_CHECK(stats.misses == 1 && stats.hits == 2 && stats.entries == 1);
+        CPNG_CHECK(stats.resident_bytes == first->storage.size());
+    }
+
+    // The caller's bytes may go away: clears and evictions decode again from the cache's copy
+    {
+        const sample_png_t a{ make_sample(12, 12, rng) };
+        image_cache_t cache{ 1u << 20 };
+        image_handle_t handle{ };
+        {
+            auto bytes{ std::make_unique<std::vector<uint8_t>>(a.png) };
+            CPNG_CHECK_OK(cache.open_memory(*bytes, 7, handle));
+            CPNG_CHECK(pixels_match(handle, a.rgba));
+            std::fill(bytes->begin(), bytes->end(), uint8_t{ 0xEE });
+        }
+
+        cache.clear();
+        CPNG_CHECK(cache.stats().resident_bytes == 0 && cache.stats().evictions == 1);
+        CPNG_CHECK(pixels_match(handle, a.rgba));
+        CPNG_CHECK(cache.stats().misses == 2);
+
+        // Reopening the key keeps the first copy; the new span is not read
+        const std::vector<uint8_t> unrelated{ make_sample(3, 3, rng).png };
+        image_handle_t again{ };
+        CPNG_CHECK_OK(cache.open_memory(unrelated, 7, again));
+        CPNG_CHECK(again.header().width == 12);
+        cache.clear();
+        CPNG_CHECK(pixels_match(again, a.rgba));
+    }
+
+    // LRU eviction under the budget; referenced images survive eviction and are shared
+    {
+        std::vector<sample_png_t> samples;
+        for (uint32_t i{ 0 }; i < 4; ++i) samples.push_back(make_sample(8, 8, rng)); // 256 bytes each
+
+        image_cache_t cache{ 600 };
+        std::vector<image_handle_t> handles(samples.size());
+        for (size_t i{ 0 }; i < samples.size(); ++i)
+        {
+            CPNG_CHECK_OK(cache.open_memory(samples[i].png, i, handles[i]));
+            CPNG_CHECK(pixels_match(handles[i], samples[i].rgba));
+        }
+        CPNG_CHECK(cache.stats().resident_bytes == 512 && cache.stats().evictions == 2);
+
+        // Most recent first: touching image 2 makes image 3 the next victim
+        CPNG_CHECK(pixels_match(handles[2], samples[2].rgba));
+        std::shared_ptr<const decoded_image_t> held;
+        CPNG_CHECK_OK(handles[0].pixels(held));
+        CPNG_CHECK(cache.stats().evictions == 3 && cache.stats().misses == 5);
+
+        const uint64_t misses{ cache.stats().misses };
+        CPNG_CHECK(pixels_match(handles[2], samples[2].rgba));
+        CPNG_CHECK(cache.stats().misses == misses);
+
+        // Image 0 gets evicted while `held` keeps it alive: it is handed out again, not re-decoded
+        cache.set_budget(0);
+        std::shared_ptr<const decoded_image_t> again;
+        CPNG_CHECK_OK(handles[0].pixels(again));
+        CPNG_CHECK(again == held && cache.stats().misses == misses);
+
+        // An image larger than the whole budget is returned but not retained
+        CPNG_CHECK(pixels_match(handles[1], samples[1].rgba));
+        CPNG_CHECK(cache.stats().resident_bytes == 0);
+    }
+
+    // Failures are remembered while the entry lives, and retried once it is gone
+    {
+        const test::png_spec_t spec{ .width = 4, .height = 4 };
+        const std::vector<uint8_t> bad_zlib{ 0x78, 0x01, 0x07, 0, 0, 0, 0 };
+        const std::vector<uint8_t> png{ test::make_png(spec, bad_zlib) };
+        image_cache_t cache{ 1u << 20 };
+        {
+            image_handle_t handle{ };
+            CPNG_CHECK_OK(cache.open_memory(png, handle));
+            std::shared_ptr<const decoded_image_t> image;
+            const decode_error first{ handle.pixels(image) };
+            CPNG_CHECK(first == decode_error::invalid_idat_stream && !image);
+            CPNG_CHECK(handle.pixels(image) == first && cache.stats().misses == 1);
+            CPNG_CHECK(cache.stats().entries == 1);
+        }
+        CPNG_CHECK(cache.stats().entries == 0);
+
+        image_handle_t handle{ };
+        CPNG_CHECK_OK(cache.open_memory(png, handle));
+        std::shared_ptr<const decoded_image_t> image;
+        CPNG_CHECK(handle.pixels(image) == decode_error::invalid_idat_stream && cache.stats().misses == 2);
+
+        // Headers are still checked up front
+        CPNG_CHECK(cache.open_memory(std::vector<uint8_t>(8, 0), handle) != decode_error::ok);
+    }
+
+    // Keys are forgotten once no handle refers to them and nothing is resident
+    {
+        image_cache_t cache{ 1024 };
+        for (uint64_t key{ 0 }; key < 500; ++key)
+        {
+            const sample_png_t s{ make_sample(4, 4, rng) };
+            image_handle_t handle{ };
+            CPNG_CHECK_OK(cache.open_memory(s.png, key, handle));
+            if (key % 3 == 0) CPNG_CHECK(pixels_match(handle, s.rgba));
+        }
+        const image_cache_stats_t stats{ cache.stats() };
+        CPNG_CHECK(stats.entries == stats.resident_bytes / 64 && stats.resident_bytes <= 1024);
+
+        cache.clear();
+        CPNG_CHECK(cache.stats().entries == 0);
+    }
+
+    // Files are keyed by path
+    {
+        const sample_png_t a{ make_sample(9, 5, rng) };
+        const std::filesystem::path path{ std::filesystem::temp_directory_path() / "carrotpng_image_cache.png" };
+        {
+            std::ofstream file{ path, std::ios::binary };
+            file.write(reinterpret_cast<const char*>(a.png.data()), static_cast<std::streamsize>(a.png.size()));
+        }
+
+        image_cache_t cache{ 1u << 20 };
+        image_handle_t first{ }, second{ };
+        CPNG_CHECK_OK(cache.open_file(path.string().c_str(), first));
+        CPNG_CHECK_OK(cache.open_file(path.string().c_str(), second));
+        CPNG_CHECK(first.key() == second.key() && pixels_match(first, a.rgba));
+        CPNG_CHECK(cache.stats().entries == 1);
+
+        image_handle_t missing{ };
+        CPNG_CHECK(cache.open_file((path.string() + ".missing").c_str(), missing) == decode_error::file_not_found);
+        std::filesystem::remove(path);
+    }
+
+    // Concurrent requests for one image decode it once
+    {
+        const sample_png_t a{ make_sample(256, 256, rng) };
+        image_cache_t cache{ 1u << 20 };
+        image_handle_t handle{ };
+        CPNG_CHECK_OK(cache.open_memory(a.png, handle));
+
+        std::vector<std::shared_ptr<const decoded_image_t>> results(8);
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i{ 0 }; i < results.size(); ++i)
+                threads.emplace_back([&, i] { static_cast<void>(handle.pixels(results[i])); });
+        }
+
+        bool shared{ results[0] && test::equal_bytes(results[0]->view.pixels, a.rgba) };
+        for (const auto& image: results) shared &= image == results[0];
+        CPNG_CHECK(shared);
+
+        const image_cache_stats_t stats{ cache.stats() };
+        CPNG_CHECK(stats.misses == 1 && stats.hits + stats.coalesced == results.size() - 1);
+    }
+
+    return test::finish("image_cache");
+}
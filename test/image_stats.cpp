@@ -0,0 +1,149 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Content statistics: every flag and the per-channel range checked against a scan of the output
+// pixels, for scanned and seeded flags, every output format, Adam7 sources and premultiplied
+// rows, plus the empty result when statistics are not requested.
+
+#include "test_support.h"
+
+using namespace cpng;
+
+namespace {
+    /// @brief Reference statistics of RGBA8 pixels.
+    image_stats_t scan(const std::vector<uint8_t>& rgba)
+    {
+        image_stats_t stats{ .valid = true, .alpha_opaque = true, .alpha_binary = true, .grayscale = true,
+                             .solid = true, .channel_min = { 1, 1, 1, 1 }, .channel_max = { } };
+        for (size_t i{ 0 }; i < rgba.size(); i += 4)
+        {
+            const uint8_t* p{ rgba.data() + i };
+            for (size_t c{ 0 }; c < 4; ++c)
+            {
+                stats.channel_min[c] = std::min(stats.channel_min[c], p[c] / 255.0f);
+                stats.channel_max[c] = std::max(stats.channel_max[c], p[c] / 255.0f);
+            }
+            stats.alpha_opaque &= p[3] == 255;
+            stats.alpha_binary &= p[3] == 0 || p[3] == 255;
+            stats.grayscale &= p[0] == p[1] && p[1] == p[2];
+            stats.solid &= std::equal(p, p + 4, rgba.data());
+        }
+        return stats;
+    }
+
+    bool same_flags(const image_stats_t& a, const image_stats_t& b)
+    {
+        return a.valid == b.valid && a.alpha_opaque == b.alpha_opaque && a.alpha_binary == b.alpha_binary &&
+               a.grayscale == b.grayscale && a.solid == b.solid;
+    }
+
+    bool same_range(const image_stats_t& a, const image_stats_t& b, const float tolerance = 0.0f)
+    {
+        bool same{ true };
+        for (size_t c{ 0 }; c < 4; ++c)
+        {
+            same &= std::abs(a.channel_min[c] - b.channel_min[c]) <= tolerance;
+            same &= std::abs(a.channel_max[c] - b.channel_max[c]) <= tolerance;
+        }
+        return same;
+    }
+
+    image_stats_t decode_stats(const std::vector<uint8_t>& png, decode_options_t options = { })
+    {
+        options.compute_stats = true;
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, options));
+        return view.stats;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x033 };
+
+    // Shapes of content that set each flag, for every color type that can carry them
+    enum class content_t : uint8_t { random, opaque, binary_alpha, gray, solid };
+
+    for (const uint8_t color_type: { 0, 2, 4, 6 })
+    {
+        for (const content_t content: { content_t::random, content_t::opaque, content_t::binary_alpha,
+                                        content_t::gray, content_t::solid })
+        {
+            const test::png_spec_t spec{ .width = 21, .height = 13, .color_type = color_type };
+            const uint32_t channels{ test::channel_count(color_type) };
+            std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+
+            for (size_t i{ 0 }; i < samples.size(); i += channels)
+            {
+                uint16_t* p{ samples.data() + i };
+                const bool alpha{ channels == 2 || channels == 4 };
+                if (content == content_t::opaque && alpha) p[channels - 1] = 255;
+                if (content == content_t::binary_alpha && alpha) p[channels - 1] = p[channels - 1] & 1 ? 255 : 0;
+                if (content == content_t::gray && channels >= 3) p[1] = p[2] = p[0];
+                if (content == content_t::solid) std::copy_n(samples.data(), channels, p);
+            }
+
+            const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+            const image_stats_t expected{ scan(test::expected_rgba8(spec, samples)) };
+            const image_stats_t stats{ decode_stats(png) };
+            CPNG_CHECK(same_flags(stats, expected) && same_range(stats, expected, 1e-6f));
+
+            // The same image interlaced
+            test::png_spec_t interlaced{ spec };
+            interlaced.interlace = 1;
+            const image_stats_t adam7{ decode_stats(test::make_png(interlaced, samples)) };
+            CPNG_CHECK(same_flags(adam7, expected) && same_range(adam7, expected, 1e-6f));
+
+            // Wider formats normalize to the same 0..1 range
+            for (const pixel_format format: { pixel_format::rgba16, pixel_format::rgba32f, pixel_format::rgba16f })
+            {
+                const image_stats_t wide{ decode_stats(png, { .format = format }) };
+                CPNG_CHECK(same_flags(wide, expected) && same_range(wide, expected, 1e-3f));
+            }
+        }
+    }
+
+    // Gray formats report gray as R, G and B; without alpha in the output, alpha is 1
+    {
+        const test::png_spec_t spec{ .width = 17, .height = 6, .color_type = 4 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        const image_stats_t expected{ scan(test::expected_rgba8(spec, samples)) };
+
+        const image_stats_t rg{ decode_stats(png, { .format = pixel_format::rg8 }) };
+        CPNG_CHECK(same_flags(rg, expected) && same_range(rg, expected));
+
+        const image_stats_t r{ decode_stats(png, { .format = pixel_format::r8 }) };
+        CPNG_CHECK(r.alpha_opaque && r.alpha_binary && r.grayscale);
+        CPNG_CHECK(r.channel_min[3] == 1.0f && r.channel_max[3] == 1.0f);
+        CPNG_CHECK(r.channel_min[0] == expected.channel_min[0] && r.channel_max[2] == expected.channel_max[2]);
+    }
+
+    // Statistics see the output: premultiplied colors under zero alpha are zero
+    {
+        const test::png_spec_t spec{ .width = 4, .height = 1 };
+        const std::vector<uint16_t> samples{ 200, 100, 50, 0, 200, 100, 50, 0, 200, 100, 50, 0, 200, 100, 50, 0 };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+
+        const image_stats_t straight{ decode_stats(png) };
+        CPNG_CHECK(straight.solid && !straight.grayscale && !straight.alpha_opaque && straight.alpha_binary);
+        CPNG_CHECK(straight.channel_max[0] == 200 / 255.0f);
+
+        const image_stats_t multiplied{ decode_stats(png, { .premultiply_alpha = true }) };
+        CPNG_CHECK(multiplied.solid && multiplied.grayscale && multiplied.channel_max[0] == 0.0f);
+    }
+
+    // Not requested: an empty, invalid record
+    {
+        const test::png_spec_t spec{ .width = 3, .height = 3 };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, test::random_samples(spec, rng)), view, storage));
+        CPNG_CHECK(!view.stats.valid && !view.stats.solid && view.stats.channel_max[0] == 0.0f);
+    }
+
+    return test::finish("image_stats");
+}
@@ -0,0 +1,343 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Inflate block sequences: fixed-Huffman blocks followed by more fixed blocks or by stored
+// blocks (the empty final one included), matches reaching back into an earlier block, previews
+// that stop inside a fixed block, streams that run past the image (a little, or far enough to be
+// rejected early) or stop before its end, and every failing check of the fixed-Huffman path with
+// its diagnostics.
+
+#include "test_support.h"
+
+#include "cpng/encoder.h"
+
+using namespace cpng;
+
+namespace {
+    /// @brief LSB-first deflate bit writer with the fixed-Huffman code of RFC 1951 3.2.6.
+    struct bit_writer_t
+    {
+        std::vector<uint8_t>    out{ 0x78, 0x01 };
+        uint32_t                bit_count{ 0 };
+
+        void bits(const uint32_t value, const uint32_t count)
+        {
+            for (uint32_t i{ 0 }; i < count; ++i, ++bit_count)
+            {
+                if (bit_count % 8 == 0) out.push_back(0);
+                out.back() |= static_cast<uint8_t>(((value >> i) & 1u) << (bit_count % 8));
+            }
+        }
+
+        /// Huffman codes go out most significant bit first.
+        void code(const uint32_t value, const uint32_t count)
+        {
+            for (uint32_t i{ count }; i-- > 0;) bits((value >> i) & 1u, 1);
+        }
+
+        void symbol(const uint32_t sym)
+        {
+            if (sym < 144) code(0x30 + sym, 8);
+            else if (sym < 256) code(0x190 + sym - 144, 9);
+            else if (sym < 280) code(sym - 256, 7);
+            else code(0xC0 + sym - 280, 8);
+        }
+
+        /// A match of 3..10 bytes (length codes 257..264) at distance 1..256.
+        void match(const uint32_t length, const uint32_t distance)
+        {
+            symbol(254 + length);
+
+            uint32_t dcode{ 0 }, base{ 1 }, extra{ 0 };
+            while (base + (1u << extra) <= distance)
+            {
+                base += 1u << extra;
+                ++dcode;
+                extra = dcode < 4 ? 0 : dcode / 2 - 1;
+            }
+            code(dcode, 5);
+            bits(distance - base, extra);
+        }
+
+        void stored(const std::span<const uint8_t> data, const bool final)
+        {
+            bits(final, 1);
+            bits(0, 2);
+            bit_count = (bit_count + 7) / 8 * 8;
+            const auto len{ static_cast<uint16_t>(data.size()) };
+            out.insert(out.end(), { static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+                                    static_cast<uint8_t>(~len), static_cast<uint8_t>(~len >> 8) });
+            out.insert(out.end(), data.begin(), data.end());
+            bit_count += static_cast<uint32_t>(data.size() + 4) * 8;
+        }
+
+        /**
+         * Writes `data[begin, end)` as one fixed block, with greedy matches of up to 10 bytes that
+         * may reach anywhere before `end`, earlier blocks included. Ends with code 256 if asked.
+         */
+        void fixed(const std::span<const uint8_t> data, const size_t begin, const size_t end, const bool final,
+                   const bool end_of_block = true)
+        {
+            bits(final, 1);
+            bits(1, 2);
+
+            for (size_t i{ begin }; i < end;)
+            {
+                uint32_t best{ 0 }, best_distance{ 0 };
+                for (uint32_t d{ 1 }; d <= std::min<size_t>(i, 256); ++d)
+                {
+                    uint32_t n{ 0 };
+                    while (n < 10 && i + n < end && data[i + n] == data[i + n - d]) ++n;
+                    if (n > best) best = n, best_distance = d;
+                }
+
+                if (best >= 3)
+                {
+                    match(best, best_distance);
+                    i += best;
+                }
+                else symbol(data[i++]);
+            }
+
+            if (end_of_block) symbol(256);
+        }
+
+        std::vector<uint8_t> finish(const std::span<const uint8_t> data)
+        {
+            test::put_u32(out, test::adler32(data));
+            return out;
+        }
+    };
+
+    /// @brief Gray samples with runs and repeats, so the fixed blocks hold matches.
+    std::vector<uint16_t> banded_samples(const test::png_spec_t& spec, test::rng_t& rng)
+    {
+        std::vector<uint16_t> samples(static_cast<size_t>(spec.width) * spec.height);
+        for (size_t i{ 0 }; i < samples.size(); ++i)
+            samples[i] = static_cast<uint16_t>(i / 5 % 7 * 30 + (rng.below(4) == 0 ? rng.below(9) : 0));
+        return samples;
+    }
+
+    decode_error decode(const test::png_spec_t& spec, const std::vector<uint8_t>& zlib, std::vector<uint8_t>& out,
+                        const decode_options_t& options = { })
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        const decode_error err{ load_from_memory(test::make_png(spec, zlib), view, storage, options) };
+        out.assign(view.pixels.begin(), view.pixels.end());
+        return err;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x045 };
+
+    const test::png_spec_t spec{ .width = 23, .height = 11, .color_type = 0 };
+    const std::vector<uint16_t> samples{ banded_samples(spec, rng) };
+    const std::vector<uint8_t> raw{ test::scanlines(spec, samples) };
+    const std::vector<uint8_t> expected{ test::expected_rgba8(spec, samples) };
+    const size_t half{ raw.size() / 2 };
+
+    // One final fixed block
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, raw.size(), true);
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(spec, w.finish(raw), out));
+        CPNG_CHECK(out == expected);
+    }
+
+    // A fixed block that holds the whole image, then an empty final stored block
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, raw.size(), false);
+        w.stored({ }, true);
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(spec, w.finish(raw), out));
+        CPNG_CHECK(out == expected);
+    }
+
+    // Two fixed blocks, the second one matching back into the first; then an empty stored block
+    for (const size_t split: { size_t{ 1 }, size_t{ 24 }, half, raw.size() - 1 })
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, split, false);
+        w.fixed(raw, split, raw.size(), false);
+        w.stored({ }, true);
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(spec, w.finish(raw), out));
+        CPNG_CHECK(out == expected);
+    }
+
+    // A fixed block, a stored block with the rest of the data, and an empty fixed final block
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, half, false);
+        w.stored(std::span{ raw }.subspan(half), false);
+        w.fixed(raw, raw.size(), raw.size(), true);
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(spec, w.finish(raw), out));
+        CPNG_CHECK(out == expected);
+    }
+
+    // Bytes past the image in a fixed block are inflated, checked against Adler-32 and dropped
+    {
+        std::vector<uint8_t> longer{ raw };
+        longer.insert(longer.end(), { 0, 0, 0 });
+        bit_writer_t w{ };
+        w.fixed(longer, 0, longer.size(), true);
+        std::vector<uint8_t> zlib{ w.finish(longer) }, out;
+        CPNG_CHECK_OK(decode(spec, zlib, out));
+        CPNG_CHECK(out == expected);
+
+        zlib.back() ^= 1;
+        CPNG_CHECK(decode(spec, zlib, out) == decode_error::invalid_idat_stream);
+    }
+
+    // A block that keeps expanding past the image is stopped long before its end-of-block code
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, raw.size(), true, false);
+        for (uint32_t i{ 0 }; i < 10000; ++i) w.match(10, 1);
+        w.symbol(256);
+        const std::vector<uint8_t> zlib{ w.finish(raw) };
+
+        decode_diagnostics_t diag{ };
+        std::vector<uint8_t> out;
+        CPNG_CHECK(decode(spec, zlib, out, { .diagnostics = &diag }) == decode_error::invalid_idat_stream);
+        CPNG_CHECK(std::string_view{ diag.reason } == "output runs past the image data");
+        CPNG_CHECK(diag.actual_size > raw.size() && diag.actual_size < raw.size() + 10000 * 10);
+    }
+
+    // The same for dynamic blocks: a tall encoded image whose IHDR claims four rows
+    {
+        const uint32_t width{ 32 }, height{ 2000 };
+        const std::vector<uint8_t> rgba(size_t{ width } * height * 4, 0x5A);
+        std::vector<uint8_t> png;
+        CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rgba }, png));
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        decode_stats_t stats{ };
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { }, stats));
+        CPNG_CHECK(stats.dynamic_blocks > 0 && stats.stored_blocks == 0);
+
+        // The single IDAT payload
+        const std::string_view bytes{ reinterpret_cast<const char*>(png.data()), png.size() };
+        const size_t idat{ bytes.find("IDAT") };
+        const size_t length{ size_t{ png[idat - 4] } << 24 | size_t{ png[idat - 3] } << 16 |
+                             size_t{ png[idat - 2] } << 8 | png[idat - 1] };
+        const std::span<const uint8_t> zlib{ png.data() + idat + 4, length };
+
+        decode_diagnostics_t diag{ };
+        std::vector<uint8_t> out;
+        const test::png_spec_t shorter{ .width = width, .height = 4, .color_type = 6 };
+        CPNG_CHECK(decode(shorter, std::vector<uint8_t>{ zlib.begin(), zlib.end() }, out, { .diagnostics = &diag }) ==
+                   decode_error::invalid_idat_stream);
+        CPNG_CHECK(std::string_view{ diag.reason } == "output runs past the image data");
+        CPNG_CHECK(diag.actual_size < size_t{ width } * height * 4);
+    }
+
+    // Streams that stop early: a block without its end-of-block code, and one short of the image
+    {
+        bit_writer_t w{ };
+        w.fixed(raw, 0, raw.size(), true, false);
+        std::vector<uint8_t> out;
+        CPNG_CHECK(decode(spec, w.finish(raw), out) == decode_error::invalid_idat_stream);
+
+        bit_writer_t short_data{ };
+        short_data.fixed(raw, 0, raw.size() - 5, true);
+        CPNG_CHECK(decode(spec, short_data.finish(raw), out) == decode_error::invalid_idat_stream);
+    }
+
+    // Adam7 previews stop inside a fixed block and still see every block boundary before it
+    {
+        test::png_spec_t interlaced{ spec };
+        interlaced.interlace = 1;
+        const std::vector<uint8_t> passes{ test::scanlines(interlaced, samples) };
+
+        bit_writer_t w{ };
+        w.fixed(passes, 0, 9, false);
+        w.fixed(passes, 9, passes.size(), false);
+        w.stored({ }, true);
+        const std::vector<uint8_t> zlib{ w.finish(passes) };
+
+        for (const uint8_t pass_count: { uint8_t{ 1 }, uint8_t{ 3 }, uint8_t{ 7 } })
+        {
+            std::vector<uint8_t> fixed_out, stored_out;
+            CPNG_CHECK_OK(decode(interlaced, zlib, fixed_out, { .adam7_passes = pass_count }));
+            CPNG_CHECK_OK(decode(interlaced, test::zlib_stored(passes), stored_out, { .adam7_passes = pass_count }));
+            CPNG_CHECK(fixed_out == stored_out);
+        }
+
+        std::vector<uint8_t> out;
+        CPNG_CHECK_OK(decode(interlaced, zlib, out));
+        CPNG_CHECK(out == expected);
+    }
+
+    // Fixed-path errors: the check that failed, where, and how far the block got
+    {
+        struct failure_t
+        {
+            const char*     reason;
+            uint32_t        nine_bit_literals;  // before the bad code, to line it up with the stream end
+            uint32_t        block_index;
+        };
+        const std::array<failure_t, 9> failures{ {
+            { "invalid length code", 2, 0 },                                // length symbol 286
+            { "invalid length code", 2, 1 },                                // length symbol 287, second block
+            { "invalid or truncated distance code", 3, 0 },                 // distance symbol 30
+            { "invalid or truncated distance code", 3, 0 },                 // distance symbol 31
+            { "stream ends in length extra bits", 6, 0 },
+            { "stream ends in distance extra bits", 1, 0 },
+            { "distance reaches before the start of the output", 1, 0 },
+            { "invalid or truncated literal/length code", 0, 0 },           // a block header, then nothing
+            { "invalid or truncated literal/length code", 5, 0 },           // cut inside a literal
+        } };
+
+        for (size_t f{ 0 }; f < failures.size(); ++f)
+        {
+            const failure_t& k{ failures[f] };
+
+            bit_writer_t w{ };
+            if (k.block_index == 1) w.fixed(raw, 0, 0, false);  // an empty block before
+            w.bits(1, 1);
+            w.bits(1, 2);
+            for (uint32_t i{ 0 }; i < k.nine_bit_literals; ++i) w.symbol(200);
+
+            switch (f)
+            {
+                case 0: w.symbol(286); break;
+                case 1: w.symbol(287); break;
+                case 2: w.symbol(257); w.code(30, 5); break;
+                case 3: w.symbol(257); w.code(31, 5); break;
+                case 4: w.symbol(265); break;                       // 11 or 12 bytes: one extra bit
+                case 5: w.symbol(257); w.code(4, 5); break;         // distance 5 or 6: one extra bit
+                case 6: w.symbol(257); w.code(1, 5); break;         // distance 2 after one byte
+                case 8: w.code(0x190 >> 4, 5); break;               // first 5 of the 9 bits of literal 144
+                default: break;
+            }
+
+            // Where the reader stands when it fails: after the bad code, or at the end of the stream.
+            // A bad distance code is rejected before it is consumed.
+            const uint32_t failed_at{ w.bit_count - (f == 2 || f == 3 ? 5 : 0) };
+            std::vector<uint8_t> zlib{ w.out };
+            test::put_u32(zlib, 0);
+
+            decode_diagnostics_t diag{ };
+            std::vector<uint8_t> out;
+            CPNG_CHECK(decode(spec, zlib, out, { .diagnostics = &diag }) == decode_error::invalid_idat_stream);
+            CPNG_CHECK(diag.stage == decode_stage::inflate && std::string_view{ diag.reason } == k.reason);
+            CPNG_CHECK(diag.block_index == k.block_index && diag.symbol_index == k.nine_bit_literals);
+            CPNG_CHECK(diag.actual_size == k.nine_bit_literals && diag.expected_size == raw.size());
+
+            if (f < 7)
+                CPNG_CHECK(diag.byte_offset == 2 + failed_at / 8 && diag.bit_offset == failed_at % 8);
+        }
+    }
+
+    return test::finish("inflate");
+}
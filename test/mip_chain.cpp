@@ -0,0 +1,213 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Mip chains built while decoding: level sizes, 2×2 box filtering against a reference built from
+// level 0, linear light averaging, level counts, interlaced sources, hashes and rejected options.
+
+#include "test_support.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+using namespace cpng;
+
+namespace {
+    /// @brief Reference 2×2 box filter of one RGBA level: integer samples round half up.
+    template <typename T>
+    std::vector<T> box_filter(const std::vector<T>& src, const uint32_t w, const uint32_t h, const uint32_t dw,
+                              const uint32_t dh)
+    {
+        std::vector<T> dst(static_cast<size_t>(dw) * dh * 4);
+        const auto at = [&](const uint32_t x, const uint32_t y, const uint32_t c) {
+            return src[(static_cast<size_t>(std::min(y, h - 1)) * w + std::min(x, w - 1)) * 4 + c];
+        };
+        for (uint32_t y{ 0 }; y < dh; ++y)
+        {
+            for (uint32_t x{ 0 }; x < dw; ++x)
+            {
+                for (uint32_t c{ 0 }; c < 4; ++c)
+                {
+                    const uint32_t x1{ w > 1 ? 2 * x + 1 : 0 };
+                    const uint32_t y1{ h > 1 ? 2 * y + 1 : 0 };
+                    if constexpr (std::is_floating_point_v<T>)
+                        dst[(y * dw + x) * 4 + c] = (at(2 * x, 2 * y, c) + at(x1, 2 * y, c) + at(2 * x, y1, c) +
+                                                     at(x1, y1, c)) * 0.25f;
+                    else
+                        dst[(y * dw + x) * 4 + c] = static_cast<T>((at(2 * x, 2 * y, c) + at(x1, 2 * y, c) +
+                                                                    at(2 * x, y1, c) + at(x1, y1, c) + 2u) >> 2);
+                }
+            }
+        }
+        return dst;
+    }
+
+    template <typename T>
+    std::vector<T> samples_of(const image_view_t& view)
+    {
+        std::vector<T> out(view.pixels.size() / sizeof(T));
+        std::memcpy(out.data(), view.pixels.data(), view.pixels.size());
+        return out;
+    }
+
+    /// @brief Checks sizes, packing and every level against the reference filter of the level above.
+    template <typename T>
+    void check_chain(const std::vector<image_view_t>& levels, const uint32_t width, const uint32_t height,
+                     const uint32_t count)
+    {
+        if (!CPNG_CHECK(levels.size() == count)) return;
+
+        for (size_t i{ 1 }; i < levels.size(); ++i)
+        {
+            const image_view_t& src{ levels[i - 1] };
+            const image_view_t& dst{ levels[i] };
+            CPNG_CHECK(dst.width == std::max(1u, width >> i) && dst.height == std::max(1u, height >> i));
+            CPNG_CHECK(dst.stride_bytes == dst.width * sizeof(T) * 4);
+            CPNG_CHECK(dst.pixels.data() == src.pixels.data() + src.pixels.size()); // one allocation, in order
+
+            const std::vector<T> expected{ box_filter(samples_of<T>(src), src.width, src.height, dst.width,
+                                                      dst.height) };
+            const std::vector<T> actual{ samples_of<T>(dst) };
+            bool same{ expected.size() == actual.size() };
+            for (size_t k{ 0 }; same && k < actual.size(); ++k)
+            {
+                if constexpr (std::is_floating_point_v<T>) same = std::abs(actual[k] - expected[k]) < 1e-6f;
+                else same = actual[k] == expected[k];
+            }
+            CPNG_CHECK(same);
+        }
+    }
+
+    double srgb_to_linear(const double c)
+    {
+        return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    double linear_to_srgb(const double c)
+    {
+        return c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x031 };
+
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 6> sizes{ {
+        { 1, 1 }, { 1, 9 }, { 16, 16 }, { 37, 20 }, { 64, 3 }, { 33, 65 },
+    } };
+
+    for (const auto& [w, h]: sizes)
+    {
+        const test::png_spec_t spec{ .width = w, .height = h };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        const uint32_t full{ static_cast<uint32_t>(std::bit_width(std::max(w, h))) };
+
+        std::vector<image_view_t> levels;
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage));
+        CPNG_CHECK(!levels.empty() && test::equal_bytes(levels[0].pixels, test::expected_rgba8(spec, samples)));
+        check_chain<uint8_t>(levels, w, h, full);
+
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, { .format = pixel_format::rgba16 }));
+        check_chain<uint16_t>(levels, w, h, full);
+
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, { .format = pixel_format::rgba32f }));
+        check_chain<float>(levels, w, h, full);
+
+        // Level counts: 2 levels, and requests past the full chain are clamped
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, { .mip_levels = 2 }));
+        check_chain<uint8_t>(levels, w, h, std::min(2u, full));
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, { .mip_levels = 40 }));
+        CPNG_CHECK(levels.size() == full);
+
+        // An interlaced copy builds the same chain once its last pass is written
+        test::png_spec_t interlaced{ spec };
+        interlaced.interlace = 1;
+        std::vector<image_view_t> adam7_levels;
+        std::vector<uint8_t> adam7_storage;
+        CPNG_CHECK_OK(load_mip_chain_from_memory(test::make_png(interlaced, samples), adam7_levels, adam7_storage));
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage));
+        CPNG_CHECK(adam7_storage == storage);
+    }
+
+    // Linear light averaging of 8-bit color; alpha averages as stored
+    {
+        const test::png_spec_t spec{ .width = 24, .height = 10 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        std::vector<image_view_t> levels;
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_mip_chain_from_memory(test::make_png(spec, samples), levels, storage,
+                                                 { .mip_levels = 2, .mip_srgb_average = true }));
+
+        bool close{ levels.size() == 2 };
+        for (uint32_t y{ 0 }; close && y < 5; ++y)
+        {
+            for (uint32_t x{ 0 }; x < 12; ++x)
+            {
+                for (uint32_t c{ 0 }; c < 4; ++c)
+                {
+                    double sum{ 0.0 };
+                    for (const uint32_t i: { 0u, 1u, spec.width, spec.width + 1 })
+                    {
+                        const double v{ samples[((2 * y) * spec.width + 2 * x + i) * 4 + c] / 255.0 };
+                        sum += c == 3 ? v : srgb_to_linear(v);
+                    }
+                    const double expected{ (c == 3 ? sum / 4 : linear_to_srgb(sum / 4)) * 255.0 };
+                    close &= std::abs(levels[1].pixels[(y * 12 + x) * 4 + c] - expected) <= 1.0;
+                }
+            }
+        }
+        CPNG_CHECK(close);
+    }
+
+    // Hashes and statistics describe level 0
+    {
+        const test::png_spec_t spec{ .width = 20, .height = 12 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        const decode_options_t options{ .compute_stats = true, .compute_hashes = true };
+
+        image_view_t view{ };
+        std::vector<uint8_t> pixels;
+        CPNG_CHECK_OK(load_from_memory(png, view, pixels, options));
+
+        std::vector<image_view_t> levels;
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, options));
+        CPNG_CHECK(!levels.empty() && levels[0].pixel_hash == view.pixel_hash && view.pixel_hash != 0);
+        CPNG_CHECK(!levels.empty() && levels[0].source_hash == view.source_hash && view.source_hash != 0);
+        CPNG_CHECK(!levels.empty() && levels[0].stats.valid);
+    }
+
+    // Rejected combinations
+    {
+        const test::png_spec_t spec{ .width = 8, .height = 8 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        std::vector<image_view_t> levels;
+        std::vector<uint8_t> storage;
+        decode_diagnostics_t diagnostics{ };
+
+        CPNG_CHECK(load_mip_chain_from_memory(png, levels, storage, { .format = pixel_format::rgba16f }) ==
+                   decode_error::unsupported_output_format);
+        CPNG_CHECK(load_mip_chain_from_memory(png, levels, storage, { .format = pixel_format::rgba16,
+                                                                      .mip_srgb_average = true }) ==
+                   decode_error::unsupported_output_format);
+
+        // Linearized samples would be decoded from sRGB a second time by the averaging
+        decode_options_t twice{ .transform = color_transform::srgb_to_linear, .mip_srgb_average = true };
+        twice.diagnostics = &diagnostics;
+        CPNG_CHECK(load_mip_chain_from_memory(png, levels, storage, twice) == decode_error::unsupported_output_format);
+        CPNG_CHECK(diagnostics.error == decode_error::unsupported_output_format &&
+                   diagnostics.stage == decode_stage::validate);
+
+        // Linearizing alone is fine, averaged as stored
+        twice.mip_srgb_average = false;
+        CPNG_CHECK_OK(load_mip_chain_from_memory(png, levels, storage, twice));
+    }
+
+    return test::finish("mip_chain");
+}
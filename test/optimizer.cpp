@@ -0,0 +1,232 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Optimizer: unchanged pixels in 8 and 16-bit output, each lossless reduction (16 to 8 bit, gray,
+// low bit depths, opaque alpha, moved tRNS keys), the report, chunks kept and dropped, interlaced
+// input, output that does not depend on the thread count, and smaller files than the fast encoder.
+
+#include "test_support.h"
+
+#include "cpng/chunks.h"
+#include "cpng/encoder.h"
+#include "cpng/optimizer.h"
+
+using namespace cpng;
+
+namespace {
+    constexpr optimize_options_t k_quick{ .iterations = 2, .max_chain = 64 };
+
+    std::vector<uint8_t> decode(const std::vector<uint8_t>& png, const pixel_format format)
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = format }));
+        return { view.pixels.begin(), view.pixels.end() };
+    }
+
+    /// @brief Optimizes `png` and checks the pixels in RGBA8 and RGBA16 output.
+    std::vector<uint8_t> optimize(const std::vector<uint8_t>& png, optimize_report_t& report,
+                                  const optimize_options_t& options = k_quick)
+    {
+        std::vector<uint8_t> out;
+        if (!CPNG_CHECK_OK(optimize_png(png, out, report, options))) return out;
+        CPNG_CHECK(decode(out, pixel_format::rgba8) == decode(png, pixel_format::rgba8));
+        CPNG_CHECK(decode(out, pixel_format::rgba16) == decode(png, pixel_format::rgba16));
+        CPNG_CHECK(report.input_bytes == png.size() && report.output_bytes == out.size());
+        return out;
+    }
+
+    std::vector<png_chunk_t> chunks_of(const std::vector<uint8_t>& png)
+    {
+        std::vector<png_chunk_t> out;
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        while (reader.next(chunk)) out.push_back(chunk);
+        return out;
+    }
+
+    bool has_chunk(const std::vector<uint8_t>& png, const uint32_t type)
+    {
+        for (const png_chunk_t& chunk: chunks_of(png))
+            if (chunk.type == type) return true;
+        return false;
+    }
+
+    ihdr_info_t header_of(const std::vector<uint8_t>& png)
+    {
+        ihdr_info_t ihdr{ };
+        CPNG_CHECK_OK(read_ihdr_from_memory(png, ihdr));
+        return ihdr;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x043 };
+
+    // Full color noise has nothing to reduce
+    {
+        const test::png_spec_t spec{ .width = 23, .height = 17 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        optimize_report_t report{ };
+        const std::vector<uint8_t> out{ optimize(png, report) };
+        CPNG_CHECK(report.color_type == 6 && report.bit_depth == 8);
+        CPNG_CHECK(header_of(out).color_type == 6 && header_of(out).bit_depth == 8);
+    }
+
+    // Reductions
+    {
+        struct case_t
+        {
+            test::png_spec_t    spec;
+            uint8_t             color_type;     // expected after reduction
+            uint8_t             bit_depth;
+        };
+        const std::array<case_t, 7> cases{ {
+            { { .width = 20, .height = 9, .bit_depth = 16, .color_type = 6 }, 6, 8 },   // v * 257
+            { { .width = 20, .height = 9, .color_type = 2 }, 0, 8 },                    // gray RGB
+            { { .width = 20, .height = 9, .color_type = 6 }, 2, 8 },                    // opaque
+            { { .width = 20, .height = 9, .color_type = 6 }, 4, 8 },                    // gray with alpha
+            { { .width = 20, .height = 9, .color_type = 0 }, 0, 1 },                    // black and white
+            { { .width = 20, .height = 9, .color_type = 0 }, 0, 2 },                    // four levels
+            { { .width = 20, .height = 9, .color_type = 0 }, 0, 4 },                    // sixteen levels
+        } };
+
+        for (size_t c{ 0 }; c < cases.size(); ++c)
+        {
+            const case_t& k{ cases[c] };
+            const uint32_t channels{ test::channel_count(k.spec.color_type) };
+            std::vector<uint16_t> samples{ test::random_samples(k.spec, rng) };
+            for (size_t i{ 0 }; i < samples.size(); i += channels)
+            {
+                uint16_t* p{ samples.data() + i };
+                switch (c)
+                {
+                    case 0: for (uint32_t j{ 0 }; j < 4; ++j) p[j] = static_cast<uint16_t>((p[j] >> 8) * 257); break;
+                    case 1: p[1] = p[2] = p[0]; break;
+                    case 2: p[3] = 255; break;
+                    case 3: p[1] = p[2] = p[0]; break;
+                    case 4: p[0] = p[0] & 1 ? 255 : 0; break;
+                    case 5: p[0] = static_cast<uint16_t>(p[0] % 4 * 85); break;
+                    case 6: p[0] = static_cast<uint16_t>(p[0] % 16 * 17); break;
+                    default: break;
+                }
+            }
+
+            const std::vector<uint8_t> png{ test::make_png(k.spec, samples) };
+            optimize_report_t report{ };
+            const std::vector<uint8_t> out{ optimize(png, report) };
+            CPNG_CHECK(report.color_type == k.color_type && report.bit_depth == k.bit_depth);
+            CPNG_CHECK(header_of(out).color_type == k.color_type && header_of(out).bit_depth == k.bit_depth);
+
+            // Without reduction the layout stays
+            const std::vector<uint8_t> kept{ optimize(png, report, { .iterations = 1, .max_chain = 64,
+                                                                     .reduce = false }) };
+            const ihdr_info_t kept_ihdr{ header_of(kept) };
+            CPNG_CHECK(kept_ihdr.color_type == k.spec.color_type && kept_ihdr.bit_depth == k.spec.bit_depth);
+        }
+
+        // One sample that is not v * 257 keeps 16 bits
+        const test::png_spec_t spec{ .width = 8, .height = 8, .bit_depth = 16, .color_type = 0 };
+        std::vector<uint16_t> samples(64, 0x4242);
+        samples[37] = 0x4243;
+        optimize_report_t report{ };
+        static_cast<void>(optimize(test::make_png(spec, samples), report));
+        CPNG_CHECK(report.color_type == 0 && report.bit_depth == 16);
+    }
+
+    // A tRNS color key moves with the reduction
+    {
+        const test::png_spec_t spec{ .width = 16, .height = 16, .color_type = 2 };
+        std::vector<uint16_t> samples(size_t{ 16 } * 16 * 3);
+        for (size_t i{ 0 }; i < samples.size(); i += 3) samples[i] = samples[i + 1] = samples[i + 2] = i / 3 % 4 * 85;
+        const std::vector<uint8_t> png{ test::make_png(spec, test::zlib_stored(test::scanlines(spec, samples)),
+                                                       { { "tRNS", { 0, 85, 0, 85, 0, 85 } } }) };
+
+        optimize_report_t report{ };
+        const std::vector<uint8_t> out{ optimize(png, report) };
+        CPNG_CHECK(report.color_type == 0 && report.bit_depth == 2);
+
+        // 85 is level 1 of 2-bit gray
+        std::vector<uint8_t> key;
+        for (const png_chunk_t& chunk: chunks_of(out))
+            if (chunk.type == chunk_type("tRNS")) key.assign(chunk.data.begin(), chunk.data.end());
+        CPNG_CHECK((key == std::vector<uint8_t>{ 0, 1 }));
+
+        // A key between the levels matched no pixel, and is not carried over
+        const std::vector<uint8_t> between{ test::make_png(spec, test::zlib_stored(test::scanlines(spec, samples)),
+                                                           { { "tRNS", { 0, 86, 0, 86, 0, 86 } } }) };
+        CPNG_CHECK(!has_chunk(optimize(between, report), chunk_type("tRNS")));
+    }
+
+    // Chunks: color space kept, other ancillary chunks dropped unless asked for
+    {
+        const test::png_spec_t spec{ .width = 12, .height = 12 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::zlib_stored(test::scanlines(spec,
+                                                       test::random_samples(spec, rng))), {
+            { "sRGB", { 0 } },
+            { "gAMA", { 0, 0, 0xB1, 0x8F } },
+            { "tEXt", { 'k', 0, 'v' } },
+            { "eNGn", { 1, 2, 3 } },
+            { "bKGD", { 0, 1, 0, 2, 0, 3 } },
+        }, 50) };
+
+        optimize_report_t report{ };
+        std::vector<uint8_t> out{ optimize(png, report) };
+        CPNG_CHECK(has_chunk(out, chunk_type("sRGB")) && has_chunk(out, chunk_type("gAMA")));
+        CPNG_CHECK(!has_chunk(out, chunk_type("tEXt")) && !has_chunk(out, chunk_type("eNGn")));
+        CPNG_CHECK(!has_chunk(out, chunk_type("bKGD")) && report.chunks_removed == 3);
+
+        const uint32_t keep[]{ chunk_type("eNGn"), chunk_type("bKGD") };
+        out = optimize(png, report, { .iterations = 1, .max_chain = 64, .keep_color_chunks = false,
+                                      .keep_chunks = keep });
+        CPNG_CHECK(!has_chunk(out, chunk_type("sRGB")) && !has_chunk(out, chunk_type("gAMA")));
+        CPNG_CHECK(has_chunk(out, chunk_type("eNGn")) && !has_chunk(out, chunk_type("bKGD")));
+        CPNG_CHECK(report.chunks_removed == 4);
+
+        // One IDAT, right after the kept chunks
+        size_t idats{ 0 };
+        for (const png_chunk_t& chunk: chunks_of(out)) idats += chunk.type == chunk_type("IDAT");
+        CPNG_CHECK(idats == 1);
+    }
+
+    // Interlaced input comes out progressive
+    {
+        test::png_spec_t spec{ .width = 31, .height = 19, .interlace = 1 };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        optimize_report_t report{ };
+        const std::vector<uint8_t> out{ optimize(png, report) };
+        CPNG_CHECK(header_of(out).interlace_method == 0);
+    }
+
+    // Thread count does not change the output; the result beats the fast encoder
+    {
+        const uint32_t width{ 96 }, height{ 64 };
+        std::vector<uint8_t> rgba(size_t{ width } * height * 4);
+        for (size_t i{ 0 }; i < rgba.size(); ++i)
+            rgba[i] = static_cast<uint8_t>(i % 4 == 3 ? 200 + i / 4 % 3 : (i / 4 % width) + (i / 4 / width) * 2);
+
+        std::vector<uint8_t> fast;
+        CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rgba, .is_srgb = false }, fast));
+
+        optimize_report_t report{ };
+        const std::vector<uint8_t> serial{ optimize(fast, report) };
+        const std::vector<uint8_t> parallel{ optimize(fast, report, { .iterations = 2, .max_chain = 64,
+                                                                      .worker_threads = 4 }) };
+        CPNG_CHECK(serial == parallel && serial.size() < fast.size());
+    }
+
+    // Input errors are those of the decoder
+    {
+        const test::png_spec_t spec{ .width = 4, .height = 4 };
+        std::vector<uint8_t> png{ test::make_png(spec, test::random_samples(spec, rng)) };
+        png[29] ^= 1;
+        std::vector<uint8_t> out{ 1 };
+        optimize_report_t report{ };
+        CPNG_CHECK(optimize_png(png, out, report) == decode_error::crc_mismatch && out.empty());
+    }
+
+    return test::finish("optimizer");
+}
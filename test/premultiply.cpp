@@ -0,0 +1,145 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Alpha premultiplication during row emission: exact rounding for every 8-bit (color, alpha)
+// pair and for 16-bit samples, float premultiplication after linearization, and no-ops for
+// layouts without alpha.
+
+#include "test_support.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace cpng;
+
+namespace {
+    constexpr uint32_t mul_div(const uint64_t x, const uint64_t a, const uint64_t max) noexcept
+    {
+        // round(x * a / max); x * a / max is never exactly n + 0.5
+        return static_cast<uint32_t>((2 * x * a + max) / (2 * max));
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x030 };
+    const decode_options_t premultiply{ .premultiply_alpha = true };
+
+    // Every (color, alpha) pair: column x is the color, row y the alpha
+    {
+        const test::png_spec_t spec{ .width = 256, .height = 256 };
+        std::vector<uint16_t> samples(256 * 256 * 4);
+        for (uint32_t a{ 0 }; a < 256; ++a)
+        {
+            for (uint32_t x{ 0 }; x < 256; ++x)
+            {
+                uint16_t* p{ samples.data() + (a * 256 + x) * 4 };
+                p[0] = static_cast<uint16_t>(x);
+                p[1] = static_cast<uint16_t>(255 - x);
+                p[2] = static_cast<uint16_t>(x ^ a);
+                p[3] = static_cast<uint16_t>(a);
+            }
+        }
+
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, premultiply));
+        bool exact{ storage.size() == samples.size() };
+        for (size_t i{ 0 }; exact && i < samples.size(); i += 4)
+        {
+            for (size_t c{ 0 }; c < 3; ++c) exact &= storage[i + c] == mul_div(samples[i + c], samples[i + 3], 255);
+            exact &= storage[i + 3] == samples[i + 3];
+        }
+        CPNG_CHECK(exact);
+    }
+
+    // Gray + alpha into RG8 and RGBA8; widths not a multiple of the SIMD step
+    {
+        const test::png_spec_t spec{ .width = 37, .height = 5, .color_type = 4 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        image_view_t view{ };
+        std::vector<uint8_t> rg;
+        std::vector<uint8_t> rgba;
+        decode_options_t options{ premultiply };
+        options.format = pixel_format::rg8;
+        CPNG_CHECK_OK(load_from_memory(png, view, rg, options));
+        CPNG_CHECK_OK(load_from_memory(png, view, rgba, premultiply));
+
+        bool exact{ rg.size() == samples.size() && rgba.size() == samples.size() * 2 };
+        for (size_t i{ 0 }; exact && i < samples.size() / 2; ++i)
+        {
+            const uint32_t g{ mul_div(samples[i * 2], samples[i * 2 + 1], 255) };
+            exact &= rg[i * 2] == g && rg[i * 2 + 1] == samples[i * 2 + 1];
+            exact &= rgba[i * 4] == g && rgba[i * 4 + 1] == g && rgba[i * 4 + 2] == g;
+        }
+        CPNG_CHECK(exact);
+    }
+
+    // 16-bit: round(x * a / 65535)
+    {
+        const test::png_spec_t spec{ .width = 23, .height = 7, .bit_depth = 16 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        decode_options_t options{ premultiply };
+        options.format = pixel_format::rgba16;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, options));
+
+        std::vector<uint16_t> out(storage.size() / 2);
+        std::memcpy(out.data(), storage.data(), storage.size());
+        bool exact{ out.size() == samples.size() };
+        for (size_t i{ 0 }; exact && i < out.size(); ++i)
+        {
+            const uint32_t a{ samples[i | 3] };
+            exact &= out[i] == (i % 4 == 3 ? a : mul_div(samples[i], a, 65535));
+        }
+        CPNG_CHECK(exact);
+    }
+
+    // Float output multiplies in linear space, after the transfer function
+    {
+        const test::png_spec_t spec{ .width = 9, .height = 9 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        image_view_t view{ };
+        std::vector<uint8_t> straight;
+        std::vector<uint8_t> multiplied;
+        decode_options_t options{ .format = pixel_format::rgba32f, .transform = color_transform::srgb_to_linear };
+        CPNG_CHECK_OK(load_from_memory(png, view, straight, options));
+        options.premultiply_alpha = true;
+        CPNG_CHECK_OK(load_from_memory(png, view, multiplied, options));
+
+        std::vector<float> s(straight.size() / 4);
+        std::vector<float> m(multiplied.size() / 4);
+        std::memcpy(s.data(), straight.data(), straight.size());
+        std::memcpy(m.data(), multiplied.data(), multiplied.size());
+        bool close{ s.size() == m.size() };
+        for (size_t i{ 0 }; close && i < s.size(); ++i)
+            close = std::abs(m[i] - (i % 4 == 3 ? s[i] : s[i] * s[i | 3])) < 1e-6f;
+        CPNG_CHECK(close);
+    }
+
+    // No alpha channel, or no alpha in the output: nothing to multiply
+    {
+        const test::png_spec_t rgb{ .width = 11, .height = 3, .color_type = 2 };
+        const std::vector<uint16_t> rgb_samples{ test::random_samples(rgb, rng) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(rgb, rgb_samples), view, storage, premultiply));
+        CPNG_CHECK(storage == test::expected_rgba8(rgb, rgb_samples));
+
+        const test::png_spec_t gray_alpha{ .width = 11, .height = 3, .color_type = 4 };
+        const std::vector<uint16_t> ga_samples{ test::random_samples(gray_alpha, rng) };
+        decode_options_t options{ premultiply };
+        options.format = pixel_format::r8;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(gray_alpha, ga_samples), view, storage, options));
+        bool untouched{ storage.size() == ga_samples.size() / 2 };
+        for (size_t i{ 0 }; untouched && i < storage.size(); ++i) untouched = storage[i] == ga_samples[i * 2];
+        CPNG_CHECK(untouched);
+    }
+
+    return test::finish("premultiply");
+}
@@ -0,0 +1,199 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Re-encoding and the decode speed profile: unchanged pixels and chunks for every color type and
+// bit depth, stale stripe indexes dropped, Adam7 files written progressive, and decode_speed output
+// in one IDAT, within its size budget and cheaper to decode than a deliberately slow encoding.
+
+#include "test_support.h"
+
+#include "cpng/chunks.h"
+#include "cpng/decode_cost.h"
+#include "cpng/encoder.h"
+
+using namespace cpng;
+
+namespace {
+    std::vector<uint8_t> decode(const std::vector<uint8_t>& png, const pixel_format format)
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = format }));
+        return { view.pixels.begin(), view.pixels.end() };
+    }
+
+    std::vector<png_chunk_t> chunks_of(const std::vector<uint8_t>& png)
+    {
+        std::vector<png_chunk_t> out;
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        while (reader.next(chunk)) out.push_back(chunk);
+        return out;
+    }
+
+    /// @brief Every chunk but IDAT and the stripe index, as raw bytes with length, type and CRC.
+    std::vector<std::vector<uint8_t>> framed_chunks(const std::vector<uint8_t>& png)
+    {
+        std::vector<std::vector<uint8_t>> out;
+        for (const png_chunk_t& chunk: chunks_of(png))
+        {
+            if (chunk.type == chunk_type("IDAT") || chunk.type == k_stripe_index_chunk) continue;
+            const auto begin{ png.begin() + static_cast<ptrdiff_t>(chunk.offset) };
+            out.emplace_back(begin, begin + static_cast<ptrdiff_t>(12 + chunk.data.size()));
+        }
+        return out;
+    }
+
+    uint32_t count_chunks(const std::vector<uint8_t>& png, const uint32_t type)
+    {
+        uint32_t n{ 0 };
+        for (const png_chunk_t& chunk: chunks_of(png)) n += chunk.type == type;
+        return n;
+    }
+
+    uint64_t predicted_ns(const std::vector<uint8_t>& png)
+    {
+        decode_cost_t cost{ };
+        CPNG_CHECK_OK(estimate_decode_cost(png, cost));
+        return cost.predicted_ns;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x044 };
+
+    const std::vector<test::extra_chunk_t> extra{
+        { "gAMA", { 0, 0, 0xB1, 0x8F } },
+        { "tEXt", { 'k', 0, 'v' } },
+        { "eNGn", { 1, 2, 3 } },
+    };
+
+    struct format_t
+    {
+        uint8_t     color_type;
+        uint8_t     bit_depth;
+    };
+    const std::array<format_t, 11> formats{ {
+        { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 }, { 2, 8 }, { 2, 16 },
+        { 4, 8 }, { 4, 16 }, { 6, 8 }, { 6, 16 },
+    } };
+
+    // Pixels and every other chunk stay; the image data is rewritten with the given options
+    for (const format_t& f: formats)
+    {
+        const test::png_spec_t spec{ .width = 29, .height = 13, .bit_depth = f.bit_depth, .color_type = f.color_type };
+        const std::vector<uint8_t> png{ test::make_png(spec, test::zlib_stored(test::scanlines(spec,
+                                                       test::random_samples(spec, rng))), extra, 60) };
+
+        std::vector<uint8_t> out{ 1, 2, 3 };
+        if (!CPNG_CHECK_OK(reencode(png, out, { .filter = encode_filter::adaptive }))) continue;
+        CPNG_CHECK(decode(out, pixel_format::rgba16) == decode(png, pixel_format::rgba16));
+        CPNG_CHECK(framed_chunks(out) == framed_chunks(png));
+        CPNG_CHECK(count_chunks(out, chunk_type("IDAT")) == 1 && out.size() < png.size());
+
+        // Gray sources also keep their one and two channel output
+        if (f.color_type == 0) CPNG_CHECK(decode(out, pixel_format::r8) == decode(png, pixel_format::r8));
+    }
+
+    // A stale stripe index is dropped; a striped re-encode writes a fresh one
+    {
+        const uint32_t width{ 40 }, height{ 60 };
+        std::vector<uint8_t> rgba(size_t{ width } * height * 4);
+        for (size_t i{ 0 }; i < rgba.size(); ++i) rgba[i] = static_cast<uint8_t>(i * 3 + rng.below(4));
+
+        std::vector<uint8_t> striped;
+        CPNG_CHECK_OK(encode({ .width = width, .height = height, .pixels = rgba }, striped, { .stripe_rows = 7 }));
+        CPNG_CHECK(count_chunks(striped, k_stripe_index_chunk) == 1);
+
+        std::vector<uint8_t> plain, restriped;
+        CPNG_CHECK_OK(reencode(striped, plain));
+        CPNG_CHECK(count_chunks(plain, k_stripe_index_chunk) == 0 && decode(plain, pixel_format::rgba8) == rgba);
+
+        CPNG_CHECK_OK(reencode(striped, restriped, { .worker_threads = 2, .stripe_rows = 20 }));
+        CPNG_CHECK(decode(restriped, pixel_format::rgba8) == rgba);
+
+        std::vector<stripe_index_entry_t> stripes;
+        for (const png_chunk_t& chunk: chunks_of(restriped))
+            if (chunk.type == k_stripe_index_chunk) CPNG_CHECK_OK(read_stripe_index(chunk, stripes));
+        CPNG_CHECK(stripes.size() == 3 && stripes[1].first_row == 20 && stripes[2].first_row == 40);
+    }
+
+    // Adam7 files come out progressive: the same bytes as re-encoding the progressive file
+    for (const format_t& f: formats)
+    {
+        for (const auto& [width, height]: { std::pair{ 1u, 1u }, std::pair{ 3u, 2u }, std::pair{ 9u, 9u },
+                                            std::pair{ 37u, 21u } })
+        {
+            test::png_spec_t spec{ .width = width, .height = height, .bit_depth = f.bit_depth,
+                                   .color_type = f.color_type };
+            const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+            const std::vector<uint8_t> progressive{ test::make_png(spec, samples, extra) };
+            spec.interlace = 1;
+            const std::vector<uint8_t> interlaced{ test::make_png(spec, samples, extra) };
+
+            std::vector<uint8_t> a, b;
+            CPNG_CHECK_OK(reencode(progressive, a, { .filter = encode_filter::paeth }));
+            if (!CPNG_CHECK_OK(reencode(interlaced, b, { .filter = encode_filter::paeth }))) continue;
+            CPNG_CHECK(a == b);
+
+            ihdr_info_t ihdr{ };
+            CPNG_CHECK_OK(read_ihdr_from_memory(b, ihdr));
+            CPNG_CHECK(ihdr.interlace_method == 0 && ihdr.bit_depth == f.bit_depth && ihdr.color_type == f.color_type);
+            CPNG_CHECK(decode(b, pixel_format::rgba16) == decode(interlaced, pixel_format::rgba16));
+        }
+    }
+
+    // A broken Adam7 stream fails like the decoder does
+    {
+        const test::png_spec_t spec{ .width = 16, .height = 16, .interlace = 1 };
+        std::vector<uint8_t> raw{ test::scanlines(spec, test::random_samples(spec, rng)) };
+        raw[0] = 5;     // filter type of the first pass row
+        std::vector<uint8_t> out;
+        CPNG_CHECK(reencode(test::make_png(spec, test::zlib_stored(raw)), out) != decode_error::ok);
+
+        raw.pop_back();
+        CPNG_CHECK(reencode(test::make_png(spec, test::zlib_stored(raw)), out) != decode_error::ok);
+    }
+
+    // decode_speed: one IDAT, unchanged pixels, within budget, cheaper to decode
+    {
+        const uint32_t width{ 160 }, height{ 120 };
+        std::vector<uint8_t> rgba(size_t{ width } * height * 4);
+        for (size_t i{ 0 }; i < rgba.size(); ++i)
+        {
+            const size_t x{ i / 4 % width }, y{ i / 4 / width };
+            rgba[i] = static_cast<uint8_t>(i % 4 == 3 ? 255 : x * (i % 4 + 1) + y * 2 + rng.below(3));
+        }
+        const image_view_t image{ .width = width, .height = height, .pixels = rgba };
+
+        std::vector<uint8_t> fast, slow, smallest;
+        CPNG_CHECK_OK(encode(image, fast, { .profile = encode_profile::decode_speed, .max_idat_bytes = 100 }));
+        CPNG_CHECK_OK(encode(image, slow, { .filter = encode_filter::paeth, .block_tokens = 256,
+                                            .max_idat_bytes = 1024 }));
+        CPNG_CHECK_OK(encode(image, smallest, { .filter = encode_filter::adaptive }));
+
+        CPNG_CHECK(decode(fast, pixel_format::rgba8) == rgba && count_chunks(fast, chunk_type("IDAT")) == 1);
+        CPNG_CHECK(static_cast<double>(fast.size()) <= static_cast<double>(smallest.size()) * 1.03);
+        CPNG_CHECK(predicted_ns(fast) < predicted_ns(slow));
+
+        decode_cost_t fast_cost{ }, slow_cost{ };
+        CPNG_CHECK_OK(estimate_decode_cost(fast, fast_cost));
+        CPNG_CHECK_OK(estimate_decode_cost(slow, slow_cost));
+        CPNG_CHECK(fast_cost.dynamic_blocks < slow_cost.dynamic_blocks && fast_cost.idat_chunks == 1);
+
+        // A zero budget still stays no larger than the smallest candidate
+        std::vector<uint8_t> tight;
+        CPNG_CHECK_OK(encode(image, tight, { .profile = encode_profile::decode_speed, .size_budget = 0.0f }));
+        CPNG_CHECK(tight.size() <= smallest.size() && decode(tight, pixel_format::rgba8) == rgba);
+
+        // Re-encoding applies the profile to an existing file
+        std::vector<uint8_t> rewritten;
+        CPNG_CHECK_OK(reencode(slow, rewritten, { .profile = encode_profile::decode_speed }));
+        CPNG_CHECK(rewritten == fast);
+    }
+
+    return test::finish("reencode");
+}
@@ -0,0 +1,203 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Striped encodes: the same pixels and the same bytes for any thread count, the stripe index
+// chunk before the image data, every stripe a self-contained deflate run whose Adler-32 matches
+// the index, stripes split across IDAT limits, and single-stripe encodes without an index.
+
+#include "test_support.h"
+
+#include "cpng/chunks.h"
+#include "cpng/encoder.h"
+
+using namespace cpng;
+
+namespace {
+    struct parsed_t
+    {
+        std::vector<png_chunk_t>            chunks;
+        std::vector<uint8_t>                zlib;       // IDAT payloads joined
+        std::vector<stripe_index_entry_t>   stripes;
+        bool                                has_index{ false };
+        bool                                index_before_idat{ false };
+    };
+
+    parsed_t parse(const std::vector<uint8_t>& png)
+    {
+        parsed_t out{ };
+        chunk_reader_t reader{ png };
+        png_chunk_t chunk{ };
+        while (reader.next(chunk))
+        {
+            out.chunks.push_back(chunk);
+            if (chunk.type == chunk_type("IDAT")) out.zlib.insert(out.zlib.end(), chunk.data.begin(), chunk.data.end());
+            if (chunk.type == k_stripe_index_chunk)
+            {
+                out.has_index = read_stripe_index(chunk, out.stripes) == decode_error::ok;
+                out.index_before_idat = out.zlib.empty();
+            }
+        }
+        return out;
+    }
+
+    bool decodes_to(const std::vector<uint8_t>& png, const std::vector<uint8_t>& rgba)
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        return load_from_memory(png, view, storage) == decode_error::ok && test::equal_bytes(view.pixels, rgba);
+    }
+
+    /**
+     * Decodes stripe `i` on its own: its deflate bytes behind a fresh zlib header, closed by an
+     * empty final stored block when the stripe is not the last, with the Adler-32 from the index.
+     * Inflating fails if the stripe reaches back into earlier stripes or its sum disagrees.
+     */
+    decode_error decode_stripe(const parsed_t& parsed, const size_t i, const uint32_t width, const uint32_t height,
+                               image_view_t& out_view, std::vector<uint8_t>& storage)
+    {
+        const bool last{ i + 1 == parsed.stripes.size() };
+        const size_t begin{ static_cast<size_t>(parsed.stripes[i].zlib_offset) };
+        const size_t end{ last ? parsed.zlib.size() - 4 : static_cast<size_t>(parsed.stripes[i + 1].zlib_offset) };
+
+        std::vector<uint8_t> zlib{ 0x78, 0x01 };
+        zlib.insert(zlib.end(), parsed.zlib.begin() + static_cast<ptrdiff_t>(begin),
+                    parsed.zlib.begin() + static_cast<ptrdiff_t>(end));
+        if (!last) zlib.insert(zlib.end(), { 0x01, 0x00, 0x00, 0xFF, 0xFF });
+        test::put_u32(zlib, parsed.stripes[i].adler);
+
+        const uint32_t rows{ (last ? height : parsed.stripes[i + 1].first_row) - parsed.stripes[i].first_row };
+        return load_from_memory(test::make_png({ .width = width, .height = rows }, zlib), out_view, storage);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x042 };
+
+    const uint32_t width{ 97 }, height{ 150 };
+    std::vector<uint8_t> rgba(size_t{ width } * height * 4);
+    for (size_t i{ 0 }; i < rgba.size(); ++i)
+        rgba[i] = static_cast<uint8_t>(i % 4 == 3 ? 255 : (i / 4 % width) * 2 + (i / 4 / width) + rng.below(8));
+    const image_view_t image{ .width = width, .height = height, .pixels = rgba };
+
+    // Output depends on the stripe layout only
+    for (const uint32_t stripe_rows: { 1u, 7u, 32u, 149u })
+    {
+        std::vector<uint8_t> serial, parallel, automatic;
+        CPNG_CHECK_OK(encode(image, serial, { .stripe_rows = stripe_rows }));
+        CPNG_CHECK_OK(encode(image, parallel, { .worker_threads = 4, .stripe_rows = stripe_rows }));
+        CPNG_CHECK_OK(encode(image, automatic, { .worker_threads = 0, .stripe_rows = stripe_rows }));
+        CPNG_CHECK(serial == parallel && serial == automatic && decodes_to(serial, rgba));
+
+        const parsed_t parsed{ parse(serial) };
+        if (!CPNG_CHECK(parsed.has_index && parsed.index_before_idat)) continue;
+
+        const uint32_t count{ (height + stripe_rows - 1) / stripe_rows };
+        bool layout{ parsed.stripes.size() == count && parsed.stripes[0].zlib_offset == 2 };
+        for (uint32_t i{ 0 }; layout && i < count; ++i) layout &= parsed.stripes[i].first_row == i * stripe_rows;
+        CPNG_CHECK(layout);
+
+        // The index chunk is ancillary, private and unsafe to copy
+        bool flags{ true };
+        for (const png_chunk_t& chunk: parsed.chunks)
+        {
+            if (chunk.type != k_stripe_index_chunk) continue;
+            flags &= !chunk.is_critical() && chunk.name()[1] >= 'a' && chunk.name()[3] >= 'A' && chunk.name()[3] <= 'Z';
+            flags &= chunk.crc_ok();
+        }
+        CPNG_CHECK(flags);
+    }
+
+    // Every stripe inflates on its own, and with Sub filtering decodes to its own rows
+    for (const encode_filter filter: { encode_filter::sub, encode_filter::paeth, encode_filter::adaptive })
+    {
+        for (const compression_mode mode: { compression_mode::fast, compression_mode::stored })
+        {
+            std::vector<uint8_t> png;
+            CPNG_CHECK_OK(encode(image, png, { .mode = mode, .filter = filter, .worker_threads = 3,
+                                               .stripe_rows = 20 }));
+            CPNG_CHECK(decodes_to(png, rgba));
+
+            const parsed_t parsed{ parse(png) };
+            bool independent{ parsed.has_index && parsed.stripes.size() == 8 };
+            for (size_t i{ 0 }; independent && i < parsed.stripes.size(); ++i)
+            {
+                image_view_t view{ };
+                std::vector<uint8_t> storage;
+                independent &= decode_stripe(parsed, i, width, height, view, storage) == decode_error::ok;
+
+                // Rows that only look left come out the same without the previous stripe
+                const size_t first{ size_t{ parsed.stripes[i].first_row } * width * 4 };
+                if (independent && filter == encode_filter::sub)
+                    independent &= std::equal(view.pixels.begin(), view.pixels.end(),
+                                              rgba.begin() + static_cast<ptrdiff_t>(first));
+            }
+            CPNG_CHECK(independent);
+        }
+    }
+
+    // IDAT limits cut through stripes without moving their offsets
+    for (const uint32_t max_idat_bytes: { 1u, 100u, 4096u })
+    {
+        std::vector<uint8_t> whole, split;
+        CPNG_CHECK_OK(encode(image, whole, { .worker_threads = 2, .stripe_rows = 16 }));
+        CPNG_CHECK_OK(encode(image, split, { .max_idat_bytes = max_idat_bytes, .worker_threads = 2,
+                                             .stripe_rows = 16 }));
+        CPNG_CHECK(decodes_to(split, rgba));
+
+        const parsed_t a{ parse(whole) }, b{ parse(split) };
+        bool same{ a.zlib == b.zlib && a.stripes.size() == b.stripes.size() && b.index_before_idat };
+        for (size_t i{ 0 }; same && i < a.stripes.size(); ++i)
+            same &= a.stripes[i].zlib_offset == b.stripes[i].zlib_offset && a.stripes[i].adler == b.stripes[i].adler;
+
+        size_t idats{ 0 };
+        for (const png_chunk_t& chunk: b.chunks)
+        {
+            if (chunk.type != chunk_type("IDAT")) continue;
+            same &= chunk.data.size() <= max_idat_bytes;
+            ++idats;
+        }
+        CPNG_CHECK(same && idats == (b.zlib.size() + max_idat_bytes - 1) / max_idat_bytes);
+    }
+
+    // A single stripe is a plain stream without an index
+    {
+        std::vector<uint8_t> plain, one_stripe, threaded_small;
+        CPNG_CHECK_OK(encode(image, plain));
+        CPNG_CHECK_OK(encode(image, one_stripe, { .stripe_rows = height }));
+        CPNG_CHECK_OK(encode(image, threaded_small, { .worker_threads = 4 }));   // under the automatic stripe size
+        CPNG_CHECK(plain == one_stripe && plain == threaded_small && !parse(plain).has_index);
+
+        bool indexed{ false };
+        for (const png_chunk_t& chunk: parse(plain).chunks) indexed |= chunk.type == k_stripe_index_chunk;
+        CPNG_CHECK(!indexed);
+    }
+
+    // Striping costs little size
+    {
+        std::vector<uint8_t> plain, striped;
+        CPNG_CHECK_OK(encode(image, plain));
+        CPNG_CHECK_OK(encode(image, striped, { .stripe_rows = 50 }));
+        CPNG_CHECK(striped.size() < plain.size() + plain.size() / 20);
+    }
+
+    // Large enough for automatic stripes
+    {
+        const uint32_t big_width{ 1024 }, big_height{ 600 };
+        std::vector<uint8_t> big(size_t{ big_width } * big_height * 4);
+        for (size_t i{ 0 }; i < big.size(); ++i) big[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12));
+        const image_view_t big_image{ .width = big_width, .height = big_height, .pixels = big };
+
+        std::vector<uint8_t> serial, parallel;
+        CPNG_CHECK_OK(encode(big_image, serial, { .worker_threads = 2 }));
+        CPNG_CHECK_OK(encode(big_image, parallel, { .worker_threads = 0 }));
+        CPNG_CHECK(serial == parallel && decodes_to(serial, big));
+
+        const parsed_t parsed{ parse(serial) };
+        CPNG_CHECK(parsed.has_index && parsed.stripes.size() == 3);
+    }
+
+    return test::finish("striped_encode");
+}
@@ -0,0 +1,359 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+/**
+ * @file test_support.h
+ * @brief Check macros and a reference PNG writer shared by the behavior tests.
+ *
+ * The writer is independent of the library's encoder: it packs samples with the
+ * textbook filters (one filter type per row, cycling None..Paeth), stores them in
+ * uncompressed deflate blocks and frames the result with its own CRC and Adler-32,
+ * so a decode test never checks the decoder against code it shares.
+ */
+
+#pragma once
+
+#include <cpng/CarrotPNG.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <print>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#define CPNG_CHECK(expr) ::cpng::test::check(static_cast<bool>(expr), #expr)
+#define CPNG_CHECK_OK(expr) ::cpng::test::check_ok((expr), #expr)
+
+namespace cpng::test {
+    inline int checks{ 0 };
+    inline int failures{ 0 };
+
+    inline bool check(const bool ok, const char* expr,
+                      const std::source_location where = std::source_location::current()) noexcept
+    {
+        ++checks;
+        if (!ok)
+        {
+            ++failures;
+            std::println(stderr, "{}:{}: check failed: {}", where.file_name(), where.line(), expr);
+        }
+        return ok;
+    }
+
+    inline bool check_ok(const decode_error err, const char* expr,
+                         const std::source_location where = std::source_location::current()) noexcept
+    {
+        ++checks;
+        if (err != decode_error::ok)
+        {
+            ++failures;
+            std::println(stderr, "{}:{}: {} returned {}", where.file_name(), where.line(), expr, to_string(err));
+        }
+        return err == decode_error::ok;
+    }
+
+    /// @brief Prints the summary line and returns the process exit code.
+    [[nodiscard]] inline int finish(const std::string_view suite) noexcept
+    {
+        std::println("{}: {} checks, {} failed", suite, checks, failures);
+        return failures ? 1 : 0;
+    }
+
+    /// @brief Small deterministic generator (xorshift64*), so failures reproduce.
+    struct rng_t
+    {
+        uint64_t state;
+
+        [[nodiscard]] uint32_t next() noexcept
+        {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return static_cast<uint32_t>(state * 0x2545F4914F6CDD1DULL >> 32);
+        }
+
+        [[nodiscard]] uint32_t below(const uint32_t n) noexcept { return next() % n; }
+    };
+
+    // ──────────────────────────────────────────────────────────────────────────────
+    // Reference PNG writer
+    // ──────────────────────────────────────────────────────────────────────────────
+
+    struct png_spec_t
+    {
+        uint32_t    width{ 1 };
+        uint32_t    height{ 1 };
+        uint8_t     bit_depth{ 8 };
+        uint8_t     color_type{ 6 };
+        uint8_t     interlace{ 0 };
+    };
+
+    [[nodiscard]] constexpr uint32_t channel_count(const uint8_t color_type) noexcept
+    {
+        switch (color_type)
+        {
+            case 0:  return 1;
+            case 2:  return 3;
+            case 4:  return 2;
+            case 6:  return 4;
+            default: return 0;
+        }
+    }
+
+    [[nodiscard]] inline uint32_t crc32(const std::span<const uint8_t> bytes, uint32_t crc = 0) noexcept
+    {
+        crc = ~crc;
+        for (const uint8_t b: bytes)
+        {
+            crc ^= b;
+            for (int k{ 0 }; k < 8; ++k) crc = crc >> 1 ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+        return ~crc;
+    }
+
+    [[nodiscard]] inline uint32_t adler32(const std::span<const uint8_t> bytes) noexcept
+    {
+        uint32_t a{ 1 };
+        uint32_t b{ 0 };
+        for (const uint8_t v: bytes)
+        {
+            a = (a + v) % 65521u;
+            b = (b + a) % 65521u;
+        }
+        return b << 16 | a;
+    }
+
+    inline void put_u32(std::vector<uint8_t>& out, const uint32_t v)
+    {
+        out.insert(out.end(), { static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16),
+                                static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) });
+    }
+
+    inline void put_chunk(std::vector<uint8_t>& png, const char (&type)[5], const std::span<const uint8_t> data)
+    {
+        put_u32(png, static_cast<uint32_t>(data.size()));
+        const size_t type_pos{ png.size() };
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        put_u32(png, crc32({ png.data() + type_pos, png.size() - type_pos }));
+    }
+
+    /// @brief zlib framing (no compression) around `raw`: stored blocks of at most 65535 bytes.
+    [[nodiscard]] inline std::vector<uint8_t> zlib_stored(const std::span<const uint8_t> raw)
+    {
+        std::vector<uint8_t> z{ 0x78, 0x01 };
+        size_t pos{ 0 };
+        do
+        {
+            const size_t len{ std::min<size_t>(raw.size() - pos, 65535) };
+            const bool final{ pos + len == raw.size() };
+            z.insert(z.end(), { static_cast<uint8_t>(final), static_cast<uint8_t>(len),
+                                static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(~len),
+                                static_cast<uint8_t>(~len >> 8) });
+            z.insert(z.end(), raw.begin() + static_cast<ptrdiff_t>(pos),
+                     raw.begin() + static_cast<ptrdiff_t>(pos + len));
+            pos += len;
+        }
+        while (pos < raw.size());
+        put_u32(z, adler32(raw));
+        return z;
+    }
+
+    struct extra_chunk_t
+    {
+        char                    type[5];
+        std::vector<uint8_t>    data;
+    };
+
+    /// @brief Frames a zlib stream as a PNG, split into IDAT chunks of `idat_size` bytes (0: one chunk).
+    [[nodiscard]] inline std::vector<uint8_t> make_png(const png_spec_t& spec, const std::span<const uint8_t> zlib,
+                                                       const std::vector<extra_chunk_t>& extra = { },
+                                                       const size_t idat_size = 0)
+    {
+        std::vector<uint8_t> png{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+        std::vector<uint8_t> ihdr;
+        put_u32(ihdr, spec.width);
+        put_u32(ihdr, spec.height);
+        ihdr.insert(ihdr.end(), { spec.bit_depth, spec.color_type, 0, 0, spec.interlace });
+        put_chunk(png, "IHDR", ihdr);
+
+        for (const extra_chunk_t& chunk: extra) put_chunk(png, chunk.type, chunk.data);
+
+        const size_t step{ idat_size ? idat_size : std::max<size_t>(zlib.size(), 1) };
+        for (size_t pos{ 0 }; pos < zlib.size(); pos += step)
+            put_chunk(png, "IDAT", zlib.subspan(pos, std::min(step, zlib.size() - pos)));
+
+        put_chunk(png, "IEND", { });
+        return png;
+    }
+
+    [[nodiscard]] constexpr uint8_t paeth(const int a, const int b, const int c) noexcept
+    {
+        const int p{ a + b - c };
+        const int pa{ p > a ? p - a : a - p };
+        const int pb{ p > b ? p - b : b - p };
+        const int pc{ p > c ? p - c : c - p };
+        return static_cast<uint8_t>(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+    }
+
+    /**
+     * Appends the filtered scanlines of the `width`×`height` sub-image that starts at pixel
+     * (x0, y0) and takes every `x_step`-th column of every `y_step`-th row (1 / 1 for a plain
+     * image). Row y uses filter type (y + filter_seed) % 5.
+     */
+    inline void append_scanlines(std::vector<uint8_t>& out, const png_spec_t& spec,
+                                 const std::span<const uint16_t> samples, const uint32_t x0, const uint32_t y0,
+                                 const uint32_t x_step, const uint32_t y_step, const uint32_t width,
+                                 const uint32_t height, const uint32_t filter_seed)
+    {
+        if (width == 0 || height == 0) return;
+
+        const uint32_t channels{ channel_count(spec.color_type) };
+        const size_t row_bytes{ (static_cast<size_t>(width) * channels * spec.bit_depth + 7) / 8 };
+        const size_t bpp{ std::max<size_t>(1, channels * spec.bit_depth / 8) };
+
+        std::vector<uint8_t> prior(row_bytes, 0);
+        std::vector<uint8_t> row(row_bytes);
+
+        for (uint32_t y{ 0 }; y < height; ++y)
+        {
+            std::fill(row.begin(), row.end(), uint8_t{ 0 });
+            const size_t src_row{ static_cast<size_t>(y0 + y * y_step) * spec.width };
+            size_t bit{ 0 };
+
+            for (uint32_t x{ 0 }; x < width; ++x)
+            {
+                for (uint32_t c{ 0 }; c < channels; ++c)
+                {
+                    const uint16_t v{ samples[(src_row + x0 + x * x_step) * channels + c] };
+                    if (spec.bit_depth == 16)
+                    {
+                        row[bit / 8] = static_cast<uint8_t>(v >> 8);
+                        row[bit / 8 + 1] = static_cast<uint8_t>(v);
+                    }
+                    else
+                    {
+                        row[bit / 8] |= static_cast<uint8_t>(v << (8 - spec.bit_depth - bit % 8));
+                    }
+                    bit += spec.bit_depth;
+                }
+            }
+
+            const uint8_t filter{ static_cast<uint8_t>((y + filter_seed) % 5) };
+            out.push_back(filter);
+            for (size_t i{ 0 }; i < row_bytes; ++i)
+            {
+                const int a{ i >= bpp ? row[i - bpp] : 0 };
+                const int b{ prior[i] };
+                const int c{ i >= bpp ? prior[i - bpp] : 0 };
+                int predicted{ 0 };
+                switch (filter)
+                {
+                    case 1: predicted = a; break;
+                    case 2: predicted = b; break;
+                    case 3: predicted = (a + b) / 2; break;
+                    case 4: predicted = paeth(a, b, c); break;
+                    default: break;
+                }
+                out.push_back(static_cast<uint8_t>(row[i] - predicted));
+            }
+
+            prior = row;
+        }
+    }
+
+    /// @brief Adam7 pass origins and steps: x0, y0, dx, dy.
+    inline constexpr std::array<std::array<uint32_t, 4>, 7> adam7_passes{ {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 },
+    } };
+
+    /// @brief Filtered scanlines for `samples` (row-major, `channel_count` per pixel), Adam7 if requested.
+    [[nodiscard]] inline std::vector<uint8_t> scanlines(const png_spec_t& spec, const std::span<const uint16_t> samples)
+    {
+        std::vector<uint8_t> raw;
+        if (spec.interlace == 0)
+        {
+            append_scanlines(raw, spec, samples, 0, 0, 1, 1, spec.width, spec.height, 0);
+            return raw;
+        }
+
+        for (uint32_t p{ 0 }; p < 7; ++p)
+        {
+            const auto [x0, y0, dx, dy]{ adam7_passes[p] };
+            const uint32_t w{ spec.width > x0 ? (spec.width - x0 + dx - 1) / dx : 0 };
+            const uint32_t h{ spec.height > y0 ? (spec.height - y0 + dy - 1) / dy : 0 };
+            append_scanlines(raw, spec, samples, x0, y0, dx, dy, w, h, p);
+        }
+        return raw;
+    }
+
+    [[nodiscard]] inline std::vector<uint8_t> make_png(const png_spec_t& spec, const std::span<const uint16_t> samples,
+                                                       const std::vector<extra_chunk_t>& extra = { })
+    {
+        return make_png(spec, zlib_stored(scanlines(spec, samples)), extra);
+    }
+
+    /// @brief Random samples for `spec`, `channel_count` per pixel, within its bit depth.
+    [[nodiscard]] inline std::vector<uint16_t> random_samples(const png_spec_t& spec, rng_t& rng)
+    {
+        std::vector<uint16_t> samples(static_cast<size_t>(spec.width) * spec.height * channel_count(spec.color_type));
+        for (uint16_t& s: samples) s = static_cast<uint16_t>(rng.below(1u << spec.bit_depth));
+        return samples;
+    }
+
+    /// @brief A sample scaled to 8 bits the way the decoder documents it.
+    [[nodiscard]] constexpr uint8_t to_8bit(const uint32_t v, const uint8_t bit_depth) noexcept
+    {
+        if (bit_depth == 16) return static_cast<uint8_t>((v * 255u + 32767u) / 65535u);
+        return static_cast<uint8_t>(v * 255u / ((1u << bit_depth) - 1u));
+    }
+
+    /// @brief Reference RGBA8 expansion of `samples`: gray replicated, missing alpha opaque.
+    [[nodiscard]] inline std::vector<uint8_t> expected_rgba8(const png_spec_t& spec,
+                                                             const std::span<const uint16_t> samples)
+    {
+        const uint32_t channels{ channel_count(spec.color_type) };
+        const size_t pixels{ static_cast<size_t>(spec.width) * spec.height };
+        std::vector<uint8_t> out(pixels * 4);
+
+        for (size_t i{ 0 }; i < pixels; ++i)
+        {
+            const uint16_t* s{ samples.data() + i * channels };
+            const bool gray{ channels <= 2 };
+            const bool alpha{ channels == 2 || channels == 4 };
+            for (uint32_t c{ 0 }; c < 3; ++c) out[i * 4 + c] = to_8bit(s[gray ? 0 : c], spec.bit_depth);
+            out[i * 4 + 3] = alpha ? to_8bit(s[channels - 1], spec.bit_depth) : uint8_t{ 255 };
+        }
+        return out;
+    }
+
+    /// @brief An RGBA8 image (4 samples per pixel) as an 8-bit color type 6 PNG.
+    [[nodiscard]] inline std::vector<uint8_t> make_rgba8_png(const uint32_t width, const uint32_t height,
+                                                             const std::span<const uint8_t> rgba)
+    {
+        const std::vector<uint16_t> samples(rgba.begin(), rgba.end());
+        return make_png({ .width = width, .height = height }, samples);
+    }
+
+    /// @brief A random RGBA8 image, optionally fully opaque.
+    [[nodiscard]] inline std::vector<uint8_t> random_rgba8(const uint32_t width, const uint32_t height, rng_t& rng,
+                                                           const bool opaque = false)
+    {
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+        for (size_t i{ 0 }; i < rgba.size(); ++i)
+            rgba[i] = opaque && i % 4 == 3 ? uint8_t{ 255 } : static_cast<uint8_t>(rng.next());
+        return rgba;
+    }
+
+    [[nodiscard]] inline bool equal_bytes(const std::span<const uint8_t> a, const std::span<const uint8_t> b) noexcept
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+} // namespace cpng::test
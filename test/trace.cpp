@@ -0,0 +1,153 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Trace hooks: balanced zones and counters around parsing, each deflate block and each band of
+// rows when the library is built with CARROTPNG_ENABLE_TRACE, no calls at all without it, hooks
+// that uninstall cleanly, and the Chrome trace writer's event list and JSON file.
+
+#include "test_support.h"
+
+#include "cpng/trace.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+using namespace cpng;
+
+namespace {
+    /// @brief Records what the hooks saw; zones are checked for nesting as they end.
+    struct recorder_t
+    {
+        std::vector<std::string>                    open;
+        std::map<std::string, uint32_t>             zones;
+        std::map<std::string, std::vector<int64_t>> counters;
+        bool                                        nested{ true };
+
+        [[nodiscard]] trace_hooks_t hooks() noexcept
+        {
+            return {
+                .begin_zone = [](void* user, const char* name) noexcept {
+                    static_cast<recorder_t*>(user)->open.emplace_back(name);
+                },
+                .end_zone = [](void* user, const char* name) noexcept {
+                    recorder_t& r{ *static_cast<recorder_t*>(user) };
+                    r.nested &= !r.open.empty() && r.open.back() == name;
+                    if (!r.open.empty()) r.open.pop_back();
+                    ++r.zones[name];
+                },
+                .counter = [](void* user, const char* name, const int64_t value) noexcept {
+                    static_cast<recorder_t*>(user)->counters[name].push_back(value);
+                },
+                .user = this,
+            };
+        }
+    };
+
+    decode_error decode(const std::vector<uint8_t>& png, decode_stats_t& stats)
+    {
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        return load_from_memory(png, view, storage, { }, stats);
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x047 };
+
+    const test::png_spec_t spec{ .width = 24, .height = 70 };
+    const std::vector<uint8_t> raw{ test::scanlines(spec, test::random_samples(spec, rng)) };
+    std::vector<uint8_t> zlib{ test::zlib_stored(std::span{ raw }.first(1000)) };
+    {
+        // Two stored blocks: the first one not final
+        std::vector<uint8_t> rest{ test::zlib_stored(std::span{ raw }.subspan(1000)) };
+        zlib.resize(zlib.size() - 4);
+        zlib[2] = 0;
+        zlib.insert(zlib.end(), rest.begin() + 2, rest.end() - 4);
+        test::put_u32(zlib, test::adler32(raw));
+    }
+    const std::vector<uint8_t> png{ test::make_png(spec, zlib) };
+
+    // Zones and counters of one decode
+    {
+        recorder_t recorder{ };
+        set_trace_hooks(recorder.hooks());
+        decode_stats_t stats{ };
+        CPNG_CHECK_OK(decode(png, stats));
+        set_trace_hooks({ });
+        CPNG_CHECK(stats.stored_blocks == 2);
+
+        if (trace_compiled_in())
+        {
+            CPNG_CHECK(recorder.nested && recorder.open.empty());
+            CPNG_CHECK(recorder.zones["cpng parse chunks"] >= 1);
+            CPNG_CHECK(recorder.zones["cpng inflate stored block"] == 2);
+            CPNG_CHECK(recorder.zones["cpng defilter rows"] == (spec.height + 31) / 32);
+
+            const std::vector<int64_t>& inflated{ recorder.counters["cpng inflated bytes"] };
+            CPNG_CHECK(inflated.size() == 2 && inflated[0] == 1000 && inflated[1] == static_cast<int64_t>(raw.size()));
+            CPNG_CHECK((recorder.counters["cpng rows"] == std::vector<int64_t>{ 32, 64, 70 }));
+        }
+        else
+        {
+            CPNG_CHECK(recorder.zones.empty() && recorder.counters.empty() && recorder.open.empty());
+        }
+
+        // Uninstalled hooks see nothing more
+        const size_t zones{ recorder.zones.size() };
+        CPNG_CHECK_OK(decode(png, stats));
+        CPNG_CHECK(recorder.zones.size() == zones && recorder.open.empty());
+
+        // Hooks with a missing function are not installed
+        trace_hooks_t partial{ recorder.hooks() };
+        partial.counter = nullptr;
+        set_trace_hooks(partial);
+        CPNG_CHECK_OK(decode(png, stats));
+        set_trace_hooks({ });
+        CPNG_CHECK(recorder.zones.size() == zones);
+    }
+
+    // The Chrome trace writer records through its hooks, installed or called directly
+    {
+        chrome_trace_writer_t writer{ };
+        const trace_hooks_t hooks{ writer.hooks() };
+        hooks.begin_zone(hooks.user, "outer \"quoted\"");
+        hooks.counter(hooks.user, "count", -42);
+        hooks.end_zone(hooks.user, "outer \"quoted\"");
+        CPNG_CHECK(writer.event_count() == 3);
+
+        set_trace_hooks(hooks);
+        decode_stats_t stats{ };
+        CPNG_CHECK_OK(decode(png, stats));
+        set_trace_hooks({ });
+        CPNG_CHECK(trace_compiled_in() ? writer.event_count() > 3 : writer.event_count() == 3);
+
+        const std::string path{ (std::filesystem::temp_directory_path() / "carrotpng_trace.json").string() };
+        CPNG_CHECK_OK(writer.write(path.c_str()));
+
+        std::stringstream json;
+        json << std::ifstream{ path, std::ios::binary }.rdbuf();
+        const std::string text{ json.str() };
+        CPNG_CHECK(text.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") && text.ends_with("\n]}\n"));
+        CPNG_CHECK(text.find("\"name\":\"outer \\\"quoted\\\"\",\"cat\":\"cpng\",\"ph\":\"B\"") != std::string::npos);
+        CPNG_CHECK(text.find("\"ph\":\"C\"") != std::string::npos);
+        CPNG_CHECK(text.find("\"args\":{\"value\":-42}") != std::string::npos);
+
+        writer.clear();
+        CPNG_CHECK(writer.event_count() == 0);
+        CPNG_CHECK_OK(writer.write(path.c_str()));
+        json.str({ });
+        json << std::ifstream{ path, std::ios::binary }.rdbuf();
+        CPNG_CHECK(json.str() == "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");
+        std::filesystem::remove(path);
+
+        CPNG_CHECK(writer.write("/nonexistent_carrotpng_dir/trace.json") == decode_error::file_write_failed);
+    }
+
+    return test::finish("trace");
+}
@@ -0,0 +1,158 @@
+//
+// Created by Zack Shrout on 4/4/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// Transfer functions and float output: RGBA32F / RGBA16F normalization, sRGB linearization,
+// gAMA / sRGB driven gamma correction, and the is_srgb hint of the result.
+
+#include "test_support.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+using namespace cpng;
+
+namespace {
+    double srgb_to_linear(const double c)
+    {
+        return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    float half_to_float(const uint16_t h)
+    {
+        const int exp{ h >> 10 & 0x1F };
+        const int mant{ h & 0x3FF };
+        const float magnitude{ exp == 0 ? std::ldexp(static_cast<float>(mant), -24)
+                                        : std::ldexp(static_cast<float>(mant | 0x400), exp - 25) };
+        return h & 0x8000 ? -magnitude : magnitude;
+    }
+
+    std::vector<float> floats(const image_view_t& view)
+    {
+        std::vector<float> out(view.pixels.size() / 4);
+        std::memcpy(out.data(), view.pixels.data(), view.pixels.size());
+        return out;
+    }
+
+    std::vector<uint8_t> gama_chunk(const uint32_t gamma_x100000)
+    {
+        std::vector<uint8_t> data;
+        test::put_u32(data, gamma_x100000);
+        return data;
+    }
+
+    /// @brief Largest |out - f(in)| over an RGBA32F decode; alpha must pass through as in / max.
+    double max_error(const image_view_t& view, const std::span<const uint16_t> samples, const double max_code,
+                     const auto& curve, bool& alpha_linear)
+    {
+        const std::vector<float> out{ floats(view) };
+        double worst{ 0.0 };
+        alpha_linear = true;
+        for (size_t i{ 0 }; i < out.size(); ++i)
+        {
+            const double in{ samples[i] / max_code };
+            if (i % 4 == 3) alpha_linear &= std::abs(out[i] - in) < 1e-6;
+            else worst = std::max(worst, std::abs(out[i] - curve(in)));
+        }
+        return worst;
+    }
+} // namespace
+
+int main()
+{
+    test::rng_t rng{ 0x029 };
+
+    for (const uint8_t depth: { 8, 16 })
+    {
+        const test::png_spec_t spec{ .width = 19, .height = 11, .bit_depth = depth };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const double max_code{ depth == 16 ? 65535.0 : 255.0 };
+        const std::vector<uint8_t> png{ test::make_png(spec, samples) };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        bool alpha_linear{ };
+
+        // Plain float output is the sample over its maximum
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::rgba32f }));
+        CPNG_CHECK(view.format == pixel_format::rgba32f && view.stride_bytes == spec.width * 16);
+        CPNG_CHECK(max_error(view, samples, max_code, [](const double v) { return v; }, alpha_linear) < 1e-6);
+        CPNG_CHECK(alpha_linear && view.is_srgb);
+
+        // sRGB decode; alpha stays linear
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::rgba32f,
+                                                             .transform = color_transform::srgb_to_linear }));
+        CPNG_CHECK(max_error(view, samples, max_code, srgb_to_linear, alpha_linear) < 1e-5);
+        CPNG_CHECK(alpha_linear && !view.is_srgb);
+
+        // Half floats: the RGBA32F result rounded to binary16
+        std::vector<uint8_t> full;
+        image_view_t full_view{ };
+        CPNG_CHECK_OK(load_from_memory(png, full_view, full, { .format = pixel_format::rgba32f,
+                                                               .transform = color_transform::srgb_to_linear }));
+        CPNG_CHECK_OK(load_from_memory(png, view, storage, { .format = pixel_format::rgba16f,
+                                                             .transform = color_transform::srgb_to_linear }));
+        const std::vector<float> expected{ floats(full_view) };
+        bool half_ok{ storage.size() == expected.size() * 2 };
+        for (size_t i{ 0 }; half_ok && i < expected.size(); ++i)
+        {
+            uint16_t h{ };
+            std::memcpy(&h, storage.data() + i * 2, 2);
+            half_ok = std::abs(half_to_float(h) - expected[i]) <= std::max(std::abs(expected[i]) * 0x1p-11f, 0x1p-25f);
+        }
+        CPNG_CHECK(half_ok);
+    }
+
+    // Linearizing into RGBA8 rounds the curve to 8 bits
+    {
+        const test::png_spec_t spec{ .width = 256, .height = 1, .color_type = 0 };
+        std::vector<uint16_t> ramp(256);
+        for (uint16_t i{ 0 }; i < 256; ++i) ramp[i] = i;
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, ramp), view, storage,
+                                       { .format = pixel_format::r8, .transform = color_transform::srgb_to_linear }));
+        bool rounded{ storage.size() == 256 };
+        for (size_t i{ 0 }; rounded && i < 256; ++i)
+            rounded = std::abs(storage[i] - srgb_to_linear(i / 255.0) * 255.0) <= 0.5 + 1e-3;
+        CPNG_CHECK(rounded && storage[0] == 0 && storage[255] == 255);
+    }
+
+    // Gamma correction: out = in^(1 / (file_gamma * display_gamma))
+    {
+        const test::png_spec_t spec{ .width = 16, .height = 16 };
+        const std::vector<uint16_t> samples{ test::random_samples(spec, rng) };
+        const decode_options_t gamma_options{ .format = pixel_format::rgba32f,
+                                              .transform = color_transform::gamma, .display_gamma = 2.2f };
+        image_view_t view{ };
+        std::vector<uint8_t> storage;
+        bool alpha_linear{ };
+
+        // Linear file (gAMA 1.0) shown on a 2.2 display
+        const std::vector<uint8_t> linear_png{ test::make_png(spec, samples, { { "gAMA", gama_chunk(100000) } }) };
+        CPNG_CHECK_OK(load_from_memory(linear_png, view, storage, gamma_options));
+        CPNG_CHECK(max_error(view, samples, 255.0, [](const double v) { return std::pow(v, 1.0 / 2.2); },
+                             alpha_linear) < 1e-4);
+        CPNG_CHECK(alpha_linear);
+
+        // sRGB files count as gamma 1/2.2: to a linear display that is in^2.2, and the result is linear
+        const std::vector<uint8_t> srgb_png{ test::make_png(spec, samples, { { "sRGB", { 0 } } }) };
+        decode_options_t to_linear{ gamma_options };
+        to_linear.display_gamma = 1.0f;
+        CPNG_CHECK_OK(load_from_memory(srgb_png, view, storage, to_linear));
+        CPNG_CHECK(max_error(view, samples, 255.0, [](const double v) { return std::pow(v, 2.2); },
+                             alpha_linear) < 1e-4);
+        CPNG_CHECK(!view.is_srgb);
+
+        // Files without gAMA or sRGB are left untouched
+        CPNG_CHECK_OK(load_from_memory(test::make_png(spec, samples), view, storage, gamma_options));
+        CPNG_CHECK(max_error(view, samples, 255.0, [](const double v) { return v; }, alpha_linear) < 1e-6);
+
+        // A gAMA of 1.0 marks the stored values as linear
+        CPNG_CHECK_OK(load_from_memory(linear_png, view, storage));
+        CPNG_CHECK(!view.is_srgb && test::equal_bytes(view.pixels, test::expected_rgba8(spec, samples)));
+    }
+
+    return test::finish("transforms");
+}
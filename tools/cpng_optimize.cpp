@@ -0,0 +1,221 @@
+//
+// Created by Zack Shrout on 3/29/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// cpng_optimize: losslessly recompresses PNGs for shipping, as small as it can.
+//
+//   cpng_optimize [--iterations N] [--threads N] [--no-reduce] [--strip-color] [--keep TYPE]...
+//                 [-o <out.png>] <file.png | directory>...
+//
+// Files are replaced in place, and only when the result is smaller. With -o the single input
+// is written to <out.png> instead, whatever its size. --keep copies an ancillary chunk type
+// (e.g. pHYs or tEXt) that would otherwise be stripped; --strip-color drops iCCP, sRGB, gAMA,
+// cHRM and cICP as well. Directories are searched recursively for *.png.
+
+#include <cpng/optimizer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool read_file(const fs::path& path, std::vector<uint8_t>& out)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        out.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size()));
+
+        return file.good();
+    }
+
+    /// @brief Writes through a temporary file, so an interrupted run never leaves a truncated asset.
+    bool write_file(const fs::path& path, const std::vector<uint8_t>& bytes)
+    {
+        fs::path temp{ path };
+        temp += ".tmp";
+
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file.good()) return false;
+        }
+
+        std::error_code ec;
+        fs::rename(temp, path, ec);
+        return !ec;
+    }
+
+    bool is_png(const fs::path& path)
+    {
+        std::string ext{ path.extension().string() };
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png";
+    }
+
+    void collect(const fs::path& arg, std::vector<std::string>& out)
+    {
+        std::error_code ec;
+
+        if (!fs::is_directory(arg, ec))
+        {
+            out.push_back(arg.generic_string());
+            return;
+        }
+
+        std::vector<std::string> found;
+        for (const fs::directory_entry& entry: fs::recursive_directory_iterator(arg, ec))
+            if (entry.is_regular_file() && is_png(entry.path()))
+                found.push_back(entry.path().generic_string());
+
+        std::ranges::sort(found);
+        out.insert(out.end(), found.begin(), found.end());
+    }
+
+    std::string_view strategy_name(const cpng::filter_strategy strategy)
+    {
+        switch (strategy)
+        {
+            case cpng::filter_strategy::none:        return "none";
+            case cpng::filter_strategy::sub:         return "sub";
+            case cpng::filter_strategy::up:          return "up";
+            case cpng::filter_strategy::average:     return "average";
+            case cpng::filter_strategy::paeth:       return "paeth";
+            case cpng::filter_strategy::min_sum:     return "min-sum";
+            case cpng::filter_strategy::brute_force: return "brute-force";
+        }
+
+        return "?";
+    }
+
+    bool parse_u32(const std::string_view text, uint32_t& out)
+    {
+        return std::from_chars(text.data(), text.data() + text.size(), out).ec == std::errc{ };
+    }
+
+    void usage()
+    {
+        std::println(stderr, "usage: cpng_optimize [--iterations N] [--threads N] [--no-reduce] [--strip-color] "
+                             "[--keep TYPE]... [-o <out.png>] <file.png | directory>...");
+    }
+} // anonymous namespace
+
+int main(const int argc, char** argv)
+{
+    cpng::optimize_options_t options{ };
+    std::vector<uint32_t> keep;
+    const char* out_path{ nullptr };
+
+    int arg{ 1 };
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        const std::string_view flag{ argv[arg] };
+        const bool has_value{ arg + 1 < argc };
+
+        if (flag == "--iterations" && has_value && parse_u32(argv[arg + 1], options.iterations))
+        {
+            ++arg;
+        }
+        else if (flag == "--threads" && has_value && parse_u32(argv[arg + 1], options.worker_threads))
+        {
+            ++arg;
+        }
+        else if (flag == "--no-reduce")
+        {
+            options.reduce = false;
+        }
+        else if (flag == "--strip-color")
+        {
+            options.keep_color_chunks = false;
+        }
+        else if (flag == "--keep" && has_value && std::string_view{ argv[arg + 1] }.size() == 4)
+        {
+            const std::string_view name{ argv[++arg] };
+            keep.push_back(static_cast<uint32_t>(static_cast<uint8_t>(name[0])) << 24 |
+                           static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 16 |
+                           static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 8 |
+                           static_cast<uint32_t>(static_cast<uint8_t>(name[3])));
+        }
+        else if (flag == "-o" && has_value)
+        {
+            out_path = argv[++arg];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    options.keep_chunks = keep;
+
+    std::vector<std::string> names;
+    for (; arg < argc; ++arg)
+        collect(argv[arg], names);
+
+    if (names.empty() || (out_path != nullptr && names.size() != 1))
+    {
+        usage();
+        return 2;
+    }
+
+    uint32_t failed{ 0 };
+    uint64_t total_in{ 0 };
+    uint64_t total_out{ 0 };
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+
+    for (const std::string& name: names)
+    {
+        if (!read_file(name, input))
+        {
+            std::println(stderr, "{}: cannot read", name);
+            ++failed;
+            continue;
+        }
+
+        cpng::optimize_report_t report{ };
+        if (const cpng::decode_error err{ cpng::optimize_png(input, output, report, options) };
+            err != cpng::decode_error::ok)
+        {
+            std::println(stderr, "{}: {}", name, cpng::to_string(err));
+            ++failed;
+            continue;
+        }
+
+        const bool replace{ out_path != nullptr || output.size() < input.size() };
+        if (replace && !write_file(out_path != nullptr ? fs::path{ out_path } : fs::path{ name }, output))
+        {
+            std::println(stderr, "{}: cannot write", out_path != nullptr ? out_path : name.c_str());
+            ++failed;
+            continue;
+        }
+
+        const size_t kept{ replace ? output.size() : input.size() };
+        total_in += input.size();
+        total_out += kept;
+
+        std::print("{}: {} -> {} bytes ({:+.1f}%), color type {}, {}-bit", name, input.size(), output.size(),
+                   100.0 * (static_cast<double>(output.size()) / static_cast<double>(input.size()) - 1.0),
+                   report.color_type, report.bit_depth);
+        std::println(", {} filters, {} chunks removed{}", strategy_name(report.filter), report.chunks_removed,
+                     replace ? "" : " (kept original)");
+    }
+
+    std::println("Optimized {} files ({} failed): {} -> {} bytes", names.size(), failed, total_in, total_out);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+//
+// Created by Zack Shrout on 3/23/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// cpng_pack: builds and inspects CarrotPNG archives.
+//
+//   cpng_pack create <out.cpak> <file.png | directory>...
+//   cpng_pack list <in.cpak>
+//
+// Directories are searched recursively for *.png; entries are named by their path
+// relative to the directory given on the command line, with '/' separators.
+
+#include <cpng/archive.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct input_file_t
+    {
+        std::string             name;
+        std::vector<uint8_t>    bytes;
+    };
+
+    bool read_file(const fs::path& path, std::vector<uint8_t>& out)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        out.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size())));
+    }
+
+    bool is_png(const fs::path& path)
+    {
+        std::string ext{ path.extension().string() };
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png";
+    }
+
+    bool collect(const fs::path& arg, std::vector<input_file_t>& out)
+    {
+        std::error_code ec;
+
+        if (!fs::is_directory(arg, ec))
+        {
+            input_file_t input{ arg.filename().generic_string(), { } };
+            if (!read_file(arg, input.bytes))
+            {
+                std::println(stderr, "Cannot read {}", arg.string());
+                return false;
+            }
+
+            out.push_back(std::move(input));
+            return true;
+        }
+
+        std::vector<fs::path> found;
+        for (const fs::directory_entry& entry: fs::recursive_directory_iterator(arg, ec))
+            if (entry.is_regular_file() && is_png(entry.path()))
+                found.push_back(entry.path());
+
+        // Directory iteration order is unspecified; sort so archives are reproducible
+        std::ranges::sort(found);
+
+        for (const fs::path& path: found)
+        {
+            input_file_t input{ fs::relative(path, arg).generic_string(), { } };
+            if (!read_file(path, input.bytes))
+            {
+                std::println(stderr, "Cannot read {}", path.string());
+                return false;
+            }
+
+            out.push_back(std::move(input));
+        }
+
+        return true;
+    }
+
+    int create(const char* out_path, const int count, char** args)
+    {
+        std::vector<input_file_t> inputs;
+        for (int i{ 0 }; i < count; ++i)
+            if (!collect(args[i], inputs)) return 1;
+
+        std::vector<cpng::archive_source_t> sources;
+        sources.reserve(inputs.size());
+
+        uint64_t total_bytes{ 0 };
+        for (const input_file_t& input: inputs)
+        {
+            sources.push_back({ input.name, input.bytes });
+            total_bytes += input.bytes.size();
+        }
+
+        const cpng::decode_error err{ cpng::write_archive(out_path, sources) };
+        if (err != cpng::decode_error::ok)
+        {
+            std::println(stderr, "Failed to write {}: {}", out_path, cpng::to_string(err));
+            return 1;
+        }
+
+        std::println("Packed {} images ({} bytes of PNG data) into {}", sources.size(), total_bytes, out_path);
+        return 0;
+    }
+
+    int list(const char* path)
+    {
+        cpng::archive_t archive;
+
+        const cpng::decode_error err{ archive.open(path) };
+        if (err != cpng::decode_error::ok)
+        {
+            std::println(stderr, "Failed to open {}: {}", path, cpng::to_string(err));
+            return 1;
+        }
+
+        for (uint32_t i{ 0 }; i < archive.size(); ++i)
+        {
+            const cpng::archive_entry_t entry{ archive.entry(i) };
+            std::println("{:>6}x{:<6} depth {:>2} type {} {:>10} bytes  {}", entry.ihdr.width, entry.ihdr.height,
+                         entry.ihdr.bit_depth, entry.ihdr.color_type, entry.size, entry.name);
+        }
+
+        std::println("{} entries", archive.size());
+        return 0;
+    }
+
+    void usage()
+    {
+        std::println(stderr, "usage: cpng_pack create <out.cpak> <file.png | directory>...");
+        std::println(stderr, "       cpng_pack list <in.cpak>");
+    }
+} // anonymous namespace
+
+int main(const int argc, char** argv)
+{
+    if (argc >= 4 && std::string_view{ argv[1] } == "create")
+        return create(argv[2], argc - 3, argv + 3);
+
+    if (argc == 3 && std::string_view{ argv[1] } == "list")
+        return list(argv[2]);
+
+    usage();
+    return 2;
+}
@@ -0,0 +1,211 @@
+//
+// Created by Zack Shrout on 3/25/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// cpng_probe: reads the headers of many PNGs and writes them as a compact binary index.
+//
+//   cpng_probe [--scan] [--threads N] <out.idx> <file.png | directory>...
+//
+// --scan also walks each chunk list (sRGB / gAMA / iCCP / PLTE flags, IDAT totals).
+// Directories are searched recursively for *.png; names are stored as given, with '/'
+// separators.
+//
+// Index layout (all integers little endian):
+//
+//   header   "CPHI" | version u32 | entry count u32 | flags u32 (bit 0: scanned) | names offset u64
+//   records  entry count × 36 bytes, in the order the files were found:
+//            width u32 | height u32 | bit depth u8 | color type u8 | interlace u8 |
+//            flags u8 (bit 0 sRGB, 1 gAMA, 2 iCCP, 3 PLTE) | decode_error u8 | reserved u8 × 3 |
+//            gAMA × 100000 u32 | IDAT bytes u64 | name offset u32 | name length u32
+//   names    paths, not terminated, addressed from the names offset
+
+#include <cpng/header_probe.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t k_header_bytes{ 24 };
+    constexpr size_t k_record_bytes{ 36 };
+
+    void write_le32(uint8_t* p, const uint32_t v)
+    {
+        for (uint32_t i{ 0 }; i < 4; ++i)
+            p[i] = static_cast<uint8_t>(v >> (i * 8));
+    }
+
+    void write_le64(uint8_t* p, const uint64_t v)
+    {
+        for (uint32_t i{ 0 }; i < 8; ++i)
+            p[i] = static_cast<uint8_t>(v >> (i * 8));
+    }
+
+    bool is_png(const fs::path& path)
+    {
+        std::string ext{ path.extension().string() };
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png";
+    }
+
+    void collect(const fs::path& arg, std::vector<std::string>& out)
+    {
+        std::error_code ec;
+
+        if (!fs::is_directory(arg, ec))
+        {
+            out.push_back(arg.generic_string());
+            return;
+        }
+
+        std::vector<std::string> found;
+        for (const fs::directory_entry& entry: fs::recursive_directory_iterator(arg, ec))
+            if (entry.is_regular_file() && is_png(entry.path()))
+                found.push_back(entry.path().generic_string());
+
+        // Directory iteration order is unspecified; sort so indices are reproducible
+        std::ranges::sort(found);
+        out.insert(out.end(), found.begin(), found.end());
+    }
+
+    bool write_index(const char* path, const std::vector<std::string>& names,
+                     const std::vector<cpng::header_probe_t>& probes, const bool scanned)
+    {
+        uint64_t names_bytes{ 0 };
+        for (const std::string& name: names)
+            names_bytes += name.size();
+
+        if (names_bytes > UINT32_MAX) return false;
+
+        std::vector<uint8_t> bytes(k_header_bytes + probes.size() * k_record_bytes);
+
+        uint8_t* header{ bytes.data() };
+        std::copy_n("CPHI", 4, header);
+        write_le32(header + 4, 1);
+        write_le32(header + 8, static_cast<uint32_t>(probes.size()));
+        write_le32(header + 12, scanned ? 1u : 0u);
+        write_le64(header + 16, bytes.size());
+
+        uint32_t name_offset{ 0 };
+        for (size_t i{ 0 }; i < probes.size(); ++i)
+        {
+            const cpng::header_probe_t& probe{ probes[i] };
+            const cpng::ihdr_info_t& ihdr{ probe.ihdr };
+            uint8_t* r{ bytes.data() + k_header_bytes + i * k_record_bytes };
+
+            write_le32(r + 0, ihdr.width);
+            write_le32(r + 4, ihdr.height);
+            r[8] = ihdr.bit_depth;
+            r[9] = ihdr.color_type;
+            r[10] = ihdr.interlace_method;
+            r[11] = static_cast<uint8_t>((ihdr.has_srgb ? 1 : 0) | (ihdr.has_gamma ? 2 : 0) |
+                                         (ihdr.has_icc_profile ? 4 : 0) | (probe.has_palette ? 8 : 0));
+            r[12] = static_cast<uint8_t>(probe.error);
+            write_le32(r + 16, static_cast<uint32_t>(std::lround(ihdr.gamma * 100000.0f)));
+            write_le64(r + 20, probe.idat_bytes);
+            write_le32(r + 28, name_offset);
+            write_le32(r + 32, static_cast<uint32_t>(names[i].size()));
+
+            name_offset += static_cast<uint32_t>(names[i].size());
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        for (const std::string& name: names)
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+
+        return file.good();
+    }
+
+    void usage()
+    {
+        std::println(stderr, "usage: cpng_probe [--scan] [--threads N] <out.idx> <file.png | directory>...");
+    }
+} // anonymous namespace
+
+int main(const int argc, char** argv)
+{
+    cpng::probe_options_t options{ };
+
+    int arg{ 1 };
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        const std::string_view flag{ argv[arg] };
+
+        if (flag == "--scan")
+        {
+            options.scan_chunks = true;
+        }
+        else if (flag == "--threads" && arg + 1 < argc)
+        {
+            const std::string_view value{ argv[++arg] };
+            if (std::from_chars(value.data(), value.data() + value.size(), options.worker_threads).ec != std::errc{ })
+            {
+                usage();
+                return 2;
+            }
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (argc - arg < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    const char* out_path{ argv[arg++] };
+
+    std::vector<std::string> names;
+    for (; arg < argc; ++arg)
+        collect(argv[arg], names);
+
+    std::vector<const char*> paths;
+    paths.reserve(names.size());
+    for (const std::string& name: names)
+        paths.push_back(name.c_str());
+
+    std::vector<cpng::header_probe_t> probes(paths.size());
+    if (cpng::probe_headers(paths, probes, options) != cpng::decode_error::ok) return 1;
+
+    uint32_t failed{ 0 };
+    uint64_t rgba8_bytes{ 0 };
+    for (size_t i{ 0 }; i < probes.size(); ++i)
+    {
+        if (probes[i].error != cpng::decode_error::ok)
+        {
+            std::println(stderr, "{}: {}", names[i], cpng::to_string(probes[i].error));
+            ++failed;
+            continue;
+        }
+
+        rgba8_bytes += cpng::output_size_bytes(probes[i].ihdr, cpng::pixel_format::rgba8);
+    }
+
+    if (!write_index(out_path, names, probes, options.scan_chunks))
+    {
+        std::println(stderr, "Failed to write {}", out_path);
+        return 1;
+    }
+
+    std::println("Probed {} files ({} failed), {} bytes as RGBA8, index written to {}", probes.size(), failed,
+                 rgba8_bytes, out_path);
+    return 0;
+}
@@ -0,0 +1,225 @@
+//
+// Created by Zack Shrout on 3/30/26.
+// Copyright (c) 2026 BunnySoft. All rights reserved.
+//
+
+// cpng_reencode: rewrites PNGs to decode faster, within a size budget.
+//
+//   cpng_reencode [--budget PERCENT] [--threads N] [--dry-run] [-o <out.png>] <file.png | directory>...
+//
+// Each file's image data is re-encoded with the decode speed profile: one IDAT, large deflate
+// blocks, cheap filters where they cost little size. Pixels and all other chunks stay as they
+// were. A file is replaced in place when its predicted decode time drops and it grows by no
+// more than the budget (default 3%). With -o the single input is written to <out.png> instead,
+// whatever the outcome. --dry-run only reports. Directories are searched recursively for *.png.
+
+#include <cpng/decode_cost.h>
+#include <cpng/encoder.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool read_file(const fs::path& path, std::vector<uint8_t>& out)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        out.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(out.size()));
+
+        return file.good();
+    }
+
+    /// @brief Writes through a temporary file, so an interrupted run never leaves a truncated asset.
+    bool write_file(const fs::path& path, const std::vector<uint8_t>& bytes)
+    {
+        fs::path temp{ path };
+        temp += ".tmp";
+
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file.good()) return false;
+        }
+
+        std::error_code ec;
+        fs::rename(temp, path, ec);
+        return !ec;
+    }
+
+    bool is_png(const fs::path& path)
+    {
+        std::string ext{ path.extension().string() };
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".png";
+    }
+
+    void collect(const fs::path& arg, std::vector<std::string>& out)
+    {
+        std::error_code ec;
+
+        if (!fs::is_directory(arg, ec))
+        {
+            out.push_back(arg.generic_string());
+            return;
+        }
+
+        std::vector<std::string> found;
+        for (const fs::directory_entry& entry: fs::recursive_directory_iterator(arg, ec))
+            if (entry.is_regular_file() && is_png(entry.path()))
+                found.push_back(entry.path().generic_string());
+
+        std::ranges::sort(found);
+        out.insert(out.end(), found.begin(), found.end());
+    }
+
+    bool parse_u32(const std::string_view text, uint32_t& out)
+    {
+        return std::from_chars(text.data(), text.data() + text.size(), out).ec == std::errc{ };
+    }
+
+    bool parse_percent(const std::string_view text, float& out)
+    {
+        float percent{ };
+        const auto [end, ec]{ std::from_chars(text.data(), text.data() + text.size(), percent) };
+        if (ec != std::errc{ } || end != text.data() + text.size() || percent < 0.0f) return false;
+
+        out = percent / 100.0f;
+        return true;
+    }
+
+    double percent_change(const double before, const double after)
+    {
+        return before > 0.0 ? 100.0 * (after / before - 1.0) : 0.0;
+    }
+
+    void usage()
+    {
+        std::println(stderr, "usage: cpng_reencode [--budget PERCENT] [--threads N] [--dry-run] [-o <out.png>] "
+                             "<file.png | directory>...");
+    }
+} // anonymous namespace
+
+int main(const int argc, char** argv)
+{
+    cpng::encode_options_t options{ };
+    options.profile = cpng::encode_profile::decode_speed;
+
+    bool dry_run{ false };
+    const char* out_path{ nullptr };
+
+    int arg{ 1 };
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        const std::string_view flag{ argv[arg] };
+        const bool has_value{ arg + 1 < argc };
+
+        if (flag == "--budget" && has_value && parse_percent(argv[arg + 1], options.size_budget))
+        {
+            ++arg;
+        }
+        else if (flag == "--threads" && has_value && parse_u32(argv[arg + 1], options.worker_threads))
+        {
+            ++arg;
+        }
+        else if (flag == "--dry-run")
+        {
+            dry_run = true;
+        }
+        else if (flag == "-o" && has_value)
+        {
+            out_path = argv[++arg];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    std::vector<std::string> names;
+    for (; arg < argc; ++arg)
+        collect(argv[arg], names);
+
+    if (names.empty() || (out_path != nullptr && names.size() != 1))
+    {
+        usage();
+        return 2;
+    }
+
+    uint32_t failed{ 0 };
+    uint32_t rewritten{ 0 };
+    uint64_t total_before_ns{ 0 };
+    uint64_t total_after_ns{ 0 };
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+
+    for (const std::string& name: names)
+    {
+        if (!read_file(name, input))
+        {
+            std::println(stderr, "{}: cannot read", name);
+            ++failed;
+            continue;
+        }
+
+        cpng::decode_cost_t before{ };
+        cpng::decode_cost_t after{ };
+
+        cpng::decode_error err{ cpng::estimate_decode_cost(input, before) };
+        if (err == cpng::decode_error::ok) err = cpng::reencode(input, output, options);
+        if (err == cpng::decode_error::ok) err = cpng::estimate_decode_cost(output, after);
+
+        if (err != cpng::decode_error::ok)
+        {
+            std::println(stderr, "{}: {}", name, cpng::to_string(err));
+            ++failed;
+            continue;
+        }
+
+        const double size_limit{ static_cast<double>(input.size()) * (1.0 + options.size_budget) };
+        const bool better{
+            after.predicted_ns < before.predicted_ns && static_cast<double>(output.size()) <= size_limit
+        };
+        const bool replace{ !dry_run && (out_path != nullptr || better) };
+
+        if (replace && !write_file(out_path != nullptr ? fs::path{ out_path } : fs::path{ name }, output))
+        {
+            std::println(stderr, "{}: cannot write", out_path != nullptr ? out_path : name.c_str());
+            ++failed;
+            continue;
+        }
+
+        rewritten += replace ? 1 : 0;
+        total_before_ns += before.predicted_ns;
+        total_after_ns += better ? after.predicted_ns : before.predicted_ns;
+
+        std::print("{}: {} -> {} bytes ({:+.1f}%), ", name, input.size(), output.size(),
+                   percent_change(static_cast<double>(input.size()), static_cast<double>(output.size())));
+        std::print("decode {:.2f} -> {:.2f} ms ({:+.1f}%), ", static_cast<double>(before.predicted_ns) / 1e6,
+                   static_cast<double>(after.predicted_ns) / 1e6,
+                   percent_change(static_cast<double>(before.predicted_ns), static_cast<double>(after.predicted_ns)));
+        std::println("{} -> {} IDAT, {} -> {} dynamic blocks{}", before.idat_chunks, after.idat_chunks,
+                     before.dynamic_blocks, after.dynamic_blocks,
+                     replace ? "" : (better ? " (dry run)" : " (kept original)"));
+    }
+
+    std::println("Re-encoded {} of {} files ({} failed): predicted decode {:.2f} -> {:.2f} ms", rewritten,
+                 names.size(), failed, static_cast<double>(total_before_ns) / 1e6,
+                 static_cast<double>(total_after_ns) / 1e6);
+    return failed == 0 ? 0 : 1;
+}